@@ -84,3 +84,54 @@ endef
 
 $(call demosapi,GL,$(BUILD_GL))
 $(call demosapi,GLES,$(BUILD_GLES))
+
+BENCHMARK_release_CFLAGS = $(LIBRARY_BUILD_release_FLAGS) $(LIBRARY_BUILD_WARN_FLAGS) $(LIBRARY_BUILD_INCLUDES_CFLAGS) $(LIBRARY_BASE_release_CFLAGS) -Idemos/common
+BENCHMARK_debug_CFLAGS = $(LIBRARY_BUILD_debug_FLAGS) $(LIBRARY_BUILD_WARN_FLAGS) $(LIBRARY_BUILD_INCLUDES_CFLAGS) $(LIBRARY_BASE_debug_CFLAGS) -Idemos/common
+
+# how to build each benchmark:
+# $1 --> Benchmark name
+# $2 --> release or debug
+define benchmarkrule
+$(eval $(2)/benchmarks/demos/%.o: demos/%.cpp
+	@mkdir -p $$(dir $$@)
+	$(CXX) $$(BENCHMARK_$(2)_CFLAGS) -c $$< -o $$@
+$(2)/benchmarks/demos/%.dd: demos/%.cpp
+	@mkdir -p $$(dir $$@)
+	@echo Generating $$@
+	@$(MAKEDEPEND) "$$(CXX)" "$$(BENCHMARK_$(2)_CFLAGS)" $(2)/benchmarks/demos "$$*" "$$<" "$$@"
+THISBENCHMARK_$(1)_$(2)_SOURCES = $$($(1)_SOURCES) $$(BENCHMARK_COMMON_SOURCES)
+THISBENCHMARK_$(1)_$(2)_DEPS = $$(addprefix $(2)/benchmarks/, $$(patsubst %.cpp, %.dd, $$(THISBENCHMARK_$(1)_$(2)_SOURCES)))
+THISBENCHMARK_$(1)_$(2)_OBJS = $$(addprefix $(2)/benchmarks/, $$(patsubst %.cpp, %.o, $$(THISBENCHMARK_$(1)_$(2)_SOURCES)))
+THISBENCHMARK_$(1)_$(2)_EXE = $(1)-$(2)
+CLEAN_FILES += $$(THISBENCHMARK_$(1)_$(2)_OBJS) $$(THISBENCHMARK_$(1)_$(2)_EXE) $$(THISBENCHMARK_$(1)_$(2)_EXE).exe
+SUPER_CLEAN_FILES += $$(THISBENCHMARK_$(1)_$(2)_DEPS)
+ifneq ($(MAKECMDGOALS),clean)
+ifneq ($(MAKECMDGOALS),clean-all)
+ifneq ($(MAKECMDGOALS),targets)
+ifneq ($(MAKECMDGOALS),docs)
+-include $$(THISBENCHMARK_$(1)_$(2)_DEPS)
+endif
+endif
+endif
+endif
+benchmarks-$(2)-exes += $$(THISBENCHMARK_$(1)_$(2)_EXE)
+DEMO_TARGETLIST += $$(THISBENCHMARK_$(1)_$(2)_EXE)
+$$(THISBENCHMARK_$(1)_$(2)_EXE): libFastUIDraw_$(2) $$(THISBENCHMARK_$(1)_$(2)_OBJS) $$(THISBENCHMARK_$(1)_$(2)_DEPS)
+	$$(CXX) -o $$@ $$(THISBENCHMARK_$(1)_$(2)_OBJS) -L. -lFastUIDraw_$(2) $(LIBRARY_LIBS)
+)
+endef
+
+# $1 --> release or debug
+define benchmarkset
+$(eval $(foreach benchmarkname,$(BENCHMARKS),$(call benchmarkrule,$(benchmarkname),$(1)))
+benchmarks-$(1): $$(benchmarks-$(1)-exes)
+.PHONY: benchmarks-$(1)
+TARGETLIST += benchmarks-$(1)
+)
+endef
+
+$(call benchmarkset,release)
+$(call benchmarkset,debug)
+benchmarks: benchmarks-release benchmarks-debug
+.PHONY: benchmarks
+TARGETLIST += benchmarks
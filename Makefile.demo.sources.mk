@@ -16,5 +16,9 @@
 # foo_RESOURCE_STRING := $(call filelist, foo_resource.resource_string)
 #
 #
+# A benchmark is built the same way except that it adds its name
+# to BENCHMARKS instead of DEMOS; a benchmark uses neither SDL nor
+# a 3D API, only libFastUIDraw and BENCHMARK_COMMON_SOURCES.
+#
 dir := demos
 include $(dir)/Rules.mk
@@ -13,6 +13,10 @@ COMMON_DEMO_SOURCES := $(call filelist, generic_command_line.cpp colorstop_comma
 	PainterWidget.cpp cycle_value.cpp random.cpp read_dash_pattern.cpp \
 	egl_gles_context.cpp)
 
+# the sources of COMMON_DEMO_SOURCES that use neither SDL nor a 3D API
+BENCHMARK_COMMON_SOURCES := $(call filelist, generic_command_line.cpp \
+	read_path.cpp read_dash_pattern.cpp text_helper.cpp random.cpp)
+
 
 # Begin standard footer
 d		:= $(dirstack_$(sp))
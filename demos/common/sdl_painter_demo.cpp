@@ -172,6 +172,10 @@ sdl_painter_demo(const std::string &about_text,
                                    "painter_break_on_shader_change",
                                    "If true, different shadings are placed into different "
                                    "entries of a call to glMultiDrawElements", *this),
+  m_painter_use_16bit_indices(m_painter_params.use_16bit_indices(),
+                              "painter_use_16bit_indices",
+                              "If true, send indices to GL as 16-bit indices when "
+                              "the number of vertices of a draw allows", *this),
   m_uber_vert_use_switch(m_painter_params.vert_shader_use_switch(),
                          "painter_uber_vert_use_switch",
                          "If true, use a switch statement in uber vertex shader dispatch",
@@ -330,6 +334,7 @@ init_gl(int w, int h)
     .data_blocks_per_store_buffer(m_painter_data_blocks_per_buffer.m_value)
     .number_pools(m_painter_number_pools.m_value)
     .break_on_shader_change(m_painter_break_on_shader_change.m_value)
+    .use_16bit_indices(m_painter_use_16bit_indices.m_value)
     .use_hw_clip_planes(m_use_hw_clip_planes.m_value)
     .vert_shader_use_switch(m_uber_vert_use_switch.m_value)
     .frag_shader_use_switch(m_uber_frag_use_switch.m_value)
@@ -361,6 +366,7 @@ init_gl(int w, int h)
       LAZY(indices_per_buffer);
       LAZY(number_pools);
       LAZY(break_on_shader_change);
+      LAZY(use_16bit_indices);
       LAZY(vert_shader_use_switch);
       LAZY(frag_shader_use_switch);
       LAZY(blend_shader_use_switch);
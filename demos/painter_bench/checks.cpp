@@ -0,0 +1,1646 @@
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+
+#include <fastuidraw/tessellated_path.hpp>
+#include <fastuidraw/painter/painter.hpp>
+#include <fastuidraw/painter/stroked_path.hpp>
+#include <fastuidraw/painter/filled_path.hpp>
+#include <fastuidraw/painter/painter_header.hpp>
+#include <fastuidraw/painter/painter_item_matrix.hpp>
+#include <fastuidraw/painter/painter_clip_equations.hpp>
+#include <fastuidraw/painter/painter_attribute_data_filler_glyphs.hpp>
+#include <fastuidraw/painter/painter_glyph_chunks.hpp>
+#include <fastuidraw/painter/packing/painter_recording.hpp>
+#include <fastuidraw/glsl/painter_backend_headless.hpp>
+#include <fastuidraw/text/glyph_cache.hpp>
+#include <fastuidraw/text/glyph_selector.hpp>
+
+#include "checks.hpp"
+#include "text_helper.hpp"
+#include "random.hpp"
+#include "cast_c_array.hpp"
+
+using namespace fastuidraw;
+
+namespace
+{
+  const char *check_text = "Painter correctness checks";
+  const float check_text_pixel_size = 24.0f;
+  const float check_stroke_width = 4.0f;
+
+  /* tessellation threshhold of the paths of the scenes drawn
+     to a display list or cached item, whose content is drawn
+     with the identity transformation
+   */
+  const float check_fixed_thresh = 0.5f;
+
+  /* What was drawn of an item: the values of its header and of
+     the item matrix, clip equations and brush it points to, and
+     the attributes of the vertices of its triangles. An item is
+     a run of the triangles of a frame whose attributes have the
+     same header, or headers of the same values. The item and
+     blend shader data are not decoded since their size depends
+     on the shader.
+   */
+  class drawn_item
+  {
+  public:
+    uint32_t m_item_shader, m_blend_shader, m_brush_shader;
+
+    /* rank of the z-value of the item among those of the items
+       of the frame, so that items of frames that assign different
+       z-values in the same order compare the same.
+     */
+    uint32_t m_z;
+
+    std::vector<uint32_t> m_item_matrix, m_clip_equations, m_brush;
+
+    /* values of the PainterAttribute of each vertex
+       of each triangle, in the order drawn
+     */
+    std::vector<uint32_t> m_vertices;
+  };
+
+  enum compare_bits
+    {
+      compare_z = 1,
+      compare_clip = 2,
+      compare_all = compare_z | compare_clip
+    };
+
+  /* the same as PainterBrush::data_size() for a
+     brush whose PainterBrush::shader() is shader
+   */
+  unsigned int
+  brush_data_size(uint32_t shader, unsigned int alignment)
+  {
+    unsigned int return_value(0);
+
+    return_value += round_up_to_multiple(PainterBrush::pen_data_size, alignment);
+    if(shader & PainterBrush::image_mask)
+      {
+        return_value += round_up_to_multiple(PainterBrush::image_data_size, alignment);
+      }
+    if(shader & PainterBrush::radial_gradient_mask)
+      {
+        return_value += round_up_to_multiple(PainterBrush::radial_gradient_data_size, alignment);
+      }
+    else if(shader & PainterBrush::gradient_mask)
+      {
+        return_value += round_up_to_multiple(PainterBrush::linear_gradient_data_size, alignment);
+      }
+    if(shader & PainterBrush::repeat_window_mask)
+      {
+        return_value += round_up_to_multiple(PainterBrush::repeat_window_data_size, alignment);
+      }
+    if(shader & PainterBrush::transformation_translation_mask)
+      {
+        return_value += round_up_to_multiple(PainterBrush::transformation_translation_data_size, alignment);
+      }
+    if(shader & PainterBrush::transformation_matrix_mask)
+      {
+        return_value += round_up_to_multiple(PainterBrush::transformation_matrix_data_size, alignment);
+      }
+    return return_value;
+  }
+
+  bool
+  copy_store(const_c_array<generic_data> store, unsigned int location,
+             unsigned int size, std::vector<uint32_t> &dst)
+  {
+    if(location + size > store.size())
+      {
+        return false;
+      }
+
+    dst.resize(size);
+    for(unsigned int i = 0; i < size; ++i)
+      {
+        dst[i] = store[location + i].u;
+      }
+    return true;
+  }
+
+  bool
+  decode_header(const_c_array<generic_data> store, uint32_t header,
+                unsigned int alignment, drawn_item &item)
+  {
+    unsigned int loc(header * alignment);
+    uint32_t item_blend;
+
+    if(loc + PainterHeader::header_size > store.size())
+      {
+        return false;
+      }
+
+    item_blend = store[loc + PainterHeader::item_blend_shader_offset].u;
+    item.m_item_shader = unpack_bits(PainterHeader::item_shader_bit0,
+                                     PainterHeader::item_shader_num_bits,
+                                     item_blend);
+    item.m_blend_shader = unpack_bits(PainterHeader::blend_shader_bit0,
+                                      PainterHeader::blend_shader_num_bits,
+                                      item_blend);
+    item.m_brush_shader = store[loc + PainterHeader::brush_shader_offset].u;
+    item.m_z = store[loc + PainterHeader::z_offset].u;
+
+    return copy_store(store, store[loc + PainterHeader::item_matrix_location_offset].u * alignment,
+                      PainterItemMatrix::matrix_data_size, item.m_item_matrix)
+      && copy_store(store, store[loc + PainterHeader::clip_equations_location_offset].u * alignment,
+                    PainterClipEquations::clip_data_size, item.m_clip_equations)
+      && copy_store(store, store[loc + PainterHeader::brush_shader_data_location_offset].u * alignment,
+                    brush_data_size(item.m_brush_shader, alignment), item.m_brush);
+  }
+
+  bool
+  same_header(const drawn_item &a, const drawn_item &b)
+  {
+    return a.m_item_shader == b.m_item_shader
+      && a.m_blend_shader == b.m_blend_shader
+      && a.m_brush_shader == b.m_brush_shader
+      && a.m_z == b.m_z
+      && a.m_item_matrix == b.m_item_matrix
+      && a.m_clip_equations == b.m_clip_equations
+      && a.m_brush == b.m_brush;
+  }
+
+  /* decode the items drawn by a frame recorded by a
+     PainterBackendHeadless whose ConfigurationHeadless::record_draw_data()
+     is true; returns false if the log is malformed.
+   */
+  bool
+  decode_frame(const glsl::PainterBackendHeadless &backend, unsigned int frame,
+               std::vector<drawn_item> &items)
+  {
+    const_c_array<glsl::PainterBackendHeadless::DrawRecord> draws(backend.draws());
+    const_c_array<PainterAttribute> attributes(backend.attribute_log());
+    const_c_array<uint32_t> headers(backend.header_attribute_log());
+    const_c_array<PainterIndex> indices(backend.index_log());
+    const_c_array<generic_data> store(backend.store_log());
+    unsigned int alignment(backend.configuration_base().alignment());
+    std::vector<uint32_t> zs;
+
+    items.clear();
+    for(unsigned int d = 0, endd = draws.size(); d < endd; ++d)
+      {
+        const glsl::PainterBackendHeadless::DrawRecord &R(draws[d]);
+        const_c_array<generic_data> draw_store;
+        unsigned int num_attributes;
+        bool new_item(true);
+        uint32_t current_header(0);
+
+        if(R.m_frame != frame)
+          {
+            continue;
+          }
+
+        if((R.m_index_range.m_end - R.m_index_range.m_begin) % 3 != 0)
+          {
+            return false;
+          }
+
+        num_attributes = R.m_attribute_range.m_end - R.m_attribute_range.m_begin;
+        draw_store = store.sub_array(R.m_store_range.m_begin,
+                                     R.m_store_range.m_end - R.m_store_range.m_begin);
+        for(unsigned int i = R.m_index_range.m_begin; i < R.m_index_range.m_end; i += 3)
+          {
+            for(unsigned int k = 0; k < 3; ++k)
+              {
+                unsigned int a(indices[i + k]);
+
+                if(a >= num_attributes)
+                  {
+                    return false;
+                  }
+                a += R.m_attribute_range.m_begin;
+
+                if(k == 0 && (new_item || headers[a] != current_header))
+                  {
+                    drawn_item item;
+
+                    new_item = false;
+                    current_header = headers[a];
+                    if(!decode_header(draw_store, current_header, alignment, item))
+                      {
+                        return false;
+                      }
+
+                    /* an item too large for what is left of a PainterDraw
+                       or of a PainterRecording is continued with another
+                       header of the same values
+                     */
+                    if(items.empty() || !same_header(items.back(), item))
+                      {
+                        items.push_back(item);
+                        zs.push_back(item.m_z);
+                      }
+                  }
+                else if(headers[a] != current_header)
+                  {
+                    /* the vertices of a triangle have different headers */
+                    return false;
+                  }
+
+                const PainterAttribute &A(attributes[a]);
+                std::vector<uint32_t> &dst(items.back().m_vertices);
+                for(unsigned int c = 0; c < 4; ++c)
+                  {
+                    dst.push_back(A.m_attrib0[c]);
+                  }
+                for(unsigned int c = 0; c < 4; ++c)
+                  {
+                    dst.push_back(A.m_attrib1[c]);
+                  }
+                for(unsigned int c = 0; c < 4; ++c)
+                  {
+                    dst.push_back(A.m_attrib2[c]);
+                  }
+              }
+          }
+      }
+
+    std::sort(zs.begin(), zs.end());
+    zs.erase(std::unique(zs.begin(), zs.end()), zs.end());
+    for(unsigned int i = 0, endi = items.size(); i < endi; ++i)
+      {
+        items[i].m_z = std::lower_bound(zs.begin(), zs.end(), items[i].m_z) - zs.begin();
+      }
+    return true;
+  }
+
+  /* true if the bits of v are those of zero
+     or of a finite, normalized float
+   */
+  bool
+  zero_or_normal_float(uint32_t v)
+  {
+    uint32_t exponent((v >> 23u) & 0xFFu);
+    return (v & 0x7FFFFFFFu) == 0u || (exponent != 0u && exponent != 0xFFu);
+  }
+
+  /* compare values that are floats (or integers) with a relative
+     tolerance; values whose bits are a denormalized float (for
+     example small integers) or not finite are compared exactly.
+   */
+  bool
+  same_values(const std::vector<uint32_t> &a, const std::vector<uint32_t> &b, float tolerance)
+  {
+    if(a.size() != b.size())
+      {
+        return false;
+      }
+
+    for(unsigned int i = 0, endi = a.size(); i < endi; ++i)
+      {
+        generic_data fa, fb;
+
+        if(a[i] == b[i])
+          {
+            continue;
+          }
+
+        if(tolerance <= 0.0f || !zero_or_normal_float(a[i]) || !zero_or_normal_float(b[i]))
+          {
+            return false;
+          }
+
+        fa.u = a[i];
+        fb.u = b[i];
+        if(std::fabs(fa.f - fb.f) > tolerance * std::max(1.0f, std::max(std::fabs(fa.f), std::fabs(fb.f))))
+          {
+            return false;
+          }
+      }
+    return true;
+  }
+
+  bool
+  same_item(const drawn_item &a, const drawn_item &b,
+            uint32_t flags, float vertex_tolerance = 0.0f)
+  {
+    /* the matrix and clip equations of a display list are
+       composed with those it is drawn with, so they are only
+       the same up to rounding
+     */
+    const float matrix_tolerance(1e-5f);
+
+    return a.m_item_shader == b.m_item_shader
+      && a.m_blend_shader == b.m_blend_shader
+      && a.m_brush_shader == b.m_brush_shader
+      && (!(flags & compare_z) || a.m_z == b.m_z)
+      && same_values(a.m_item_matrix, b.m_item_matrix, matrix_tolerance)
+      && (!(flags & compare_clip) || same_values(a.m_clip_equations, b.m_clip_equations, matrix_tolerance))
+      && same_values(a.m_brush, b.m_brush, 0.0f)
+      && same_values(a.m_vertices, b.m_vertices, vertex_tolerance);
+  }
+
+  /* compare the items of two frames; on failure
+     writes why to reason and returns false.
+   */
+  bool
+  same_items(const std::vector<drawn_item> &a, const std::vector<drawn_item> &b,
+             uint32_t flags, std::ostream &reason, float vertex_tolerance = 0.0f)
+  {
+    if(a.size() != b.size())
+      {
+        reason << a.size() << " items drawn instead of " << b.size();
+        return false;
+      }
+
+    for(unsigned int i = 0, endi = a.size(); i < endi; ++i)
+      {
+        if(!same_item(a[i], b[i], flags, vertex_tolerance))
+          {
+            reason << "item " << i << " of " << a.size() << " differs";
+            return false;
+          }
+      }
+    return true;
+  }
+
+  /* match, in order, each item of sub to an item of full;
+     returns false if an item of sub matches no item of
+     full, otherwise sets matched[i] to true for each item
+     i of full that is matched.
+   */
+  bool
+  match_items(const std::vector<drawn_item> &sub, const std::vector<drawn_item> &full,
+              uint32_t flags, std::vector<bool> &matched)
+  {
+    unsigned int j(0);
+
+    matched.assign(full.size(), false);
+    for(unsigned int i = 0, endi = sub.size(); i < endi; ++i, ++j)
+      {
+        while(j < full.size() && !same_item(sub[i], full[j], flags))
+          {
+            ++j;
+          }
+
+        if(j == full.size())
+          {
+            return false;
+          }
+        matched[j] = true;
+      }
+    return true;
+  }
+
+  bool
+  contains(const vec2 &outer_min, const vec2 &outer_max,
+           const vec2 &inner_min, const vec2 &inner_max)
+  {
+    return outer_min.x() <= inner_min.x() && outer_min.y() <= inner_min.y()
+      && outer_max.x() >= inner_max.x() && outer_max.y() >= inner_max.y();
+  }
+
+  bool
+  intersects(const vec2 &amin, const vec2 &amax,
+             const vec2 &bmin, const vec2 &bmax)
+  {
+    return amin.x() < bmax.x() && bmin.x() < amax.x()
+      && amin.y() < bmax.y() && bmin.y() < amax.y();
+  }
+
+  void
+  report(std::ostream &str, const char *name, bool passed, const std::string &details)
+  {
+    str << "check " << name << ": " << (passed ? "PASS" : "FAIL");
+    if(!details.empty())
+      {
+        str << " (" << details << ")";
+      }
+    str << "\n" << std::flush;
+  }
+}
+
+/* A Painter drawing to its own PainterBackendHeadless
+   that records the data drawn.
+ */
+class painter_checks::target
+{
+public:
+  /* \param attributes_per_buffer if non-zero, the number of attributes
+                                  (and 3/2 of it the number of indices)
+                                  of the PainterDraw objects of the backend
+   */
+  target(ivec2 resolution, const reference_counted_ptr<FontFreeType> &font,
+         unsigned int attributes_per_buffer = 0);
+
+  ~target();
+
+  void
+  begin(void);
+
+  void
+  begin(const std::vector<vec2> &dirty_pmin, const std::vector<vec2> &dirty_wh);
+
+  /* ends the frame, returns the index of the frame in the log */
+  unsigned int
+  end(void);
+
+  bool
+  decode(unsigned int frame, std::vector<drawn_item> &items) const
+  {
+    return decode_frame(*m_backend, frame, items);
+  }
+
+  reference_counted_ptr<glsl::PainterBackendHeadless> m_backend;
+  reference_counted_ptr<Painter> m_painter;
+  reference_counted_ptr<GlyphCache> m_glyph_cache;
+  reference_counted_ptr<GlyphSelector> m_glyph_selector;
+
+  /* text of the scene objects of kind text, NULL if there is no font */
+  PainterGlyphChunks *m_text;
+
+private:
+  ivec2 m_resolution;
+  float3x3 m_proj;
+};
+
+painter_checks::target::
+target(ivec2 resolution, const reference_counted_ptr<FontFreeType> &font,
+       unsigned int attributes_per_buffer):
+  m_text(NULL),
+  m_resolution(resolution),
+  m_proj(float_orthogonal_projection_params(0, resolution.x(), resolution.y(), 0))
+{
+  glsl::PainterBackendHeadless::ConfigurationHeadless config;
+
+  config.record_draw_data(true);
+  if(attributes_per_buffer != 0)
+    {
+      config
+        .attributes_per_buffer(attributes_per_buffer)
+        .indices_per_buffer((attributes_per_buffer * 3) / 2);
+    }
+  m_backend = FASTUIDRAWnew glsl::PainterBackendHeadless(config);
+  m_painter = FASTUIDRAWnew Painter(m_backend);
+  m_painter->target_resolution(resolution.x(), resolution.y());
+
+  if(font)
+    {
+      std::vector<Glyph> glyphs;
+      std::vector<vec2> positions;
+      std::vector<uint32_t> character_codes;
+      std::istringstream str(check_text);
+
+      m_glyph_cache = FASTUIDRAWnew GlyphCache(m_painter->glyph_atlas());
+      m_glyph_selector = FASTUIDRAWnew GlyphSelector(m_glyph_cache);
+      m_glyph_selector->add_font(font);
+      create_formatted_text(str, GlyphRender(curve_pair_glyph), check_text_pixel_size,
+                            font, m_glyph_selector, glyphs, positions, character_codes);
+      m_text = FASTUIDRAWnew PainterGlyphChunks(PainterAttributeDataFillerGlyphs(cast_c_array(positions),
+                                                                                 cast_c_array(glyphs),
+                                                                                 check_text_pixel_size));
+    }
+}
+
+painter_checks::target::
+~target()
+{
+  if(m_text)
+    {
+      FASTUIDRAWdelete(m_text);
+    }
+}
+
+void
+painter_checks::target::
+begin(void)
+{
+  m_painter->begin();
+  m_painter->transformation(m_proj);
+}
+
+void
+painter_checks::target::
+begin(const std::vector<vec2> &dirty_pmin, const std::vector<vec2> &dirty_wh)
+{
+  /* the dirty rects are in the coordinates of m_proj, where
+     y increases downwards, Painter takes them with y = 0 at
+     the bottom of the target.
+   */
+  std::vector<vec2> pmin(dirty_pmin);
+
+  for(unsigned int i = 0, endi = pmin.size(); i < endi; ++i)
+    {
+      pmin[i].y() = float(m_resolution.y()) - dirty_pmin[i].y() - dirty_wh[i].y();
+    }
+  m_painter->begin(cast_c_array(pmin), cast_c_array(dirty_wh));
+  m_painter->transformation(m_proj);
+}
+
+unsigned int
+painter_checks::target::
+end(void)
+{
+  m_painter->end();
+  m_painter->wait_submission();
+  return m_backend->number_frames() - 1;
+}
+
+//////////////////////////////////
+// painter_checks methods
+painter_checks::
+painter_checks(ivec2 resolution, int tessellation_threads,
+               const reference_counted_ptr<FontFreeType> &font):
+  m_resolution(resolution),
+  m_tessellation_threads(tessellation_threads),
+  m_font(font)
+{
+  make_paths(m_paths, false);
+  make_scene();
+}
+
+painter_checks::
+~painter_checks()
+{
+  for(unsigned int i = 0, endi = m_paths.size(); i < endi; ++i)
+    {
+      FASTUIDRAWdelete(m_paths[i]);
+    }
+}
+
+void
+painter_checks::
+make_paths(std::vector<Path*> &paths, bool compact)
+{
+  Path *path;
+
+  /* arcs and line segments */
+  path = FASTUIDRAWnew Path();
+  path->compact_tessellation(compact);
+  (*path) << vec2(0.0f, 0.0f)
+          << Path::arc_degrees(180.0f, vec2(80.0f, 0.0f))
+          << vec2(80.0f, 60.0f)
+          << Path::arc_degrees(180.0f, vec2(0.0f, 60.0f))
+          << Path::contour_end();
+  paths.push_back(path);
+
+  /* quadratic and cubic curves */
+  path = FASTUIDRAWnew Path();
+  path->compact_tessellation(compact);
+  (*path) << vec2(50.0f, 0.0f)
+          << Path::control_point(65.0f, 30.0f)
+          << vec2(100.0f, 40.0f)
+          << Path::control_point(60.0f, 55.0f)
+          << Path::control_point(90.0f, 95.0f)
+          << vec2(50.0f, 75.0f)
+          << Path::control_point(10.0f, 95.0f)
+          << Path::control_point(40.0f, 55.0f)
+          << vec2(0.0f, 40.0f)
+          << Path::control_point(35.0f, 30.0f)
+          << Path::contour_end();
+  paths.push_back(path);
+
+  /* a cubic with a cusp */
+  path = FASTUIDRAWnew Path();
+  path->compact_tessellation(compact);
+  (*path) << vec2(0.0f, 0.0f)
+          << Path::control_point(100.0f, 60.0f)
+          << Path::control_point(0.0f, 60.0f)
+          << vec2(100.0f, 0.0f)
+          << vec2(50.0f, 80.0f)
+          << Path::contour_end();
+  paths.push_back(path);
+
+  /* many small contours with line, quadratic, cubic and arc edges */
+  path = FASTUIDRAWnew Path();
+  path->compact_tessellation(compact);
+  for(int i = 0; i < 16; ++i)
+    {
+      vec2 p(float(i % 4) * 16.0f, float(i / 4) * 16.0f);
+
+      (*path) << p
+              << Path::control_point(p + vec2(5.0f, -4.0f))
+              << p + vec2(10.0f, 0.0f)
+              << Path::control_point(p + vec2(14.0f, 2.0f))
+              << Path::control_point(p + vec2(9.0f, 5.0f))
+              << p + vec2(13.0f, 7.0f)
+              << Path::arc_degrees(90.0f, p + vec2(12.0f, 8.0f))
+              << p + vec2(3.0f, 12.0f)
+              << Path::contour_end_arc(float(M_PI) * 0.25f);
+    }
+  paths.push_back(path);
+}
+
+void
+painter_checks::
+add_path_object(enum scene_object::kind_t kind, unsigned int path,
+                const vec2 &pmin, const vec2 &pmax)
+{
+  scene_object obj;
+  vec2 bb_min, bb_max, slack(4.0f, 4.0f);
+  float s;
+
+  /* scale and translate the path to be within [pmin, pmax]
+   */
+  m_paths[path]->approximate_bounding_box(&bb_min, &bb_max);
+  if(kind == scene_object::stroke || kind == scene_object::dashed_stroke)
+    {
+      slack += vec2(check_stroke_width, check_stroke_width);
+    }
+  s = std::min((pmax.x() - pmin.x() - 2.0f * slack.x()) / (bb_max.x() - bb_min.x()),
+               (pmax.y() - pmin.y() - 2.0f * slack.y()) / (bb_max.y() - bb_min.y()));
+  s = std::max(0.25f, std::min(s, 2.0f));
+
+  obj.m_kind = kind;
+  obj.m_path = path;
+  obj.m_scale = s;
+  obj.m_translate = pmin + slack - s * bb_min;
+  obj.m_wh = vec2(0.0f, 0.0f);
+  obj.m_color = random_value(vec4(0.0f, 0.0f, 0.0f, 1.0f), vec4(1.0f, 1.0f, 1.0f, 1.0f));
+  obj.m_min = obj.m_translate + s * bb_min - slack;
+  obj.m_max = obj.m_translate + s * bb_max + slack;
+  m_scene.push_back(obj);
+}
+
+void
+painter_checks::
+make_scene(void)
+{
+  vec2 res(m_resolution.x(), m_resolution.y());
+  vec2 cover_min(0.25f * res), cover_max(0.75f * res);
+  scene_object obj;
+
+  /* the scene is random but the same from run to run
+   */
+  srand(3);
+  obj.m_path = 0;
+  obj.m_scale = 1.0f;
+
+  /* translucent and opaque rects anywhere */
+  for(int i = 0; i < 48; ++i)
+    {
+      obj.m_kind = scene_object::rect;
+      obj.m_wh = random_value(vec2(8.0f, 8.0f), vec2(160.0f, 120.0f));
+      obj.m_translate = random_value(vec2(0.0f, 0.0f), res - obj.m_wh);
+      obj.m_color = random_value(vec4(0.0f, 0.0f, 0.0f, 1.0f), vec4(1.0f, 1.0f, 1.0f, 1.0f));
+      if(i % 3 == 0)
+        {
+          obj.m_color.w() = 0.6f;
+        }
+      obj.m_min = obj.m_translate;
+      obj.m_max = obj.m_translate + obj.m_wh;
+      m_scene.push_back(obj);
+
+      /* fills and strokes of the paths in between */
+      if(i % 4 == 3)
+        {
+          unsigned int p((i / 4) % m_paths.size());
+          enum scene_object::kind_t kinds[] =
+            {
+              scene_object::fill,
+              scene_object::stroke,
+              scene_object::dashed_stroke
+            };
+          vec2 pmin(random_value(vec2(0.0f, 0.0f), 0.75f * res));
+
+          add_path_object(kinds[(i / 4) % 3], p, pmin, pmin + 0.25f * res);
+        }
+    }
+
+  /* text */
+  if(m_font)
+    {
+      float w(std::strlen(check_text) * check_text_pixel_size);
+
+      for(int i = 0; i < 3; ++i)
+        {
+          obj.m_kind = scene_object::text;
+          obj.m_translate = random_value(vec2(0.0f, 0.0f), res - vec2(w, 2.0f * check_text_pixel_size));
+          obj.m_color = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+          obj.m_min = obj.m_translate - vec2(check_text_pixel_size, check_text_pixel_size);
+          obj.m_max = obj.m_translate + vec2(w, 3.0f * check_text_pixel_size);
+          m_scene.push_back(obj);
+        }
+    }
+
+  /* content hidden by the opaque rect drawn after it */
+  for(int i = 0; i < 6; ++i)
+    {
+      obj.m_kind = scene_object::rect;
+      obj.m_wh = random_value(vec2(8.0f, 8.0f), 0.2f * (cover_max - cover_min));
+      obj.m_translate = random_value(cover_min, cover_max - obj.m_wh);
+      obj.m_color = random_value(vec4(0.0f, 0.0f, 0.0f, 1.0f), vec4(1.0f, 1.0f, 1.0f, 1.0f));
+      obj.m_min = obj.m_translate;
+      obj.m_max = obj.m_translate + obj.m_wh;
+      m_scene.push_back(obj);
+    }
+  add_path_object(scene_object::fill, 1, cover_min, 0.5f * (cover_min + cover_max));
+  add_path_object(scene_object::stroke, 0, 0.5f * (cover_min + cover_max), cover_max);
+  if(m_font)
+    {
+      obj.m_kind = scene_object::text;
+      obj.m_translate = cover_min + vec2(check_text_pixel_size, check_text_pixel_size);
+      obj.m_color = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+      obj.m_min = obj.m_translate - vec2(check_text_pixel_size, check_text_pixel_size);
+      obj.m_max = obj.m_translate + vec2(std::strlen(check_text) * check_text_pixel_size,
+                                         3.0f * check_text_pixel_size);
+      m_scene.push_back(obj);
+    }
+
+  obj.m_kind = scene_object::rect;
+  obj.m_translate = cover_min;
+  obj.m_wh = cover_max - cover_min;
+  obj.m_color = vec4(0.5f, 0.5f, 0.5f, 1.0f);
+  obj.m_min = cover_min;
+  obj.m_max = cover_max;
+  m_scene.push_back(obj);
+
+  /* more rects over everything */
+  for(int i = 0; i < 16; ++i)
+    {
+      obj.m_kind = scene_object::rect;
+      obj.m_wh = random_value(vec2(8.0f, 8.0f), vec2(80.0f, 60.0f));
+      obj.m_translate = random_value(vec2(0.0f, 0.0f), res - obj.m_wh);
+      obj.m_color = random_value(vec4(0.0f, 0.0f, 0.0f, 0.6f), vec4(1.0f, 1.0f, 1.0f, 1.0f));
+      obj.m_min = obj.m_translate;
+      obj.m_max = obj.m_translate + obj.m_wh;
+      m_scene.push_back(obj);
+    }
+
+  /* the dirty rects of the dirty rect check */
+  m_dirty_rect_pmin.push_back(vec2(0.10f, 0.10f) * res);
+  m_dirty_rect_wh.push_back(vec2(0.20f, 0.15f) * res);
+  m_dirty_rect_pmin.push_back(vec2(0.60f, 0.50f) * res);
+  m_dirty_rect_wh.push_back(vec2(0.25f, 0.20f) * res);
+  m_dirty_rect_pmin.push_back(vec2(0.30f, 0.70f) * res);
+  m_dirty_rect_wh.push_back(vec2(0.10f, 0.10f) * res);
+}
+
+void
+painter_checks::
+draw_object(target &T, const scene_object &obj, const std::vector<Path*> &paths,
+            float thresh)
+{
+  PainterBrush brush;
+  Painter &painter(*T.m_painter);
+  const PainterShaderSet &shaders(painter.default_shaders());
+  reference_counted_ptr<const TessellatedPath> tess;
+
+  if(thresh > 0.0f && obj.m_kind != scene_object::rect && obj.m_kind != scene_object::text)
+    {
+      tess = paths[obj.m_path]->tessellation(thresh);
+    }
+
+  brush.pen(obj.m_color);
+  painter.save();
+  painter.translate(obj.m_translate);
+  painter.scale(obj.m_scale);
+  switch(obj.m_kind)
+    {
+    case scene_object::rect:
+      painter.draw_rect(PainterData(&brush), vec2(0.0f, 0.0f), obj.m_wh);
+      break;
+
+    case scene_object::fill:
+      if(tess)
+        {
+          painter.fill_path(shaders.fill_shader(), PainterData(&brush),
+                            tess->filled()->painter_data(), PainterEnums::nonzero_fill_rule);
+        }
+      else
+        {
+          painter.fill_path(PainterData(&brush), *paths[obj.m_path],
+                            PainterEnums::nonzero_fill_rule);
+        }
+      break;
+
+    case scene_object::stroke:
+      {
+        PainterStrokeParams st;
+
+        st.width(check_stroke_width);
+        if(tess)
+          {
+            painter.stroke_path(shaders.stroke_shader(), PainterData(&brush, &st),
+                                *tess->stroked(), thresh,
+                                true, PainterEnums::rounded_caps, PainterEnums::rounded_joins,
+                                true);
+          }
+        else
+          {
+            painter.stroke_path(PainterData(&brush, &st), *paths[obj.m_path],
+                                true, PainterEnums::rounded_caps, PainterEnums::rounded_joins,
+                                true);
+          }
+      }
+      break;
+
+    case scene_object::dashed_stroke:
+      {
+        PainterDashedStrokeParams st;
+        std::vector<PainterDashedStrokeParams::DashPatternElement> pattern;
+
+        pattern.push_back(PainterDashedStrokeParams::DashPatternElement(10.0f, 5.0f));
+        pattern.push_back(PainterDashedStrokeParams::DashPatternElement(3.0f, 4.0f));
+        st.width(check_stroke_width);
+        st.dash_pattern(cast_c_array(pattern));
+        if(tess)
+          {
+            painter.stroke_dashed_path(shaders.dashed_stroke_shader(), PainterData(&brush, &st),
+                                       *tess->stroked(), thresh,
+                                       true, PainterEnums::square_caps, PainterEnums::rounded_joins,
+                                       true);
+          }
+        else
+          {
+            painter.stroke_dashed_path(PainterData(&brush, &st), *paths[obj.m_path],
+                                       true, PainterEnums::square_caps, PainterEnums::rounded_joins,
+                                       true);
+          }
+      }
+      break;
+
+    case scene_object::text:
+      if(T.m_text)
+        {
+          painter.draw_glyphs(PainterData(&brush), *T.m_text);
+        }
+      break;
+    }
+  painter.restore();
+}
+
+void
+painter_checks::
+draw_scene(target &T, const std::vector<Path*> &paths, bool with_text, float thresh)
+{
+  for(unsigned int i = 0, endi = m_scene.size(); i < endi; ++i)
+    {
+      if(with_text || m_scene[i].m_kind != scene_object::text)
+        {
+          draw_object(T, m_scene[i], paths, thresh);
+        }
+    }
+}
+
+void
+painter_checks::
+push_clip_tree_op(target &T, bool replay, const clip_tree_op &op)
+{
+  m_clip_tree_ops.push_back(op);
+  if(replay)
+    {
+      return;
+    }
+
+  switch(op.m_kind)
+    {
+    case clip_tree_op::translate:
+      T.m_painter->translate(op.m_a);
+      break;
+
+    case clip_tree_op::scale:
+      T.m_painter->scale(op.m_a.x());
+      break;
+
+    case clip_tree_op::clip_in_rect:
+      T.m_painter->clipInRect(op.m_a, op.m_b);
+      break;
+    }
+}
+
+void
+painter_checks::
+draw_clip_tree_item(target &T, bool replay, unsigned int item)
+{
+  Painter &painter(*T.m_painter);
+  PainterBrush brush;
+
+  /* when replaying, the state of the item is made from
+     scratch by applying all the operations in effect
+   */
+  if(replay)
+    {
+      std::vector<clip_tree_op> ops;
+
+      painter.save();
+      ops.swap(m_clip_tree_ops);
+      for(unsigned int i = 0, endi = ops.size(); i < endi; ++i)
+        {
+          push_clip_tree_op(T, false, ops[i]);
+        }
+      ops.swap(m_clip_tree_ops);
+    }
+
+  brush.pen(float(item % 7) / 7.0f, float(item % 5) / 5.0f, float(item % 3) / 3.0f, 0.8f);
+  if(item % 2 == 0)
+    {
+      painter.draw_rect(PainterData(&brush), vec2(-20.0f, -20.0f), vec2(200.0f, 150.0f));
+    }
+  else
+    {
+      painter.fill_path(PainterData(&brush), *m_paths[item % m_paths.size()],
+                        PainterEnums::nonzero_fill_rule);
+    }
+
+  if(replay)
+    {
+      painter.restore();
+    }
+}
+
+void
+painter_checks::
+draw_clip_tree(target &T, bool replay, int depth)
+{
+  unsigned int item(m_clip_tree_ops.size() * 3 + depth);
+
+  for(int c = 0; c < 3; ++c)
+    {
+      unsigned int mark(m_clip_tree_ops.size());
+      clip_tree_op op;
+
+      if(!replay)
+        {
+          T.m_painter->save();
+        }
+
+      op.m_kind = clip_tree_op::translate;
+      op.m_a = vec2(40.0f + 25.0f * float(c), 30.0f + 10.0f * float(depth));
+      push_clip_tree_op(T, replay, op);
+      if(c != 1)
+        {
+          op.m_kind = clip_tree_op::clip_in_rect;
+          op.m_a = vec2(5.0f * float(c), 3.0f * float(depth));
+          op.m_b = vec2(300.0f - 40.0f * float(depth), 200.0f - 30.0f * float(c));
+          push_clip_tree_op(T, replay, op);
+        }
+      if(c != 0)
+        {
+          op.m_kind = clip_tree_op::scale;
+          op.m_a = vec2(0.9f, 0.9f);
+          push_clip_tree_op(T, replay, op);
+        }
+
+      draw_clip_tree_item(T, replay, item++);
+      if(depth < 3)
+        {
+          draw_clip_tree(T, replay, depth + 1);
+        }
+      draw_clip_tree_item(T, replay, item++);
+
+      if(!replay)
+        {
+          T.m_painter->restore();
+        }
+      m_clip_tree_ops.resize(mark);
+
+      /* drawn with the state restored */
+      draw_clip_tree_item(T, replay, item++);
+    }
+}
+
+bool
+painter_checks::
+check_tessellation_threads(std::ostream &str)
+{
+  /* a map-like path: many small contours, each
+     with line, quadratic, cubic and arc edges
+   */
+  Path path;
+  for(int i = 0; i < 256; ++i)
+    {
+      vec2 p(float(i % 16) * 16.0f, float(i / 16) * 16.0f);
+
+      path << p
+           << Path::control_point(p + vec2(5.0f, -4.0f))
+           << p + vec2(10.0f, 0.0f)
+           << Path::control_point(p + vec2(14.0f, 2.0f))
+           << Path::control_point(p + vec2(9.0f, 5.0f))
+           << p + vec2(13.0f, 7.0f)
+           << Path::arc_degrees(90.0f, p + vec2(12.0f, 8.0f))
+           << p + vec2(3.0f, 12.0f)
+           << Path::contour_end_arc(float(M_PI) * 0.25f);
+    }
+
+  TessellatedPath::TessellationParams params;
+  unsigned int threads(std::max(2, m_tessellation_threads));
+  reference_counted_ptr<const TessellatedPath> serial, parallel;
+  std::ostringstream details;
+
+  params.curve_distance_tessellate(0.01f).max_segments(64);
+  serial = FASTUIDRAWnew TessellatedPath(path, params.max_threads(1));
+  parallel = FASTUIDRAWnew TessellatedPath(path, params.max_threads(threads));
+
+  const_c_array<TessellatedPath::point> a(serial->point_data()), b(parallel->point_data());
+  bool same(a.size() == b.size()
+            && std::memcmp(a.c_ptr(), b.c_ptr(), a.size() * sizeof(TessellatedPath::point)) == 0);
+
+  details << a.size() << " points with 1 and " << threads << " threads";
+  report(str, "tessellation_threads", same, details.str());
+  return same;
+}
+
+bool
+painter_checks::
+check_pipelined_submission(std::ostream &str)
+{
+  /* the logs, data drawn included, must be the same;
+     the frames include dirty rects and occlusion culling
+     since those change what is sent on submission.
+   */
+  target serial(m_resolution, m_font), pipelined(m_resolution, m_font);
+  std::ostringstream serial_log, pipelined_log;
+  target *targets[2] = { &serial, &pipelined };
+  bool passed;
+
+  pipelined.m_painter->pipelined_submission(true);
+  for(unsigned int t = 0; t < 2; ++t)
+    {
+      target &T(*targets[t]);
+
+      T.begin();
+      draw_scene(T, m_paths);
+      T.end();
+
+      T.begin(m_dirty_rect_pmin, m_dirty_rect_wh);
+      draw_scene(T, m_paths);
+      T.end();
+
+      T.m_painter->occlusion_culling(true);
+      T.begin();
+      draw_scene(T, m_paths);
+      T.end();
+    }
+
+  serial.m_backend->save_log(serial_log);
+  pipelined.m_backend->save_log(pipelined_log);
+  passed = (serial_log.str() == pipelined_log.str());
+  report(str, "pipelined_submission", passed,
+         passed ? "" : "logs differ");
+  return passed;
+}
+
+bool
+painter_checks::
+check_deterministic_packing(std::ostream &str)
+{
+  /* packing the same frame must give the same log, data
+     drawn included, byte for byte: once each with two fresh
+     Painter objects and again with the first after clearing
+     its log (so that nothing left from packing the first
+     frame leaks into the second).
+   */
+  target first(m_resolution, m_font), second(m_resolution, m_font);
+  std::ostringstream logs[3];
+  target *targets[3] = { &first, &second, &first };
+  bool passed;
+
+  for(unsigned int t = 0; t < 3; ++t)
+    {
+      target &T(*targets[t]);
+
+      T.m_backend->clear_log();
+      T.begin();
+      draw_scene(T, m_paths);
+      T.end();
+      T.m_backend->save_log(logs[t]);
+    }
+
+  passed = (logs[0].str() == logs[1].str() && logs[0].str() == logs[2].str());
+  report(str, "deterministic_packing", passed,
+         passed ? "" : "logs differ");
+  return passed;
+}
+
+bool
+painter_checks::
+check_clip_state(std::ostream &str)
+{
+  /* each item drawn within nested save()/restore() pairs
+     must get the same transformation and clip equations as
+     when its state is made from scratch.
+   */
+  target nested(m_resolution, m_font), replayed(m_resolution, m_font);
+  std::vector<drawn_item> nested_items, replayed_items;
+  std::ostringstream details;
+  unsigned int nested_frame, replayed_frame;
+  bool passed;
+
+  nested.begin();
+  draw_clip_tree(nested, false, 0);
+  nested_frame = nested.end();
+
+  replayed.begin();
+  draw_clip_tree(replayed, true, 0);
+  replayed_frame = replayed.end();
+
+  passed = nested.decode(nested_frame, nested_items)
+    && replayed.decode(replayed_frame, replayed_items)
+    && same_items(nested_items, replayed_items, compare_all, details);
+  if(passed)
+    {
+      details << nested_items.size() << " items";
+    }
+  report(str, "clip_state", passed, details.str());
+  return passed;
+}
+
+bool
+painter_checks::
+check_occlusion_culling(std::ostream &str)
+{
+  /* the items drawn with occlusion culling must be those drawn
+     without it less some items; an item may only be dropped if
+     it is within an opaque rect drawn after it.
+   */
+  target reference(m_resolution, m_font), culled(m_resolution, m_font), single(m_resolution, m_font);
+  std::vector<drawn_item> reference_items, culled_items, items;
+  std::vector<unsigned int> object_of_item;
+  std::vector<bool> matched;
+  std::ostringstream details;
+  unsigned int frame;
+  bool passed(true);
+
+  culled.m_painter->occlusion_culling(true);
+
+  reference.begin();
+  draw_scene(reference, m_paths);
+  frame = reference.end();
+  passed = reference.decode(frame, reference_items);
+
+  culled.begin();
+  draw_scene(culled, m_paths);
+  frame = culled.end();
+  passed = passed && culled.decode(frame, culled_items);
+
+  /* find what object of the scene each item is of
+     by drawing each object alone
+   */
+  for(unsigned int i = 0, endi = m_scene.size(); i < endi && passed; ++i)
+    {
+      single.begin();
+      draw_object(single, m_scene[i], m_paths);
+      frame = single.end();
+      passed = single.decode(frame, items);
+      object_of_item.resize(object_of_item.size() + items.size(), i);
+    }
+
+  if(!passed)
+    {
+      details << "malformed log";
+    }
+  else if(object_of_item.size() != reference_items.size())
+    {
+      passed = false;
+      details << "objects drawn alone give " << object_of_item.size()
+              << " items instead of " << reference_items.size();
+    }
+  else if(!match_items(culled_items, reference_items, compare_clip, matched))
+    {
+      passed = false;
+      details << "an item drawn with culling is not drawn without it";
+    }
+
+  for(unsigned int i = 0, endi = reference_items.size(); i < endi && passed; ++i)
+    {
+      const scene_object &obj(m_scene[object_of_item[i]]);
+      bool may_drop(false);
+
+      if(matched[i])
+        {
+          continue;
+        }
+
+      /* a rect may be dropped if it is within a later opaque
+         rect, the other objects, whose bounds are larger than
+         they are, if their bounds intersect a later opaque rect.
+       */
+      for(unsigned int j = object_of_item[i] + 1, endj = m_scene.size(); j < endj && !may_drop; ++j)
+        {
+          const scene_object &occluder(m_scene[j]);
+
+          if(occluder.m_kind == scene_object::rect && occluder.m_color.w() >= 1.0f)
+            {
+              may_drop = (obj.m_kind == scene_object::rect) ?
+                contains(occluder.m_min, occluder.m_max, obj.m_min, obj.m_max) :
+                intersects(occluder.m_min, occluder.m_max, obj.m_min, obj.m_max);
+            }
+        }
+
+      if(!may_drop)
+        {
+          passed = false;
+          details << "item " << i << " (of object " << object_of_item[i]
+                  << ") is dropped but visible";
+        }
+    }
+
+  if(passed)
+    {
+      /* the scene hides items, so nothing dropped means the check checked nothing */
+      passed = culled_items.size() < reference_items.size();
+      details << reference_items.size() - culled_items.size() << " of "
+              << reference_items.size() << " items dropped";
+    }
+  report(str, "occlusion_culling", passed, details.str());
+  return passed;
+}
+
+bool
+painter_checks::
+check_dirty_rects(std::ostream &str)
+{
+  /* each object is drawn alone with and without the dirty
+     rects; with them, it must be drawn the same (other than
+     the clipping) if it is within a dirty rect and not drawn
+     if it is away from all of them. Items of an object that
+     crosses the edge of a dirty rect may be drawn in part
+     (for example only some of the chunks of a stroke).
+   */
+  target full(m_resolution, m_font), dirty(m_resolution, m_font);
+  std::vector<drawn_item> full_items, dirty_items, items;
+  std::ostringstream details;
+  uint32_t occluder_blend_shader;
+  unsigned int number_culled(0);
+  bool passed(true);
+
+  /* the gaps between the dirty rects are occluded
+     with the blend mode that writes no color
+   */
+  occluder_blend_shader =
+    dirty.m_painter->default_shaders().blend_shaders().shader(PainterEnums::blend_porter_duff_dst)->ID();
+
+  for(unsigned int i = 0, endi = m_scene.size(); i < endi && passed; ++i)
+    {
+      const scene_object &obj(m_scene[i]);
+      vec2 slack(4.0f, 4.0f);
+      bool within(false), crosses(false), away(true);
+      unsigned int frame;
+
+      full.begin();
+      draw_object(full, obj, m_paths);
+      frame = full.end();
+      passed = full.decode(frame, full_items);
+
+      dirty.begin(m_dirty_rect_pmin, m_dirty_rect_wh);
+      draw_object(dirty, obj, m_paths);
+      frame = dirty.end();
+      passed = passed && dirty.decode(frame, items);
+
+      if(!passed)
+        {
+          details << "malformed log";
+          break;
+        }
+
+      dirty_items.clear();
+      for(unsigned int k = 0, endk = items.size(); k < endk; ++k)
+        {
+          if(items[k].m_blend_shader != occluder_blend_shader)
+            {
+              dirty_items.push_back(items[k]);
+            }
+        }
+
+      for(unsigned int r = 0, endr = m_dirty_rect_pmin.size(); r < endr; ++r)
+        {
+          vec2 rmin(m_dirty_rect_pmin[r]), rmax(m_dirty_rect_pmin[r] + m_dirty_rect_wh[r]);
+
+          within = within || contains(rmin, rmax, obj.m_min, obj.m_max);
+          crosses = crosses || intersects(rmin, rmax, obj.m_min, obj.m_max);
+          away = away && !intersects(rmin - slack, rmax + slack, obj.m_min, obj.m_max);
+        }
+
+      /* the bounds of a rect are exact, so a rect that
+         crosses a dirty rect must be drawn; the culling
+         of a rect or a fill is all or nothing.
+       */
+      if(away && !dirty_items.empty())
+        {
+          passed = false;
+          details << "object " << i << " is away from the dirty rects but drawn";
+        }
+      else if((within || (crosses && obj.m_kind == scene_object::rect)) && dirty_items.empty())
+        {
+          passed = false;
+          details << "object " << i << " is within the dirty rects but culled";
+        }
+      else if(!dirty_items.empty()
+              && (within || obj.m_kind == scene_object::rect || obj.m_kind == scene_object::fill))
+        {
+          std::ostringstream reason;
+
+          passed = same_items(dirty_items, full_items, compare_z, reason);
+          if(!passed)
+            {
+              details << "object " << i << ": " << reason.str();
+            }
+        }
+
+      if(dirty_items.empty())
+        {
+          ++number_culled;
+        }
+    }
+
+  if(passed)
+    {
+      passed = (number_culled > 0);
+      details << number_culled << " of " << m_scene.size() << " objects culled";
+    }
+  report(str, "dirty_rects", passed, details.str());
+  return passed;
+}
+
+bool
+painter_checks::
+check_display_list(std::ostream &str)
+{
+  /* a display list drawn with a transformation and clipping
+     must draw the same as drawing its content directly with
+     them; the scene is drawn scaled down so that none of it
+     is clipped (text is not in the display list since the
+     glyph chunks drawn depend on the clipping when drawn
+     directly). The content of a display list is drawn with
+     the identity transformation, so the paths are drawn with
+     a fixed tessellation instead of one chosen from the
+     transformation.
+   */
+  target direct(m_resolution, m_font), listed(m_resolution, m_font);
+  reference_counted_ptr<PainterRecording> display_list;
+  std::vector<drawn_item> direct_items, listed_items;
+  std::ostringstream details;
+  vec2 res(m_resolution.x(), m_resolution.y());
+  unsigned int direct_frame, listed_frame;
+  bool passed;
+
+  direct.begin();
+  direct.m_painter->translate(0.2f * res);
+  direct.m_painter->scale(0.5f);
+  direct.m_painter->clipInRect(vec2(-8.0f, -8.0f), res + vec2(16.0f, 16.0f));
+  draw_scene(direct, m_paths, false, check_fixed_thresh);
+  direct_frame = direct.end();
+
+  display_list = FASTUIDRAWnew PainterRecording();
+  listed.begin();
+  listed.m_painter->begin_display_list(display_list);
+  draw_scene(listed, m_paths, false, check_fixed_thresh);
+  listed.m_painter->end_display_list();
+  listed.m_painter->translate(0.2f * res);
+  listed.m_painter->scale(0.5f);
+  listed.m_painter->clipInRect(vec2(-8.0f, -8.0f), res + vec2(16.0f, 16.0f));
+  listed.m_painter->draw_display_list(*display_list);
+  listed_frame = listed.end();
+
+  passed = direct.decode(direct_frame, direct_items)
+    && listed.decode(listed_frame, listed_items)
+    && same_items(listed_items, direct_items, compare_all, details);
+  if(passed)
+    {
+      details << direct_items.size() << " items";
+    }
+  report(str, "display_list", passed, details.str());
+  return passed;
+}
+
+bool
+painter_checks::
+check_display_list_split(std::ostream &str)
+{
+  /* a display list recorded to buffers larger than the
+     PainterDraw objects of the backend drawing it must be
+     split across several PainterDraw objects, and draw the
+     same as drawing its content directly; the scene is drawn
+     as in check_display_list(), without the clipping. The
+     buffers of a recording are no larger than the PainterDraw
+     objects of the backend recording it, so it is recorded
+     by a backend with larger ones.
+   */
+  const unsigned int small_buffer(12 * 1024);
+  target direct(m_resolution, m_font, small_buffer), listed(m_resolution, m_font, small_buffer);
+  target recorder(m_resolution, m_font);
+  reference_counted_ptr<PainterRecording> display_list;
+  std::vector<drawn_item> direct_items, listed_items;
+  std::ostringstream details;
+  unsigned int direct_frame, listed_frame, listed_draws(0);
+  bool passed;
+
+  direct.begin();
+  draw_scene(direct, m_paths, false, check_fixed_thresh);
+  direct_frame = direct.end();
+
+  display_list = FASTUIDRAWnew PainterRecording(8 * small_buffer, 12 * small_buffer);
+  recorder.begin();
+  recorder.m_painter->begin_display_list(display_list);
+  draw_scene(recorder, m_paths, false, check_fixed_thresh);
+  recorder.m_painter->end_display_list();
+  recorder.end();
+
+  listed.begin();
+  listed.m_painter->draw_display_list(*display_list);
+  listed_frame = listed.end();
+
+  for(unsigned int d = 0, endd = listed.m_backend->draws().size(); d < endd; ++d)
+    {
+      listed_draws += (listed.m_backend->draws()[d].m_frame == listed_frame) ? 1u : 0u;
+    }
+
+  passed = direct.decode(direct_frame, direct_items)
+    && listed.decode(listed_frame, listed_items)
+    && same_items(listed_items, direct_items, compare_all, details);
+  if(passed)
+    {
+      passed = (listed_draws > 1);
+      details << direct_items.size() << " items in " << listed_draws << " draws";
+    }
+  report(str, "display_list_split", passed, details.str());
+  return passed;
+}
+
+bool
+painter_checks::
+check_cached_item(std::ostream &str)
+{
+  /* a cached item must draw the same as drawing its content
+     directly, both in the frame that captures it and in the
+     frames that draw it from the cache; as in check_display_list(),
+     the scene is scaled down, has no text and its paths are drawn
+     with a fixed tessellation.
+   */
+  const uint64_t key(1), state_hash(0x5eed);
+  target direct(m_resolution, m_font), cached(m_resolution, m_font);
+  std::vector<drawn_item> direct_items, cached_items;
+  std::ostringstream details;
+  vec2 res(m_resolution.x(), m_resolution.y());
+  unsigned int direct_frame;
+  bool passed, hit(false);
+
+  direct.begin();
+  direct.m_painter->translate(0.2f * res);
+  direct.m_painter->scale(0.5f);
+  draw_scene(direct, m_paths, false, check_fixed_thresh);
+  direct_frame = direct.end();
+  passed = direct.decode(direct_frame, direct_items);
+
+  for(unsigned int f = 0; f < 3 && passed; ++f)
+    {
+      unsigned int frame;
+      std::ostringstream reason;
+
+      cached.begin();
+      cached.m_painter->translate(0.2f * res);
+      cached.m_painter->scale(0.5f);
+      if(cached.m_painter->draw_cached_item(key, state_hash))
+        {
+          hit = true;
+        }
+      else
+        {
+          cached.m_painter->begin_cached_item(key, state_hash);
+          draw_scene(cached, m_paths, false, check_fixed_thresh);
+          cached.m_painter->end_cached_item();
+        }
+      frame = cached.end();
+
+      passed = cached.decode(frame, cached_items)
+        && same_items(cached_items, direct_items, compare_all, reason);
+      if(!passed)
+        {
+          details << "frame " << f << ": " << reason.str();
+        }
+    }
+
+  if(passed)
+    {
+      passed = hit;
+      details << direct_items.size() << " items, "
+              << (hit ? "drawn from the cache" : "never drawn from the cache");
+    }
+  report(str, "cached_item", passed, details.str());
+  return passed;
+}
+
+bool
+painter_checks::
+check_compact_tessellation(std::ostream &str)
+{
+  /* the points of a compact tessellation are the same except
+     that the derivative is rounded to 16-bit floats, so the
+     fills must be the same and the strokes (whose normals
+     come from the derivatives) the same up to rounding.
+   */
+  const float stroke_tolerance(2e-3f);
+  const float threshs[] = { -1.0f, 1.0f, 0.25f, 0.0625f };
+  std::vector<Path*> compact_paths;
+  target full(m_resolution, m_font), compact(m_resolution, m_font);
+  std::vector<drawn_item> full_items, compact_items;
+  std::ostringstream details;
+  unsigned int full_frame, compact_frame, number_exact(0), number_points(0);
+  bool passed(true);
+
+  /* compare the points of the tessellations at several
+     levels of detail
+   */
+  for(unsigned int i = 0, endi = m_paths.size(); i < endi && passed; ++i)
+    {
+      for(unsigned int t = 0; t < sizeof(threshs) / sizeof(threshs[0]) && passed; ++t)
+        {
+          TessellatedPath::TessellationParams params;
+          reference_counted_ptr<const TessellatedPath> full_tess, compact_tess;
+          const_c_array<TessellatedPath::point> pts;
+
+          if(threshs[t] > 0.0f)
+            {
+              params.curve_distance_tessellate(threshs[t]).max_segments(64);
+            }
+          full_tess = FASTUIDRAWnew TessellatedPath(*m_paths[i], params.compact_point_data(false));
+          compact_tess = FASTUIDRAWnew TessellatedPath(*m_paths[i], params.compact_point_data(true));
+
+          pts = full_tess->point_data();
+          number_points += pts.size();
+          passed = (pts.size() == compact_tess->number_points());
+          for(unsigned int k = 0, endk = pts.size(); k < endk && passed; ++k)
+            {
+              TessellatedPath::point a(pts[k]), b(compact_tess->point_value(k));
+
+              passed = a.m_p == b.m_p
+                && a.m_distance_from_edge_start == b.m_distance_from_edge_start
+                && a.m_distance_from_contour_start == b.m_distance_from_contour_start
+                && a.m_edge_length == b.m_edge_length
+                && a.m_open_contour_length == b.m_open_contour_length
+                && a.m_closed_contour_length == b.m_closed_contour_length;
+
+              /* a 16-bit float has 11 bits of precision and
+                 its denormals are spaced by 2^-24
+               */
+              for(unsigned int c = 0; c < 2 && passed; ++c)
+                {
+                  passed = std::fabs(a.m_p_t[c] - b.m_p_t[c])
+                    <= std::ldexp(std::fabs(a.m_p_t[c]), -11) + std::ldexp(1.0f, -24);
+                }
+            }
+
+          if(!passed)
+            {
+              details << "path " << i << ": the points of a compact tessellation differ";
+            }
+        }
+    }
+
+  make_paths(compact_paths, true);
+
+  full.begin();
+  draw_scene(full, m_paths);
+  full_frame = full.end();
+
+  compact.begin();
+  draw_scene(compact, compact_paths);
+  compact_frame = compact.end();
+
+  passed = passed
+    && full.decode(full_frame, full_items)
+    && compact.decode(compact_frame, compact_items)
+    && same_items(compact_items, full_items, compare_all, details, stroke_tolerance);
+
+  if(passed)
+    {
+      for(unsigned int i = 0, endi = full_items.size(); i < endi; ++i)
+        {
+          if(same_item(compact_items[i], full_items[i], compare_all))
+            {
+              ++number_exact;
+            }
+        }
+      details << number_points << " points the same up to rounding, "
+              << number_exact << " of " << full_items.size() << " items exactly the same";
+    }
+
+  for(unsigned int i = 0, endi = compact_paths.size(); i < endi; ++i)
+    {
+      FASTUIDRAWdelete(compact_paths[i]);
+    }
+  report(str, "compact_tessellation", passed, details.str());
+  return passed;
+}
+
+unsigned int
+painter_checks::
+run(std::ostream &str)
+{
+  unsigned int number_failed(0);
+
+  if(!m_font)
+    {
+      str << "No font, the scenes of the checks have no text\n";
+    }
+
+  number_failed += check_tessellation_threads(str) ? 0 : 1;
+  number_failed += check_deterministic_packing(str) ? 0 : 1;
+  number_failed += check_pipelined_submission(str) ? 0 : 1;
+  number_failed += check_clip_state(str) ? 0 : 1;
+  number_failed += check_occlusion_culling(str) ? 0 : 1;
+  number_failed += check_dirty_rects(str) ? 0 : 1;
+  number_failed += check_display_list(str) ? 0 : 1;
+  number_failed += check_display_list_split(str) ? 0 : 1;
+  number_failed += check_cached_item(str) ? 0 : 1;
+  number_failed += check_compact_tessellation(str) ? 0 : 1;
+
+  str << number_failed << " checks failed\n";
+  return number_failed;
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+#include <fastuidraw/util/vecN.hpp>
+#include <fastuidraw/path.hpp>
+#include <fastuidraw/text/freetype_font.hpp>
+
+/* Correctness checks of the optional features of Painter and
+   of the tessellation of paths. Each check draws a fixed scene
+   with a fresh Painter to a fresh PainterBackendHeadless that
+   records the data drawn, once with the feature and once
+   without (or once with an equivalent way to draw the same
+   content), decodes the items drawn from the logs of the
+   backends and compares them.
+ */
+class painter_checks
+{
+public:
+  /* \param resolution target resolution of the Painter objects
+     \param tessellation_threads number of threads with which to
+                                 tessellate in the tessellation check
+     \param font font of the text of the scenes, if NULL the
+                 scenes have no text
+   */
+  painter_checks(fastuidraw::ivec2 resolution,
+                 int tessellation_threads,
+                 const fastuidraw::reference_counted_ptr<fastuidraw::FontFreeType> &font);
+
+  ~painter_checks();
+
+  /* run all checks, printing the result of each
+     to str; returns the number of checks that fail.
+   */
+  unsigned int
+  run(std::ostream &str);
+
+private:
+  class target;
+
+  /* an item of the scene drawn by the checks
+   */
+  class scene_object
+  {
+  public:
+    enum kind_t
+      {
+        rect,
+        fill,
+        stroke,
+        dashed_stroke,
+        text
+      };
+
+    enum kind_t m_kind;
+
+    /* path of a fill or stroke */
+    unsigned int m_path;
+
+    /* the object is drawn with translate(m_translate)
+       and then scale(m_scale)
+     */
+    fastuidraw::vec2 m_translate;
+    float m_scale;
+
+    /* size of a rect */
+    fastuidraw::vec2 m_wh;
+
+    fastuidraw::vec4 m_color;
+
+    /* bounds, in pixels, of the object; exact for a rect
+       and containing the object for the other kinds
+     */
+    fastuidraw::vec2 m_min, m_max;
+  };
+
+  /* an operation of draw_clip_tree()
+   */
+  class clip_tree_op
+  {
+  public:
+    enum kind_t
+      {
+        translate,
+        scale,
+        clip_in_rect
+      };
+
+    enum kind_t m_kind;
+    fastuidraw::vec2 m_a, m_b;
+  };
+
+  void
+  make_paths(std::vector<fastuidraw::Path*> &paths, bool compact);
+
+  void
+  make_scene(void);
+
+  void
+  add_path_object(enum scene_object::kind_t kind, unsigned int path,
+                  const fastuidraw::vec2 &pmin, const fastuidraw::vec2 &pmax);
+
+  /* draws an object of the scene; if thresh is positive,
+     paths are drawn with their tessellation for thresh
+     instead of one chosen by the Painter from the
+     transformation.
+   */
+  void
+  draw_object(target &T, const scene_object &obj,
+              const std::vector<fastuidraw::Path*> &paths,
+              float thresh = -1.0f);
+
+  void
+  draw_scene(target &T, const std::vector<fastuidraw::Path*> &paths,
+             bool with_text = true, float thresh = -1.0f);
+
+  void
+  draw_clip_tree(target &T, bool replay, int depth);
+
+  void
+  push_clip_tree_op(target &T, bool replay, const clip_tree_op &op);
+
+  void
+  draw_clip_tree_item(target &T, bool replay, unsigned int item);
+
+  bool
+  check_tessellation_threads(std::ostream &str);
+
+  bool
+  check_deterministic_packing(std::ostream &str);
+
+  bool
+  check_pipelined_submission(std::ostream &str);
+
+  bool
+  check_clip_state(std::ostream &str);
+
+  bool
+  check_occlusion_culling(std::ostream &str);
+
+  bool
+  check_dirty_rects(std::ostream &str);
+
+  bool
+  check_display_list(std::ostream &str);
+
+  bool
+  check_display_list_split(std::ostream &str);
+
+  bool
+  check_cached_item(std::ostream &str);
+
+  bool
+  check_compact_tessellation(std::ostream &str);
+
+  fastuidraw::ivec2 m_resolution;
+  int m_tessellation_threads;
+  fastuidraw::reference_counted_ptr<fastuidraw::FontFreeType> m_font;
+  std::vector<fastuidraw::Path*> m_paths;
+  std::vector<scene_object> m_scene;
+  std::vector<fastuidraw::vec2> m_dirty_rect_pmin, m_dirty_rect_wh;
+
+  /* the operations of draw_clip_tree() in effect */
+  std::vector<clip_tree_op> m_clip_tree_ops;
+};
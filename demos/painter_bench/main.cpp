@@ -0,0 +1,1502 @@
+#include <stdlib.h>
+#include <new>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <dirent.h>
+#include <boost/thread.hpp>
+
+#include <fastuidraw/painter/painter.hpp>
+#include <fastuidraw/painter/painter_attribute_data_filler_glyphs.hpp>
+#include <fastuidraw/painter/painter_glyph_chunks.hpp>
+#include <fastuidraw/glsl/painter_backend_headless.hpp>
+#include <fastuidraw/text/glyph_cache.hpp>
+#include <fastuidraw/text/freetype_font.hpp>
+#include <fastuidraw/text/glyph_selector.hpp>
+
+#include "generic_command_line.hpp"
+#include "simple_time.hpp"
+#include "read_path.hpp"
+#include "read_dash_pattern.hpp"
+#include "text_helper.hpp"
+#include "random.hpp"
+#include "cast_c_array.hpp"
+#include "checks.hpp"
+
+using namespace fastuidraw;
+
+/* Count the heap allocations made by the process (the library
+   included) so that the benchmark can report the number of
+   allocations made per frame.
+ */
+namespace
+{
+  volatile unsigned long number_allocations = 0;
+
+  unsigned long
+  query_number_allocations(void)
+  {
+    return __sync_fetch_and_add(&number_allocations, 0ul);
+  }
+
+  void*
+  counted_malloc(size_t sz)
+  {
+    void *p;
+
+    __sync_fetch_and_add(&number_allocations, 1ul);
+    p = malloc(sz > 0 ? sz : 1);
+    if(p == NULL)
+      {
+        throw std::bad_alloc();
+      }
+    return p;
+  }
+}
+
+void*
+operator new(size_t sz)
+{
+  return counted_malloc(sz);
+}
+
+void*
+operator new[](size_t sz)
+{
+  return counted_malloc(sz);
+}
+
+void
+operator delete(void *p) throw()
+{
+  free(p);
+}
+
+void
+operator delete[](void *p) throw()
+{
+  free(p);
+}
+
+/* the sized forms, called instead of the above when the
+   compiler knows the size of the object being deleted
+ */
+void
+operator delete(void *p, size_t) throw()
+{
+  free(p);
+}
+
+void
+operator delete[](void *p, size_t) throw()
+{
+  free(p);
+}
+
+/* Non-interactive benchmark of the CPU side of Painter:
+   it draws reproducible workloads to a PainterBackendHeadless
+   (so that neither SDL nor a GPU are needed) and reports
+   the throughput and latency of each workload.
+ */
+/* makes the tessellations, fills and strokes of each path
+   at several levels of detail, starting at a different path
+   for each thread so that the threads both race for the same
+   levels and make different ones at once.
+ */
+class pretessellate_worker
+{
+public:
+  pretessellate_worker(const std::vector<Path*> *paths, unsigned int start):
+    m_paths(paths),
+    m_start(start)
+  {}
+
+  void
+  operator()(void) const
+  {
+    const float threshs[] = { -1.0f, 1.0f, 0.25f, 0.0625f };
+
+    for(unsigned int i = 0, endi = m_paths->size(); i < endi; ++i)
+      {
+        const Path &path(*(*m_paths)[(i + m_start) % endi]);
+        for(unsigned int t = 0; t < sizeof(threshs) / sizeof(threshs[0]); ++t)
+          {
+            const reference_counted_ptr<const TessellatedPath> &tess(path.tessellation(threshs[t]));
+
+            tess->filled()->painter_data();
+            tess->stroked()->rounded_joins(threshs[t]);
+            tess->stroked()->rounded_caps(threshs[t]);
+          }
+      }
+  }
+
+private:
+  const std::vector<Path*> *m_paths;
+  unsigned int m_start;
+};
+
+class painter_bench:public command_line_register
+{
+public:
+  painter_bench(void);
+
+  ~painter_bench();
+
+  int
+  main(int argc, char **argv);
+
+private:
+  enum
+    {
+      grid_palette_size = 8
+    };
+
+  enum workload_t
+    {
+      workload_rects,
+      workload_paths,
+      workload_dashed,
+      workload_clipped,
+      workload_text,
+      workload_scrolled_text,
+      workload_panels,
+      workload_grid,
+      workload_widgets,
+      workload_layers,
+      workload_zoom,
+
+      number_workloads
+    };
+
+  class frame_result
+  {
+  public:
+    uint64_t m_time_us;
+    unsigned int m_items;
+    uint64_t m_bytes_packed;
+    unsigned int m_draws;
+    unsigned int m_breaks;
+    unsigned int m_headers, m_headers_occluded;
+    unsigned long m_allocations;
+    vecN<uint64_t, PainterPacker::num_timers> m_timers;
+  };
+
+  static
+  const char*
+  workload_name(enum workload_t w);
+
+  bool
+  workload_enabled(enum workload_t w) const;
+
+  void
+  init_painter(void);
+
+  void
+  load_paths(void);
+
+  void
+  load_dash_pattern(void);
+
+  void
+  pretessellate_paths(void);
+
+  void
+  bench_tessellation(void);
+
+  void
+  bench_point_memory(void);
+
+  void
+  load_text(void);
+
+  unsigned int
+  draw_workload(enum workload_t w);
+
+  unsigned int
+  draw_rects(void);
+
+  unsigned int
+  draw_paths(void);
+
+  unsigned int
+  draw_dashed(void);
+
+  unsigned int
+  draw_clipped(void);
+
+  unsigned int
+  draw_text(void);
+
+  unsigned int
+  draw_scrolled_text(void);
+
+  unsigned int
+  draw_panels(void);
+
+  unsigned int
+  draw_grid(void);
+
+  unsigned int
+  draw_widgets(void);
+
+  unsigned int
+  draw_layers(void);
+
+  unsigned int
+  draw_zoom(void);
+
+  void
+  run_workload(enum workload_t w);
+
+  static
+  uint64_t
+  percentile(const std::vector<uint64_t> &sorted_values, float p);
+
+  command_line_argument_value<bool> m_run_checks;
+  command_line_argument_value<int> m_num_frames;
+  command_line_argument_value<int> m_skip_frames;
+  command_line_argument_value<int> m_width, m_height;
+  command_line_argument_value<bool> m_sort_by_shader_group;
+  command_line_argument_value<bool> m_packed_value_arena;
+  command_line_argument_value<bool> m_occlusion_culling;
+  command_line_argument_value<bool> m_break_on_shader_change;
+  command_line_argument_value<bool> m_use_hw_clip_planes;
+  command_line_argument_value<bool> m_pipelined_submission;
+  command_line_argument_value<bool> m_timers;
+  command_line_argument_value<int> m_num_dirty_rects;
+  command_line_argument_value<float> m_dirty_rect_size;
+
+  command_line_argument_value<bool> m_bench_rects;
+  command_line_argument_value<int> m_num_rects;
+
+  command_line_argument_value<bool> m_bench_paths;
+  command_line_argument_value<bool> m_bench_dashed;
+  command_line_argument_value<std::string> m_path_dir;
+  command_line_argument_value<int> m_path_repeat;
+  command_line_argument_value<int> m_pretessellate_threads;
+  command_line_argument_value<int> m_tessellation_threads;
+  command_line_argument_value<int> m_tessellation_contours;
+  command_line_argument_value<bool> m_compact_tessellation;
+  command_line_argument_value<bool> m_bench_point_memory;
+  command_line_argument_value<std::string> m_dash_pattern_file;
+
+  command_line_argument_value<bool> m_bench_clipped;
+  command_line_argument_value<int> m_num_clip_cells;
+
+  command_line_argument_value<bool> m_bench_text;
+  command_line_argument_value<std::string> m_font;
+  command_line_argument_value<std::string> m_text;
+  command_line_argument_value<float> m_pixel_size;
+  command_line_argument_value<int> m_num_text_runs;
+
+  command_line_argument_value<bool> m_bench_scrolled_text;
+  command_line_argument_value<int> m_num_text_lines;
+  command_line_argument_value<bool> m_text_chunks;
+
+  command_line_argument_value<bool> m_bench_panels;
+  command_line_argument_value<int> m_num_panels;
+  command_line_argument_value<int> m_panel_items;
+
+  command_line_argument_value<bool> m_bench_grid;
+  command_line_argument_value<int> m_num_grid_cells;
+  command_line_argument_value<bool> m_grid_batched;
+
+  command_line_argument_value<bool> m_bench_widgets;
+  command_line_argument_value<int> m_num_widgets;
+  command_line_argument_value<int> m_widget_children;
+  command_line_argument_value<int> m_widget_draw_every;
+
+  command_line_argument_value<bool> m_bench_layers;
+  command_line_argument_value<int> m_num_layers;
+  command_line_argument_value<int> m_layer_items;
+  command_line_argument_value<bool> m_layers_cached;
+
+  command_line_argument_value<bool> m_bench_zoom;
+  command_line_argument_value<float> m_zoom_velocity;
+  command_line_argument_value<int> m_path_prefetch_threads;
+
+  reference_counted_ptr<glsl::PainterBackendHeadless> m_backend;
+  reference_counted_ptr<Painter> m_painter;
+  reference_counted_ptr<GlyphCache> m_glyph_cache;
+  reference_counted_ptr<GlyphSelector> m_glyph_selector;
+
+  std::vector<vec4> m_rect_colors;
+  std::vector<vec2> m_dirty_rect_pmin, m_dirty_rect_wh;
+  std::vector<vec2> m_grid_cells;
+  std::vector<unsigned int> m_grid_colors;
+  vec2 m_grid_cell_size;
+  std::vector<Path*> m_paths;
+  std::vector<PainterDashedStrokeParams::DashPatternElement> m_dash_pattern;
+  Path m_clip_path;
+  PainterAttributeData m_text_data;
+  PainterAttributeData m_scrolled_text_data;
+  PainterGlyphChunks *m_scrolled_text_chunks;
+  unsigned int m_scroll_line;
+  bool m_have_text;
+  float m_zoom_scale;
+};
+
+painter_bench::
+painter_bench(void):
+  m_run_checks(false, "run_checks",
+               "If true, run the correctness checks of the optional features of Painter "
+               "(see checks.hpp) instead of the workloads; the exit status is non-zero "
+               "if a check fails",
+               *this),
+  m_num_frames(100, "num_frames", "Number of frames measured for each workload", *this),
+  m_skip_frames(5, "skip_frames",
+                "Number of frames drawn before measuring for each workload; "
+                "the first frames include the creation of the path data",
+                *this),
+  m_width(1024, "width", "Width of the target resolution", *this),
+  m_height(768, "height", "Height of the target resolution", *this),
+  m_sort_by_shader_group(false, "sort_by_shader_group",
+                         "If true, reorder items by shader group (see Painter::sort_by_shader_group()); "
+                         "only items whose blending does not read the framebuffer (thus not src-over) "
+                         "are moved, and only within a buffer of the frame's recording",
+                         *this),
+  m_packed_value_arena(false, "packed_value_arena",
+                       "If true, the packed values made each frame come from an arena "
+                       "(see Painter::packed_value_arena())",
+                       *this),
+  m_occlusion_culling(false, "occlusion_culling",
+                      "If true, items hidden by opaque rects drawn after them are dropped "
+                      "(see Painter::occlusion_culling())",
+                      *this),
+  m_break_on_shader_change(false, "break_on_shader_change",
+                           "If true, each shader change is a draw break", *this),
+  m_use_hw_clip_planes(true, "use_hw_clip_planes",
+                       "If false, convex polygons are clipped on the CPU by Painter "
+                       "instead of by hardware clip planes",
+                       *this),
+  m_pipelined_submission(false, "pipelined_submission",
+                         "If true, the data of a frame is sent to the backend by a "
+                         "submission thread; the time of a frame is then the time "
+                         "until Painter::end() returns (see Painter::pipelined_submission())",
+                         *this),
+  m_timers(false, "timers",
+           "If true, enable the timers of the packing (see PainterPacker::timers_enabled()) "
+           "and report the time of each per workload; reading the clocks adds to the "
+           "frame time",
+           *this),
+  m_num_dirty_rects(0, "num_dirty_rects",
+                    "If positive, each frame is begun with this many dirty rects placed "
+                    "along the diagonal of the target so that only the content "
+                    "within them is drawn",
+                    *this),
+  m_dirty_rect_size(64.0f, "dirty_rect_size", "Width and height in pixels of each dirty rect", *this),
+  m_bench_rects(true, "bench_rects", "If true, run the rect workload", *this),
+  m_num_rects(10000, "num_rects", "Number of rects drawn per frame by the rect workload", *this),
+  m_bench_paths(true, "bench_paths", "If true, run the path fill and stroke workload", *this),
+  m_bench_dashed(true, "bench_dashed", "If true, run the dashed stroke workload", *this),
+  m_path_dir("demo_data/paths", "path_dir",
+             "Directory from which to load the paths of the path workloads", *this),
+  m_path_repeat(10, "path_repeat", "Number of times each path is drawn per frame", *this),
+  m_pretessellate_threads(0, "pretessellate_threads",
+                          "If positive, before the workloads this many threads at once make the "
+                          "tessellations, fills and strokes of all the paths at several levels "
+                          "of detail, and the time taken is printed",
+                          *this),
+  m_tessellation_threads(1, "tessellation_threads",
+                         "Maximum number of threads with which each path is tessellated, "
+                         "see Path::tessellation_threads()",
+                         *this),
+  m_tessellation_contours(0, "tessellation_contours",
+                          "If positive, before the workloads time the tessellation of a path "
+                          "with this many contours with one thread and with tessellation_threads "
+                          "threads",
+                          *this),
+  m_compact_tessellation(false, "compact_tessellation",
+                         "If true, the paths store the points of their tessellations compactly, "
+                         "see Path::compact_tessellation()",
+                         *this),
+  m_bench_point_memory(false, "bench_point_memory",
+                       "If true, before the workloads print the memory used by the points of the "
+                       "tessellations of the paths at several levels of detail, stored as arrays "
+                       "of TessellatedPath::point and stored compactly",
+                       *this),
+  m_dash_pattern_file("demo_data/dash_patterns/pattern0.txt", "dash_pattern",
+                      "File from which to read the dash pattern of the dashed stroke workload",
+                      *this),
+  m_bench_clipped(true, "bench_clipped", "If true, run the clipped content workload", *this),
+  m_num_clip_cells(400, "num_clip_cells",
+                   "Number of clipped cells drawn per frame by the clipped content workload",
+                   *this),
+  m_bench_text(true, "bench_text", "If true, run the text workload", *this),
+  m_font("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf", "font",
+         "File from which to take font for the text workload", *this),
+  m_text("The quick brown fox jumps over the lazy dog 0123456789", "text",
+         "Text of each text run of the text workload", *this),
+  m_pixel_size(16.0f, "font_pixel_size", "Pixel size of the text of the text workload", *this),
+  m_num_text_runs(200, "num_text_runs", "Number of text runs drawn per frame by the text workload", *this),
+  m_bench_scrolled_text(true, "bench_scrolled_text",
+                        "If true, run the scrolled text workload which draws a single "
+                        "block of text of which only the lines within the window are visible",
+                        *this),
+  m_num_text_lines(2000, "num_text_lines", "Number of lines of text of the scrolled text workload", *this),
+  m_text_chunks(true, "text_chunks",
+                "If true, the scrolled text workload draws the text from a PainterGlyphChunks "
+                "so that only the chunks of glyphs within the window are drawn",
+                *this),
+  m_bench_panels(true, "bench_panels",
+                 "If true, run the panels workload which draws overlapping opaque "
+                 "panels, each with content, so that most panels are hidden by the "
+                 "panels drawn after them",
+                 *this),
+  m_num_panels(100, "num_panels", "Number of panels drawn per frame by the panels workload", *this),
+  m_panel_items(100, "panel_items", "Number of rects drawn within each panel by the panels workload", *this),
+  m_bench_grid(true, "bench_grid",
+               "If true, run the grid workload which draws a heatmap-like grid of cells "
+               "colored from a small palette",
+               *this),
+  m_num_grid_cells(100000, "num_grid_cells", "Number of cells of the grid workload", *this),
+  m_grid_batched(true, "grid_batched",
+                 "If true, the grid workload draws the cells with Painter::draw_rects(), "
+                 "otherwise with a call to Painter::draw_rect() per cell",
+                 *this),
+  m_bench_widgets(true, "bench_widgets",
+                  "If true, run the widgets workload which saves, translates, clips "
+                  "and restores for each widget of a widget hierarchy where only few "
+                  "of the widgets draw anything",
+                  *this),
+  m_num_widgets(2000, "num_widgets", "Number of top level widgets of the widgets workload", *this),
+  m_widget_children(10, "widget_children",
+                    "Number of child widgets of each top level widget of the widgets workload",
+                    *this),
+  m_widget_draw_every(16, "widget_draw_every",
+                      "Only one of this many child widgets of the widgets workload draws a rect",
+                      *this),
+  m_bench_layers(true, "bench_layers",
+                 "If true, run the layers workload which draws translucent groups of "
+                 "rects with Painter::begin_layer() and Painter::end_layer()",
+                 *this),
+  m_num_layers(16, "num_layers", "Number of layers of the layers workload", *this),
+  m_layer_items(400, "layer_items", "Number of rects drawn within each layer of the layers workload", *this),
+  m_layers_cached(true, "layers_cached",
+                  "If true, the layers of the layers workload are keyed and marked as unchanged "
+                  "so that their images are reused across frames, otherwise the content of each "
+                  "layer is drawn every frame",
+                  *this),
+  m_bench_zoom(true, "bench_zoom",
+               "If true, run the zoom workload which fills and strokes the paths "
+               "with a scale that grows every frame, so that finer levels of detail "
+               "of the paths are needed as the frames go",
+               *this),
+  m_zoom_velocity(1.05f, "zoom_velocity",
+                  "Factor by which the scale of the zoom workload grows every frame", *this),
+  m_path_prefetch_threads(0, "path_prefetch_threads",
+                          "If positive, the Painter makes the levels of detail of the paths "
+                          "on a PathPrefetcher with this many threads and draws the finest "
+                          "level already made instead of waiting for a missing one",
+                          *this),
+  m_scrolled_text_chunks(NULL),
+  m_scroll_line(0),
+  m_have_text(false),
+  m_zoom_scale(1.0f)
+{}
+
+painter_bench::
+~painter_bench()
+{
+  for(unsigned int i = 0, endi = m_paths.size(); i < endi; ++i)
+    {
+      FASTUIDRAWdelete(m_paths[i]);
+    }
+
+  if(m_scrolled_text_chunks)
+    {
+      FASTUIDRAWdelete(m_scrolled_text_chunks);
+    }
+}
+
+const char*
+painter_bench::
+workload_name(enum workload_t w)
+{
+#define CASE(X) case workload_##X: return #X
+
+  switch(w)
+    {
+    default:
+      return "unknown";
+      CASE(rects);
+      CASE(paths);
+      CASE(dashed);
+      CASE(clipped);
+      CASE(text);
+      CASE(scrolled_text);
+      CASE(panels);
+      CASE(grid);
+      CASE(widgets);
+      CASE(layers);
+      CASE(zoom);
+    }
+
+#undef CASE
+}
+
+bool
+painter_bench::
+workload_enabled(enum workload_t w) const
+{
+  switch(w)
+    {
+    case workload_rects:
+      return m_bench_rects.m_value;
+    case workload_paths:
+      return m_bench_paths.m_value && !m_paths.empty();
+    case workload_dashed:
+      return m_bench_dashed.m_value && !m_paths.empty();
+    case workload_clipped:
+      return m_bench_clipped.m_value;
+    case workload_text:
+      return m_bench_text.m_value && m_have_text;
+    case workload_scrolled_text:
+      return m_bench_scrolled_text.m_value && m_have_text;
+    case workload_panels:
+      return m_bench_panels.m_value;
+    case workload_grid:
+      return m_bench_grid.m_value;
+    case workload_widgets:
+      return m_bench_widgets.m_value;
+    case workload_layers:
+      return m_bench_layers.m_value;
+    case workload_zoom:
+      return m_bench_zoom.m_value && !m_paths.empty();
+    default:
+      return false;
+    }
+}
+
+void
+painter_bench::
+init_painter(void)
+{
+  glsl::PainterBackendHeadless::ConfigurationHeadless config;
+
+  config
+    .break_on_shader_change(m_break_on_shader_change.m_value)
+    .use_hw_clip_planes(m_use_hw_clip_planes.m_value);
+  m_backend = FASTUIDRAWnew glsl::PainterBackendHeadless(config);
+  m_painter = FASTUIDRAWnew Painter(m_backend);
+  m_painter->target_resolution(m_width.m_value, m_height.m_value);
+  m_painter->sort_by_shader_group(m_sort_by_shader_group.m_value);
+  m_painter->packed_value_arena(m_packed_value_arena.m_value);
+  m_painter->occlusion_culling(m_occlusion_culling.m_value);
+  m_painter->pipelined_submission(m_pipelined_submission.m_value);
+  m_painter->timers_enabled(m_timers.m_value);
+  if(m_path_prefetch_threads.m_value > 0)
+    {
+      m_painter->path_prefetcher(FASTUIDRAWnew PathPrefetcher(m_path_prefetch_threads.m_value));
+    }
+
+  /* colors are random but the same from run to run
+   */
+  srand(1);
+  m_rect_colors.resize(m_num_rects.m_value);
+  for(unsigned int i = 0, endi = m_rect_colors.size(); i < endi; ++i)
+    {
+      m_rect_colors[i] = random_value(vec4(0.0f, 0.0f, 0.0f, 0.5f), vec4(1.0f, 1.0f, 1.0f, 1.0f));
+    }
+
+  /* the grid covers the window, each row of cells is colored
+     in runs of a palette color of random length
+   */
+  int grid_per_row(std::max(1, int(std::sqrt(float(m_num_grid_cells.m_value)))));
+  unsigned int color(0), run(0);
+
+  m_grid_cell_size = vec2(float(m_width.m_value) / float(grid_per_row),
+                          float(m_height.m_value) / float(grid_per_row));
+  m_grid_cells.resize(std::max(0, m_num_grid_cells.m_value));
+  m_grid_colors.resize(m_grid_cells.size());
+  for(unsigned int i = 0, endi = m_grid_cells.size(); i < endi; ++i)
+    {
+      if(run == 0)
+        {
+          color = rand() % grid_palette_size;
+          run = 1 + rand() % 32;
+        }
+      --run;
+      m_grid_cells[i] = vec2(float(i % grid_per_row), float(i / grid_per_row)) * m_grid_cell_size;
+      m_grid_colors[i] = color;
+    }
+
+  m_clip_path << vec2(0.0f, 0.0f)
+              << Path::arc_degrees(180.0f, vec2(40.0f, 0.0f))
+              << vec2(40.0f, 30.0f)
+              << Path::arc_degrees(180.0f, vec2(0.0f, 30.0f))
+              << Path::contour_end();
+}
+
+void
+painter_bench::
+load_paths(void)
+{
+  DIR *dir;
+  std::vector<std::string> files;
+
+  dir = opendir(m_path_dir.m_value.c_str());
+  if(!dir)
+    {
+      std::cout << "Unable to open path directory \"" << m_path_dir.m_value
+                << "\", path workloads are skipped\n";
+      return;
+    }
+
+  for(struct dirent *entry = readdir(dir); entry != NULL; entry = readdir(dir))
+    {
+      std::string name(entry->d_name);
+      if(name != "." && name != "..")
+        {
+          files.push_back(m_path_dir.m_value + "/" + name);
+        }
+    }
+  closedir(dir);
+
+  /* sort so that the workload is the same regardless
+     of the order the file system lists the files
+   */
+  std::sort(files.begin(), files.end());
+  for(unsigned int i = 0, endi = files.size(); i < endi; ++i)
+    {
+      std::ifstream file(files[i].c_str());
+      if(file)
+        {
+          std::ostringstream str;
+          Path *path;
+
+          str << file.rdbuf();
+          path = FASTUIDRAWnew Path();
+          read_path(*path, str.str());
+          path->tessellation_threads(std::max(1, m_tessellation_threads.m_value));
+          path->compact_tessellation(m_compact_tessellation.m_value);
+          m_paths.push_back(path);
+        }
+    }
+}
+
+void
+painter_bench::
+load_dash_pattern(void)
+{
+  std::ifstream file(m_dash_pattern_file.m_value.c_str());
+  if(file)
+    {
+      read_dash_pattern(m_dash_pattern, file);
+    }
+
+  if(m_dash_pattern.empty())
+    {
+      m_dash_pattern.push_back(PainterDashedStrokeParams::DashPatternElement(20.0f, 10.0f));
+      m_dash_pattern.push_back(PainterDashedStrokeParams::DashPatternElement(5.0f, 10.0f));
+    }
+}
+
+void
+painter_bench::
+load_text(void)
+{
+  reference_counted_ptr<FontFreeType> font;
+  std::vector<Glyph> glyphs;
+  std::vector<vec2> positions;
+  std::vector<uint32_t> character_codes;
+  std::istringstream str(m_text.m_value);
+
+  font = FontFreeType::create(m_font.m_value.c_str());
+  if(!font)
+    {
+      std::cout << "Unable to load font \"" << m_font.m_value
+                << "\", text workload is skipped\n";
+      return;
+    }
+
+  m_glyph_cache = FASTUIDRAWnew GlyphCache(m_painter->glyph_atlas());
+  m_glyph_selector = FASTUIDRAWnew GlyphSelector(m_glyph_cache);
+  m_glyph_selector->add_font(font);
+  create_formatted_text(str, GlyphRender(curve_pair_glyph), m_pixel_size.m_value,
+                        font, m_glyph_selector, glyphs, positions, character_codes);
+  m_text_data.set_data(PainterAttributeDataFillerGlyphs(cast_c_array(positions),
+                                                        cast_c_array(glyphs),
+                                                        m_pixel_size.m_value));
+
+  /* the scrolled text is the text repeated on each line
+   */
+  std::vector<Glyph> lines_glyphs;
+  std::vector<vec2> lines_positions;
+  float line_height(m_pixel_size.m_value * 1.2f);
+  for(int L = 0; L < m_num_text_lines.m_value; ++L)
+    {
+      for(unsigned int g = 0; g < glyphs.size(); ++g)
+        {
+          lines_glyphs.push_back(glyphs[g]);
+          lines_positions.push_back(positions[g] + vec2(0.0f, float(L) * line_height));
+        }
+    }
+
+  PainterAttributeDataFillerGlyphs lines_filler(cast_c_array(lines_positions),
+                                                cast_c_array(lines_glyphs),
+                                                m_pixel_size.m_value);
+  if(m_text_chunks.m_value)
+    {
+      m_scrolled_text_chunks = FASTUIDRAWnew PainterGlyphChunks(lines_filler);
+    }
+  else
+    {
+      m_scrolled_text_data.set_data(lines_filler);
+    }
+  m_have_text = true;
+}
+
+unsigned int
+painter_bench::
+draw_workload(enum workload_t w)
+{
+  switch(w)
+    {
+    case workload_rects:
+      return draw_rects();
+    case workload_paths:
+      return draw_paths();
+    case workload_dashed:
+      return draw_dashed();
+    case workload_clipped:
+      return draw_clipped();
+    case workload_text:
+      return draw_text();
+    case workload_scrolled_text:
+      return draw_scrolled_text();
+    case workload_panels:
+      return draw_panels();
+    case workload_grid:
+      return draw_grid();
+    case workload_widgets:
+      return draw_widgets();
+    case workload_layers:
+      return draw_layers();
+    case workload_zoom:
+      return draw_zoom();
+    default:
+      return 0;
+    }
+}
+
+unsigned int
+painter_bench::
+draw_rects(void)
+{
+  unsigned int N(m_rect_colors.size());
+  int per_row(std::max(1, int(std::sqrt(float(N)))));
+  vec2 wh(float(m_width.m_value) / float(per_row),
+          float(m_height.m_value) / float(per_row));
+
+  for(unsigned int i = 0; i < N; ++i)
+    {
+      PainterBrush brush;
+      vec2 p(float(i % per_row) * wh.x(), float(i / per_row) * wh.y());
+
+      brush.pen(m_rect_colors[i]);
+      m_painter->draw_rect(PainterData(&brush), p, wh);
+    }
+  return N;
+}
+
+unsigned int
+painter_bench::
+draw_paths(void)
+{
+  PainterBrush fill_brush, stroke_brush;
+  PainterStrokeParams st;
+  unsigned int count(0);
+
+  fill_brush.pen(0.2f, 0.6f, 0.9f, 1.0f);
+  stroke_brush.pen(1.0f, 1.0f, 1.0f, 1.0f);
+  st.miter_limit(5.0f);
+  st.width(4.0f);
+
+  for(int r = 0; r < m_path_repeat.m_value; ++r)
+    {
+      for(unsigned int i = 0, endi = m_paths.size(); i < endi; ++i)
+        {
+          m_painter->save();
+          m_painter->translate(vec2(float(r) * 8.0f, float(i) * 8.0f));
+          m_painter->fill_path(PainterData(&fill_brush), *m_paths[i],
+                               PainterEnums::nonzero_fill_rule);
+          m_painter->stroke_path(PainterData(&stroke_brush, &st), *m_paths[i],
+                                 true, PainterEnums::rounded_caps, PainterEnums::miter_joins,
+                                 true);
+          m_painter->restore();
+          count += 2;
+        }
+    }
+  return count;
+}
+
+unsigned int
+painter_bench::
+draw_dashed(void)
+{
+  PainterBrush brush;
+  PainterDashedStrokeParams st;
+  unsigned int count(0);
+
+  brush.pen(1.0f, 0.8f, 0.2f, 1.0f);
+  st.miter_limit(5.0f);
+  st.width(4.0f);
+  st.dash_pattern(cast_c_array(m_dash_pattern));
+
+  for(int r = 0; r < m_path_repeat.m_value; ++r)
+    {
+      for(unsigned int i = 0, endi = m_paths.size(); i < endi; ++i)
+        {
+          m_painter->save();
+          m_painter->translate(vec2(float(r) * 8.0f, float(i) * 8.0f));
+          m_painter->stroke_dashed_path(PainterData(&brush, &st), *m_paths[i],
+                                        true, PainterEnums::square_caps, PainterEnums::rounded_joins,
+                                        true);
+          m_painter->restore();
+          ++count;
+        }
+    }
+  return count;
+}
+
+unsigned int
+painter_bench::
+draw_clipped(void)
+{
+  PainterBrush background, foreground;
+  int N(m_num_clip_cells.m_value);
+  int per_row(std::max(1, int(std::sqrt(float(N)))));
+  vec2 wh(float(m_width.m_value) / float(per_row),
+          float(m_height.m_value) / float(per_row));
+  unsigned int count(0);
+
+  background.pen(0.3f, 0.3f, 0.3f, 1.0f);
+  foreground.pen(0.9f, 0.2f, 0.2f, 0.8f);
+
+  for(int i = 0; i < N; ++i)
+    {
+      m_painter->save();
+      m_painter->translate(vec2(float(i % per_row) * wh.x(), float(i / per_row) * wh.y()));
+      m_painter->clipInRect(vec2(0.0f, 0.0f), wh);
+
+      /* content that partially crosses the clip-rect
+       */
+      m_painter->draw_rect(PainterData(&background), vec2(-4.0f, -4.0f), wh + vec2(8.0f, 8.0f));
+      ++count;
+
+      /* every other cell is also clipped by a path
+       */
+      if(i & 1)
+        {
+          m_painter->clipInPath(m_clip_path, PainterEnums::nonzero_fill_rule);
+        }
+      m_painter->fill_path(PainterData(&foreground), m_clip_path,
+                           PainterEnums::odd_even_fill_rule);
+      ++count;
+
+      /* content entirely outside of the clip-rect
+       */
+      m_painter->draw_rect(PainterData(&foreground), wh + vec2(10.0f, 10.0f), wh);
+      ++count;
+
+      m_painter->restore();
+    }
+  return count;
+}
+
+unsigned int
+painter_bench::
+draw_text(void)
+{
+  PainterBrush brush;
+  float line_height(m_pixel_size.m_value * 1.2f);
+  int lines_per_column(std::max(1, int(float(m_height.m_value) / line_height)));
+
+  brush.pen(0.0f, 0.0f, 0.0f, 1.0f);
+  for(int i = 0; i < m_num_text_runs.m_value; ++i)
+    {
+      m_painter->save();
+      m_painter->translate(vec2(float(i / lines_per_column) * 300.0f,
+                                float(i % lines_per_column) * line_height));
+      m_painter->draw_glyphs(PainterData(&brush), m_text_data);
+      m_painter->restore();
+    }
+  return m_num_text_runs.m_value;
+}
+
+unsigned int
+painter_bench::
+draw_scrolled_text(void)
+{
+  PainterBrush brush;
+  float line_height(m_pixel_size.m_value * 1.2f);
+  int lines_per_screen(std::max(1, int(float(m_height.m_value) / line_height)));
+
+  /* scroll by a line each frame
+   */
+  m_scroll_line = (m_scroll_line + 1) % std::max(1, m_num_text_lines.m_value - lines_per_screen);
+
+  brush.pen(0.0f, 0.0f, 0.0f, 1.0f);
+  m_painter->save();
+  m_painter->translate(vec2(0.0f, -float(m_scroll_line) * line_height));
+  if(m_scrolled_text_chunks)
+    {
+      m_painter->draw_glyphs(PainterData(&brush), *m_scrolled_text_chunks);
+    }
+  else
+    {
+      m_painter->draw_glyphs(PainterData(&brush), m_scrolled_text_data);
+    }
+  m_painter->restore();
+  return 1;
+}
+
+unsigned int
+painter_bench::
+draw_panels(void)
+{
+  unsigned int count(0);
+  int per_row(std::max(1, int(std::sqrt(float(m_panel_items.m_value)))));
+  vec2 panel_wh(0.75f * float(m_width.m_value), 0.75f * float(m_height.m_value));
+  vec2 step(0.25f * float(m_width.m_value), 0.25f * float(m_height.m_value));
+  vec2 item_wh(panel_wh / float(per_row + 1));
+
+  /* the panels cascade from the top-left to the bottom-right
+     of the window and each panel is mostly hidden by the panels
+     drawn after it.
+   */
+  for(int p = 0; p < m_num_panels.m_value; ++p)
+    {
+      PainterBrush brush;
+      float t(float(p) / float(std::max(1, m_num_panels.m_value - 1)));
+      vec2 corner(t * step);
+
+      brush.pen(0.9f, 0.9f, 0.9f, 1.0f);
+      m_painter->draw_rect(PainterData(&brush), corner, panel_wh);
+      ++count;
+
+      for(int i = 0; i < m_panel_items.m_value; ++i)
+        {
+          const vec4 &c(m_rect_colors[(p * m_panel_items.m_value + i) % m_rect_colors.size()]);
+          vec2 q(float(i % per_row) + 0.5f, float(i / per_row) + 0.5f);
+
+          brush.pen(c.x(), c.y(), c.z(), 1.0f);
+          m_painter->draw_rect(PainterData(&brush), corner + q * item_wh, 0.75f * item_wh);
+          ++count;
+        }
+    }
+  return count;
+}
+
+unsigned int
+painter_bench::
+draw_grid(void)
+{
+  vecN<PainterBrush, grid_palette_size> brushes;
+  vecN<PainterData, grid_palette_size> draws;
+
+  for(unsigned int k = 0; k < grid_palette_size; ++k)
+    {
+      float t(float(k) / float(grid_palette_size - 1));
+
+      brushes[k].pen(t, 0.2f, 1.0f - t, 1.0f);
+      draws[k] = PainterData(&brushes[k]);
+    }
+
+  if(m_grid_batched.m_value)
+    {
+      m_painter->draw_rects(const_c_array<PainterData>(draws.c_ptr(), draws.size()),
+                            cast_c_array(m_grid_colors),
+                            cast_c_array(m_grid_cells),
+                            const_c_array<vec2>(&m_grid_cell_size, 1));
+    }
+  else
+    {
+      for(unsigned int i = 0, endi = m_grid_cells.size(); i < endi; ++i)
+        {
+          m_painter->draw_rect(draws[m_grid_colors[i]], m_grid_cells[i], m_grid_cell_size);
+        }
+    }
+  return m_grid_cells.size();
+}
+
+unsigned int
+painter_bench::
+draw_widgets(void)
+{
+  PainterBrush brush;
+  int N(m_num_widgets.m_value);
+  int C(std::max(1, m_widget_children.m_value));
+  int draw_every(std::max(1, m_widget_draw_every.m_value));
+  int per_row(std::max(1, int(std::sqrt(float(N)))));
+  vec2 wh(float(m_width.m_value) / float(per_row),
+          float(m_height.m_value) / float(per_row));
+  vec2 child_wh(wh.x(), wh.y() / float(C));
+  unsigned int count(0);
+
+  brush.pen(0.2f, 0.6f, 0.2f, 1.0f);
+  for(int i = 0; i < N; ++i)
+    {
+      m_painter->save();
+      m_painter->translate(vec2(float(i % per_row) * wh.x(), float(i / per_row) * wh.y()));
+      m_painter->clipInRect(vec2(0.0f, 0.0f), wh);
+      ++count;
+
+      /* the child widgets are stacked vertically, most
+         of them only change the state and draw nothing.
+       */
+      for(int c = 0; c < C; ++c, ++count)
+        {
+          m_painter->save();
+          m_painter->translate(vec2(0.0f, float(c) * child_wh.y()));
+          if((i * C + c) % draw_every == 0)
+            {
+              m_painter->draw_rect(PainterData(&brush), vec2(1.0f, 1.0f), child_wh - vec2(2.0f, 2.0f));
+            }
+          m_painter->restore();
+        }
+      m_painter->restore();
+    }
+  return count;
+}
+
+unsigned int
+painter_bench::
+draw_layers(void)
+{
+  int N(m_num_layers.m_value);
+  int M(std::max(1, m_layer_items.m_value));
+  int per_row(std::max(1, int(std::sqrt(float(N)))));
+  int items_per_row(std::max(1, int(std::sqrt(float(M)))));
+  vec2 wh(float(m_width.m_value) / float(per_row),
+          float(m_height.m_value) / float(per_row));
+  vec2 item_wh(wh / float(items_per_row));
+  unsigned int count(0);
+
+  for(int i = 0; i < N; ++i)
+    {
+      uint64_t key(0);
+
+      m_painter->save();
+      m_painter->translate(vec2(float(i % per_row) * wh.x(), float(i / per_row) * wh.y()));
+      if(m_layers_cached.m_value)
+        {
+          key = i + 1;
+        }
+
+      if(m_painter->begin_layer(vec2(0.0f, 0.0f), wh, 0.5f, key, m_layers_cached.m_value))
+        {
+          for(int c = 0; c < M; ++c)
+            {
+              PainterBrush brush;
+              vec2 p(float(c % items_per_row) * item_wh.x(), float(c / items_per_row) * item_wh.y());
+
+              brush.pen(m_rect_colors[(i * M + c) % m_rect_colors.size()]);
+              m_painter->draw_rect(PainterData(&brush), p, item_wh);
+            }
+        }
+      m_painter->end_layer();
+      m_painter->restore();
+      count += M;
+    }
+  return count;
+}
+
+unsigned int
+painter_bench::
+draw_zoom(void)
+{
+  PainterBrush fill_brush, stroke_brush;
+  PainterStrokeParams st;
+  unsigned int count(0);
+
+  fill_brush.pen(0.2f, 0.6f, 0.9f, 1.0f);
+  stroke_brush.pen(1.0f, 1.0f, 1.0f, 1.0f);
+  st.width(2.0f);
+
+  m_painter->scale(m_zoom_scale);
+  for(unsigned int i = 0, endi = m_paths.size(); i < endi; ++i)
+    {
+      m_painter->fill_path(PainterData(&fill_brush), *m_paths[i],
+                           PainterEnums::nonzero_fill_rule);
+      m_painter->stroke_path(PainterData(&stroke_brush, &st), *m_paths[i],
+                             true, PainterEnums::rounded_caps, PainterEnums::rounded_joins,
+                             true);
+      count += 2;
+    }
+  m_zoom_scale *= m_zoom_velocity.m_value;
+  return count;
+}
+
+uint64_t
+painter_bench::
+percentile(const std::vector<uint64_t> &sorted_values, float p)
+{
+  unsigned int idx;
+
+  if(sorted_values.empty())
+    {
+      return 0;
+    }
+
+  /* nearest-rank percentile */
+  idx = static_cast<unsigned int>(std::ceil(p * float(sorted_values.size())));
+  idx = std::max(1u, std::min(idx, static_cast<unsigned int>(sorted_values.size())));
+  return sorted_values[idx - 1];
+}
+
+void
+painter_bench::
+run_workload(enum workload_t w)
+{
+  std::vector<frame_result> results;
+  std::vector<uint64_t> times;
+  frame_result total;
+  unsigned long max_allocations(0), first_frame_allocations(0);
+  int num_frames(std::max(1, m_num_frames.m_value));
+  int skip_frames(std::max(0, m_skip_frames.m_value));
+
+  /* the workloads are in pixel coordinates with the
+     origin at the top left
+   */
+  float3x3 proj(float_orthogonal_projection_params(0, m_width.m_value, m_height.m_value, 0));
+
+  m_dirty_rect_pmin.resize(std::max(0, m_num_dirty_rects.m_value));
+  m_dirty_rect_wh.resize(m_dirty_rect_pmin.size(), vec2(m_dirty_rect_size.m_value, m_dirty_rect_size.m_value));
+  for(unsigned int i = 0, endi = m_dirty_rect_pmin.size(); i < endi; ++i)
+    {
+      float t((float(i) + 0.5f) / float(endi));
+      m_dirty_rect_pmin[i] = t * vec2(m_width.m_value, m_height.m_value) - 0.5f * m_dirty_rect_wh[i];
+    }
+
+  /* only the zoom workload tells the Painter how its
+     scale changes, so that only it schedules the levels
+     of detail of its paths ahead of need.
+   */
+  unsigned int prefetched_begin(0);
+  if(w == workload_zoom)
+    {
+      m_zoom_scale = 1.0f;
+      m_painter->zoom_velocity(m_zoom_velocity.m_value);
+    }
+  if(m_painter->path_prefetcher())
+    {
+      prefetched_begin = m_painter->path_prefetcher()->number_completed();
+    }
+
+  m_backend->clear_log();
+  results.reserve(num_frames);
+  for(int frame = 0; frame < skip_frames + num_frames; ++frame)
+    {
+      frame_result R;
+      simple_time timer;
+      unsigned int draw_begin, break_begin;
+      unsigned long allocations_begin;
+      const_c_array<glsl::PainterBackendHeadless::DrawRecord> draws;
+
+      draw_begin = m_backend->draws().size();
+      break_begin = m_backend->breaks().size();
+      allocations_begin = query_number_allocations();
+
+      m_painter->begin(cast_c_array(m_dirty_rect_pmin), cast_c_array(m_dirty_rect_wh));
+      m_painter->transformation(proj);
+      R.m_items = draw_workload(w);
+      m_painter->end();
+      R.m_time_us = timer.elapsed_us();
+
+      /* the log of the backend and the timers are only
+         complete once the frame is submitted
+       */
+      m_painter->wait_submission();
+      R.m_allocations = query_number_allocations() - allocations_begin;
+      if(frame == 0)
+        {
+          /* includes the allocations made to grow the
+             scratch buffers of Painter to the workload
+           */
+          first_frame_allocations = R.m_allocations;
+        }
+
+      draws = m_backend->draws();
+      R.m_draws = draws.size() - draw_begin;
+      R.m_breaks = m_backend->breaks().size() - break_begin;
+      R.m_bytes_packed = 0;
+      for(unsigned int d = draw_begin; d < draws.size(); ++d)
+        {
+          R.m_bytes_packed += draws[d].m_attributes_written * (sizeof(PainterAttribute) + sizeof(uint32_t))
+            + draws[d].m_indices_written * sizeof(PainterIndex)
+            + draws[d].m_store_written * sizeof(generic_data);
+        }
+      R.m_headers = m_painter->query_stat(PainterPacker::num_headers);
+      R.m_headers_occluded = m_painter->query_stat(PainterPacker::num_headers_occluded);
+      for(unsigned int t = 0; t < PainterPacker::num_timers; ++t)
+        {
+          R.m_timers[t] = m_painter->query_timer(static_cast<enum PainterPacker::timer_t>(t));
+        }
+
+      if(frame >= skip_frames)
+        {
+          results.push_back(R);
+        }
+    }
+
+  total.m_time_us = 0;
+  total.m_items = 0;
+  total.m_bytes_packed = 0;
+  total.m_draws = 0;
+  total.m_breaks = 0;
+  total.m_headers = 0;
+  total.m_headers_occluded = 0;
+  total.m_allocations = 0;
+  total.m_timers = vecN<uint64_t, PainterPacker::num_timers>(0);
+  times.reserve(results.size());
+  for(unsigned int i = 0, endi = results.size(); i < endi; ++i)
+    {
+      total.m_time_us += results[i].m_time_us;
+      total.m_items += results[i].m_items;
+      total.m_bytes_packed += results[i].m_bytes_packed;
+      total.m_draws += results[i].m_draws;
+      total.m_breaks += results[i].m_breaks;
+      total.m_headers += results[i].m_headers;
+      total.m_headers_occluded += results[i].m_headers_occluded;
+      total.m_allocations += results[i].m_allocations;
+      max_allocations = std::max(max_allocations, results[i].m_allocations);
+      for(unsigned int t = 0; t < PainterPacker::num_timers; ++t)
+        {
+          total.m_timers[t] += results[i].m_timers[t];
+        }
+      times.push_back(results[i].m_time_us);
+    }
+  std::sort(times.begin(), times.end());
+
+  double seconds(std::max(1e-6, double(total.m_time_us) / 1e6));
+  double frames(results.size());
+
+  std::cout << "\nworkload " << workload_name(w) << ": "
+            << results.size() << " frames, "
+            << double(total.m_items) / frames << " items/frame\n"
+            << std::fixed << std::setprecision(2)
+            << "\titems/s            : " << double(total.m_items) / seconds << "\n"
+            << "\tMB packed/s        : " << double(total.m_bytes_packed) / (seconds * 1024.0 * 1024.0) << "\n"
+            << "\tKB packed/frame    : " << double(total.m_bytes_packed) / (frames * 1024.0) << "\n"
+            << "\tdraws/frame        : " << double(total.m_draws) / frames << "\n"
+            << "\tdraw breaks/frame  : " << double(total.m_breaks) / frames << "\n"
+            << "\theaders/frame      : " << double(total.m_headers) / frames
+            << " (" << double(total.m_headers_occluded) / frames << " occluded)\n"
+            << "\tallocations/frame  : mean = " << double(total.m_allocations) / frames
+            << ", max = " << max_allocations
+            << ", first frame = " << first_frame_allocations << "\n"
+            << "\tframe time (us)    : mean = " << double(total.m_time_us) / frames
+            << ", p50 = " << percentile(times, 0.50f)
+            << ", p90 = " << percentile(times, 0.90f)
+            << ", p99 = " << percentile(times, 0.99f)
+            << ", max = " << times.back() << "\n";
+  for(unsigned int t = 0; t < PainterPacker::num_timers && m_timers.m_value; ++t)
+    {
+      std::cout << "\t" << std::setw(19) << std::left
+                << PainterPacker::timer_name(static_cast<enum PainterPacker::timer_t>(t))
+                << std::right << ": " << double(total.m_timers[t]) / (frames * 1000.0)
+                << " us/frame\n";
+    }
+  if(m_painter->path_prefetcher())
+    {
+      /* let the levels of detail scheduled finish so that
+         they are not made during the next workload
+       */
+      m_painter->path_prefetcher()->wait();
+      std::cout << "\tprefetched levels  : "
+                << m_painter->path_prefetcher()->number_completed() - prefetched_begin << "\n";
+    }
+  m_painter->zoom_velocity(1.0f);
+  std::cout.unsetf(std::ios::floatfield);
+  std::cout << std::setprecision(6) << std::flush;
+}
+
+void
+painter_bench::
+pretessellate_paths(void)
+{
+  int N(m_pretessellate_threads.m_value);
+
+  if(N <= 0 || m_paths.empty())
+    {
+      return;
+    }
+
+  simple_time timer;
+  boost::thread_group threads;
+
+  for(int i = 0; i < N; ++i)
+    {
+      threads.create_thread(pretessellate_worker(&m_paths, i * m_paths.size() / N));
+    }
+  threads.join_all();
+  std::cout << "Pre-tessellated " << m_paths.size() << " paths with "
+            << N << " threads in " << timer.elapsed_us() << " us\n";
+}
+
+void
+painter_bench::
+bench_tessellation(void)
+{
+  if(m_tessellation_contours.m_value <= 0)
+    {
+      return;
+    }
+
+  /* a map-like path: many small contours, each
+     with line, quadratic, cubic and arc edges
+   */
+  Path path;
+  int per_row(std::max(1, int(std::sqrt(float(m_tessellation_contours.m_value)))));
+  for(int i = 0; i < m_tessellation_contours.m_value; ++i)
+    {
+      vec2 p(float(i % per_row) * 16.0f, float(i / per_row) * 16.0f);
+
+      path << p
+           << Path::control_point(p + vec2(5.0f, -4.0f))
+           << p + vec2(10.0f, 0.0f)
+           << Path::control_point(p + vec2(14.0f, 2.0f))
+           << Path::control_point(p + vec2(9.0f, 5.0f))
+           << p + vec2(13.0f, 7.0f)
+           << Path::arc_degrees(90.0f, p + vec2(12.0f, 8.0f))
+           << p + vec2(3.0f, 12.0f)
+           << Path::contour_end_arc(float(M_PI) * 0.25f);
+    }
+
+  TessellatedPath::TessellationParams params;
+  unsigned int threads(std::max(1, m_tessellation_threads.m_value));
+  reference_counted_ptr<const TessellatedPath> serial, parallel;
+  uint64_t serial_us, parallel_us;
+
+  params.curve_distance_tessellate(0.01f).max_segments(64);
+  {
+    simple_time timer;
+    serial = FASTUIDRAWnew TessellatedPath(path, params.max_threads(1));
+    serial_us = timer.elapsed_us();
+  }
+  {
+    simple_time timer;
+    parallel = FASTUIDRAWnew TessellatedPath(path, params.max_threads(threads));
+    parallel_us = timer.elapsed_us();
+  }
+
+  std::cout << "Tessellated " << m_tessellation_contours.m_value << " contours ("
+            << serial->number_points() << " points) in " << serial_us << " us with 1 thread and in "
+            << parallel_us << " us with " << threads << " threads\n";
+}
+
+void
+painter_bench::
+bench_point_memory(void)
+{
+  if(!m_bench_point_memory.m_value || m_paths.empty())
+    {
+      return;
+    }
+
+  /* the levels of detail are those pretessellate_worker makes
+   */
+  const float threshs[] = { -1.0f, 1.0f, 0.25f, 0.0625f };
+  uint64_t number_points(0), full_bytes(0), compact_bytes(0);
+
+  for(unsigned int i = 0, endi = m_paths.size(); i < endi; ++i)
+    {
+      for(unsigned int t = 0; t < sizeof(threshs) / sizeof(threshs[0]); ++t)
+        {
+          TessellatedPath::TessellationParams params;
+          reference_counted_ptr<const TessellatedPath> full, compact;
+
+          if(threshs[t] > 0.0f)
+            {
+              params.curve_distance_tessellate(threshs[t]).max_segments(64);
+            }
+          full = FASTUIDRAWnew TessellatedPath(*m_paths[i], params.compact_point_data(false));
+          compact = FASTUIDRAWnew TessellatedPath(*m_paths[i], params.compact_point_data(true));
+
+          number_points += full->number_points();
+          full_bytes += full->point_data_bytes();
+          compact_bytes += compact->point_data_bytes();
+        }
+    }
+
+  std::cout << "Point memory of " << m_paths.size() << " paths at "
+            << sizeof(threshs) / sizeof(threshs[0]) << " levels of detail ("
+            << number_points << " points):\n"
+            << "\tarray of points: " << full_bytes << " bytes ("
+            << double(full_bytes) / double(std::max(uint64_t(1), number_points)) << " bytes/point)\n"
+            << "\tcompact        : " << compact_bytes << " bytes ("
+            << double(compact_bytes) / double(std::max(uint64_t(1), number_points)) << " bytes/point)\n";
+}
+
+int
+painter_bench::
+main(int argc, char **argv)
+{
+  if(argc == 2 && (std::string(argv[1]) == "-help" || std::string(argv[1]) == "--help"))
+    {
+      std::cout << "Benchmark of the CPU side of Painter against a headless backend\n"
+                << "\n\nUsage: " << argv[0];
+      print_help(std::cout);
+      print_detailed_help(std::cout);
+      return 0;
+    }
+
+  std::cout << "\n\nRunning: \"";
+  for(int i = 0; i < argc; ++i)
+    {
+      std::cout << argv[i] << " ";
+    }
+  parse_command_line(argc, argv);
+  std::cout << "\n\n" << std::flush;
+
+  if(m_run_checks.m_value)
+    {
+      painter_checks checks(ivec2(m_width.m_value, m_height.m_value),
+                            m_tessellation_threads.m_value,
+                            FontFreeType::create(m_font.m_value.c_str()));
+      return checks.run(std::cout) == 0 ? 0 : 1;
+    }
+
+  init_painter();
+  load_paths();
+  pretessellate_paths();
+  bench_tessellation();
+  bench_point_memory();
+  load_dash_pattern();
+  if(m_bench_text.m_value || m_bench_scrolled_text.m_value)
+    {
+      load_text();
+    }
+
+  if(m_sort_by_shader_group.m_value)
+    {
+      /* the draw breaks reported are those the sort leaves */
+      std::cout << "sort_by_shader_group: only items whose blending does not read "
+                << "the framebuffer (i.e. not src-over) are regrouped, and only "
+                << "within each buffer of the frame's recording\n";
+    }
+
+  for(unsigned int w = 0; w < number_workloads; ++w)
+    {
+      if(workload_enabled(static_cast<enum workload_t>(w)))
+        {
+          run_workload(static_cast<enum workload_t>(w));
+        }
+    }
+
+  return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+  painter_bench P;
+  return P.main(argc, argv);
+}
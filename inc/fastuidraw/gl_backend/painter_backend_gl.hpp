@@ -288,6 +288,25 @@ namespace fastuidraw
         ConfigurationGL&
         break_on_shader_change(bool v);
 
+        /*!
+          If true, the indices of a PainterDraw are written to host
+          memory and, when the PainterDraw is unmapped, sent to GL as
+          16-bit indices if the number of attributes written to the
+          PainterDraw is no more than 65536, otherwise as 32-bit
+          indices. Halves the index upload for most PainterDraw
+          objects at the cost of a host copy of the indices and
+          a pass over them on the CPU; only worth enabling when
+          the index upload is the bottleneck. Default value is false.
+         */
+        bool
+        use_16bit_indices(void) const;
+
+        /*!
+          Set the value for use_16bit_indices(void) const
+        */
+        ConfigurationGL&
+        use_16bit_indices(bool v);
+
         /*!
           If true, unpacks the brush and fragment shader specific data
           from the data buffer at the fragment shader. If false, unpacks
@@ -433,6 +452,18 @@ namespace fastuidraw
       reference_counted_ptr<const PainterDraw>
       map_draw(void);
 
+      /*!
+        Uploads the attribute and index data to GL buffer objects
+        (with usage GL_STATIC_DRAW) once; the returned object is
+        PainterStaticAttributeData::backend_resident() and the data
+        is drawn directly from the buffer objects. A GL context in
+        the share group of the PainterBackendGL must be current.
+       */
+      virtual
+      reference_counted_ptr<const PainterStaticAttributeData>
+      create_static_attribute_data(const PainterAttributeData &data,
+                                   const_c_array<unsigned int> attrib_chunk_selector);
+
       /*!
         Return the specified Program use to draw
         with this PainterBackendGL.
@@ -0,0 +1,499 @@
+/*!
+ * \file painter_backend_headless.hpp
+ * \brief file painter_backend_headless.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+#pragma once
+
+#include <iosfwd>
+#include <stdint.h>
+#include <fastuidraw/util/util.hpp>
+#include <fastuidraw/painter/painter_attribute.hpp>
+#include <fastuidraw/glsl/painter_backend_glsl.hpp>
+
+namespace fastuidraw
+{
+  namespace glsl
+  {
+/*!\addtogroup GLSLShaderBuilder
+  @{
+ */
+
+    /*!
+      A PainterBackendHeadless is a PainterBackend that does not
+      use a 3D API. The PainterDraw objects it maps are plain
+      host memory and "drawing" them records (in a log) the amount
+      of data drawn and each draw break; the atlases of a
+      PainterBackendHeadless are backed by stores that only record
+      the uploads made to them. Because it derives from
+      PainterBackendGLSL, the shaders and the shader groups (and
+      thus the draw breaks) are the same as those of a GL backend
+      with the same settings. The purpose of PainterBackendHeadless
+      is to benchmark and test the CPU side of Painter (i.e. Painter,
+      PainterPacker and the creation of path and glyph data) without
+      a GPU.
+     */
+    class PainterBackendHeadless:public PainterBackendGLSL
+    {
+    public:
+      /*!
+        Enumeration naming the backing stores of the
+        atlases of a PainterBackendHeadless.
+       */
+      enum atlas_store_t
+        {
+          /*!
+            GlyphAtlas::texel_store() of glyph_atlas()
+           */
+          glyph_texel_store,
+
+          /*!
+            GlyphAtlas::geometry_store() of glyph_atlas()
+           */
+          glyph_geometry_store,
+
+          /*!
+            ImageAtlas::color_store() of image_atlas()
+           */
+          image_color_store,
+
+          /*!
+            ImageAtlas::index_store() of image_atlas()
+           */
+          image_index_store,
+
+          /*!
+            ColorStopAtlas::backing_store() of colorstop_atlas()
+           */
+          colorstop_store,
+
+          /*!
+            Number of atlas stores
+           */
+          number_atlas_stores
+        };
+
+      /*!
+        Enumeration naming what is recorded for
+        each atlas store.
+       */
+      enum atlas_stat_t
+        {
+          /*!
+            Number of calls to set data on the store
+           */
+          atlas_num_uploads,
+
+          /*!
+            Number of values (texels or generic_data)
+            set on the store
+           */
+          atlas_num_values_uploaded,
+
+          /*!
+            Number of times the store was flushed
+           */
+          atlas_num_flushes,
+
+          /*!
+            Number of times the store was resized
+           */
+          atlas_num_resizes,
+
+          /*!
+            Number of stats
+           */
+          number_atlas_stats
+        };
+
+      /*!
+        A DrawRecord records what a single
+        PainterDraw drew.
+       */
+      class DrawRecord
+      {
+      public:
+        /*!
+          Index of the frame, i.e. the number of calls
+          to on_pre_draw() since the log was cleared,
+          minus one.
+         */
+        unsigned int m_frame;
+
+        /*!
+          Number of attributes drawn
+         */
+        unsigned int m_attributes_written;
+
+        /*!
+          Number of indices drawn
+         */
+        unsigned int m_indices_written;
+
+        /*!
+          Number of generic_data values of the data store
+         */
+        unsigned int m_store_written;
+
+        /*!
+          Range into breaks() of the draw breaks
+          of the PainterDraw
+         */
+        range_type<unsigned int> m_breaks;
+
+        /*!
+          Range into attribute_log() (and header_attribute_log()),
+          index_log() and store_log() of the data of the PainterDraw;
+          the ranges are empty if
+          ConfigurationHeadless::record_draw_data()
+          is false.
+         */
+        range_type<unsigned int> m_attribute_range, m_index_range, m_store_range;
+
+        /*!
+          Dimensions of the Image to which the PainterDraw
+          was drawn (see PainterBackend::begin_draw_to_image()),
+          or (0, 0) if it was drawn to the target surface.
+         */
+        ivec2 m_image_dimensions;
+      };
+
+      /*!
+        A BreakRecord records a single call to
+        PainterDraw::draw_break().
+       */
+      class BreakRecord
+      {
+      public:
+        /*!
+          Number of attributes written when
+          the break was made
+         */
+        unsigned int m_attributes_written;
+
+        /*!
+          Number of indices written when
+          the break was made
+         */
+        unsigned int m_indices_written;
+
+        /*!
+          PainterShaderGroup::item_group() after the break
+         */
+        uint32_t m_item_group;
+
+        /*!
+          PainterShaderGroup::blend_group() after the break
+         */
+        uint32_t m_blend_group;
+
+        /*!
+          PainterShaderGroup::brush() after the break
+         */
+        uint32_t m_brush;
+
+        /*!
+          PainterShaderGroup::packed_blend_mode() after the break
+         */
+        BlendMode::packed_value m_blend_mode;
+      };
+
+      /*!
+        A ConfigurationHeadless gives parameters how
+        to contruct a PainterBackendHeadless.
+       */
+      class ConfigurationHeadless
+      {
+      public:
+        /*!
+          Ctor.
+         */
+        ConfigurationHeadless(void);
+
+        /*!
+          Copy ctor.
+          \param obj value from which to copy
+         */
+        ConfigurationHeadless(const ConfigurationHeadless &obj);
+
+        ~ConfigurationHeadless();
+
+        /*!
+          Assignment operator
+          \param rhs value from which to copy
+         */
+        ConfigurationHeadless&
+        operator=(const ConfigurationHeadless &rhs);
+
+        /*!
+          The number of attributes of each PainterDraw
+         */
+        unsigned int
+        attributes_per_buffer(void) const;
+
+        /*!
+          Set the value returned by attributes_per_buffer(void) const.
+          Default value is 512 * 512.
+         */
+        ConfigurationHeadless&
+        attributes_per_buffer(unsigned int v);
+
+        /*!
+          The number of indices of each PainterDraw
+         */
+        unsigned int
+        indices_per_buffer(void) const;
+
+        /*!
+          Set the value returned by indices_per_buffer(void) const.
+          Default value is 1.5 times the default value of
+          attributes_per_buffer().
+         */
+        ConfigurationHeadless&
+        indices_per_buffer(unsigned int v);
+
+        /*!
+          The number of blocks (each of size
+          PainterBackend::ConfigurationBase::alignment())
+          of the data store of each PainterDraw
+         */
+        unsigned int
+        data_blocks_per_store_buffer(void) const;
+
+        /*!
+          Set the value returned by data_blocks_per_store_buffer(void) const.
+          Default value is 1024 * 64.
+         */
+        ConfigurationHeadless&
+        data_blocks_per_store_buffer(unsigned int v);
+
+        /*!
+          If true, each item and blend shader gets its own
+          group so that a shader change is a draw break;
+          the same as gl::PainterBackendGL::ConfigurationGL::break_on_shader_change().
+         */
+        bool
+        break_on_shader_change(void) const;
+
+        /*!
+          Set the value returned by break_on_shader_change(void) const.
+          Default value is false.
+         */
+        ConfigurationHeadless&
+        break_on_shader_change(bool v);
+
+        /*!
+          If true, item shaders that use discard are placed in a
+          separate group from those that do not; the same as
+          gl::PainterBackendGL::ConfigurationGL::separate_program_for_discard().
+         */
+        bool
+        separate_program_for_discard(void) const;
+
+        /*!
+          Set the value returned by separate_program_for_discard(void) const.
+          Default value is true.
+         */
+        ConfigurationHeadless&
+        separate_program_for_discard(bool v);
+
+        /*!
+          If true, clipping is performed by the (virtual) GPU
+          with hardware clip planes; the same as
+          gl::PainterBackendGL::ConfigurationGL::use_hw_clip_planes().
+          If false, Painter clips convex polygons on the CPU.
+         */
+        bool
+        use_hw_clip_planes(void) const;
+
+        /*!
+          Set the value returned by use_hw_clip_planes(void) const.
+          Default value is true.
+         */
+        ConfigurationHeadless&
+        use_hw_clip_planes(bool v);
+
+        /*!
+          If true, the attributes, indices and data store
+          values drawn are copied into the log (see
+          attribute_log(), index_log() and store_log()).
+         */
+        bool
+        record_draw_data(void) const;
+
+        /*!
+          Set the value returned by record_draw_data(void) const.
+          Default value is false.
+         */
+        ConfigurationHeadless&
+        record_draw_data(bool v);
+
+      private:
+        void *m_d;
+      };
+
+      /*!
+        Ctor.
+        \param config_headless ConfigurationHeadless providing configuration parameters
+        \param config_base ConfigurationBase parameters inherited from PainterBackend
+       */
+      explicit
+      PainterBackendHeadless(const ConfigurationHeadless &config_headless = ConfigurationHeadless(),
+                             const ConfigurationBase &config_base = ConfigurationBase());
+
+      ~PainterBackendHeadless();
+
+      /*!
+        Returns the ConfigurationHeadless passed in the ctor.
+       */
+      const ConfigurationHeadless&
+      configuration_headless(void) const;
+
+      /*!
+        Returns the number of frames recorded, i.e. the
+        number of calls to on_pre_draw() since the log
+        was last cleared.
+       */
+      unsigned int
+      number_frames(void) const;
+
+      /*!
+        Returns the records of the PainterDraw objects
+        drawn since the log was last cleared.
+       */
+      const_c_array<DrawRecord>
+      draws(void) const;
+
+      /*!
+        Returns the records of the draw breaks of the
+        PainterDraw objects drawn since the log was
+        last cleared, see DrawRecord::m_breaks.
+       */
+      const_c_array<BreakRecord>
+      breaks(void) const;
+
+      /*!
+        Returns the attributes drawn, see
+        DrawRecord::m_attribute_range.
+       */
+      const_c_array<PainterAttribute>
+      attribute_log(void) const;
+
+      /*!
+        Returns the header attributes drawn (i.e. the values
+        of PainterDraw::m_header_attributes), see
+        DrawRecord::m_attribute_range. A header attribute
+        is the location, in units of
+        PainterBackend::ConfigurationBase::alignment(), of the
+        PainterHeader of the attribute within the data store
+        values of its PainterDraw.
+       */
+      const_c_array<uint32_t>
+      header_attribute_log(void) const;
+
+      /*!
+        Returns the indices drawn, see
+        DrawRecord::m_index_range.
+       */
+      const_c_array<PainterIndex>
+      index_log(void) const;
+
+      /*!
+        Returns the data store values drawn,
+        see DrawRecord::m_store_range.
+       */
+      const_c_array<generic_data>
+      store_log(void) const;
+
+      /*!
+        Returns a stat of the uploads to an atlas store since
+        the log was last cleared.
+        \param store atlas store to query
+        \param st stat to query
+       */
+      uint64_t
+      query_atlas_stat(enum atlas_store_t store, enum atlas_stat_t st) const;
+
+      /*!
+        Clears the log.
+       */
+      void
+      clear_log(void);
+
+      /*!
+        Writes the log as text to an std::ostream, one record
+        per line. The format is intended to be diffed between
+        runs and to be read by scripts:
+        \code
+        frames N
+        draw frame attributes indices store [image width height]
+        break attributes indices item_group blend_group brush blend_mode
+        attribute v0 v1 ... v11 header
+        index v
+        store v
+        atlas name uploads values flushes resizes
+        \endcode
+        where the draw line ends with the dimensions of the image
+        drawn to if the draw was to an image (see
+        DrawRecord::m_image_dimensions), each draw line is followed
+        by its break lines and,
+        if record_draw_data() is true, by its data lines. The
+        values of the attributes and data store are written as
+        their bit patterns (i.e. as unsigned integers) and
+        each attribute line ends with its header attribute.
+        \param str std::ostream to which to write
+       */
+      void
+      save_log(std::ostream &str) const;
+
+      virtual
+      void
+      on_pre_draw(void);
+
+      virtual
+      void
+      on_post_draw(void);
+
+      virtual
+      reference_counted_ptr<const PainterDraw>
+      map_draw(void);
+
+      virtual
+      void
+      begin_draw_to_image(const reference_counted_ptr<const Image> &image);
+
+      virtual
+      void
+      end_draw_to_image(void);
+
+    protected:
+
+      virtual
+      uint32_t
+      compute_item_shader_group(PainterShader::Tag tag,
+                                const reference_counted_ptr<PainterItemShader> &shader);
+
+      virtual
+      uint32_t
+      compute_blend_shader_group(PainterShader::Tag tag,
+                                 const reference_counted_ptr<PainterBlendShader> &shader);
+
+    private:
+      void *m_d;
+    };
+/*! @} */
+  }
+}
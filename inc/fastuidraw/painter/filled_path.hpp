@@ -39,10 +39,12 @@ class Path;
 /*!
   A FilledPath represents the data needed to draw a path filled.
   It contains -all- the data needed to fill a path regardless of
-  the fill rule.
+  the fill rule. The methods of a FilledPath, including the lazy
+  construction of painter_data(), may be called from several
+  threads at once.
  */
 class FilledPath:
-    public reference_counted<FilledPath>::non_concurrent
+    public reference_counted<FilledPath>::default_base
 {
 public:
   /*!
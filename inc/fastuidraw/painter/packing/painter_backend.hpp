@@ -134,6 +134,45 @@ namespace fastuidraw
       PerformanceHints&
       clipping_via_hw_clip_planes(bool v);
 
+      /*!
+        Returns true if on_pre_draw(), on_post_draw() and the
+        PainterDraw::unmap() and PainterDraw::draw() of the
+        PainterDraw objects returned by map_draw() may be
+        called from a thread other than the one that calls
+        map_draw(), while that thread calls map_draw() and
+        fills other PainterDraw objects. Such an implementation
+        does not flush its atlases in on_pre_draw(); instead
+        PainterPacker flushes them (from the thread that fills
+        the PainterDraw objects) before drawing. See also
+        PainterPacker::pipelined_submission().
+       */
+      bool
+      thread_safe_submission(void) const;
+
+      /*!
+        Set the value returned by
+        thread_safe_submission(void) const,
+        default value is false.
+       */
+      PerformanceHints&
+      thread_safe_submission(bool v);
+
+      /*!
+        Returns true if an implementation of PainterBackend
+        can draw to an Image of its ImageAtlas, see
+        begin_draw_to_image().
+       */
+      bool
+      draw_to_image(void) const;
+
+      /*!
+        Set the value returned by
+        draw_to_image(void) const,
+        default value is false.
+       */
+      PerformanceHints&
+      draw_to_image(bool v);
+
     private:
       void *m_d;
     };
@@ -221,6 +260,51 @@ namespace fastuidraw
     reference_counted_ptr<const PainterDraw>
     map_draw(void) = 0;
 
+    /*!
+      Create a PainterStaticAttributeData from a PainterAttributeData.
+      A backend that can draw attribute and index data that has been
+      uploaded once (instead of copied into each PainterDraw every
+      time it is drawn) overrides this method to upload the data
+      and returns an object whose PainterStaticAttributeData::backend_resident()
+      returns true. The default implementation returns a
+      PainterStaticAttributeData that is not backend resident.
+      Must not be called within a on_pre_draw()/on_post_draw() pair.
+      \param data attribute and index data
+      \param attrib_chunk_selector selects which attribute chunk each index
+                                   chunk uses, see the ctor of PainterStaticAttributeData
+     */
+    virtual
+    reference_counted_ptr<const PainterStaticAttributeData>
+    create_static_attribute_data(const PainterAttributeData &data,
+                                 const_c_array<unsigned int> attrib_chunk_selector);
+
+    /*!
+      To be implemented by a derived class for which
+      PerformanceHints::draw_to_image() is true to direct the
+      PainterDraw objects drawn until end_draw_to_image() to an
+      Image of image_atlas() instead of to the target surface.
+      The contents of the image (and the depth values used for
+      drawing to it) are cleared when drawing to it begins. The
+      clip coordinates (-1, -1) and (1, 1) are the corners of the
+      image at texel (0, 0) and at texel Image::dimensions()
+      respectively. Must not be called within a
+      on_pre_draw()/on_post_draw() pair. The default
+      implementation asserts.
+      \param image Image to which to draw
+     */
+    virtual
+    void
+    begin_draw_to_image(const reference_counted_ptr<const Image> &image);
+
+    /*!
+      End drawing to an Image started with begin_draw_to_image(),
+      the PainterDraw objects drawn afterwards are drawn to the
+      target surface. The default implementation asserts.
+     */
+    virtual
+    void
+    end_draw_to_image(void);
+
     /*!
       Registers a vertex shader for use. Must not be called within a
       on_pre_draw()/on_post_draw() pair.
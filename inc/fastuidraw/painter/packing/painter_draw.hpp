@@ -26,6 +26,7 @@
 #include <fastuidraw/painter/painter_attribute.hpp>
 #include <fastuidraw/painter/painter_shader.hpp>
 #include <fastuidraw/painter/packing/painter_shader_group.hpp>
+#include <fastuidraw/painter/packing/painter_static_attribute_data.hpp>
 
 namespace fastuidraw
 {
@@ -141,6 +142,33 @@ namespace fastuidraw
                unsigned int attributes_written,
                unsigned int indices_written) const = 0;
 
+    /*!
+      Called to add a draw of index data of a PainterStaticAttributeData
+      that is PainterStaticAttributeData::backend_resident(). The draw
+      is to be performed after the indices of m_indices written before
+      the call and before the indices written after the call. The
+      attributes drawn are to use the header found at header_location.
+      Default implementation asserts, a PainterBackend whose
+      PainterBackend::create_static_attribute_data() returns objects
+      that are PainterStaticAttributeData::backend_resident() must
+      implement this method for the PainterDraw objects it creates.
+      \param data PainterStaticAttributeData to draw, the object must
+                  have been created by the same PainterBackend that
+                  created this PainterDraw
+      \param index_ranges ranges into PainterStaticAttributeData::index_data()
+                          of the indices to draw, each range is non-empty
+      \param header_location location of the header within m_store
+      \param attributes_written total number of attributes written to m_attributes -before- the call
+      \param indices_written total number of indices written to m_indices -before- the call
+     */
+    virtual
+    void
+    draw_static(const reference_counted_ptr<const PainterStaticAttributeData> &data,
+                const_c_array<range_type<unsigned int> > index_ranges,
+                uint32_t header_location,
+                unsigned int attributes_written,
+                unsigned int indices_written) const;
+
     /*!
       Adds a delayed action to the action list.
       \param h handle to action to add.
@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include <iosfwd>
+#include <stdint.h>
 #include <fastuidraw/util/reference_counted.hpp>
 #include <fastuidraw/util/vecN.hpp>
 #include <fastuidraw/util/matrix.hpp>
@@ -36,6 +38,7 @@
 #include <fastuidraw/painter/packing/painter_draw.hpp>
 #include <fastuidraw/painter/packing/painter_backend.hpp>
 #include <fastuidraw/painter/packing/painter_packer_data.hpp>
+#include <fastuidraw/painter/packing/painter_recording.hpp>
 
 namespace fastuidraw
 {
@@ -111,12 +114,128 @@ namespace fastuidraw
         */
         num_headers,
 
+        /*!
+          Offset to how many times PainterDraw::draw_break()
+          was called, i.e. how many times the shader group
+          changed. Whether or not a change breaks the draw
+          is up to the PainterBackend.
+         */
+        num_draw_breaks,
+
+        /*!
+          Offset to how many of the calls to PainterDraw::draw_break()
+          had a change in the blend mode.
+         */
+        num_draw_breaks_blend_mode,
+
+        /*!
+          Offset to how many of the calls to PainterDraw::draw_break()
+          had a change in the item shader group (see
+          PainterShader::group()). A PainterBackend that breaks
+          on each shader change assigns a group per shader,
+          so those shader changes are counted here.
+         */
+        num_draw_breaks_item_group,
+
+        /*!
+          Offset to how many of the calls to PainterDraw::draw_break()
+          had a change in the blend shader group.
+         */
+        num_draw_breaks_blend_group,
+
+        /*!
+          Offset to how many of the calls to PainterDraw::draw_break()
+          had a change in the brush shader (masked by
+          PainterBackend::ConfigurationBase::brush_shader_mask()).
+         */
+        num_draw_breaks_brush,
+
+        /*!
+          Offset to how many PainterDraw objects were started
+          because the previous one ran out of room for the
+          attributes, indices or data store values.
+         */
+        num_draws_room_exhausted,
+
+        /*!
+          Offset to how many generic_data values were NOT
+          placed onto store buffer(s) because the value
+          of a PainterPackedValue was already present.
+         */
+        num_generic_datas_reused,
+
+        /*!
+          Offset to how many generic_data values were NOT
+          placed onto store buffer(s) because a value passed
+          by value (i.e. not as a PainterPackedValue) with
+          the same content was already placed on the store
+          buffer of the same PainterDraw.
+         */
+        num_generic_datas_deduplicated,
+
+        /*!
+          Offset to how many painter headers were NOT sent
+          to the PainterBackend because the items that added
+          them are hidden by opaque items drawn after them,
+          see occlusion_culling(bool).
+         */
+        num_headers_occluded,
+
         /*!
           Number of stats.
          */
         num_stats,
       };
 
+    /*!
+      Enumeration to query the timers of the packing;
+      timers are only updated if timers_enabled() is
+      true.
+     */
+    enum timer_t
+      {
+        /*!
+          Offset to the time spent packing the draws,
+          this includes the time to unmap PainterDraw
+          objects that became full while packing.
+          Packing a single item is short, so only about
+          one in every 64 items is timed and its time
+          counts for 64 of them; the value is an estimate.
+         */
+        packing_time,
+
+        /*!
+          Offset to the time spent in unmapping
+          the PainterDraw objects.
+         */
+        unmap_time,
+
+        /*!
+          Offset to the time spent sending the PainterDraw
+          objects to the PainterBackend, i.e. PainterBackend::on_pre_draw(),
+          PainterDraw::draw() and PainterBackend::on_post_draw().
+         */
+        draw_time,
+
+        /*!
+          Offset to the time spent by a Painter to cull
+          and intersect clipping regions and to cull and
+          clip the items it draws (convex polygons, the
+          quads of a batch of rectangles, the edge chunks
+          of a stroke and the chunks of glyphs) against
+          them, see accumulate_timer(). Since each of these
+          tasks is short, a Painter only times about one in
+          every 64 of them and counts that time for 64, so
+          the value is an estimate.
+         */
+        clip_culling_time,
+
+        /*!
+          Number of timers.
+         */
+        num_timers,
+      };
+
     /*!
       Ctor.
       \param backend handle to PainterBackend for the constructed PainterPacker
@@ -182,6 +301,47 @@ namespace fastuidraw
     void
     begin(void);
 
+    /*!
+      Indicate to start recording. Instead of packing to the
+      PainterDraw objects of the PainterBackend, the values are
+      packed to the host memory of the passed PainterRecording;
+      the recording is ended by end(). A PainterPacker that records
+      does not use its PainterBackend beyond reading the values of
+      PainterBackend::configuration_base(), PainterBackend::hints()
+      and the shaders registered to it, thus different PainterPacker
+      objects (sharing the same PainterBackend) can record from
+      different threads simultaneously, as long as no shaders are
+      registered while recording is in progress. Recording clears
+      the previous contents of the PainterRecording.
+      \param recording PainterRecording to which to record
+     */
+    void
+    begin(const reference_counted_ptr<PainterRecording> &recording);
+
+    /*!
+      Start capturing to a PainterRecording within a begin()/end()
+      pair. Until end_capture() is called, the values are packed to
+      the passed PainterRecording instead of the PainterDraw objects
+      of the PainterBackend; content drawn before begin_capture() is
+      not affected. A captured PainterRecording is intended to be
+      drawn with draw_recording(const PainterRecording&, const PainterData::value<PainterItemMatrix>&, const PainterData::value<PainterClipEquations>&, int).
+      Capturing clears the previous contents of the PainterRecording.
+      The values are packed to buffers of the PainterPacker that are
+      reused across captures and copied to the PainterRecording by
+      end_capture(), so a captured PainterRecording only holds the
+      memory of its content (see PainterRecording::shrink()).
+      \param recording PainterRecording to which to capture
+     */
+    void
+    begin_capture(const reference_counted_ptr<PainterRecording> &recording);
+
+    /*!
+      End capturing started with begin_capture(); drawing
+      resumes to the PainterDraw objects of the PainterBackend.
+     */
+    void
+    end_capture(void);
+
     /*!
       Indicate to end drawing. Commands are buffered and not
       set to the backend until end() or flush() is called.
@@ -196,6 +356,108 @@ namespace fastuidraw
     void
     flush(void);
 
+    /*!
+      If true, the items drawn between begin() and end() are first
+      packed to host memory and, when end() is called, the headers
+      of each buffer are reordered so that items that use the same
+      shaders are drawn together before being sent to the PainterBackend.
+      An item is only moved to be drawn earlier if doing so does not
+      change the rendered result: its blending must not read the
+      framebuffer (i.e. the blend mode is non-blending or its
+      destination factors are zero) and its z-value must be
+      larger than that of every item added before it, so that the
+      depth test hides the earlier items wherever the moved
+      item is drawn. In particular, items drawn with the default
+      Porter-Duff src-over blend mode keep their order, even when
+      they do not overlap the items they would be grouped with.
+      The headers are only reordered within each buffer of the
+      recording of the frame, so items in different buffers are
+      never grouped together. Reordering does not affect recordings
+      (see begin(const reference_counted_ptr<PainterRecording>&)).
+      The value can only be changed outside of a begin()/end() pair.
+      Default value is false.
+     */
+    void
+    sort_by_shader_group(bool v);
+
+    /*!
+      Returns the value set by sort_by_shader_group(bool).
+     */
+    bool
+    sort_by_shader_group(void) const;
+
+    /*!
+      If true, the items drawn between begin() and end() are first
+      packed to host memory and, when end() is called, the items
+      that are hidden by opaque items drawn after them are dropped
+      before the data is sent to the PainterBackend. Since the z-value
+      of an item is no smaller than that of the items drawn before it
+      and the depth test passes on equal z-values, an opaque item
+      hides whatever was drawn before it within its region. Only those items for which item_bounds() was called
+      participate: an item is dropped if each cell of a coarse grid
+      over the clip coordinates that its bounds intersect is
+      entirely within an opaque item drawn after it. Occlusion
+      culling does not affect recordings (see begin(const reference_counted_ptr<PainterRecording>&)).
+      The value can only be changed outside of a begin()/end() pair.
+      Default value is false.
+     */
+    void
+    occlusion_culling(bool v);
+
+    /*!
+      Returns the value set by occlusion_culling(bool).
+     */
+    bool
+    occlusion_culling(void) const;
+
+    /*!
+      If true and PainterBackend::PerformanceHints::thread_safe_submission()
+      of the PainterBackend is true, end() returns once the data of the
+      frame is packed; the PainterDraw objects of the frame are unmapped
+      and sent to the PainterBackend by a dedicated thread while the
+      caller packs the next frame. At most one frame is in flight: the
+      submission of a frame is waited upon before the next frame (or a
+      call to flush()) sends its data and by wait_submission(). When the
+      submission is pipelined, the timers unmap_time and draw_time report
+      the submission of the previous frame, added when it is waited upon.
+      The value can only be changed outside of a begin()/end() pair;
+      setting it to false waits for any submission in flight.
+      Default value is false.
+     */
+    void
+    pipelined_submission(bool v);
+
+    /*!
+      Returns the value set by pipelined_submission(bool).
+     */
+    bool
+    pipelined_submission(void) const;
+
+    /*!
+      Blocks until the data of the last frame is sent to the
+      PainterBackend, see pipelined_submission(bool). Does
+      nothing if no frame is in flight.
+     */
+    void
+    wait_submission(void);
+
+    /*!
+      Specify the bounds of the next item drawn with draw_generic();
+      the value only applies to the next call to draw_generic() and
+      is only used if occlusion_culling() is true.
+      \param pmin min-corner, in clip coordinates, of a rectangle
+                  containing every pixel the item may draw
+      \param pmax max-corner, in clip coordinates, of a rectangle
+                  containing every pixel the item may draw
+      \param opaque if true, the item draws every pixel of the
+                    rectangle with full coverage and opacity with a
+                    blend mode that does not read the framebuffer,
+                    i.e. the item hides everything drawn before it
+                    within the rectangle.
+     */
+    void
+    item_bounds(const vec2 &pmin, const vec2 &pmax, bool opaque);
+
     /*!
       Return the default shaders for common drawing types.
      */
@@ -245,6 +507,76 @@ namespace fastuidraw
                  const_c_array<unsigned int> attrib_chunk_selector,
                  unsigned int z,
                  const reference_counted_ptr<DataCallBack> &call_back = reference_counted_ptr<DataCallBack>());
+
+    /*!
+      Draw the index chunks of a PainterStaticAttributeData. If the
+      PainterStaticAttributeData is PainterStaticAttributeData::backend_resident()
+      and this PainterPacker is not recording, then only the painter
+      state and a single header are packed and the attributes and indices
+      are drawn directly from the data uploaded by the PainterBackend
+      (see PainterDraw::draw_static()). Otherwise the attributes referenced
+      by each chunk and the indices of the chunks are copied from the
+      PainterStaticAttributeData as in the other overloads of draw_generic().
+      Note that the PainterPacker records when capturing (see begin_capture())
+      and when sort_by_shader_group() or occlusion_culling() is true.
+      \param shader shader with which to draw data
+      \param data data for how to draw
+      \param static_data attribute and index data to draw, must be created by
+                         PainterBackend::create_static_attribute_data() of
+                         the PainterBackend of this PainterPacker or be
+                         not backend resident
+      \param chunks which index chunks of static_data to draw
+      \param z z-value z value placed into the header
+      \param call_back if non-NULL handle, call back called when attribute data
+                       is added.
+     */
+    void
+    draw_generic(const reference_counted_ptr<PainterItemShader> &shader,
+                 const PainterPackerData &data,
+                 const reference_counted_ptr<const PainterStaticAttributeData> &static_data,
+                 const_c_array<unsigned int> chunks,
+                 unsigned int z,
+                 const reference_counted_ptr<DataCallBack> &call_back = reference_counted_ptr<DataCallBack>());
+
+    /*!
+      Splice the contents of a PainterRecording into the
+      draws of this PainterPacker. The attribute, index
+      and data store values are copied with the indices
+      and locations within the data store relocated; only
+      the z-values of the recorded headers are modified.
+      The PainterRecording must have been recorded by a
+      PainterPacker using the same PainterBackend as this
+      PainterPacker and the recording must have ended.
+      \param recording PainterRecording to splice
+      \param z_adjust amount by which to adjust the z-value
+                      (see PainterHeader::m_z) of each recorded
+                      header
+     */
+    void
+    draw_recording(const PainterRecording &recording, int z_adjust);
+
+    /*!
+      Splice the contents of a PainterRecording into the draws of
+      this PainterPacker replacing the transformation and the clip
+      equations of each recorded header. The transformation of each
+      recorded header becomes the product of the passed transformation
+      with the recorded transformation and the clip equations of each
+      recorded header become the passed clip equations. Only the
+      headers (and the transformations) are re-packed, the recorded
+      attribute, index and data store values are copied.
+      \param recording PainterRecording to splice
+      \param matrix transformation by which to transform the recorded content
+      \param clip clip equations to apply to the recorded content
+      \param z_adjust amount by which to adjust the z-value
+                      (see PainterHeader::m_z) of each recorded
+                      header
+     */
+    void
+    draw_recording(const PainterRecording &recording,
+                   const PainterData::value<PainterItemMatrix> &matrix,
+                   const PainterData::value<PainterClipEquations> &clip,
+                   int z_adjust);
+
     /*!
       Returns a stat on how much data the PainterPacker has
       handled since the last call to begin().
@@ -253,6 +585,78 @@ namespace fastuidraw
     unsigned int
     query_stat(enum stats_t st) const;
 
+    /*!
+      Returns the value of a timer, in nanoseconds, for
+      the time spent since the last call to begin().
+      \param t timer to query
+     */
+    uint64_t
+    query_timer(enum timer_t t) const;
+
+    /*!
+      Adds to the value of a timer; intended for a Painter
+      to report the time spent in tasks that do not happen
+      within the PainterPacker (such as clip culling). Does
+      nothing if timers_enabled() is false.
+      \param t timer to add to
+      \param nanoseconds value to add to the timer
+     */
+    void
+    accumulate_timer(enum timer_t t, uint64_t nanoseconds);
+
+    /*!
+      Set if the timers (see timer_t) are updated.
+      Updating a timer requires reading a clock at the
+      start and end of each timed task (for packing_time
+      and clip_culling_time, of only about one in every
+      64 tasks). Default value is false.
+     */
+    void
+    timers_enabled(bool v);
+
+    /*!
+      Returns the value set by timers_enabled(bool).
+     */
+    bool
+    timers_enabled(void) const;
+
+    /*!
+      Returns, for each item shader, the number of items drawn
+      with it since the last call to begin(); element I of
+      the returned array is the count for the PainterItemShader
+      whose PainterShader::ID() is I. Items of a PainterRecording
+      are counted when they are recorded, not when the recording
+      is drawn with draw_recording(). The array is only valid
+      until the next draw command.
+     */
+    const_c_array<unsigned int>
+    item_shader_stats(void) const;
+
+    /*!
+      Returns a string naming a stat.
+      \param st stat to name
+     */
+    static
+    const char*
+    stat_name(enum stats_t st);
+
+    /*!
+      Returns a string naming a timer.
+      \param t timer to name
+     */
+    static
+    const char*
+    timer_name(enum timer_t t);
+
+    /*!
+      Print all the stats, the timers (if timers_enabled()
+      is true) and the non-zero entries of item_shader_stats()
+      to an std::ostream.
+      \param str std::ostream to which to print
+     */
+    void
+    print_stats(std::ostream &str) const;
+
     /*!
       Returns the PainterBackend::PerformanceHints of the underlying
       PainterBackend of this PainterPacker.
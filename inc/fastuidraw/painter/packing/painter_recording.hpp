@@ -0,0 +1,142 @@
+/*!
+ * \file painter_recording.hpp
+ * \brief file painter_recording.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+#pragma once
+
+#include <fastuidraw/util/reference_counted.hpp>
+
+namespace fastuidraw
+{
+  class PainterPacker;
+
+/*!\addtogroup PainterPacking
+  @{
+ */
+
+  /*!
+    A PainterRecording holds, in host memory, the attribute,
+    index and data store values packed by a PainterPacker
+    that was started with PainterPacker::begin(const reference_counted_ptr<PainterRecording>&).
+    The purpose of a PainterRecording is to allow for the (expensive)
+    packing of items to be performed by threads other than the
+    thread that sends draws to the PainterBackend. Once the recording
+    is ended (by PainterPacker::end()), the recorded streams can be
+    spliced, in order, into the PainterDraw objects of another
+    PainterPacker by PainterPacker::draw_recording(). The splicing
+    amounts to copying the recorded values and relocating the
+    indices and the data store locations of the headers.
+
+    The recorded values include the locations on the atlases of
+    the Image and ColorStopSequenceOnAtlas objects of the brushes
+    and of the glyphs drawn. A PainterRecording holds a reference
+    to each of those Image and ColorStopSequenceOnAtlas objects
+    until it is cleared, but not to the glyphs: the glyphs drawn
+    must stay uploaded to the GlyphAtlas for as long as the
+    recording is spliced (i.e. neither GlyphCache::delete_glyph(),
+    GlyphCache::clear_atlas() nor GlyphCache::clear_cache() is
+    to remove them).
+
+    A PainterRecording is NOT thread safe; only one thread may record
+    to or splice from a PainterRecording at a time. It is the
+    responsibility of the caller to synchronize a recording thread
+    ending a recording with the thread splicing the recording.
+   */
+  class PainterRecording:public reference_counted<PainterRecording>::default_base
+  {
+  public:
+    /*!
+      Ctor. The values passed give the size of the host side buffers
+      used for recording. A chunk of attributes or indices larger
+      than these sizes is recorded to a buffer of its own size.
+      No buffer is made larger than the PainterDraw objects of the
+      PainterBackend of the recording PainterPacker (once it has
+      mapped one), and a recorded buffer larger than the PainterDraw
+      objects of the PainterBackend into which it is spliced is
+      split across several of them; thus the values should be no
+      larger than the sizes of the buffers of the PainterDraw
+      objects of that PainterBackend.
+      \param attributes_per_buffer number of attributes per recorded buffer
+      \param indices_per_buffer number of indices per recorded buffer
+      \param data_blocks_per_store_buffer number of blocks (each block of size
+                                          PainterBackend::ConfigurationBase::alignment())
+                                          of the data store per recorded buffer
+     */
+    explicit
+    PainterRecording(unsigned int attributes_per_buffer = 16 * 1024,
+                     unsigned int indices_per_buffer = 24 * 1024,
+                     unsigned int data_blocks_per_store_buffer = 4 * 1024);
+
+    ~PainterRecording();
+
+    /*!
+      Clears the contents of this PainterRecording. The host
+      memory used for recording is retained for reuse. It is
+      an error to clear a PainterRecording that is being
+      recorded to.
+     */
+    void
+    clear(void);
+
+    /*!
+      Releases the host memory of this PainterRecording that is
+      not used by the recorded content. Intended for recordings
+      that are kept for many frames, such as display lists. It
+      is an error to shrink a PainterRecording that is being
+      recorded to.
+     */
+    void
+    shrink(void);
+
+    /*!
+      Returns true if and only if this PainterRecording
+      has no recorded content.
+     */
+    bool
+    empty(void) const;
+
+    /*!
+      Returns true if a PainterPacker is currently recording
+      to this PainterRecording, i.e. PainterPacker::begin(const reference_counted_ptr<PainterRecording>&)
+      has been called and the matching PainterPacker::end()
+      has not yet been called.
+     */
+    bool
+    recording(void) const;
+
+    /*!
+      Returns the number of buffers recorded, each recorded
+      buffer is spliced into a single PainterDraw.
+     */
+    unsigned int
+    number_buffers(void) const;
+
+    /*!
+      Returns the largest z-value (see PainterHeader::m_z) of
+      all the headers recorded. The value is only valid
+      once the recording has ended.
+     */
+    unsigned int
+    max_z(void) const;
+
+  private:
+    friend class PainterPacker;
+    void *m_d;
+  };
+
+/*! @} */
+}
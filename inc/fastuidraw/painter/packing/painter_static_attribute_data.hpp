@@ -0,0 +1,127 @@
+/*!
+ * \file painter_static_attribute_data.hpp
+ * \brief file painter_static_attribute_data.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+#pragma once
+
+#include <fastuidraw/util/reference_counted.hpp>
+#include <fastuidraw/util/c_array.hpp>
+#include <fastuidraw/util/util.hpp>
+#include <fastuidraw/painter/painter_attribute.hpp>
+#include <fastuidraw/painter/painter_attribute_data.hpp>
+
+namespace fastuidraw
+{
+/*!\addtogroup PainterPacking
+  @{
+ */
+
+  /*!
+    A PainterStaticAttributeData holds the attribute and index
+    data of a PainterAttributeData flattened into a single
+    attribute array and a single index array. The indices
+    are stored already adjusted, i.e. each index is an index
+    into attribute_data(). The purpose of PainterStaticAttributeData
+    is to allow a PainterBackend to upload the attribute and index
+    data once to the 3D API (see PainterBackend::create_static_attribute_data())
+    so that drawing it only requires packing the painter state and
+    a header instead of copying all the attributes and indices each
+    time the data is drawn (see PainterPacker::draw_generic()).
+
+    If a PainterStaticAttributeData is not backend_resident(), or
+    if the PainterPacker is recording (see PainterRecording), then
+    the attributes and indices are copied from attribute_data()
+    and index_data() into the PainterDraw as usual.
+   */
+  class PainterStaticAttributeData:
+    public reference_counted<PainterStaticAttributeData>::default_base
+  {
+  public:
+    /*!
+      Ctor.
+      \param data attribute and index data to flatten
+      \param attrib_chunk_selector if empty, then index data chunk i
+                                   of data is taken to index into
+                                   attribute data chunk i of data;
+                                   otherwise index data chunk i indexes
+                                   into attribute data chunk attrib_chunk_selector[i]
+     */
+    explicit
+    PainterStaticAttributeData(const PainterAttributeData &data,
+                               const_c_array<unsigned int> attrib_chunk_selector = const_c_array<unsigned int>());
+
+    virtual
+    ~PainterStaticAttributeData();
+
+    /*!
+      Returns all attribute data chunks of the PainterAttributeData
+      from which this was constructed, concatenated.
+     */
+    const_c_array<PainterAttribute>
+    attribute_data(void) const;
+
+    /*!
+      Returns all index data chunks of the PainterAttributeData
+      from which this was constructed, concatenated. The index
+      values are indices into attribute_data().
+     */
+    const_c_array<PainterIndex>
+    index_data(void) const;
+
+    /*!
+      Returns the number of index chunks, this is the same
+      value as PainterAttributeData::index_data_chunks().size()
+      of the PainterAttributeData from which this was constructed.
+     */
+    unsigned int
+    number_index_data_chunks(void) const;
+
+    /*!
+      Returns the range into index_data() of the named index
+      chunk. If the index is larger than number_index_data_chunks(),
+      returns an empty range.
+      \param i index of chunk
+     */
+    range_type<unsigned int>
+    index_data_chunk(unsigned int i) const;
+
+    /*!
+      Returns the range into attribute_data() of the attributes
+      referenced by the named index chunk. If the index is larger
+      than number_index_data_chunks(), returns an empty range.
+      \param i index of chunk
+     */
+    range_type<unsigned int>
+    attribute_data_chunk(unsigned int i) const;
+
+    /*!
+      Returns true if the attribute and index data have been
+      uploaded to the 3D API by a PainterBackend. If true,
+      the PainterDraw objects of the PainterBackend that
+      created this PainterStaticAttributeData implement
+      PainterDraw::draw_static(). Default implementation
+      returns false.
+     */
+    virtual
+    bool
+    backend_resident(void) const;
+
+  private:
+    void *m_d;
+  };
+/*! @} */
+}
@@ -20,9 +20,11 @@
 #pragma once
 
 #include <fastuidraw/path.hpp>
+#include <fastuidraw/path_prefetcher.hpp>
 #include <fastuidraw/tessellated_path.hpp>
 #include <fastuidraw/painter/stroked_path.hpp>
 #include <fastuidraw/painter/filled_path.hpp>
+#include <fastuidraw/painter/painter_glyph_chunks.hpp>
 #include <fastuidraw/painter/painter_brush.hpp>
 #include <fastuidraw/painter/painter_stroke_params.hpp>
 #include <fastuidraw/painter/painter_dashed_stroke_params.hpp>
@@ -222,6 +224,98 @@ namespace fastuidraw
     void
     target_resolution(int w, int h);
 
+    /*!
+      Set if the items drawn between begin() and end() are
+      reordered to draw items with the same shaders together
+      when doing so does not change the rendered result, see
+      PainterPacker::sort_by_shader_group(bool). Only items
+      whose blending does not read the framebuffer are moved,
+      so items drawn with src-over blending keep their order.
+      May only be called outside of a begin()/end() pair.
+      Default value is false.
+     */
+    void
+    sort_by_shader_group(bool v);
+
+    /*!
+      Returns the value set by sort_by_shader_group(bool).
+     */
+    bool
+    sort_by_shader_group(void) const;
+
+    /*!
+      Set if the items drawn between begin() and end() that are
+      hidden by opaque items drawn after them are dropped before
+      being sent to the PainterBackend, see PainterPacker::occlusion_culling(bool).
+      The Painter gives the bounds of the convex polygons it draws
+      (draw_convex_polygon(), draw_quad() and draw_rect()), of each
+      batch of draw_rects() and draw_quads(), of the glyphs drawn
+      from a PainterGlyphChunks and, from Path::approximate_bounding_box(),
+      of the paths it fills and strokes (except strokes with miter
+      joins). Only a convex polygon can hide other items; it does
+      so if it is an axis aligned rectangle (after the current
+      transformation) drawn with the default fill shader, a brush
+      with only an opaque pen color, the blend mode
+      PainterEnums::blend_porter_duff_src_over or
+      PainterEnums::blend_porter_duff_src and no clipping by an
+      occluder (clipOutPath() or a clipInRect() that is not axis
+      aligned) active; the occluders of the gaps between the dirty
+      rects of begin(const_c_array<vec2>, const_c_array<vec2>, bool)
+      do not count since they clip every item of the frame. May only
+      be called outside of a begin()/end() pair. Default value is false.
+     */
+    void
+    occlusion_culling(bool v);
+
+    /*!
+      Returns the value set by occlusion_culling(bool).
+     */
+    bool
+    occlusion_culling(void) const;
+
+    /*!
+      Set if the data of a frame is sent to the PainterBackend by
+      a dedicated thread while the next frame is drawn, see
+      PainterPacker::pipelined_submission(bool). May only be called
+      outside of a begin()/end() pair. Default value is false.
+     */
+    void
+    pipelined_submission(bool v);
+
+    /*!
+      Returns the value set by pipelined_submission(bool).
+     */
+    bool
+    pipelined_submission(void) const;
+
+    /*!
+      Blocks until the data of the last frame is sent to the
+      PainterBackend, see PainterPacker::wait_submission().
+     */
+    void
+    wait_submission(void);
+
+    /*!
+      Set if the PainterPackedValue objects that the Painter
+      makes between begin() and end() (for example for
+      the transformation and clipping state) are made from
+      an arena of packed_value_pool(), see
+      PainterPackedValuePool::begin_arena(). If true, begin()
+      begins an arena and end() ends it; in that case
+      the PainterPackedValue objects created from packed_value_pool()
+      (including those returned by transformation_state()) between
+      begin() and end() must not be used after end(). May only be
+      called outside of a begin()/end() pair. Default value is false.
+     */
+    void
+    packed_value_arena(bool v);
+
+    /*!
+      Returns the value set by packed_value_arena(bool).
+     */
+    bool
+    packed_value_arena(void) const;
+
     /*!
       Indicate to start drawing with methods of this Painter.
       Drawing commands sent to 3D hardware are buffered and not
@@ -231,6 +325,45 @@ namespace fastuidraw
     void
     begin(bool reset_z = true);
 
+    /*!
+      Indicate to start drawing a frame of which only the
+      content within a set of dirty rectangles is to change.
+      The frame is clipped to the bounding box of the dirty
+      rectangles, items whose bounds do not intersect any of
+      the dirty rectangles are culled on the CPU and, if there
+      is more than one dirty rectangle, the region between them
+      within their bounding box is occluded so that content
+      outside of the dirty rectangles is left unchanged. The
+      caller should also restrict the backend (for example with
+      a scissor test) to the bounding box of the dirty
+      rectangles when the frame is sent to the 3D API. The
+      rectangles are in pixels where (0, 0) is the corner of
+      clip coordinate (-1, -1) and target_resolution() is the
+      corner of clip coordinate (1, 1). If there are no dirty
+      rectangles, the result is the same as begin(reset_z).
+      \param dirty_pmin min-corner of each dirty rectangle
+      \param dirty_wh width and height of each dirty rectangle
+      \param reset_z if true, reset the z-value as in begin(bool)
+     */
+    void
+    begin(const_c_array<vec2> dirty_pmin, const_c_array<vec2> dirty_wh,
+          bool reset_z = true);
+
+    /*!
+      Indicate to start recording with methods of this Painter
+      to a PainterRecording, see PainterPacker::begin(const reference_counted_ptr<PainterRecording>&).
+      The recording is ended by end(). Recording always starts
+      with current_z() as 1. Different Painter objects (created
+      from the same PainterBackend) may record from different
+      threads simultaneously; the Painter objects themselves
+      must be created (and target_resolution() set) from the
+      thread that uses the PainterBackend. The recorded content
+      is later added with draw_recording() of another Painter.
+      \param recording PainterRecording to which to record
+     */
+    void
+    begin(const reference_counted_ptr<PainterRecording> &recording);
+
     /*!
       Indicate to end drawing with methods of this Painter.
       Drawing commands sent to 3D hardware are buffered and not
@@ -240,6 +373,14 @@ namespace fastuidraw
     void
     end(void);
 
+    /*!
+      Equivalent to calling end(void) and then printing
+      the stats of the frame, see PainterPacker::print_stats().
+      \param stats std::ostream to which to print the stats
+     */
+    void
+    end(std::ostream &stats);
+
     /*!
       Concats the current transformation matrix
       by a given matrix.
@@ -388,6 +529,59 @@ namespace fastuidraw
     float
     curveFlatness(void);
 
+    /*!
+      Set the PathPrefetcher by which this Painter makes the levels
+      of detail of a Path it fills or strokes (when passing to drawing
+      methods a Path object). If non-NULL, the Painter does not wait
+      for a level of detail that is not yet made: it schedules it on
+      the PathPrefetcher and draws the finest level of detail of the
+      Path that is already made, see Path::tessellation_if_ready().
+      Only the very first level of detail of a Path is made by the
+      Painter itself. The Path objects drawn must then stay unchanged
+      while the PathPrefetcher works on them, see PathPrefetcher.
+      Default value is NULL.
+     */
+    void
+    path_prefetcher(const reference_counted_ptr<PathPrefetcher> &p);
+
+    /*!
+      Returns the value set by path_prefetcher(const reference_counted_ptr<PathPrefetcher>&).
+     */
+    const reference_counted_ptr<PathPrefetcher>&
+    path_prefetcher(void) const;
+
+    /*!
+      Set the zoom velocity, i.e. the factor by which the scale of
+      the transformation grows from one frame to the next. If greater
+      than one and path_prefetcher() is non-NULL, then when drawing a
+      Path the Painter also schedules on path_prefetcher() the finer
+      level of detail the Path will need after path_prefetch_frames()
+      frames at that velocity, but no more than two levels of detail
+      finer than what it needs now. Default value is 1.0.
+     */
+    void
+    zoom_velocity(float v);
+
+    /*!
+      Returns the value set by zoom_velocity(float).
+     */
+    float
+    zoom_velocity(void) const;
+
+    /*!
+      Set the number of frames ahead for which to schedule levels
+      of detail of a Path, see zoom_velocity(float). Default value
+      is 8.
+     */
+    void
+    path_prefetch_frames(unsigned int v);
+
+    /*!
+      Returns the value set by path_prefetch_frames(unsigned int).
+     */
+    unsigned int
+    path_prefetch_frames(void) const;
+
     /*!
       Save the current state of this Painter onto the save state stack.
       The state is restored (and the stack popped) by called restore().
@@ -441,6 +635,37 @@ namespace fastuidraw
                 const PainterAttributeData &data, bool use_anistopic_antialias = false,
                 const reference_counted_ptr<PainterPacker::DataCallBack> &call_back = reference_counted_ptr<PainterPacker::DataCallBack>());
 
+    /*!
+      Draw glyphs, only drawing those chunks of the glyphs
+      (see PainterGlyphChunks::chunks()) that intersect
+      the current clipping region.
+      \param shader with which to draw the glyphs
+      \param draw data for how to draw
+      \param data glyphs to draw
+      \param call_back if non-NULL handle, call back called when attribute data
+                       is added.
+     */
+    void
+    draw_glyphs(const PainterGlyphShader &shader, const PainterData &draw,
+                const PainterGlyphChunks &data,
+                const reference_counted_ptr<PainterPacker::DataCallBack> &call_back = reference_counted_ptr<PainterPacker::DataCallBack>());
+
+    /*!
+      Draw glyphs, only drawing those chunks of the glyphs
+      (see PainterGlyphChunks::chunks()) that intersect
+      the current clipping region.
+      \param draw data for how to draw
+      \param data glyphs to draw
+      \param use_anistopic_antialias if true, use default_shaders().glyph_shader_anisotropic()
+                                     otherwise use default_shaders().glyph_shader()
+      \param call_back if non-NULL handle, call back called when attribute data
+                       is added.
+     */
+    void
+    draw_glyphs(const PainterData &draw,
+                const PainterGlyphChunks &data, bool use_anistopic_antialias = false,
+                const reference_counted_ptr<PainterPacker::DataCallBack> &call_back = reference_counted_ptr<PainterPacker::DataCallBack>());
+
     /*!
       Stroke a path.
       \param shader shader with which to stroke the attribute data
@@ -667,6 +892,23 @@ namespace fastuidraw
               const PainterAttributeData &data, enum PainterEnums::fill_rule_t fill_rule,
               const reference_counted_ptr<PainterPacker::DataCallBack> &call_back = reference_counted_ptr<PainterPacker::DataCallBack>());
 
+    /*!
+      Fill a path whose attribute and index data has been made
+      static by create_static_attribute_data(const PainterFillShader&, const PainterAttributeData&).
+      \param shader shader with which to fill the attribute data, must be
+                    the same shader passed to create_static_attribute_data()
+      \param draw data for how to draw
+      \param data static attribute and index data with which to fill a path
+      \param fill_rule fill rule with which to fill the path
+      \param call_back if non-NULL handle, call back called when attribute data
+                       is added.
+     */
+    void
+    fill_path(const PainterFillShader &shader, const PainterData &draw,
+              const reference_counted_ptr<const PainterStaticAttributeData> &data,
+              enum PainterEnums::fill_rule_t fill_rule,
+              const reference_counted_ptr<PainterPacker::DataCallBack> &call_back = reference_counted_ptr<PainterPacker::DataCallBack>());
+
     /*!
       Fill a path.
       \param shader shader with which to fill the attribute data
@@ -823,6 +1065,259 @@ namespace fastuidraw
     draw_rect(const PainterData &draw, const vec2 &p, const vec2 &wh,
               const reference_counted_ptr<PainterPacker::DataCallBack> &call_back = reference_counted_ptr<PainterPacker::DataCallBack>());
 
+    /*!
+      Draw a set of quads using a custom shader. The quads are
+      packed as a single item (i.e. they share the same header
+      and z-value), drawn in the order given. Each quad is tested
+      against the current clipping and quads outside of it are
+      not packed. The result is the same as calling draw_quad()
+      for each quad, but with far less overhead per quad.
+      \param draw data for how to draw
+      \param pts points of the quads, the i'th quad is given by
+                 pts[4 * i], pts[4 * i + 1], pts[4 * i + 2] and
+                 pts[4 * i + 3] in the same order as for draw_quad();
+                 the size of pts must be a multiple of 4.
+      \param shader shader with which to draw the quads. The shader must
+                    accept the exact same format as packed by
+                    PainterAttributeDataFillerPathFill
+      \param call_back if non-NULL handle, call back called when attribute data
+                       is added.
+     */
+    void
+    draw_quads(const reference_counted_ptr<PainterItemShader> &shader, const PainterData &draw,
+               const_c_array<vec2> pts,
+               const reference_counted_ptr<PainterPacker::DataCallBack> &call_back = reference_counted_ptr<PainterPacker::DataCallBack>());
+
+    /*!
+      Draw a set of quads using the default fill shader,
+      see draw_quads(const reference_counted_ptr<PainterItemShader>&, const PainterData&, const_c_array<vec2>, const reference_counted_ptr<PainterPacker::DataCallBack>&).
+      \param draw data for how to draw
+      \param pts points of the quads, the size of pts must be a multiple of 4.
+      \param call_back if non-NULL handle, call back called when attribute data
+                       is added.
+     */
+    void
+    draw_quads(const PainterData &draw, const_c_array<vec2> pts,
+               const reference_counted_ptr<PainterPacker::DataCallBack> &call_back = reference_counted_ptr<PainterPacker::DataCallBack>());
+
+    /*!
+      Draw a set of rects using a custom shader. The rects are
+      packed as a single item (i.e. they share the same header
+      and z-value), drawn in the order given. Each rect is tested
+      against the current clipping and rects outside of it are
+      not packed. The result is the same as calling draw_rect()
+      for each rect, but with far less overhead per rect.
+      \param draw data for how to draw
+      \param p min-corners of the rects
+      \param wh width and height of the rects, either of the same size
+                as p or of size one to give all rects the same size
+      \param shader shader with which to draw the rects. The shader must
+                    accept the exact same format as packed by
+                    PainterAttributeDataFillerPathFill
+      \param call_back if non-NULL handle, call back called when attribute data
+                       is added.
+     */
+    void
+    draw_rects(const reference_counted_ptr<PainterItemShader> &shader, const PainterData &draw,
+               const_c_array<vec2> p, const_c_array<vec2> wh,
+               const reference_counted_ptr<PainterPacker::DataCallBack> &call_back = reference_counted_ptr<PainterPacker::DataCallBack>());
+
+    /*!
+      Draw a set of rects using the default fill shader,
+      see draw_rects(const reference_counted_ptr<PainterItemShader>&, const PainterData&, const_c_array<vec2>, const_c_array<vec2>, const reference_counted_ptr<PainterPacker::DataCallBack>&).
+      \param draw data for how to draw
+      \param p min-corners of the rects
+      \param wh width and height of the rects, either of the same size
+                as p or of size one to give all rects the same size
+      \param call_back if non-NULL handle, call back called when attribute data
+                       is added.
+     */
+    void
+    draw_rects(const PainterData &draw, const_c_array<vec2> p, const_c_array<vec2> wh,
+               const reference_counted_ptr<PainterPacker::DataCallBack> &call_back = reference_counted_ptr<PainterPacker::DataCallBack>());
+
+    /*!
+      Draw a set of rects using a custom shader where each rect
+      selects how it is drawn (for example its brush) from an
+      array of PainterData values. Each run of consecutive rects
+      with the same selection is packed as a single item, thus
+      the rects should be ordered so that the runs are long.
+      \param draws values for how to draw
+      \param draw_selector the i'th rect is drawn with draws[draw_selector[i]],
+                           must be of the same size as p
+      \param p min-corners of the rects
+      \param wh width and height of the rects, either of the same size
+                as p or of size one to give all rects the same size
+      \param shader shader with which to draw the rects. The shader must
+                    accept the exact same format as packed by
+                    PainterAttributeDataFillerPathFill
+      \param call_back if non-NULL handle, call back called when attribute data
+                       is added.
+     */
+    void
+    draw_rects(const reference_counted_ptr<PainterItemShader> &shader,
+               const_c_array<PainterData> draws, const_c_array<unsigned int> draw_selector,
+               const_c_array<vec2> p, const_c_array<vec2> wh,
+               const reference_counted_ptr<PainterPacker::DataCallBack> &call_back = reference_counted_ptr<PainterPacker::DataCallBack>());
+
+    /*!
+      Draw a set of rects using the default fill shader where each
+      rect selects how it is drawn from an array of PainterData values,
+      see draw_rects(const reference_counted_ptr<PainterItemShader>&, const_c_array<PainterData>, const_c_array<unsigned int>, const_c_array<vec2>, const_c_array<vec2>, const reference_counted_ptr<PainterPacker::DataCallBack>&).
+      \param draws values for how to draw
+      \param draw_selector the i'th rect is drawn with draws[draw_selector[i]],
+                           must be of the same size as p
+      \param p min-corners of the rects
+      \param wh width and height of the rects, either of the same size
+                as p or of size one to give all rects the same size
+      \param call_back if non-NULL handle, call back called when attribute data
+                       is added.
+     */
+    void
+    draw_rects(const_c_array<PainterData> draws, const_c_array<unsigned int> draw_selector,
+               const_c_array<vec2> p, const_c_array<vec2> wh,
+               const reference_counted_ptr<PainterPacker::DataCallBack> &call_back = reference_counted_ptr<PainterPacker::DataCallBack>());
+
+    /*!
+      Draw the contents of a PainterRecording. The recorded content
+      is drawn with the transformation and clipping of the Painter
+      that recorded it, its z-values are placed above all content
+      drawn before and current_z() is incremented so that content
+      drawn afterwards is above the recorded content. The recording
+      must have ended.
+      \param recording PainterRecording to draw
+     */
+    void
+    draw_recording(const PainterRecording &recording);
+
+    /*!
+      Start capturing a display list; must be called within a
+      begin()/end() pair. Until end_display_list() is called, the
+      drawing commands are captured to the passed PainterRecording
+      instead of being drawn. While capturing:
+       - the transformation starts as the identity and content
+         is not clipped or culled, the transformation and clipping
+         are given when the display list is drawn with
+         draw_display_list(),
+       - each save() must be matched by a restore(),
+       - clipInRect() and clipInPath() are not supported.
+      The display list keeps the Image and color stops of each
+      brush used alive, but not the glyphs drawn: the glyphs
+      must remain on the GlyphAtlas for as long as the display
+      list is drawn (see PainterRecording).
+      \param display_list PainterRecording to which to capture
+     */
+    void
+    begin_display_list(const reference_counted_ptr<PainterRecording> &display_list);
+
+    /*!
+      End capturing a display list started by begin_display_list();
+      the state of this Painter is restored to what it was at
+      begin_display_list().
+     */
+    void
+    end_display_list(void);
+
+    /*!
+      Draw a display list captured with begin_display_list() /
+      end_display_list() with the current transformation and
+      clipping. Only the headers of the captured items (and
+      their transformations) are re-packed, the captured
+      attribute, index and data store values are copied as-is.
+      \param display_list PainterRecording to draw
+     */
+    void
+    draw_display_list(const PainterRecording &display_list);
+
+    /*!
+      Draw an item cached by a previous frame. An item is cached
+      with begin_cached_item() / end_cached_item(); a cached item
+      is kept as long as it is drawn every frame and is released
+      by end() otherwise. If the cache holds an item for the
+      key whose state hash matches the passed state hash,
+      the item is drawn, as in draw_display_list(), with the
+      current transformation and clipping and true is returned.
+      Otherwise nothing is drawn and false is returned, the
+      caller is then expected to draw the item between
+      begin_cached_item() and end_cached_item().
+      \param key key of the item, the key must be stable across frames
+      \param state_hash hash of everything (other than the transformation
+                        and clipping) that affects the drawing of the item
+     */
+    bool
+    draw_cached_item(uint64_t key, uint64_t state_hash);
+
+    /*!
+      Begin capturing an item to the cache of items, the drawing
+      commands until end_cached_item() are captured as if by
+      begin_display_list(). Capturing of cached items cannot
+      be nested. As for a display list, the glyphs drawn must
+      remain on the GlyphAtlas for as long as the item is kept
+      in the cache; after GlyphCache::clear_atlas(), pass a new
+      state_hash so that the items with text are captured again.
+      \param key key of the item, the key must be stable across frames
+      \param state_hash hash of everything (other than the transformation
+                        and clipping) that affects the drawing of the item
+     */
+    void
+    begin_cached_item(uint64_t key, uint64_t state_hash);
+
+    /*!
+      End capturing an item started by begin_cached_item()
+      and draw it with the current transformation and clipping.
+     */
+    void
+    end_cached_item(void);
+
+    /*!
+      Begin a layer; until the matching end_layer(), the content
+      drawn is drawn to an offscreen Image (on the ImageAtlas of
+      the PainterBackend) instead of to the target surface. The
+      call to end_layer() then draws that Image, as a single
+      textured rectangle, with the current clipping and blend
+      shader and with its alpha modulated by an opacity; thus
+      the content of a layer is blended as a group. The layer
+      covers the pixel aligned bounding box, clamped to the
+      target surface, of the rectangle [pmin, pmin + wh] under
+      the current transformation; content outside of it is lost.
+      If key is non-zero, the Image of the layer is kept for the
+      next frame: if the layer drawn by the previous frame with
+      the same key is to be drawn again with contents_unchanged
+      true and the transformation differs from that of the previous
+      frame by at most a translation, the kept Image is drawn
+      again, begin_layer() returns false and the caller is expected
+      to skip drawing the content of the layer before calling
+      end_layer(). A kept layer that is not drawn in a frame is
+      released by end(). While drawing the content of a layer the
+      restrictions of begin_display_list() apply and layers cannot
+      be nested. If PainterBackend::PerformanceHints::draw_to_image()
+      is false (as is the case for the GL backend) or the ImageAtlas
+      has no room for the layer, the content of a layer is drawn
+      directly to the target surface, the opacity is ignored (a
+      warning is printed to std::cerr the first time this happens
+      with an opacity less than 1) and begin_layer() returns true
+      unless the layer is clipped away.
+      \param pmin min-corner of the rectangle of the layer
+      \param wh width and height of the rectangle of the layer
+      \param opacity opacity with which to draw the layer
+      \param key if non-zero, key of the layer, the key must be
+                 stable across frames
+      \param contents_unchanged if true, the content of the layer
+                                is the same as that of the previous
+                                frame for the layer of the same key
+      
+eturns true if the caller is to draw the content of the layer
+     */
+    bool
+    begin_layer(const vec2 &pmin, const vec2 &wh, float opacity,
+                uint64_t key = 0, bool contents_unchanged = false);
+
+    /*!
+      End a layer started by begin_layer() and draw it.
+     */
+    void
+    end_layer(void);
+
     /*!
       Draw generic attribute data.
       \param draw data for how to draw
@@ -882,6 +1377,53 @@ namespace fastuidraw
                  const_c_array<unsigned int> attrib_chunk_selector,
                  const reference_counted_ptr<PainterPacker::DataCallBack> &call_back = reference_counted_ptr<PainterPacker::DataCallBack>());
 
+    /*!
+      Draw index chunks of static attribute data. If the PainterBackend
+      of this Painter uploaded the data (see PainterBackend::create_static_attribute_data()),
+      then the attributes and indices are not copied, only the state of
+      the draw is packed. The data is still copied if the draw is
+      recorded, i.e. when drawing to a PainterRecording, a display
+      list, a cached item or a layer, or when sort_by_shader_group()
+      or occlusion_culling() is true.
+      \param shader shader with which to draw data
+      \param draw data for how to draw
+      \param data static attribute and index data, created by
+                  create_static_attribute_data() of this Painter
+      \param chunks which index chunks of data to draw
+      \param call_back if non-NULL handle, call back called when attribute data
+                       is added.
+     */
+    void
+    draw_generic(const reference_counted_ptr<PainterItemShader> &shader,
+                 const PainterData &draw,
+                 const reference_counted_ptr<const PainterStaticAttributeData> &data,
+                 const_c_array<unsigned int> chunks,
+                 const reference_counted_ptr<PainterPacker::DataCallBack> &call_back = reference_counted_ptr<PainterPacker::DataCallBack>());
+
+    /*!
+      Create static attribute and index data from a PainterAttributeData
+      via PainterBackend::create_static_attribute_data(). The returned
+      object is intended to be created once for data that does not
+      change and then drawn many times with draw_generic().
+      \param data attribute and index data
+      \param attrib_chunk_selector selects which attribute chunk each index
+                                   chunk uses, see the ctor of PainterStaticAttributeData
+     */
+    reference_counted_ptr<const PainterStaticAttributeData>
+    create_static_attribute_data(const PainterAttributeData &data,
+                                 const_c_array<unsigned int> attrib_chunk_selector = const_c_array<unsigned int>());
+
+    /*!
+      Create static attribute and index data from the PainterAttributeData
+      of a path fill (for example FilledPath::painter_data()) for use by
+      fill_path(const PainterFillShader&, const PainterData&, const reference_counted_ptr<const PainterStaticAttributeData>&, enum PainterEnums::fill_rule_t, const reference_counted_ptr<PainterPacker::DataCallBack>&).
+      \param shader shader with which the data will be filled
+      \param data attribute and index data of a path fill
+     */
+    reference_counted_ptr<const PainterStaticAttributeData>
+    create_static_attribute_data(const PainterFillShader &shader,
+                                 const PainterAttributeData &data);
+
     /*!
       Returns a stat on how much data the Packer has
       handled since the last call to begin().
@@ -890,6 +1432,37 @@ namespace fastuidraw
     unsigned int
     query_stat(enum PainterPacker::stats_t st) const;
 
+    /*!
+      Returns the value of a timer, in nanoseconds, of the
+      time spent since the last call to begin(), see
+      PainterPacker::query_timer().
+      \param t timer to query
+     */
+    uint64_t
+    query_timer(enum PainterPacker::timer_t t) const;
+
+    /*!
+      Set if the timers are updated, see
+      PainterPacker::timers_enabled(bool).
+      Default value is false.
+     */
+    void
+    timers_enabled(bool v);
+
+    /*!
+      Returns the value set by timers_enabled(bool).
+     */
+    bool
+    timers_enabled(void) const;
+
+    /*!
+      Returns the number of items drawn per item
+      shader since the last call to begin(), see
+      PainterPacker::item_shader_stats().
+     */
+    const_c_array<unsigned int>
+    item_shader_stats(void) const;
+
     /*!
       Return the z-depth value that the next item will have.
      */
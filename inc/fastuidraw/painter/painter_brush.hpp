@@ -760,6 +760,15 @@ namespace fastuidraw
     PainterBrush&
     operator=(const PainterBrush &rhs);
 
+    /*!
+      Returns the value of the pen color.
+     */
+    const vec4&
+    pen(void) const
+    {
+      return m_data.m_pen;
+    }
+
     /*!
       Returns the value of the handle to the
       Image that the brush is set to use.
@@ -0,0 +1,182 @@
+/*!
+ * \file painter_glyph_chunks.hpp
+ * \brief file painter_glyph_chunks.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#pragma once
+
+#include <fastuidraw/util/util.hpp>
+#include <fastuidraw/util/vecN.hpp>
+#include <fastuidraw/util/matrix.hpp>
+#include <fastuidraw/util/c_array.hpp>
+#include <fastuidraw/text/glyph_render_data.hpp>
+#include <fastuidraw/painter/painter_attribute_data.hpp>
+#include <fastuidraw/painter/painter_attribute_data_filler_glyphs.hpp>
+
+namespace fastuidraw
+{
+/*!\addtogroup Painter
+  @{
+ */
+
+  /*!
+    A PainterGlyphChunks holds the attribute and index data to
+    draw glyphs (as filled by a PainterAttributeDataFillerGlyphs)
+    together with a hierarchy of bounding boxes so that only
+    those portions of the glyphs that are within the clipping
+    region need to be drawn. The glyphs of each glyph type are
+    split, in the order in which they were given to the
+    PainterAttributeDataFillerGlyphs, into blocks of at most
+    max_glyphs_per_chunk() glyphs; the blocks are then organized
+    into a binary tree where each node of the tree is a chunk
+    that holds the glyphs of its blocks. Since text is typically
+    given in reading order, the glyphs of a block are near each
+    other, which makes the culling effective for large blocks
+    of text of which only a small portion is visible.
+   */
+  class PainterGlyphChunks:noncopyable
+  {
+  public:
+    /*!
+      Opaque object to hold work room needed for functions
+      of PainterGlyphChunks that require scratch space.
+     */
+    class ScratchSpace:noncopyable
+    {
+    public:
+      ScratchSpace(void);
+      ~ScratchSpace();
+    private:
+      friend class PainterGlyphChunks;
+      void *m_d;
+    };
+
+    /*!
+      Ctor.
+      \param filler PainterAttributeDataFillerGlyphs used to
+                    fill the data of the PainterGlyphChunks;
+                    the arrays passed to the ctor of filler
+                    need only stay in scope for the duration of
+                    the ctor of PainterGlyphChunks.
+      \param max_glyphs_per_chunk maximum number of glyphs
+                                  in a leaf chunk
+     */
+    explicit
+    PainterGlyphChunks(const PainterAttributeDataFillerGlyphs &filler,
+                       unsigned int max_glyphs_per_chunk = 64);
+
+    ~PainterGlyphChunks();
+
+    /*!
+      Returns the data to draw all of the glyphs; the
+      data is the same as that of a PainterAttributeData
+      filled by the filler passed to the ctor, i.e. the
+      chunk enumerated by a glyph_type holds the data to
+      draw all glyphs of that type.
+     */
+    const PainterAttributeData&
+    data(void) const;
+
+    /*!
+      Returns the value of PainterAttributeDataFillerGlyphs::number_glyphs()
+      of the filler passed to the ctor.
+     */
+    unsigned int
+    number_glyphs(void) const;
+
+    /*!
+      Returns the value of max_glyphs_per_chunk passed to the ctor.
+     */
+    unsigned int
+    max_glyphs_per_chunk(void) const;
+
+    /*!
+      Returns the glyph types for which there are glyphs.
+     */
+    const_c_array<enum glyph_type>
+    glyph_types(void) const;
+
+    /*!
+      Returns the attribute data of a chunk of the culling
+      hierarchy; the data is a sub-array of data().
+      \param chunk chunk as returned by chunks()
+     */
+    const_c_array<PainterAttribute>
+    attribute_data_chunk(unsigned int chunk) const;
+
+    /*!
+      Returns the index data of a chunk of the culling
+      hierarchy; the data is a sub-array of data().
+      \param chunk chunk as returned by chunks()
+     */
+    const_c_array<PainterIndex>
+    index_data_chunk(unsigned int chunk) const;
+
+    /*!
+      Returns the value by which to adjust the indices of
+      index_data_chunk() so that they index into
+      attribute_data_chunk().
+      \param chunk chunk as returned by chunks()
+     */
+    int
+    index_adjust_chunk(unsigned int chunk) const;
+
+    /*!
+      Gives the bounding box, in local coordinates, of the
+      glyphs of a chunk of the culling hierarchy.
+      \param chunk chunk as returned by chunks()
+      \param out_min_bb (output) location to which to write the min-corner
+      \param out_max_bb (output) location to which to write the max-corner
+      \returns false if the chunk has no glyphs
+     */
+    bool
+    bounding_box_chunk(unsigned int chunk, vec2 *out_min_bb, vec2 *out_max_bb) const;
+
+    /*!
+      Returns the chunks of the culling hierarchy that hold the
+      glyphs of a fixed glyph type that intersect a region given
+      by clip equations. The chunks returned hold no glyph in
+      common, their data is fetched with attribute_data_chunk(),
+      index_data_chunk() and index_adjust_chunk().
+      \param scratch_space scratch space for computations.
+      \param tp glyph type
+      \param clip_equations array of clip equations
+      \param clip_matrix_local 3x3 transformation from local (x, y, 1)
+                               coordinates to clip coordinates.
+      \param dst[output] location to which to write the chunks
+      \returns the number of chunks that intersect the clipping region,
+               that number is guarnanteed to be no more than maximum_chunks().
+     */
+    unsigned int
+    chunks(ScratchSpace &scratch_space,
+           enum glyph_type tp,
+           const_c_array<vec3> clip_equations,
+           const float3x3 &clip_matrix_local,
+           c_array<unsigned int> dst) const;
+
+    /*!
+      Gives the maximum return value to chunks(), i.e. the
+      maximum number of chunks that chunks() will return.
+     */
+    unsigned int
+    maximum_chunks(void) const;
+
+  private:
+    void *m_d;
+  };
+/*! @} */
+}
@@ -118,7 +118,7 @@ namespace fastuidraw
     unsigned int
     alignment_packing(void) const
     {
-      return this->m_d->alignment_packing();
+      return PainterPackedValueBase::alignment_packing();
     }
 
     /*!
@@ -209,6 +209,41 @@ namespace fastuidraw
 
     ~PainterPackedValuePool();
 
+    /*!
+      Begin an arena. Until end_arena() is called, the
+      PainterPackedValue objects returned by create_packed_value()
+      come from an arena: they are taken in order from storage
+      that is reused from arena to arena, they are not reference
+      counted and they are all released together by end_arena().
+      Creating and copying packed values within an arena thus
+      does not allocate memory (once the storage has grown to
+      its working size) nor modify reference counts. A
+      PainterPackedValue made within an arena must NOT be used
+      (even to copy or to draw with) after end_arena() is called;
+      an arena is intended to hold the packed values made for a
+      single frame, see Painter::packed_value_arena(bool).
+      It is an error to call begin_arena() if arena_active()
+      is true.
+     */
+    void
+    begin_arena(void);
+
+    /*!
+      End the arena begun by begin_arena(), releasing
+      all of the PainterPackedValue objects created
+      within the arena. It is an error to call end_arena()
+      if arena_active() is false.
+     */
+    void
+    end_arena(void);
+
+    /*!
+      Returns true if and only if begin_arena() has been
+      called without a matching end_arena().
+     */
+    bool
+    arena_active(void) const;
+
     /*!
       Create and return a PainterPackedValue<PainterBrush>
       object for the value of a PainterBrush object.
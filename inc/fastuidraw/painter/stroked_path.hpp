@@ -43,10 +43,13 @@ class PainterAttribute;
   It contains -all- the data needed to stroke a path regardless of
   stroking style. in particular, for a given TessellatedPath,
   one only needs to construct a StrokedPath <i>once</i> regardless
-  of how one strokes the original path for drawing.
+  of how one strokes the original path for drawing. The methods
+  of a StrokedPath, including the lazy construction of the levels
+  of detail of rounded_joins() and rounded_caps(), may be called
+  from several threads at once.
  */
 class StrokedPath:
-    public reference_counted<StrokedPath>::non_concurrent
+    public reference_counted<StrokedPath>::default_base
 {
 public:
   /*!
@@ -28,6 +28,8 @@
 
 namespace fastuidraw  {
 
+class PathPrefetcher;
+
 /*!\addtogroup Core
   @{
  */
@@ -40,7 +42,7 @@ namespace fastuidraw  {
   to the first point.
  */
 class PathContour:
-    public reference_counted<PathContour>::non_concurrent
+    public reference_counted<PathContour>::default_base
 {
 public:
 
@@ -50,7 +52,7 @@ public:
     the shape of an edge.
    */
   class interpolator_base:
-    public reference_counted<interpolator_base>::non_concurrent
+    public reference_counted<interpolator_base>::default_base
   {
   public:
     /*!
@@ -92,7 +94,11 @@ public:
       are to be filled; the other fields of TessellatedPath::point are
       filled by TessellatedPath using the named fields. In addition to
       filling the output array, the function shall return the number of
-      points needed to perform the required tessellation.
+      points needed to perform the required tessellation. Several threads
+      may call produce_tessellation() on the same interpolator at once
+      (see Path::tessellation()), so an implementation must not write
+      to data of the interpolator; scratch space is to be local to
+      the call.
 
       \param tess_params tessellation parameters
       \param out_data location to which to write the edge tessellated
@@ -223,6 +229,9 @@ public:
 
     /*!
       To be implemented by a derived to assist in recursive tessellation.
+      A NULL in_region is the region of the entire curve. As with
+      produce_tessellation(), tessellate() may be called from several
+      threads at once and must not write to data of the interpolator.
       \param in_region region to divide in half
       \param out_regionA location to which to write the first half
       \param out_regionB location to which to write the second half
@@ -248,7 +257,15 @@ public:
 
   /*!
     Derived class of interpolator_base to indicate a Bezier curve.
-    Supports Bezier curves of _any_ degree.
+    Supports Bezier curves of _any_ degree. Quadratic and cubic
+    curves are not tessellated by recursion: the number of segments
+    is computed from the control points (from the angle the control
+    polygon turns for curvature tessellation and from Wang's formula
+    for curve distance tessellation) and the curve is evaluated at
+    uniform times by forward differencing; a curve whose uniform
+    segments cannot meet the threshhold within
+    TessellatedPath::TessellationParams::m_max_segments is
+    tessellated by adaptive subdivision as other curves are.
    */
   class bezier:public interpolator_generic
   {
@@ -284,6 +301,13 @@ public:
     virtual
     ~bezier();
 
+    virtual
+    unsigned int
+    produce_tessellation(const TessellatedPath::TessellationParams &tess_params,
+                         c_array<TessellatedPath::point> out_data,
+                         float *out_effective_curve_distance,
+                         float *out_effective_curvature) const;
+
     virtual
     void
     compute(float in_t, vec2 *outp, vec2 *outp_t, vec2 *outp_tt) const;
@@ -866,7 +890,13 @@ public:
     level of detail. The TessellatedPath is constructed
     lazily. Additionally, if this Path changes its geometry,
     then a new TessellatedPath will be contructed on the
-    next call to tessellation().
+    next call to tessellation(). It is safe to call
+    tessellation() and approximate_bounding_box() from
+    several threads at once, provided that no thread
+    changes the Path meanwhile: a level of detail already
+    made is returned without locking and a missing level
+    is made only once, by the first thread to need it,
+    while the other threads needing it wait for it.
     \param thresh the returned tessellated path will be so that
                   TessellatedPath::effective_curve_distance_threshhold()
                   is no more than thresh. A non-positive value
@@ -887,7 +917,63 @@ public:
   const reference_counted_ptr<const TessellatedPath>&
   tessellation(void) const;
 
+  /*!
+    Returns, without ever making a TessellatedPath or waiting
+    for another thread, the tessellation that tessellation(float)
+    would return if it is already made and otherwise the finest
+    level of detail that is already made. Returns a NULL value if
+    no level of detail is made yet. Together with PathPrefetcher,
+    this allows a thread that draws to use a coarser level of
+    detail while the level it needs is made by another thread.
+    \param thresh threshhold as in tessellation(float)
+    \param out_ready if non-NULL, location to which to write true
+                     if the returned value is what tessellation(float)
+                     would return and false otherwise
+   */
+  reference_counted_ptr<const TessellatedPath>
+  tessellation_if_ready(float thresh, bool *out_ready = NULL) const;
+
+  /*!
+    Set the maximum number of threads with which the
+    levels of detail of this Path are made, see
+    TessellatedPath::TessellationParams::m_max_threads.
+    Does not change the levels of detail already made.
+    Default value is 1.
+   */
+  void
+  tessellation_threads(unsigned int v);
+
+  /*!
+    Returns the value set by tessellation_threads(unsigned int).
+   */
+  unsigned int
+  tessellation_threads(void) const;
+
+  /*!
+    Set if the levels of detail of this Path store their
+    points compactly, see
+    TessellatedPath::TessellationParams::m_compact_point_data.
+    Does not change the levels of detail already made.
+    Default value is false.
+   */
+  void
+  compact_tessellation(bool v);
+
+  /*!
+    Returns the value set by compact_tessellation(bool).
+   */
+  bool
+  compact_tessellation(void) const;
+
 private:
+  friend class PathPrefetcher;
+
+  /* records the PathPrefetcher on which this Path is
+     scheduled, see PathPrefetcher::prefetch().
+   */
+  void
+  prefetcher(PathPrefetcher *p) const;
+
   void *m_d;
 };
 
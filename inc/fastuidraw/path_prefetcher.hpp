@@ -0,0 +1,174 @@
+/*!
+ * \file path_prefetcher.hpp
+ * \brief file path_prefetcher.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#pragma once
+
+#include <fastuidraw/util/util.hpp>
+#include <fastuidraw/util/reference_counted.hpp>
+
+namespace fastuidraw  {
+
+class Path;
+
+/*!\addtogroup Core
+  @{
+ */
+
+/*!
+  A PathPrefetcher makes levels of detail of Path objects,
+  see Path::tessellation(float), on a pool of worker threads
+  so that a thread that draws can use the levels of detail
+  that are already made, see Path::tessellation_if_ready(),
+  instead of waiting for a missing level of detail to be made.
+  Together with a level of detail, the data to fill and/or
+  stroke it (i.e. TessellatedPath::filled() and
+  TessellatedPath::stroked()) is also made.
+
+  A Path scheduled on a PathPrefetcher keeps a reference to
+  the PathPrefetcher until the Path is destroyed or changes
+  its geometry; destroying or changing the Path cancels the
+  work scheduled for it that is not yet started and waits
+  for the work on it in progress to finish. The methods of
+  a PathPrefetcher may be called from several threads at once,
+  but a Path must not be scheduled on a PathPrefetcher while
+  another thread changes the Path.
+ */
+class PathPrefetcher:
+    public reference_counted<PathPrefetcher>::default_base
+{
+public:
+  /*!
+    Enumeration to specify what to make
+    together with a level of detail.
+   */
+  enum prefetch_flags_t
+    {
+      /*!
+        Make TessellatedPath::filled() and its
+        FilledPath::painter_data().
+       */
+      prefetch_filled = 1,
+
+      /*!
+        Make TessellatedPath::stroked().
+       */
+      prefetch_stroked = 2
+    };
+
+  /*!
+    A CallBack is used to report when the level of
+    detail scheduled by prefetch() for a Path is made.
+   */
+  class CallBack:
+    public reference_counted<CallBack>::default_base
+  {
+  public:
+    /*!
+      To be implemented by a derived class to be told that
+      the level of detail scheduled for a Path is made, i.e.
+      that Path::tessellation_if_ready() for the Path and
+      the threshhold will report that it is ready. Called
+      from a worker thread of the PathPrefetcher; an
+      implementation must not destroy or change the Path
+      from the call.
+      \param path Path whose level of detail is made
+      \param thresh threshhold of the level of detail made,
+                    see Path::tessellation(float)
+     */
+    virtual
+    void
+    tessellation_ready(const Path &path, float thresh) = 0;
+  };
+
+  /*!
+    Ctor.
+    \param number_threads number of worker threads, at least
+                          one worker thread is always made
+   */
+  explicit
+  PathPrefetcher(unsigned int number_threads = 1);
+
+  ~PathPrefetcher();
+
+  /*!
+    Schedule making the level of detail of a Path for a
+    threshhold, i.e. what Path::tessellation(float) makes.
+    If the Path is already scheduled and its work is not
+    yet started, the schedule is merged into it, taking
+    the finer of the two threshholds. Does nothing if the
+    level of detail and what is to be made with it
+    are already being made.
+    \param path Path to tessellate
+    \param thresh threshhold as in Path::tessellation(float)
+    \param flags bit field of \ref prefetch_flags_t values
+                 to specify what to make with the level of detail
+   */
+  void
+  prefetch(const Path &path, float thresh,
+           uint32_t flags = prefetch_filled | prefetch_stroked);
+
+  /*!
+    Removes the work scheduled for a Path that is not started
+    and waits for the work on the Path in progress to finish.
+    Must not be called from CallBack::tessellation_ready().
+    \param path Path whose work to cancel
+   */
+  void
+  cancel(const Path &path);
+
+  /*!
+    Waits until all the work scheduled is done.
+   */
+  void
+  wait(void);
+
+  /*!
+    Returns the number of Path objects whose work is
+    scheduled or in progress.
+   */
+  unsigned int
+  number_pending(void) const;
+
+  /*!
+    Returns the number of Path levels of detail made by
+    the worker threads since the ctor.
+   */
+  unsigned int
+  number_completed(void) const;
+
+  /*!
+    Set the CallBack to which to report that the work
+    of a Path is done, a NULL value means to not report.
+   */
+  void
+  call_back(const reference_counted_ptr<CallBack> &v);
+
+  /*!
+    Returns the value set by call_back(const reference_counted_ptr<CallBack>&).
+   */
+  reference_counted_ptr<CallBack>
+  call_back(void) const;
+
+private:
+  void *m_d;
+};
+
+/*! @} */
+
+}
@@ -39,9 +39,12 @@ class FilledPath;
 
 /*!
   A TessellatedPath represents the tessellation of a Path.
+  The methods of a TessellatedPath, including the lazy
+  construction of stroked() and filled(), may be called
+  from several threads at once.
  */
 class TessellatedPath:
-    public reference_counted<TessellatedPath>::non_concurrent
+    public reference_counted<TessellatedPath>::default_base
 {
 public:
   /*!
@@ -57,11 +60,15 @@ public:
     TessellationParams(void):
       m_curvature_tessellation(true),
       m_threshhold(float(M_PI)/30.0f),
-      m_max_segments(32)
+      m_max_segments(32),
+      m_max_threads(1),
+      m_compact_point_data(false)
     {}
 
     /*!
-      Non-equal comparison operator.
+      Non-equal comparison operator; \ref m_max_threads
+      and \ref m_compact_point_data are not compared
+      since they do not change the tessellation.
       \param rhs value to which to compare against
      */
     bool
@@ -131,6 +138,28 @@ public:
       return *this;
     }
 
+    /*!
+      Set the value of \ref m_max_threads.
+      \param v value to which to assign to \ref m_max_threads
+     */
+    TessellationParams&
+    max_threads(unsigned int v)
+    {
+      m_max_threads = v;
+      return *this;
+    }
+
+    /*!
+      Set the value of \ref m_compact_point_data.
+      \param v value to which to assign to \ref m_compact_point_data
+     */
+    TessellationParams&
+    compact_point_data(bool v)
+    {
+      m_compact_point_data = v;
+      return *this;
+    }
+
     /*!
       Specifies the meaning of \ref m_threshhold.
      */
@@ -157,6 +186,39 @@ public:
       PathContour of a Path.
      */
     unsigned int m_max_segments;
+
+    /*!
+      Maximum number of threads with which to tessellate
+      the PathContour objects of a Path; the contours are
+      tessellated independently and the result is the same
+      regardless of the number of threads. A value of 0 or
+      1 means to tessellate on the calling thread only.
+      Using more than one thread only pays off for a Path
+      with many contours (for example map data).
+     */
+    unsigned int m_max_threads;
+
+    /*!
+      If true, the TessellatedPath stores its points compactly:
+      per point only the position (8 bytes), the derivative as
+      two 16-bit floats (4 bytes) and the distance from the
+      start of the edge (4 bytes), i.e. 16 bytes per point
+      instead of sizeof(point) (36 bytes); the distance of each
+      edge from the start of its contour is stored once per
+      edge (4 bytes) and the lengths of a contour once per
+      contour (8 bytes). The values read back are the same
+      except that the derivative is rounded to 16-bit floats;
+      a derivative with a coordinate larger than 65504 (the
+      largest 16-bit float) is scaled to keep its direction.
+      The point data is then read with extract_point_data(),
+      point_value() or the methods taking a work room, such as
+      edge_point_data(unsigned int, unsigned int, c_array<point>) const,
+      which expand only the points requested; the methods that
+      return arrays of point without a work room, such as
+      point_data(void) const, expand all the points on first
+      use and keep the expansion, which loses the saving.
+     */
+    bool m_compact_point_data;
   };
 
   /*!
@@ -247,11 +309,58 @@ public:
   max_segments(void) const;
 
   /*!
-    Returns all the point data
+    Returns all the point data. If the points are stored
+    compactly (see TessellationParams::m_compact_point_data),
+    the points are expanded on the first call and the expansion
+    is kept for the lifetime of this TessellatedPath.
    */
   const_c_array<point>
   point_data(void) const;
 
+  /*!
+    Copies all the point data, i.e. point_data(), to an
+    array without keeping an expansion of compactly stored
+    points (see TessellationParams::m_compact_point_data).
+    \param dst location to which to copy the points,
+               dst.size() must be number_points()
+   */
+  void
+  extract_point_data(c_array<point> dst) const;
+
+  /*!
+    Copies a range of the point data, i.e. point_data().sub_array(R),
+    to an array without keeping an expansion of compactly stored
+    points (see TessellationParams::m_compact_point_data).
+    \param R range of the points to copy, R.m_end must be no more
+             than number_points()
+    \param dst location to which to copy the points,
+               dst.size() must be R.m_end - R.m_begin
+   */
+  void
+  extract_point_data(range_type<unsigned int> R, c_array<point> dst) const;
+
+  /*!
+    Returns the named point, i.e. point_data()[i],
+    without expanding compactly stored points.
+    \param i index of the point with 0 <= i < number_points()
+   */
+  point
+  point_value(unsigned int i) const;
+
+  /*!
+    Returns the number of points, i.e. point_data().size().
+   */
+  unsigned int
+  number_points(void) const;
+
+  /*!
+    Returns the number of bytes used to store the points,
+    not including an expansion made by point_data(void) const
+    of compactly stored points.
+   */
+  unsigned int
+  point_data_bytes(void) const;
+
   /*!
     Returns the number of contours
    */
@@ -286,6 +395,20 @@ public:
   const_c_array<point>
   contour_point_data(unsigned int contour) const;
 
+  /*!
+    Returns the point data of the named contour, i.e.
+    contour_point_data(unsigned int) const, without
+    keeping an expansion of compactly stored points:
+    such points are expanded to work_room and the
+    returned array is then within work_room.
+    \param contour which contour
+    \param work_room location to which to expand the points,
+                     must be at least as large as the range
+                     contour_range(contour)
+   */
+  const_c_array<point>
+  contour_point_data(unsigned int contour, c_array<point> work_room) const;
+
   /*!
     Returns the point data of the named contour
     lacking the point data of the closing edge.
@@ -294,6 +417,20 @@ public:
   const_c_array<point>
   unclosed_contour_point_data(unsigned int contour) const;
 
+  /*!
+    Returns the point data of the named contour lacking
+    the point data of the closing edge, i.e.
+    unclosed_contour_point_data(unsigned int) const,
+    without keeping an expansion of compactly stored
+    points, see contour_point_data(unsigned int, c_array<point>) const.
+    \param contour which contour
+    \param work_room location to which to expand the points,
+                     must be at least as large as the range
+                     unclosed_contour_range(contour)
+   */
+  const_c_array<point>
+  unclosed_contour_point_data(unsigned int contour, c_array<point> work_room) const;
+
   /*!
     Returns the number of edges for the named contour
    */
@@ -316,6 +453,20 @@ public:
   const_c_array<point>
   edge_point_data(unsigned int contour, unsigned int edge) const;
 
+  /*!
+    Returns the point data of the named edge of the named
+    contour, i.e. edge_point_data(unsigned int, unsigned int) const,
+    without keeping an expansion of compactly stored points,
+    see contour_point_data(unsigned int, c_array<point>) const.
+    \param contour which contour
+    \param edge which edge of the contour
+    \param work_room location to which to expand the points,
+                     must be at least as large as the range
+                     edge_range(contour, edge)
+   */
+  const_c_array<point>
+  edge_point_data(unsigned int contour, unsigned int edge, c_array<point> work_room) const;
+
   /*!
     Returns the minimum point of the bounding box of
     the tessellation.
@@ -17,6 +17,7 @@
  */
 
 
+#include <cstring>
 #include <list>
 #include <map>
 #include <sstream>
@@ -57,12 +58,18 @@ namespace
       m_header_bo(0),
       m_index_bo(0),
       m_data_bo(0),
-      m_data_tbo(0)
+      m_data_tbo(0),
+      m_host_indices(NULL)
     {}
 
     GLuint m_vao;
     GLuint m_attribute_bo, m_header_bo, m_index_bo, m_data_bo;
     GLuint m_data_tbo;
+
+    /* non-NULL if indices are written to host memory
+       and converted to 16-bit indices on unmap
+     */
+    std::vector<fastuidraw::PainterIndex> *m_host_indices;
     enum fastuidraw::gl::PainterBackendGL::data_store_backing_t m_data_store_backing;
     unsigned int m_data_store_binding_point;
   };
@@ -122,7 +129,8 @@ namespace
     generate_bo(GLenum bind_target, GLsizei psize);
 
     unsigned int m_attribute_buffer_size, m_header_buffer_size;
-    unsigned int m_index_buffer_size;
+    unsigned int m_index_buffer_size, m_indices_per_buffer;
+    bool m_use_16bit_indices;
     int m_alignment, m_blocks_per_data_buffer;
     unsigned int m_data_buffer_size;
     enum fastuidraw::gl::PainterBackendGL::data_store_backing_t m_data_store_backing;
@@ -134,6 +142,52 @@ namespace
     std::vector<GLuint> m_ubos;
   };
 
+  class StaticAttributeDataGL:public fastuidraw::PainterStaticAttributeData
+  {
+  public:
+    StaticAttributeDataGL(const fastuidraw::PainterAttributeData &data,
+                          fastuidraw::const_c_array<unsigned int> attrib_chunk_selector);
+
+    ~StaticAttributeDataGL();
+
+    virtual
+    bool
+    backend_resident(void) const
+    {
+      return true;
+    }
+
+    GLuint
+    vao(void) const
+    {
+      return m_vao;
+    }
+
+  private:
+    GLuint m_vao, m_attribute_bo, m_index_bo;
+  };
+
+  void
+  set_attribute_pointers(void)
+  {
+    fastuidraw::gl::opengl_trait_value v;
+
+    glEnableVertexAttribArray(fastuidraw::glsl::PainterBackendGLSL::primary_attrib_slot);
+    v = fastuidraw::gl::opengl_trait_values<fastuidraw::uvec4>(sizeof(fastuidraw::PainterAttribute),
+                                                               offsetof(fastuidraw::PainterAttribute, m_attrib0));
+    fastuidraw::gl::VertexAttribIPointer(fastuidraw::glsl::PainterBackendGLSL::primary_attrib_slot, v);
+
+    glEnableVertexAttribArray(fastuidraw::glsl::PainterBackendGLSL::secondary_attrib_slot);
+    v = fastuidraw::gl::opengl_trait_values<fastuidraw::uvec4>(sizeof(fastuidraw::PainterAttribute),
+                                                               offsetof(fastuidraw::PainterAttribute, m_attrib1));
+    fastuidraw::gl::VertexAttribIPointer(fastuidraw::glsl::PainterBackendGLSL::secondary_attrib_slot, v);
+
+    glEnableVertexAttribArray(fastuidraw::glsl::PainterBackendGLSL::uint_attrib_slot);
+    v = fastuidraw::gl::opengl_trait_values<fastuidraw::uvec4>(sizeof(fastuidraw::PainterAttribute),
+                                                               offsetof(fastuidraw::PainterAttribute, m_attrib2));
+    fastuidraw::gl::VertexAttribIPointer(fastuidraw::glsl::PainterBackendGLSL::uint_attrib_slot, v);
+  }
+
   bool
   use_shader_helper(enum fastuidraw::gl::PainterBackendGL::program_type_t tp,
                     bool uses_discard)
@@ -234,12 +288,25 @@ namespace
 
     DrawEntry(const fastuidraw::BlendMode &mode);
 
+    DrawEntry(const fastuidraw::BlendMode &mode,
+              const fastuidraw::reference_counted_ptr<const StaticAttributeDataGL> &static_data,
+              uint32_t header_location, GLuint restore_vao);
+
     void
     add_entry(GLsizei count, const void *offset);
 
     void
     draw(void) const;
 
+    const fastuidraw::BlendMode&
+    blend_mode(void) const
+    {
+      return m_blend_mode;
+    }
+
+    void
+    use_16bit_indices(void);
+
   private:
 
     static
@@ -255,6 +322,15 @@ namespace
     std::vector<const GLvoid*> m_indices;
     PainterBackendGLPrivate *m_private;
     unsigned int m_choice;
+    GLenum m_index_type;
+
+    /* if non-NULL, the indices of the entry are drawn
+       from the buffers of m_static_data with the header
+       given by m_header_location
+     */
+    fastuidraw::reference_counted_ptr<const StaticAttributeDataGL> m_static_data;
+    uint32_t m_header_location;
+    GLuint m_restore_vao;
   };
 
   class DrawCommand:public fastuidraw::PainterDraw
@@ -275,6 +351,14 @@ namespace
                const fastuidraw::PainterShaderGroup &new_shaders,
                unsigned int attributes_written, unsigned int indices_written) const;
 
+    virtual
+    void
+    draw_static(const fastuidraw::reference_counted_ptr<const fastuidraw::PainterStaticAttributeData> &data,
+                fastuidraw::const_c_array<fastuidraw::range_type<unsigned int> > index_ranges,
+                uint32_t header_location,
+                unsigned int attributes_written,
+                unsigned int indices_written) const;
+
     virtual
     void
     draw(void) const;
@@ -292,6 +376,10 @@ namespace
     void
     add_entry(unsigned int indices_written) const;
 
+    void
+    upload_host_indices(unsigned int attributes_written,
+                        unsigned int indices_written) const;
+
     PainterBackendGLPrivate *m_pr;
     painter_vao m_vao;
     mutable unsigned int m_attributes_written, m_indices_written;
@@ -308,6 +396,7 @@ namespace
       m_data_store_backing(fastuidraw::gl::PainterBackendGL::data_store_tbo),
       m_number_pools(3),
       m_break_on_shader_change(false),
+      m_use_16bit_indices(false),
       m_use_hw_clip_planes(true),
       /* on Mesa/i965 using switch statement gives much slower
          performance than using if/else chain.
@@ -330,6 +419,7 @@ namespace
     enum fastuidraw::gl::PainterBackendGL::data_store_backing_t m_data_store_backing;
     unsigned int m_number_pools;
     bool m_break_on_shader_change;
+    bool m_use_16bit_indices;
     fastuidraw::reference_counted_ptr<fastuidraw::gl::ImageAtlasGL> m_image_atlas;
     fastuidraw::reference_counted_ptr<fastuidraw::gl::ColorStopAtlasGL> m_colorstop_atlas;
     fastuidraw::reference_counted_ptr<fastuidraw::gl::GlyphAtlasGL> m_glyph_atlas;
@@ -348,6 +438,53 @@ namespace
 
 }
 
+///////////////////////////////////////////
+// StaticAttributeDataGL methods
+StaticAttributeDataGL::
+StaticAttributeDataGL(const fastuidraw::PainterAttributeData &data,
+                      fastuidraw::const_c_array<unsigned int> attrib_chunk_selector):
+  fastuidraw::PainterStaticAttributeData(data, attrib_chunk_selector),
+  m_vao(0),
+  m_attribute_bo(0),
+  m_index_bo(0)
+{
+  glGenVertexArrays(1, &m_vao);
+  assert(m_vao != 0);
+  glBindVertexArray(m_vao);
+
+  glGenBuffers(1, &m_attribute_bo);
+  assert(m_attribute_bo != 0);
+  glBindBuffer(GL_ARRAY_BUFFER, m_attribute_bo);
+  glBufferData(GL_ARRAY_BUFFER,
+               attribute_data().size() * sizeof(fastuidraw::PainterAttribute),
+               attribute_data().c_ptr(), GL_STATIC_DRAW);
+
+  glGenBuffers(1, &m_index_bo);
+  assert(m_index_bo != 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_index_bo);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+               index_data().size() * sizeof(fastuidraw::PainterIndex),
+               index_data().c_ptr(), GL_STATIC_DRAW);
+
+  /* the header attribute is not sourced from a buffer,
+     its value is set with glVertexAttribI4ui() by the
+     DrawEntry that draws from the buffers.
+   */
+  set_attribute_pointers();
+  glDisableVertexAttribArray(fastuidraw::glsl::PainterBackendGLSL::header_attrib_slot);
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+StaticAttributeDataGL::
+~StaticAttributeDataGL()
+{
+  glDeleteBuffers(1, &m_attribute_bo);
+  glDeleteBuffers(1, &m_index_bo);
+  glDeleteVertexArrays(1, &m_vao);
+}
+
 ///////////////////////////////////////////
 // painter_vao_pool methods
 painter_vao_pool::
@@ -358,6 +495,8 @@ painter_vao_pool(const fastuidraw::gl::PainterBackendGL::ConfigurationGL &params
   m_attribute_buffer_size(params.attributes_per_buffer() * sizeof(fastuidraw::PainterAttribute)),
   m_header_buffer_size(params.attributes_per_buffer() * sizeof(uint32_t)),
   m_index_buffer_size(params.indices_per_buffer() * sizeof(fastuidraw::PainterIndex)),
+  m_indices_per_buffer(params.indices_per_buffer()),
+  m_use_16bit_indices(params.use_16bit_indices()),
   m_alignment(params_base.alignment()),
   m_blocks_per_data_buffer(params.data_blocks_per_store_buffer()),
   m_data_buffer_size(m_blocks_per_data_buffer * m_alignment * sizeof(fastuidraw::generic_data)),
@@ -387,6 +526,10 @@ painter_vao_pool::
           glDeleteBuffers(1, &m_vaos[p][i].m_index_bo);
           glDeleteBuffers(1, &m_vaos[p][i].m_data_bo);
           glDeleteVertexArrays(1, &m_vaos[p][i].m_vao);
+          if(m_vaos[p][i].m_host_indices != NULL)
+            {
+              FASTUIDRAWdelete(m_vaos[p][i].m_host_indices);
+            }
         }
 
       if(m_ubos[p] != 0)
@@ -461,21 +604,12 @@ request_vao(void)
       */
       m_vaos[m_pool][m_current].m_attribute_bo = generate_bo(GL_ARRAY_BUFFER, m_attribute_buffer_size);
       m_vaos[m_pool][m_current].m_index_bo = generate_bo(GL_ELEMENT_ARRAY_BUFFER, m_index_buffer_size);
+      set_attribute_pointers();
 
-      glEnableVertexAttribArray(fastuidraw::glsl::PainterBackendGLSL::primary_attrib_slot);
-      v = fastuidraw::gl::opengl_trait_values<fastuidraw::uvec4>(sizeof(fastuidraw::PainterAttribute),
-                                                                 offsetof(fastuidraw::PainterAttribute, m_attrib0));
-      fastuidraw::gl::VertexAttribIPointer(fastuidraw::glsl::PainterBackendGLSL::primary_attrib_slot, v);
-
-      glEnableVertexAttribArray(fastuidraw::glsl::PainterBackendGLSL::secondary_attrib_slot);
-      v = fastuidraw::gl::opengl_trait_values<fastuidraw::uvec4>(sizeof(fastuidraw::PainterAttribute),
-                                                                 offsetof(fastuidraw::PainterAttribute, m_attrib1));
-      fastuidraw::gl::VertexAttribIPointer(fastuidraw::glsl::PainterBackendGLSL::secondary_attrib_slot, v);
-
-      glEnableVertexAttribArray(fastuidraw::glsl::PainterBackendGLSL::uint_attrib_slot);
-      v = fastuidraw::gl::opengl_trait_values<fastuidraw::uvec4>(sizeof(fastuidraw::PainterAttribute),
-                                                                 offsetof(fastuidraw::PainterAttribute, m_attrib2));
-      fastuidraw::gl::VertexAttribIPointer(fastuidraw::glsl::PainterBackendGLSL::uint_attrib_slot, v);
+      if(m_use_16bit_indices)
+        {
+          m_vaos[m_pool][m_current].m_host_indices = FASTUIDRAWnew std::vector<fastuidraw::PainterIndex>(m_indices_per_buffer);
+        }
 
       m_vaos[m_pool][m_current].m_header_bo = generate_bo(GL_ARRAY_BUFFER, m_header_buffer_size);
       glEnableVertexAttribArray(fastuidraw::glsl::PainterBackendGLSL::header_attrib_slot);
@@ -556,7 +690,10 @@ DrawEntry(const fastuidraw::BlendMode &mode,
           unsigned int pz):
   m_blend_mode(mode),
   m_private(pr),
-  m_choice(pz)
+  m_choice(pz),
+  m_index_type(fastuidraw::gl::opengl_trait<fastuidraw::PainterIndex>::type),
+  m_header_location(0),
+  m_restore_vao(0)
 {}
 
 
@@ -564,7 +701,23 @@ DrawEntry::
 DrawEntry(const fastuidraw::BlendMode &mode):
   m_blend_mode(mode),
   m_private(NULL),
-  m_choice(fastuidraw::gl::PainterBackendGL::number_program_types)
+  m_choice(fastuidraw::gl::PainterBackendGL::number_program_types),
+  m_index_type(fastuidraw::gl::opengl_trait<fastuidraw::PainterIndex>::type),
+  m_header_location(0),
+  m_restore_vao(0)
+{}
+
+DrawEntry::
+DrawEntry(const fastuidraw::BlendMode &mode,
+          const fastuidraw::reference_counted_ptr<const StaticAttributeDataGL> &static_data,
+          uint32_t header_location, GLuint restore_vao):
+  m_blend_mode(mode),
+  m_private(NULL),
+  m_choice(fastuidraw::gl::PainterBackendGL::number_program_types),
+  m_index_type(fastuidraw::gl::opengl_trait<fastuidraw::PainterIndex>::type),
+  m_static_data(static_data),
+  m_header_location(header_location),
+  m_restore_vao(restore_vao)
 {}
 
 void
@@ -575,6 +728,27 @@ add_entry(GLsizei count, const void *offset)
   m_indices.push_back(offset);
 }
 
+void
+DrawEntry::
+use_16bit_indices(void)
+{
+  /* the indices of static data are always 32-bit
+   */
+  if(m_static_data)
+    {
+      return;
+    }
+
+  m_index_type = fastuidraw::gl::opengl_trait<uint16_t>::type;
+  for(unsigned int i = 0, endi = m_indices.size(); i < endi; ++i)
+    {
+      const uint16_t *offset(NULL);
+
+      offset += reinterpret_cast<uintptr_t>(m_indices[i]) / sizeof(fastuidraw::PainterIndex);
+      m_indices[i] = offset;
+    }
+}
+
 void
 DrawEntry::
 draw(void) const
@@ -601,6 +775,13 @@ draw(void) const
   assert(!m_counts.empty());
   assert(m_counts.size() == m_indices.size());
 
+  if(m_static_data)
+    {
+      glBindVertexArray(m_static_data->vao());
+      glVertexAttribI4ui(fastuidraw::glsl::PainterBackendGLSL::header_attrib_slot,
+                         m_header_location, 0u, 0u, 0u);
+    }
+
   /* TODO:
      Get rid of this unholy mess of #ifdef's here and move
      it to an internal private function that also has a tag
@@ -609,7 +790,7 @@ draw(void) const
   #ifndef FASTUIDRAW_GL_USE_GLES
     {
       glMultiDrawElements(GL_TRIANGLES, &m_counts[0],
-                          fastuidraw::gl::opengl_trait<fastuidraw::PainterIndex>::type,
+                          m_index_type,
                           &m_indices[0], m_counts.size());
     }
   #else
@@ -617,7 +798,7 @@ draw(void) const
       if(FASTUIDRAWglfunctionExists(glMultiDrawElementsEXT))
         {
           glMultiDrawElementsEXT(GL_TRIANGLES, &m_counts[0],
-                                 fastuidraw::gl::opengl_trait<fastuidraw::PainterIndex>::type,
+                                 m_index_type,
                                  &m_indices[0], m_counts.size());
         }
       else
@@ -625,12 +806,16 @@ draw(void) const
           for(unsigned int i = 0, endi = m_counts.size(); i < endi; ++i)
             {
               glDrawElements(GL_TRIANGLES, m_counts[i],
-                             fastuidraw::gl::opengl_trait<fastuidraw::PainterIndex>::type,
-                             m_indices[i]);
+                             m_index_type, m_indices[i]);
             }
         }
     }
   #endif
+
+  if(m_static_data)
+    {
+      glBindVertexArray(m_restore_vao);
+    }
 }
 
 GLenum
@@ -722,9 +907,19 @@ DrawCommand(painter_vao_pool *hnd,
   header_bo = glMapBufferRange(GL_ARRAY_BUFFER, 0, hnd->header_buffer_size(), flags);
   assert(header_bo != NULL);
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_vao.m_index_bo);
-  index_bo = glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, hnd->index_buffer_size(), flags);
-  assert(index_bo != NULL);
+  if(m_vao.m_host_indices)
+    {
+      /* indices are written to host memory and sent
+         to GL in unmap_implement()
+       */
+      index_bo = &m_vao.m_host_indices->operator[](0);
+    }
+  else
+    {
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_vao.m_index_bo);
+      index_bo = glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, hnd->index_buffer_size(), flags);
+      assert(index_bo != NULL);
+    }
 
   glBindBuffer(GL_ARRAY_BUFFER, m_vao.m_data_bo);
   data_bo = glMapBufferRange(GL_ARRAY_BUFFER, 0, hnd->data_buffer_size(), flags);
@@ -793,6 +988,41 @@ draw_break(const fastuidraw::PainterShaderGroup &old_shaders,
   FASTUIDRAWunused(attributes_written);
 }
 
+void
+DrawCommand::
+draw_static(const fastuidraw::reference_counted_ptr<const fastuidraw::PainterStaticAttributeData> &data,
+            fastuidraw::const_c_array<fastuidraw::range_type<unsigned int> > index_ranges,
+            uint32_t header_location,
+            unsigned int attributes_written,
+            unsigned int indices_written) const
+{
+  const StaticAttributeDataGL *p;
+  fastuidraw::BlendMode mode;
+
+  assert(dynamic_cast<const StaticAttributeDataGL*>(data.get()));
+  p = static_cast<const StaticAttributeDataGL*>(data.get());
+
+  /* end the current DrawEntry, add a DrawEntry that draws
+     from the static buffers and then a DrawEntry to continue
+     drawing from the buffers of this DrawCommand, all with
+     the same blend mode and program.
+   */
+  add_entry(indices_written);
+  mode = m_draws.back().blend_mode();
+  m_draws.push_back(DrawEntry(mode, p, header_location, m_vao.m_vao));
+  for(unsigned int i = 0, endi = index_ranges.size(); i < endi; ++i)
+    {
+      const fastuidraw::PainterIndex *offset(NULL);
+
+      assert(index_ranges[i].m_end > index_ranges[i].m_begin);
+      offset += index_ranges[i].m_begin;
+      m_draws.back().add_entry(index_ranges[i].difference(), offset);
+    }
+  m_draws.push_back(DrawEntry(mode));
+
+  FASTUIDRAWunused(attributes_written);
+}
+
 void
 DrawCommand::
 draw(void) const
@@ -849,14 +1079,68 @@ unmap_implement(unsigned int attributes_written,
   glUnmapBuffer(GL_ARRAY_BUFFER);
 
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_vao.m_index_bo);
-  glFlushMappedBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, indices_written * sizeof(fastuidraw::PainterIndex));
-  glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+  if(m_vao.m_host_indices)
+    {
+      upload_host_indices(attributes_written, indices_written);
+    }
+  else
+    {
+      glFlushMappedBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, indices_written * sizeof(fastuidraw::PainterIndex));
+      glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+    }
 
   glBindBuffer(GL_ARRAY_BUFFER, m_vao.m_data_bo);
   glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, data_store_written * sizeof(fastuidraw::generic_data));
   glUnmapBuffer(GL_ARRAY_BUFFER);
 }
 
+void
+DrawCommand::
+upload_host_indices(unsigned int attributes_written,
+                    unsigned int indices_written) const
+{
+  uint32_t flags;
+
+  if(indices_written == 0)
+    {
+      return;
+    }
+
+  flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+  if(attributes_written <= 65536u)
+    {
+      uint16_t *dst;
+
+      dst = static_cast<uint16_t*>(glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0,
+                                                    indices_written * sizeof(uint16_t),
+                                                    flags));
+      assert(dst != NULL);
+      for(unsigned int i = 0; i < indices_written; ++i)
+        {
+          assert(m_indices[i] < attributes_written);
+          dst[i] = static_cast<uint16_t>(m_indices[i]);
+        }
+      glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+
+      for(std::list<DrawEntry>::iterator iter = m_draws.begin(),
+            end = m_draws.end(); iter != end; ++iter)
+        {
+          iter->use_16bit_indices();
+        }
+    }
+  else
+    {
+      void *dst;
+
+      dst = glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0,
+                             indices_written * sizeof(fastuidraw::PainterIndex),
+                             flags);
+      assert(dst != NULL);
+      std::memcpy(dst, m_indices.c_ptr(), indices_written * sizeof(fastuidraw::PainterIndex));
+      glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+    }
+}
+
 void
 DrawCommand::
 add_entry(unsigned int indices_written) const
@@ -1396,6 +1680,7 @@ setget_implement(unsigned int, indices_per_buffer)
 setget_implement(unsigned int, data_blocks_per_store_buffer)
 setget_implement(unsigned int, number_pools)
 setget_implement(bool, break_on_shader_change)
+setget_implement(bool, use_16bit_indices)
 setget_implement(const fastuidraw::reference_counted_ptr<fastuidraw::gl::ImageAtlasGL>&, image_atlas)
 setget_implement(const fastuidraw::reference_counted_ptr<fastuidraw::gl::ColorStopAtlasGL>&, colorstop_atlas)
 setget_implement(const fastuidraw::reference_counted_ptr<fastuidraw::gl::GlyphAtlasGL>&, glyph_atlas)
@@ -1707,3 +1992,11 @@ map_draw(void)
 
   return FASTUIDRAWnew DrawCommand(d->m_pool, d->m_params, d);
 }
+
+fastuidraw::reference_counted_ptr<const fastuidraw::PainterStaticAttributeData>
+fastuidraw::gl::PainterBackendGL::
+create_static_attribute_data(const PainterAttributeData &data,
+                             const_c_array<unsigned int> attrib_chunk_selector)
+{
+  return FASTUIDRAWnew StaticAttributeDataGL(data, attrib_chunk_selector);
+}
@@ -0,0 +1,974 @@
+/*!
+ * \file painter_backend_headless.cpp
+ * \brief file painter_backend_headless.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+#include <vector>
+#include <ostream>
+#include <cstring>
+
+#include <fastuidraw/glsl/painter_backend_headless.hpp>
+#include <fastuidraw/glsl/painter_item_shader_glsl.hpp>
+#include "../private/util_private.hpp"
+
+namespace
+{
+  enum
+    {
+      shader_group_discard_mask = (1u << 31u)
+    };
+
+  typedef fastuidraw::vecN<uint64_t, fastuidraw::glsl::PainterBackendHeadless::number_atlas_stats> atlas_stats;
+
+  /* Each of the atlas backing stores of a PainterBackendHeadless
+     only counts what is uploaded to it; the values are never
+     read back, so they are not kept.
+   */
+  class store_stats
+  {
+  public:
+    store_stats(void):
+      m_stats(0)
+    {}
+
+    virtual
+    ~store_stats()
+    {}
+
+    void
+    record_upload(uint64_t num_values)
+    {
+      ++m_stats[fastuidraw::glsl::PainterBackendHeadless::atlas_num_uploads];
+      m_stats[fastuidraw::glsl::PainterBackendHeadless::atlas_num_values_uploaded] += num_values;
+    }
+
+    void
+    record(enum fastuidraw::glsl::PainterBackendHeadless::atlas_stat_t st)
+    {
+      ++m_stats[st];
+    }
+
+    mutable atlas_stats m_stats;
+  };
+
+  class GlyphTexelStoreHeadless:
+    public fastuidraw::GlyphAtlasTexelBackingStoreBase,
+    public store_stats
+  {
+  public:
+    GlyphTexelStoreHeadless(void):
+      fastuidraw::GlyphAtlasTexelBackingStoreBase(1024, 1024, 16, true)
+    {}
+
+    virtual
+    void
+    set_data(int x, int y, int l, int w, int h,
+             fastuidraw::const_c_array<uint8_t> data)
+    {
+      FASTUIDRAWunused(x);
+      FASTUIDRAWunused(y);
+      FASTUIDRAWunused(l);
+      FASTUIDRAWunused(data);
+      record_upload(w * h);
+    }
+
+    virtual
+    void
+    flush(void)
+    {
+      record(fastuidraw::glsl::PainterBackendHeadless::atlas_num_flushes);
+    }
+
+  protected:
+    virtual
+    void
+    resize_implement(int new_num_layers)
+    {
+      FASTUIDRAWunused(new_num_layers);
+      record(fastuidraw::glsl::PainterBackendHeadless::atlas_num_resizes);
+    }
+  };
+
+  class GlyphGeometryStoreHeadless:
+    public fastuidraw::GlyphAtlasGeometryBackingStoreBase,
+    public store_stats
+  {
+  public:
+    GlyphGeometryStoreHeadless(void):
+      fastuidraw::GlyphAtlasGeometryBackingStoreBase(4, 1024 * 1024 / 4, true)
+    {}
+
+    virtual
+    void
+    set_values(unsigned int location, fastuidraw::const_c_array<fastuidraw::generic_data> pdata)
+    {
+      FASTUIDRAWunused(location);
+      record_upload(pdata.size());
+    }
+
+    virtual
+    void
+    flush(void)
+    {
+      record(fastuidraw::glsl::PainterBackendHeadless::atlas_num_flushes);
+    }
+
+  protected:
+    virtual
+    void
+    resize_implement(unsigned int new_size)
+    {
+      FASTUIDRAWunused(new_size);
+      record(fastuidraw::glsl::PainterBackendHeadless::atlas_num_resizes);
+    }
+  };
+
+  class ColorStoreHeadless:
+    public fastuidraw::AtlasColorBackingStoreBase,
+    public store_stats
+  {
+  public:
+    ColorStoreHeadless(int tile_size, int tiles_per_row_per_col):
+      fastuidraw::AtlasColorBackingStoreBase(tile_size * tiles_per_row_per_col,
+                                             tile_size * tiles_per_row_per_col,
+                                             1, true)
+    {}
+
+    virtual
+    void
+    set_data(int x, int y, int l, int w, int h,
+             fastuidraw::const_c_array<fastuidraw::u8vec4> data)
+    {
+      FASTUIDRAWunused(x);
+      FASTUIDRAWunused(y);
+      FASTUIDRAWunused(l);
+      FASTUIDRAWunused(data);
+      record_upload(w * h);
+    }
+
+    virtual
+    void
+    flush(void)
+    {
+      record(fastuidraw::glsl::PainterBackendHeadless::atlas_num_flushes);
+    }
+
+  protected:
+    virtual
+    void
+    resize_implement(int new_num_layers)
+    {
+      FASTUIDRAWunused(new_num_layers);
+      record(fastuidraw::glsl::PainterBackendHeadless::atlas_num_resizes);
+    }
+  };
+
+  class IndexStoreHeadless:
+    public fastuidraw::AtlasIndexBackingStoreBase,
+    public store_stats
+  {
+  public:
+    IndexStoreHeadless(int tile_size, int tiles_per_row_per_col):
+      fastuidraw::AtlasIndexBackingStoreBase(tile_size * tiles_per_row_per_col,
+                                             tile_size * tiles_per_row_per_col,
+                                             4, true)
+    {}
+
+    virtual
+    void
+    set_data(int x, int y, int l, int w, int h,
+             fastuidraw::const_c_array<fastuidraw::ivec3> data,
+             int slack,
+             const fastuidraw::AtlasColorBackingStoreBase *c,
+             int color_tile_size)
+    {
+      FASTUIDRAWunused(x);
+      FASTUIDRAWunused(y);
+      FASTUIDRAWunused(l);
+      FASTUIDRAWunused(data);
+      FASTUIDRAWunused(slack);
+      FASTUIDRAWunused(c);
+      FASTUIDRAWunused(color_tile_size);
+      record_upload(w * h);
+    }
+
+    virtual
+    void
+    set_data(int x, int y, int l, int w, int h,
+             fastuidraw::const_c_array<fastuidraw::ivec3> data)
+    {
+      FASTUIDRAWunused(x);
+      FASTUIDRAWunused(y);
+      FASTUIDRAWunused(l);
+      FASTUIDRAWunused(data);
+      record_upload(w * h);
+    }
+
+    virtual
+    void
+    flush(void)
+    {
+      record(fastuidraw::glsl::PainterBackendHeadless::atlas_num_flushes);
+    }
+
+  protected:
+    virtual
+    void
+    resize_implement(int new_num_layers)
+    {
+      FASTUIDRAWunused(new_num_layers);
+      record(fastuidraw::glsl::PainterBackendHeadless::atlas_num_resizes);
+    }
+  };
+
+  class ColorStopStoreHeadless:
+    public fastuidraw::ColorStopBackingStore,
+    public store_stats
+  {
+  public:
+    ColorStopStoreHeadless(void):
+      fastuidraw::ColorStopBackingStore(1024, 32, true)
+    {}
+
+    virtual
+    void
+    set_data(int x, int l, int w,
+             fastuidraw::const_c_array<fastuidraw::u8vec4> data)
+    {
+      FASTUIDRAWunused(x);
+      FASTUIDRAWunused(l);
+      FASTUIDRAWunused(data);
+      record_upload(w);
+    }
+
+    virtual
+    void
+    flush(void)
+    {
+      record(fastuidraw::glsl::PainterBackendHeadless::atlas_num_flushes);
+    }
+
+  protected:
+    virtual
+    void
+    resize_implement(int new_num_layers)
+    {
+      FASTUIDRAWunused(new_num_layers);
+      record(fastuidraw::glsl::PainterBackendHeadless::atlas_num_resizes);
+    }
+  };
+
+  class ConfigurationHeadlessPrivate
+  {
+  public:
+    ConfigurationHeadlessPrivate(void):
+      m_attributes_per_buffer(512 * 512),
+      m_indices_per_buffer((m_attributes_per_buffer * 6) / 4),
+      m_data_blocks_per_store_buffer(1024 * 64),
+      m_break_on_shader_change(false),
+      m_separate_program_for_discard(true),
+      m_use_hw_clip_planes(true),
+      m_record_draw_data(false)
+    {}
+
+    unsigned int m_attributes_per_buffer;
+    unsigned int m_indices_per_buffer;
+    unsigned int m_data_blocks_per_store_buffer;
+    bool m_break_on_shader_change;
+    bool m_separate_program_for_discard;
+    bool m_use_hw_clip_planes;
+    bool m_record_draw_data;
+  };
+
+  /* host memory of a PainterDraw, reused between frames;
+     the pool is locked since a PainterDraw may be released
+     on the submission thread of a PainterPacker.
+   */
+  class HostBuffers
+  {
+  public:
+    std::vector<fastuidraw::PainterAttribute> m_attributes;
+    std::vector<uint32_t> m_header_attributes;
+    std::vector<fastuidraw::PainterIndex> m_indices;
+    std::vector<fastuidraw::generic_data> m_store;
+    std::vector<fastuidraw::glsl::PainterBackendHeadless::BreakRecord> m_breaks;
+  };
+
+  class HostBufferPool:
+    public fastuidraw::reference_counted<HostBufferPool>::default_base
+  {
+  public:
+    HostBufferPool(const fastuidraw::glsl::PainterBackendHeadless::ConfigurationHeadless &config,
+                   unsigned int alignment):
+      m_attributes_per_buffer(config.attributes_per_buffer()),
+      m_indices_per_buffer(config.indices_per_buffer()),
+      m_store_size(config.data_blocks_per_store_buffer() * alignment)
+    {}
+
+    ~HostBufferPool();
+
+    HostBuffers*
+    allocate(void);
+
+    void
+    release(HostBuffers *b)
+    {
+      fastuidraw::autolock_mutex m(m_mutex);
+      m_free.push_back(b);
+    }
+
+  private:
+    unsigned int m_attributes_per_buffer;
+    unsigned int m_indices_per_buffer;
+    unsigned int m_store_size;
+    fastuidraw::mutex m_mutex;
+    std::vector<HostBuffers*> m_free;
+  };
+
+  class PainterBackendHeadlessPrivate;
+
+  class DrawHeadless:public fastuidraw::PainterDraw
+  {
+  public:
+    DrawHeadless(const fastuidraw::reference_counted_ptr<HostBufferPool> &pool,
+                 PainterBackendHeadlessPrivate *log);
+
+    ~DrawHeadless();
+
+    virtual
+    void
+    draw_break(const fastuidraw::PainterShaderGroup &old_shaders,
+               const fastuidraw::PainterShaderGroup &new_shaders,
+               unsigned int attributes_written,
+               unsigned int indices_written) const;
+
+    virtual
+    void
+    draw(void) const;
+
+  protected:
+    virtual
+    void
+    unmap_implement(unsigned int attributes_written,
+                    unsigned int indices_written,
+                    unsigned int data_store_written) const;
+
+  private:
+    fastuidraw::reference_counted_ptr<HostBufferPool> m_pool;
+    HostBuffers *m_buffers;
+    PainterBackendHeadlessPrivate *m_log;
+    mutable unsigned int m_attributes_written, m_indices_written, m_store_written;
+  };
+
+  class PainterBackendHeadlessPrivate
+  {
+  public:
+    PainterBackendHeadlessPrivate(const fastuidraw::glsl::PainterBackendHeadless::ConfigurationHeadless &config,
+                                  fastuidraw::glsl::PainterBackendHeadless *p);
+
+    static
+    fastuidraw::reference_counted_ptr<fastuidraw::GlyphAtlas>
+    create_glyph_atlas(void);
+
+    static
+    fastuidraw::reference_counted_ptr<fastuidraw::ImageAtlas>
+    create_image_atlas(void);
+
+    static
+    fastuidraw::reference_counted_ptr<fastuidraw::ColorStopAtlas>
+    create_colorstop_atlas(void);
+
+    static
+    fastuidraw::glsl::PainterBackendGLSL::ConfigurationGLSL
+    create_config_glsl(const fastuidraw::glsl::PainterBackendHeadless::ConfigurationHeadless &config);
+
+    void
+    record_draw(const HostBuffers &buffers,
+                unsigned int attributes_written,
+                unsigned int indices_written,
+                unsigned int store_written);
+
+    fastuidraw::glsl::PainterBackendHeadless::ConfigurationHeadless m_config;
+    fastuidraw::reference_counted_ptr<HostBufferPool> m_pool;
+    fastuidraw::vecN<const store_stats*, fastuidraw::glsl::PainterBackendHeadless::number_atlas_stores> m_atlas_stats;
+
+    unsigned int m_number_frames;
+
+    /* dimensions of the image drawn to, (0, 0) when
+       drawing to the target surface
+     */
+    fastuidraw::ivec2 m_image_dimensions;
+    std::vector<fastuidraw::glsl::PainterBackendHeadless::DrawRecord> m_draws;
+    std::vector<fastuidraw::glsl::PainterBackendHeadless::BreakRecord> m_breaks;
+    std::vector<fastuidraw::PainterAttribute> m_attributes;
+    std::vector<uint32_t> m_header_attributes;
+    std::vector<fastuidraw::PainterIndex> m_indices;
+    std::vector<fastuidraw::generic_data> m_store;
+  };
+}
+
+////////////////////////////////////
+// HostBufferPool methods
+HostBufferPool::
+~HostBufferPool()
+{
+  for(unsigned int i = 0, endi = m_free.size(); i < endi; ++i)
+    {
+      FASTUIDRAWdelete(m_free[i]);
+    }
+}
+
+HostBuffers*
+HostBufferPool::
+allocate(void)
+{
+  HostBuffers *return_value(NULL);
+
+  {
+    fastuidraw::autolock_mutex m(m_mutex);
+    if(!m_free.empty())
+      {
+        return_value = m_free.back();
+        m_free.pop_back();
+      }
+  }
+
+  if(return_value == NULL)
+    {
+      return_value = FASTUIDRAWnew HostBuffers();
+      return_value->m_attributes.resize(m_attributes_per_buffer);
+      return_value->m_header_attributes.resize(m_attributes_per_buffer);
+      return_value->m_indices.resize(m_indices_per_buffer);
+      return_value->m_store.resize(m_store_size);
+    }
+  return_value->m_breaks.clear();
+  return return_value;
+}
+
+////////////////////////////////////
+// DrawHeadless methods
+DrawHeadless::
+DrawHeadless(const fastuidraw::reference_counted_ptr<HostBufferPool> &pool,
+             PainterBackendHeadlessPrivate *log):
+  m_pool(pool),
+  m_log(log),
+  m_attributes_written(0),
+  m_indices_written(0),
+  m_store_written(0)
+{
+  m_buffers = m_pool->allocate();
+  m_attributes = fastuidraw::make_c_array(m_buffers->m_attributes);
+  m_header_attributes = fastuidraw::make_c_array(m_buffers->m_header_attributes);
+  m_indices = fastuidraw::make_c_array(m_buffers->m_indices);
+  m_store = fastuidraw::make_c_array(m_buffers->m_store);
+}
+
+DrawHeadless::
+~DrawHeadless()
+{
+  m_pool->release(m_buffers);
+}
+
+void
+DrawHeadless::
+draw_break(const fastuidraw::PainterShaderGroup &old_shaders,
+           const fastuidraw::PainterShaderGroup &new_shaders,
+           unsigned int attributes_written,
+           unsigned int indices_written) const
+{
+  fastuidraw::glsl::PainterBackendHeadless::BreakRecord b;
+
+  FASTUIDRAWunused(old_shaders);
+  b.m_attributes_written = attributes_written;
+  b.m_indices_written = indices_written;
+  b.m_item_group = new_shaders.item_group();
+  b.m_blend_group = new_shaders.blend_group();
+  b.m_brush = new_shaders.brush();
+  b.m_blend_mode = new_shaders.packed_blend_mode();
+  m_buffers->m_breaks.push_back(b);
+}
+
+void
+DrawHeadless::
+unmap_implement(unsigned int attributes_written,
+                unsigned int indices_written,
+                unsigned int data_store_written) const
+{
+  m_attributes_written = attributes_written;
+  m_indices_written = indices_written;
+  m_store_written = data_store_written;
+}
+
+void
+DrawHeadless::
+draw(void) const
+{
+  m_log->record_draw(*m_buffers, m_attributes_written,
+                     m_indices_written, m_store_written);
+}
+
+/////////////////////////////////////////////
+// PainterBackendHeadlessPrivate methods
+PainterBackendHeadlessPrivate::
+PainterBackendHeadlessPrivate(const fastuidraw::glsl::PainterBackendHeadless::ConfigurationHeadless &config,
+                              fastuidraw::glsl::PainterBackendHeadless *p):
+  m_config(config),
+  m_number_frames(0),
+  m_image_dimensions(0, 0)
+{
+  m_pool = FASTUIDRAWnew HostBufferPool(m_config, p->configuration_base().alignment());
+
+  m_atlas_stats[fastuidraw::glsl::PainterBackendHeadless::glyph_texel_store]
+    = dynamic_cast<const store_stats*>(p->glyph_atlas()->texel_store().get());
+  m_atlas_stats[fastuidraw::glsl::PainterBackendHeadless::glyph_geometry_store]
+    = dynamic_cast<const store_stats*>(p->glyph_atlas()->geometry_store().get());
+  m_atlas_stats[fastuidraw::glsl::PainterBackendHeadless::image_color_store]
+    = dynamic_cast<const store_stats*>(p->image_atlas()->color_store().get());
+  m_atlas_stats[fastuidraw::glsl::PainterBackendHeadless::image_index_store]
+    = dynamic_cast<const store_stats*>(p->image_atlas()->index_store().get());
+  m_atlas_stats[fastuidraw::glsl::PainterBackendHeadless::colorstop_store]
+    = dynamic_cast<const store_stats*>(p->colorstop_atlas()->backing_store().get());
+}
+
+fastuidraw::reference_counted_ptr<fastuidraw::GlyphAtlas>
+PainterBackendHeadlessPrivate::
+create_glyph_atlas(void)
+{
+  return FASTUIDRAWnew fastuidraw::GlyphAtlas(FASTUIDRAWnew GlyphTexelStoreHeadless(),
+                                             FASTUIDRAWnew GlyphGeometryStoreHeadless());
+}
+
+fastuidraw::reference_counted_ptr<fastuidraw::ImageAtlas>
+PainterBackendHeadlessPrivate::
+create_image_atlas(void)
+{
+  /* same tile sizes and number of tiles as the
+     default values of gl::ImageAtlasGL::params
+   */
+  return FASTUIDRAWnew fastuidraw::ImageAtlas(1 << 5, 1 << 2,
+                                             FASTUIDRAWnew ColorStoreHeadless(1 << 5, 1 << 8),
+                                             FASTUIDRAWnew IndexStoreHeadless(1 << 2, 1 << 6));
+}
+
+fastuidraw::reference_counted_ptr<fastuidraw::ColorStopAtlas>
+PainterBackendHeadlessPrivate::
+create_colorstop_atlas(void)
+{
+  return FASTUIDRAWnew fastuidraw::ColorStopAtlas(FASTUIDRAWnew ColorStopStoreHeadless());
+}
+
+fastuidraw::glsl::PainterBackendGLSL::ConfigurationGLSL
+PainterBackendHeadlessPrivate::
+create_config_glsl(const fastuidraw::glsl::PainterBackendHeadless::ConfigurationHeadless &config)
+{
+  fastuidraw::glsl::PainterBackendGLSL::ConfigurationGLSL return_value;
+  return_value.use_hw_clip_planes(config.use_hw_clip_planes());
+  return return_value;
+}
+
+void
+PainterBackendHeadlessPrivate::
+record_draw(const HostBuffers &buffers,
+            unsigned int attributes_written,
+            unsigned int indices_written,
+            unsigned int store_written)
+{
+  fastuidraw::glsl::PainterBackendHeadless::DrawRecord R;
+
+  assert(m_number_frames > 0);
+  R.m_frame = m_number_frames - 1;
+  R.m_attributes_written = attributes_written;
+  R.m_indices_written = indices_written;
+  R.m_store_written = store_written;
+  R.m_image_dimensions = m_image_dimensions;
+
+  R.m_breaks.m_begin = m_breaks.size();
+  m_breaks.insert(m_breaks.end(), buffers.m_breaks.begin(), buffers.m_breaks.end());
+  R.m_breaks.m_end = m_breaks.size();
+
+  R.m_attribute_range.m_begin = R.m_attribute_range.m_end = m_attributes.size();
+  R.m_index_range.m_begin = R.m_index_range.m_end = m_indices.size();
+  R.m_store_range.m_begin = R.m_store_range.m_end = m_store.size();
+  if(m_config.record_draw_data())
+    {
+      m_attributes.insert(m_attributes.end(), buffers.m_attributes.begin(),
+                          buffers.m_attributes.begin() + attributes_written);
+      m_header_attributes.insert(m_header_attributes.end(), buffers.m_header_attributes.begin(),
+                                 buffers.m_header_attributes.begin() + attributes_written);
+      m_indices.insert(m_indices.end(), buffers.m_indices.begin(),
+                       buffers.m_indices.begin() + indices_written);
+      m_store.insert(m_store.end(), buffers.m_store.begin(),
+                     buffers.m_store.begin() + store_written);
+      R.m_attribute_range.m_end = m_attributes.size();
+      R.m_index_range.m_end = m_indices.size();
+      R.m_store_range.m_end = m_store.size();
+    }
+  m_draws.push_back(R);
+}
+
+///////////////////////////////////////////////
+// fastuidraw::glsl::PainterBackendHeadless::ConfigurationHeadless methods
+fastuidraw::glsl::PainterBackendHeadless::ConfigurationHeadless::
+ConfigurationHeadless(void)
+{
+  m_d = FASTUIDRAWnew ConfigurationHeadlessPrivate();
+}
+
+fastuidraw::glsl::PainterBackendHeadless::ConfigurationHeadless::
+ConfigurationHeadless(const ConfigurationHeadless &obj)
+{
+  ConfigurationHeadlessPrivate *d;
+  d = reinterpret_cast<ConfigurationHeadlessPrivate*>(obj.m_d);
+  m_d = FASTUIDRAWnew ConfigurationHeadlessPrivate(*d);
+}
+
+fastuidraw::glsl::PainterBackendHeadless::ConfigurationHeadless::
+~ConfigurationHeadless()
+{
+  ConfigurationHeadlessPrivate *d;
+  d = reinterpret_cast<ConfigurationHeadlessPrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = NULL;
+}
+
+fastuidraw::glsl::PainterBackendHeadless::ConfigurationHeadless&
+fastuidraw::glsl::PainterBackendHeadless::ConfigurationHeadless::
+operator=(const ConfigurationHeadless &rhs)
+{
+  if(this != &rhs)
+    {
+      ConfigurationHeadlessPrivate *d, *rhs_d;
+      d = reinterpret_cast<ConfigurationHeadlessPrivate*>(m_d);
+      rhs_d = reinterpret_cast<ConfigurationHeadlessPrivate*>(rhs.m_d);
+      *d = *rhs_d;
+    }
+  return *this;
+}
+
+#define setget_implement(type, name)                                    \
+  fastuidraw::glsl::PainterBackendHeadless::ConfigurationHeadless&      \
+  fastuidraw::glsl::PainterBackendHeadless::ConfigurationHeadless::     \
+  name(type v)                                                          \
+  {                                                                     \
+    ConfigurationHeadlessPrivate *d;                                    \
+    d = reinterpret_cast<ConfigurationHeadlessPrivate*>(m_d);           \
+    d->m_##name = v;                                                    \
+    return *this;                                                       \
+  }                                                                     \
+                                                                        \
+  type                                                                  \
+  fastuidraw::glsl::PainterBackendHeadless::ConfigurationHeadless::     \
+  name(void) const                                                      \
+  {                                                                     \
+    ConfigurationHeadlessPrivate *d;                                    \
+    d = reinterpret_cast<ConfigurationHeadlessPrivate*>(m_d);           \
+    return d->m_##name;                                                 \
+  }
+
+setget_implement(unsigned int, attributes_per_buffer)
+setget_implement(unsigned int, indices_per_buffer)
+setget_implement(unsigned int, data_blocks_per_store_buffer)
+setget_implement(bool, break_on_shader_change)
+setget_implement(bool, separate_program_for_discard)
+setget_implement(bool, use_hw_clip_planes)
+setget_implement(bool, record_draw_data)
+
+#undef setget_implement
+
+///////////////////////////////////////////////
+// fastuidraw::glsl::PainterBackendHeadless methods
+fastuidraw::glsl::PainterBackendHeadless::
+PainterBackendHeadless(const ConfigurationHeadless &config_headless,
+                       const ConfigurationBase &config_base):
+  PainterBackendGLSL(PainterBackendHeadlessPrivate::create_glyph_atlas(),
+                     PainterBackendHeadlessPrivate::create_image_atlas(),
+                     PainterBackendHeadlessPrivate::create_colorstop_atlas(),
+                     PainterBackendHeadlessPrivate::create_config_glsl(config_headless),
+                     config_base)
+{
+  m_d = FASTUIDRAWnew PainterBackendHeadlessPrivate(config_headless, this);
+  set_hints()
+    .thread_safe_submission(true)
+    .draw_to_image(true);
+}
+
+fastuidraw::glsl::PainterBackendHeadless::
+~PainterBackendHeadless()
+{
+  PainterBackendHeadlessPrivate *d;
+  d = reinterpret_cast<PainterBackendHeadlessPrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = NULL;
+}
+
+const fastuidraw::glsl::PainterBackendHeadless::ConfigurationHeadless&
+fastuidraw::glsl::PainterBackendHeadless::
+configuration_headless(void) const
+{
+  PainterBackendHeadlessPrivate *d;
+  d = reinterpret_cast<PainterBackendHeadlessPrivate*>(m_d);
+  return d->m_config;
+}
+
+unsigned int
+fastuidraw::glsl::PainterBackendHeadless::
+number_frames(void) const
+{
+  PainterBackendHeadlessPrivate *d;
+  d = reinterpret_cast<PainterBackendHeadlessPrivate*>(m_d);
+  return d->m_number_frames;
+}
+
+fastuidraw::const_c_array<fastuidraw::glsl::PainterBackendHeadless::DrawRecord>
+fastuidraw::glsl::PainterBackendHeadless::
+draws(void) const
+{
+  PainterBackendHeadlessPrivate *d;
+  d = reinterpret_cast<PainterBackendHeadlessPrivate*>(m_d);
+  return make_c_array(d->m_draws);
+}
+
+fastuidraw::const_c_array<fastuidraw::glsl::PainterBackendHeadless::BreakRecord>
+fastuidraw::glsl::PainterBackendHeadless::
+breaks(void) const
+{
+  PainterBackendHeadlessPrivate *d;
+  d = reinterpret_cast<PainterBackendHeadlessPrivate*>(m_d);
+  return make_c_array(d->m_breaks);
+}
+
+fastuidraw::const_c_array<fastuidraw::PainterAttribute>
+fastuidraw::glsl::PainterBackendHeadless::
+attribute_log(void) const
+{
+  PainterBackendHeadlessPrivate *d;
+  d = reinterpret_cast<PainterBackendHeadlessPrivate*>(m_d);
+  return make_c_array(d->m_attributes);
+}
+
+fastuidraw::const_c_array<uint32_t>
+fastuidraw::glsl::PainterBackendHeadless::
+header_attribute_log(void) const
+{
+  PainterBackendHeadlessPrivate *d;
+  d = reinterpret_cast<PainterBackendHeadlessPrivate*>(m_d);
+  return make_c_array(d->m_header_attributes);
+}
+
+fastuidraw::const_c_array<fastuidraw::PainterIndex>
+fastuidraw::glsl::PainterBackendHeadless::
+index_log(void) const
+{
+  PainterBackendHeadlessPrivate *d;
+  d = reinterpret_cast<PainterBackendHeadlessPrivate*>(m_d);
+  return make_c_array(d->m_indices);
+}
+
+fastuidraw::const_c_array<fastuidraw::generic_data>
+fastuidraw::glsl::PainterBackendHeadless::
+store_log(void) const
+{
+  PainterBackendHeadlessPrivate *d;
+  d = reinterpret_cast<PainterBackendHeadlessPrivate*>(m_d);
+  return make_c_array(d->m_store);
+}
+
+uint64_t
+fastuidraw::glsl::PainterBackendHeadless::
+query_atlas_stat(enum atlas_store_t store, enum atlas_stat_t st) const
+{
+  PainterBackendHeadlessPrivate *d;
+  d = reinterpret_cast<PainterBackendHeadlessPrivate*>(m_d);
+  return d->m_atlas_stats[store]->m_stats[st];
+}
+
+void
+fastuidraw::glsl::PainterBackendHeadless::
+clear_log(void)
+{
+  PainterBackendHeadlessPrivate *d;
+  d = reinterpret_cast<PainterBackendHeadlessPrivate*>(m_d);
+
+  d->m_number_frames = 0;
+  d->m_draws.clear();
+  d->m_breaks.clear();
+  d->m_attributes.clear();
+  d->m_header_attributes.clear();
+  d->m_indices.clear();
+  d->m_store.clear();
+  for(unsigned int i = 0; i < number_atlas_stores; ++i)
+    {
+      d->m_atlas_stats[i]->m_stats = atlas_stats(0);
+    }
+}
+
+void
+fastuidraw::glsl::PainterBackendHeadless::
+save_log(std::ostream &str) const
+{
+  PainterBackendHeadlessPrivate *d;
+  d = reinterpret_cast<PainterBackendHeadlessPrivate*>(m_d);
+
+  const char *store_names[number_atlas_stores] =
+    {
+      "glyph_texel_store",
+      "glyph_geometry_store",
+      "image_color_store",
+      "image_index_store",
+      "colorstop_store",
+    };
+
+  str << "frames " << d->m_number_frames << "\n";
+  for(unsigned int i = 0, endi = d->m_draws.size(); i < endi; ++i)
+    {
+      const DrawRecord &R(d->m_draws[i]);
+
+      str << "draw " << R.m_frame << " " << R.m_attributes_written
+          << " " << R.m_indices_written << " " << R.m_store_written;
+      if(R.m_image_dimensions != ivec2(0, 0))
+        {
+          str << " image " << R.m_image_dimensions.x()
+              << " " << R.m_image_dimensions.y();
+        }
+      str << "\n";
+
+      for(unsigned int b = R.m_breaks.m_begin; b < R.m_breaks.m_end; ++b)
+        {
+          const BreakRecord &B(d->m_breaks[b]);
+          str << "break " << B.m_attributes_written << " " << B.m_indices_written
+              << " " << B.m_item_group << " " << B.m_blend_group
+              << " " << B.m_brush << " " << B.m_blend_mode << "\n";
+        }
+
+      for(unsigned int a = R.m_attribute_range.m_begin; a < R.m_attribute_range.m_end; ++a)
+        {
+          const PainterAttribute &A(d->m_attributes[a]);
+          str << "attribute";
+          for(unsigned int k = 0; k < 4; ++k)
+            {
+              str << " " << A.m_attrib0[k];
+            }
+          for(unsigned int k = 0; k < 4; ++k)
+            {
+              str << " " << A.m_attrib1[k];
+            }
+          for(unsigned int k = 0; k < 4; ++k)
+            {
+              str << " " << A.m_attrib2[k];
+            }
+          str << " " << d->m_header_attributes[a] << "\n";
+        }
+
+      for(unsigned int v = R.m_index_range.m_begin; v < R.m_index_range.m_end; ++v)
+        {
+          str << "index " << d->m_indices[v] << "\n";
+        }
+
+      for(unsigned int v = R.m_store_range.m_begin; v < R.m_store_range.m_end; ++v)
+        {
+          str << "store " << d->m_store[v].u << "\n";
+        }
+    }
+
+  for(unsigned int i = 0; i < number_atlas_stores; ++i)
+    {
+      const atlas_stats &S(d->m_atlas_stats[i]->m_stats);
+      str << "atlas " << store_names[i]
+          << " " << S[atlas_num_uploads]
+          << " " << S[atlas_num_values_uploaded]
+          << " " << S[atlas_num_flushes]
+          << " " << S[atlas_num_resizes] << "\n";
+    }
+}
+
+void
+fastuidraw::glsl::PainterBackendHeadless::
+on_pre_draw(void)
+{
+  PainterBackendHeadlessPrivate *d;
+  d = reinterpret_cast<PainterBackendHeadlessPrivate*>(m_d);
+
+  /* the atlases are flushed by PainterPacker before drawing,
+     see PerformanceHints::thread_safe_submission()
+   */
+  ++d->m_number_frames;
+}
+
+void
+fastuidraw::glsl::PainterBackendHeadless::
+on_post_draw(void)
+{
+}
+
+void
+fastuidraw::glsl::PainterBackendHeadless::
+begin_draw_to_image(const reference_counted_ptr<const Image> &image)
+{
+  PainterBackendHeadlessPrivate *d;
+  d = reinterpret_cast<PainterBackendHeadlessPrivate*>(m_d);
+
+  assert(image);
+  assert(d->m_image_dimensions == ivec2(0, 0));
+  d->m_image_dimensions = image->dimensions();
+}
+
+void
+fastuidraw::glsl::PainterBackendHeadless::
+end_draw_to_image(void)
+{
+  PainterBackendHeadlessPrivate *d;
+  d = reinterpret_cast<PainterBackendHeadlessPrivate*>(m_d);
+  d->m_image_dimensions = ivec2(0, 0);
+}
+
+fastuidraw::reference_counted_ptr<const fastuidraw::PainterDraw>
+fastuidraw::glsl::PainterBackendHeadless::
+map_draw(void)
+{
+  PainterBackendHeadlessPrivate *d;
+  d = reinterpret_cast<PainterBackendHeadlessPrivate*>(m_d);
+  return FASTUIDRAWnew DrawHeadless(d->m_pool, d);
+}
+
+uint32_t
+fastuidraw::glsl::PainterBackendHeadless::
+compute_item_shader_group(PainterShader::Tag tag,
+                          const reference_counted_ptr<PainterItemShader> &shader)
+{
+  uint32_t return_value;
+
+  return_value = (configuration_headless().break_on_shader_change()) ? tag.m_ID : 0u;
+  return_value |= (shader_group_discard_mask & tag.m_group);
+  if(configuration_headless().separate_program_for_discard())
+    {
+      const PainterItemShaderGLSL *sh;
+      sh = dynamic_cast<const PainterItemShaderGLSL*>(shader.get());
+      if(sh && sh->uses_discard())
+        {
+          return_value |= shader_group_discard_mask;
+        }
+    }
+  return return_value;
+}
+
+uint32_t
+fastuidraw::glsl::PainterBackendHeadless::
+compute_blend_shader_group(PainterShader::Tag tag,
+                           const reference_counted_ptr<PainterBlendShader> &shader)
+{
+  FASTUIDRAWunused(shader);
+  return (configuration_headless().break_on_shader_change()) ? tag.m_ID : 0u;
+}
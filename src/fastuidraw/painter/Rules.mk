@@ -13,6 +13,7 @@ LIBRARY_SOURCES += $(call filelist, \
 	painter_attribute_data.cpp \
 	painter_attribute_data_filler_path_fill.cpp \
 	painter_attribute_data_filler_glyphs.cpp \
+	painter_glyph_chunks.cpp \
 	painter_brush.cpp painter_stroke_params.cpp \
 	painter_dashed_stroke_params.cpp \
 	painter.cpp painter_enums.cpp \
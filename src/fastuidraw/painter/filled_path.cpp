@@ -19,9 +19,11 @@
 
 #include <vector>
 #include <map>
+#include <iostream>
 #include <list>
 #include <algorithm>
 #include <math.h>
+#include <boost/atomic.hpp>
 
 #include <fastuidraw/tessellated_path.hpp>
 #include <fastuidraw/path.hpp>
@@ -29,6 +31,7 @@
 #include <fastuidraw/painter/painter_attribute_data.hpp>
 #include <fastuidraw/painter/painter_attribute_data_filler_path_fill.hpp>
 #include "../private/util_private.hpp"
+#include "../private/path_util_private.hpp"
 #include "../../3rd_party/glu-tess/glu-tess.hpp"
 
 namespace
@@ -382,7 +385,10 @@ namespace
     fastuidraw::const_c_array<unsigned int> m_nonzero_winding, m_odd_winding;
     fastuidraw::const_c_array<unsigned int> m_even_winding, m_zero_winding;
 
-    fastuidraw::PainterAttributeData *m_attribute_data;
+    /* made on first use by painter_data(), with m_mutex locked
+     */
+    boost::atomic<fastuidraw::PainterAttributeData*> m_attribute_data;
+    boost::mutex m_mutex;
   };
 }
 
@@ -413,9 +419,10 @@ void
 point_hoard::
 generate_path(const fastuidraw::TessellatedPath &input, path &output)
 {
+  std::vector<fastuidraw::TessellatedPath::point> work_room;
   fastuidraw::const_c_array<fastuidraw::TessellatedPath::point> pts;
 
-  pts = input.point_data();
+  pts = fastuidraw::detail::point_data(input, work_room);
   output.clear();
   output.reserve(input.number_contours());
   for(unsigned int o = 0, endo = input.number_contours(); o < endo; ++o)
@@ -975,9 +982,9 @@ FilledPathPrivate(const fastuidraw::TessellatedPath &P):
 FilledPathPrivate::
 ~FilledPathPrivate()
 {
-  if(m_attribute_data != NULL)
+  if(m_attribute_data.load() != NULL)
     {
-      FASTUIDRAWdelete(m_attribute_data);
+      FASTUIDRAWdelete(m_attribute_data.load());
     }
 }
 
@@ -1027,12 +1034,20 @@ painter_data(void) const
      handle at ctor time is very bad. This is one of the reasons
      why it must be made lazily and not at ctor.
    */
-  if(d->m_attribute_data == NULL)
+  PainterAttributeData *p;
+  p = d->m_attribute_data.load(boost::memory_order_acquire);
+  if(p == NULL)
     {
-      d->m_attribute_data = FASTUIDRAWnew PainterAttributeData();
-      d->m_attribute_data->set_data(PainterAttributeDataFillerPathFill(this));
+      boost::lock_guard<boost::mutex> lock(d->m_mutex);
+      p = d->m_attribute_data.load(boost::memory_order_relaxed);
+      if(p == NULL)
+        {
+          p = FASTUIDRAWnew PainterAttributeData();
+          p->set_data(PainterAttributeDataFillerPathFill(this));
+          d->m_attribute_data.store(p, boost::memory_order_release);
+        }
     }
-  return *d->m_attribute_data;
+  return *p;
 }
 
 fastuidraw::const_c_array<fastuidraw::vec2>
@@ -4,7 +4,8 @@ dirstack_$(sp)	:= $(d)
 d		:= $(dir)
 # End standard header
 
-LIBRARY_SOURCES += $(call filelist, painter_backend.cpp painter_draw.cpp painter_packer.cpp)
+LIBRARY_SOURCES += $(call filelist, painter_backend.cpp painter_draw.cpp painter_packer.cpp \
+	painter_static_attribute_data.cpp)
 
 # Begin standard footer
 d		:= $(dirstack_$(sp))
@@ -25,10 +25,14 @@ namespace
   {
   public:
     PerformanceHintsPrivate(void):
-      m_clipping_via_hw_clip_planes(true)
+      m_clipping_via_hw_clip_planes(true),
+      m_thread_safe_submission(false),
+      m_draw_to_image(false)
     {}
 
     bool m_clipping_via_hw_clip_planes;
+    bool m_thread_safe_submission;
+    bool m_draw_to_image;
   };
 
   class PainterBackendPrivate
@@ -105,6 +109,44 @@ clipping_via_hw_clip_planes(bool v)
   return *this;
 }
 
+bool
+fastuidraw::PainterBackend::PerformanceHints::
+thread_safe_submission(void) const
+{
+  PerformanceHintsPrivate *d;
+  d = static_cast<PerformanceHintsPrivate*>(m_d);
+  return d->m_thread_safe_submission;
+}
+
+fastuidraw::PainterBackend::PerformanceHints&
+fastuidraw::PainterBackend::PerformanceHints::
+thread_safe_submission(bool v)
+{
+  PerformanceHintsPrivate *d;
+  d = static_cast<PerformanceHintsPrivate*>(m_d);
+  d->m_thread_safe_submission = v;
+  return *this;
+}
+
+bool
+fastuidraw::PainterBackend::PerformanceHints::
+draw_to_image(void) const
+{
+  PerformanceHintsPrivate *d;
+  d = static_cast<PerformanceHintsPrivate*>(m_d);
+  return d->m_draw_to_image;
+}
+
+fastuidraw::PainterBackend::PerformanceHints&
+fastuidraw::PainterBackend::PerformanceHints::
+draw_to_image(bool v)
+{
+  PerformanceHintsPrivate *d;
+  d = static_cast<PerformanceHintsPrivate*>(m_d);
+  d->m_draw_to_image = v;
+  return *this;
+}
+
 ///////////////////////////////////////////////////
 // fastuidraw::PainterBackend::ConfigurationBase methods
 fastuidraw::PainterBackend::ConfigurationBase::
@@ -385,3 +427,26 @@ configuration_base(void) const
   d = reinterpret_cast<PainterBackendPrivate*>(m_d);
   return d->m_config;
 }
+
+fastuidraw::reference_counted_ptr<const fastuidraw::PainterStaticAttributeData>
+fastuidraw::PainterBackend::
+create_static_attribute_data(const PainterAttributeData &data,
+                             const_c_array<unsigned int> attrib_chunk_selector)
+{
+  return FASTUIDRAWnew PainterStaticAttributeData(data, attrib_chunk_selector);
+}
+
+void
+fastuidraw::PainterBackend::
+begin_draw_to_image(const reference_counted_ptr<const Image> &image)
+{
+  FASTUIDRAWunused(image);
+  assert(!"PainterBackend::begin_draw_to_image() called on a backend that cannot draw to images");
+}
+
+void
+fastuidraw::PainterBackend::
+end_draw_to_image(void)
+{
+  assert(!"PainterBackend::end_draw_to_image() called on a backend that cannot draw to images");
+}
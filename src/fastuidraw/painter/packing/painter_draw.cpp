@@ -122,6 +122,22 @@ fastuidraw::PainterDraw::
   m_d = NULL;
 }
 
+void
+fastuidraw::PainterDraw::
+draw_static(const reference_counted_ptr<const PainterStaticAttributeData> &data,
+            const_c_array<range_type<unsigned int> > index_ranges,
+            uint32_t header_location,
+            unsigned int attributes_written,
+            unsigned int indices_written) const
+{
+  FASTUIDRAWunused(data);
+  FASTUIDRAWunused(index_ranges);
+  FASTUIDRAWunused(header_location);
+  FASTUIDRAWunused(attributes_written);
+  FASTUIDRAWunused(indices_written);
+  assert(!"PainterDraw::draw_static() called on a PainterDraw that does not support it");
+}
+
 void
 fastuidraw::PainterDraw::
 add_action(const reference_counted_ptr<DelayedAction> &h) const
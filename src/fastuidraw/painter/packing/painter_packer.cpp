@@ -20,7 +20,12 @@
 
 #include <vector>
 #include <list>
+#include <map>
 #include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <ostream>
+#include <iostream>
 
 #include <fastuidraw/painter/packing/painter_packer.hpp>
 #include <fastuidraw/painter/painter_header.hpp>
@@ -55,6 +60,52 @@ namespace
     return default_value;
   }
 
+  bool
+  blend_op_independent_of_dst(enum fastuidraw::BlendMode::op_t op)
+  {
+    return op == fastuidraw::BlendMode::ADD
+      || op == fastuidraw::BlendMode::SUBTRACT
+      || op == fastuidraw::BlendMode::REVERSE_SUBTRACT;
+  }
+
+  bool
+  blend_func_independent_of_dst(enum fastuidraw::BlendMode::func_t f)
+  {
+    return f != fastuidraw::BlendMode::DST_COLOR
+      && f != fastuidraw::BlendMode::ONE_MINUS_DST_COLOR
+      && f != fastuidraw::BlendMode::DST_ALPHA
+      && f != fastuidraw::BlendMode::ONE_MINUS_DST_ALPHA
+      && f != fastuidraw::BlendMode::SRC_ALPHA_SATURATE;
+  }
+
+  /* returns true if the color written by an item does not
+     depend on the contents of the framebuffer, i.e. the
+     item is opaque with respect to what is underneath it.
+   */
+  bool
+  blend_independent_of_dst(const fastuidraw::reference_counted_ptr<fastuidraw::PainterBlendShader> &shader,
+                           fastuidraw::BlendMode::packed_value packed_mode)
+  {
+    fastuidraw::BlendMode mode(packed_mode);
+
+    if(shader && shader->type() == fastuidraw::PainterBlendShader::framebuffer_fetch)
+      {
+        return false;
+      }
+
+    if(!mode.blending_on())
+      {
+        return true;
+      }
+
+    return blend_op_independent_of_dst(mode.equation_rgb())
+      && blend_op_independent_of_dst(mode.equation_alpha())
+      && mode.func_dst_rgb() == fastuidraw::BlendMode::ZERO
+      && mode.func_dst_alpha() == fastuidraw::BlendMode::ZERO
+      && blend_func_independent_of_dst(mode.func_src_rgb())
+      && blend_func_independent_of_dst(mode.func_src_alpha());
+  }
+
   class PainterShaderGroupPrivate:
     public fastuidraw::PainterShaderGroup,
     public PainterShaderGroupValues
@@ -67,6 +118,11 @@ namespace
       PainterShaderGroupValues(obj)
     {}
 
+    explicit
+    PainterShaderGroupPrivate(const PainterShaderGroupValues &obj):
+      PainterShaderGroupValues(obj)
+    {}
+
     void
     operator=(const PainterShaderGroupPrivate &obj)
     {
@@ -156,12 +212,22 @@ namespace
 
     EntryBase(void):
       m_raw_value(NULL),
-      m_pool_slot(-1)
+      m_pool_slot(-1),
+      m_arena_generation(NULL),
+      m_generation(0)
     {}
 
     void
     aquire(void)
     {
+      /* entries of an arena are not reference counted,
+         they are all released by PainterPackedValuePool::end_arena()
+       */
+      if(m_arena_generation)
+        {
+          return;
+        }
+
       assert(m_pool);
       assert(m_pool_slot >= 0);
       m_count.add_reference();
@@ -170,6 +236,11 @@ namespace
     void
     release(void)
     {
+      if(m_arena_generation)
+        {
+          return;
+        }
+
       assert(m_pool);
       assert(m_pool_slot >= 0);
       if(m_count.remove_reference())
@@ -180,9 +251,19 @@ namespace
         }
     }
 
+    /* returns false if the entry is from an arena
+       that has ended since the entry was made
+     */
+    bool
+    valid(void) const
+    {
+      return !m_arena_generation || *m_arena_generation == m_generation;
+    }
+
     const void*
     raw_value(void)
     {
+      assert(valid());
       return m_raw_value;
     }
 
@@ -209,6 +290,13 @@ namespace
     fastuidraw::reference_counted_ptr<PoolBase> m_pool;
     int m_pool_slot;
 
+    /* non-NULL if the entry is from an arena; the entry is
+       valid as long as the generation of the arena is the
+       generation when the entry was made
+     */
+    const unsigned int *m_arena_generation;
+    unsigned int m_generation;
+
   private:
     /* Entry reference count is not thread safe because
        the objects themselves are not.
@@ -232,19 +320,41 @@ namespace
       assert(slot >= 0);
 
       m_pool = p;
-      m_state = st;
       m_pool_slot = slot;
+      this->m_arena_generation = NULL;
+      set_state(st, alignment);
+    }
+
+    void
+    set_arena(const T &st, int alignment, const unsigned int *generation)
+    {
+      assert(generation);
+
+      this->m_arena_generation = generation;
+      this->m_generation = *generation;
+      set_state(st, alignment);
+    }
+
+    T m_state;
 
+  private:
+    void
+    set_state(const T &st, int alignment)
+    {
+      m_state = st;
       this->m_begin_id = -1;
       this->m_draw_command_id = 0;
       this->m_offset = 0;
       this->m_painter = NULL;
       this->m_alignment = alignment;
+
+      /* an Entry of an arena is reused each arena, thus
+         after the first arena, resizing m_data does not
+         allocate.
+       */
       this->m_data.resize(m_state.data_size(alignment));
       m_state.pack_data(alignment, fastuidraw::make_c_array(this->m_data));
     }
-
-    T m_state;
   };
 
   template<typename T>
@@ -302,394 +412,2051 @@ namespace
     std::vector<fastuidraw::reference_counted_ptr<Pool<T> > > m_pools;
   };
 
+  /* An ArenaSet hands out the Entry objects in order from
+     slabs that are kept (and reused) across arenas; clear()
+     releases all of the entries at once.
+   */
+  template<typename T>
+  class ArenaSet:fastuidraw::noncopyable
+  {
+  public:
+    ArenaSet(void):
+      m_next(0)
+    {}
+
+    ~ArenaSet()
+    {
+      for(unsigned int i = 0, endi = m_slabs.size(); i < endi; ++i)
+        {
+          FASTUIDRAWdelete(m_slabs[i]);
+        }
+    }
+
+    Entry<T>*
+    allocate(const T &st, int alignment, const unsigned int *generation)
+    {
+      unsigned int slab, slot;
+      Entry<T> *return_value;
+
+      slab = m_next / PoolBase::pool_size;
+      slot = m_next % PoolBase::pool_size;
+      if(slab == m_slabs.size())
+        {
+          m_slabs.push_back(FASTUIDRAWnew Slab());
+        }
+      ++m_next;
+
+      return_value = &(*m_slabs[slab])[slot];
+      return_value->set_arena(st, alignment, generation);
+      return return_value;
+    }
+
+    void
+    clear(void)
+    {
+      m_next = 0;
+    }
+
+  private:
+    typedef fastuidraw::vecN<Entry<T>, PoolBase::pool_size> Slab;
+
+    std::vector<Slab*> m_slabs;
+    unsigned int m_next;
+  };
+
+  template<typename T>
+  class PoolAndArena
+  {
+  public:
+    Entry<T>*
+    allocate(const T &st, int alignment, bool use_arena,
+             const unsigned int *generation)
+    {
+      return (use_arena) ?
+        m_arena.allocate(st, alignment, generation) :
+        m_pool.allocate(st, alignment);
+    }
+
+    PoolSet<T> m_pool;
+    ArenaSet<T> m_arena;
+  };
+
   class PainterPackedValuePoolPrivate
   {
   public:
     explicit
     PainterPackedValuePoolPrivate(int d):
-      m_alignment(d)
+      m_alignment(d),
+      m_arena_active(false),
+      m_arena_generation(0)
     {}
 
+    template<typename T>
+    Entry<T>*
+    allocate(PoolAndArena<T> &pool, const T &value)
+    {
+      return pool.allocate(value, m_alignment, m_arena_active, &m_arena_generation);
+    }
+
     int m_alignment;
+    bool m_arena_active;
+    unsigned int m_arena_generation;
+
+    PoolAndArena<fastuidraw::PainterBrush> m_brush_pool;
+    PoolAndArena<fastuidraw::PainterClipEquations> m_clip_equations_pool;
+    PoolAndArena<fastuidraw::PainterItemMatrix> m_item_matrix_pool;
+    PoolAndArena<fastuidraw::PainterItemShaderData> m_item_shader_data_pool;
+    PoolAndArena<fastuidraw::PainterBlendShaderData> m_blend_shader_data_pool;
+  };
+
+  /* the number of attributes, indices and generic_data
+     values of the store of a draw command; a value of 0
+     stands for no limit.
+   */
+  class DrawRoom
+  {
+  public:
+    DrawRoom(void):
+      m_attributes(0),
+      m_indices(0),
+      m_store(0)
+    {}
 
-    PoolSet<fastuidraw::PainterBrush> m_brush_pool;
-    PoolSet<fastuidraw::PainterClipEquations> m_clip_equations_pool;
-    PoolSet<fastuidraw::PainterItemMatrix> m_item_matrix_pool;
-    PoolSet<fastuidraw::PainterItemShaderData> m_item_shader_data_pool;
-    PoolSet<fastuidraw::PainterBlendShaderData> m_blend_shader_data_pool;
+    unsigned int m_attributes, m_indices, m_store;
   };
 
-  class painter_state_location
+  /* host memory backing of a RecordedDraw; the memory is
+     kept by the PainterRecording for reuse across recordings.
+   */
+  class RecordedStorage
   {
   public:
-    uint32_t m_clipping_data_loc;
-    uint32_t m_item_matrix_data_loc;
-    uint32_t m_brush_shader_data_loc;
-    uint32_t m_item_shader_data_loc;
-    uint32_t m_blend_shader_data_loc;
+    std::vector<fastuidraw::PainterAttribute> m_attributes;
+    std::vector<uint32_t> m_header_attributes;
+    std::vector<fastuidraw::PainterIndex> m_indices;
+    std::vector<fastuidraw::generic_data> m_store;
   };
 
-  class PainterPackerPrivate;
+  /* bounding box, in clip coordinates, of the region
+     an item may draw to, see PainterPacker::item_bounds()
+   */
+  class ItemBounds
+  {
+  public:
+    ItemBounds(void):
+      m_has_bounds(false),
+      m_occluder(false),
+      m_min(0.0f, 0.0f),
+      m_max(0.0f, 0.0f),
+      m_item(0)
+    {}
 
-  class per_draw_command
+    /* if false, the item may draw anywhere
+     */
+    bool m_has_bounds;
+
+    /* if true, the item draws every pixel of
+       [m_min, m_max] opaquely
+     */
+    bool m_occluder;
+
+    fastuidraw::vec2 m_min, m_max;
+
+    /* the items are numbered in the order they are drawn,
+       all headers added by one call to draw_generic()
+       have the same value
+     */
+    unsigned int m_item;
+  };
+
+  /* An OcclusionGrid records which cells of a coarse grid
+     over the clip coordinates [-1, 1]x[-1, 1] are fully
+     covered by opaque items.
+   */
+  class OcclusionGrid
   {
   public:
-    per_draw_command(const fastuidraw::reference_counted_ptr<const fastuidraw::PainterDraw> &r,
-                     const fastuidraw::PainterBackend::ConfigurationBase &config);
+    enum
+      {
+        grid_size = 64
+      };
 
-    unsigned int
-    attribute_room(void)
+    void
+    clear(void)
     {
-      assert(m_attributes_written <= m_draw_command->m_attributes.size());
-      return m_draw_command->m_attributes.size() - m_attributes_written;
+      std::fill(m_rows.begin(), m_rows.end(), uint64_t(0));
     }
 
-    unsigned int
-    index_room(void)
-    {
-      assert(m_indices_written <= m_draw_command->m_indices.size());
-      return m_draw_command->m_indices.size() - m_indices_written;
-    }
+    /* mark the cells that are entirely within [pmin, pmax]
+     */
+    void
+    add_occluder(const fastuidraw::vec2 &pmin, const fastuidraw::vec2 &pmax);
 
-    unsigned int
-    store_room(void)
+    /* returns true if every cell that intersects
+       [pmin, pmax] is covered
+     */
+    bool
+    covered(const fastuidraw::vec2 &pmin, const fastuidraw::vec2 &pmax) const;
+
+  private:
+    static
+    int
+    cell_floor(float v)
     {
-      unsigned int s;
-      s = store_written();
-      assert(s <= m_draw_command->m_store.size());
-      return m_draw_command->m_store.size() - s;
+      return static_cast<int>(std::floor((v + 1.0f) * 0.5f * float(grid_size)));
     }
 
-    unsigned int
-    store_written(void)
+    static
+    int
+    cell_ceil(float v)
     {
-      return current_block() * m_alignment;
+      return static_cast<int>(std::ceil((v + 1.0f) * 0.5f * float(grid_size)));
     }
 
-    void
-    unmap(void)
+    static
+    uint64_t
+    row_mask(int begin, int end)
     {
-      m_draw_command->unmap(m_attributes_written, m_indices_written, store_written());
+      uint64_t r;
+
+      assert(0 <= begin && begin < end && end <= grid_size);
+      r = (end - begin == grid_size) ? ~uint64_t(0) : ((uint64_t(1) << (end - begin)) - uint64_t(1));
+      return r << begin;
     }
 
-    void
-    pack_painter_state(const fastuidraw::PainterPackerData &state,
-                       PainterPackerPrivate *p, painter_state_location &out_data);
+    fastuidraw::vecN<uint64_t, grid_size> m_rows;
+  };
 
-    unsigned int
-    pack_header(unsigned int header_size,
-                uint32_t brush_shader,
-                const fastuidraw::reference_counted_ptr<fastuidraw::PainterBlendShader> &blend_shader,
-                uint64_t blend_mode,
-                const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &item_shader,
-                unsigned int z,
-                const painter_state_location &loc,
-                const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back);
+  class RecordedHeader
+  {
+  public:
+    /* location, in blocks, of the header in the store
+     */
+    unsigned int m_location;
 
-    fastuidraw::reference_counted_ptr<const fastuidraw::PainterDraw> m_draw_command;
+    /* number attributes and indices written before
+       the header was added
+     */
     unsigned int m_attributes_written, m_indices_written;
 
-  private:
-    fastuidraw::c_array<fastuidraw::generic_data>
-    allocate_store(unsigned int num_elements);
+    /* shader groups of the header
+     */
+    PainterShaderGroupValues m_group;
 
-    unsigned int
-    current_block(void)
+    /* true if the blending of the header does not
+       read the framebuffer, see blend_independent_of_dst()
+     */
+    bool m_dst_independent;
+
+    /* bounds of the item of the header
+     */
+    ItemBounds m_bounds;
+
+    /* set by PainterPackerPrivate::compute_occlusion() if
+       the header is hidden by opaque items drawn after it
+     */
+    bool m_hidden;
+  };
+
+  class RecordedDraw:public fastuidraw::PainterDraw
+  {
+  public:
+    explicit
+    RecordedDraw(RecordedStorage *storage):
+      m_attributes_written(0),
+      m_indices_written(0),
+      m_store_written(0)
     {
-      return m_store_blocks_written;
+      m_attributes = fastuidraw::make_c_array(storage->m_attributes);
+      m_header_attributes = fastuidraw::make_c_array(storage->m_header_attributes);
+      m_indices = fastuidraw::make_c_array(storage->m_indices);
+      m_store = fastuidraw::make_c_array(storage->m_store);
     }
 
+    virtual
     void
-    pack_state_data(PainterPackerPrivate *p, EntryBase *st_d, uint32_t &location);
+    draw_break(const fastuidraw::PainterShaderGroup&,
+               const fastuidraw::PainterShaderGroup&,
+               unsigned int, unsigned int) const
+    {
+      /* the breaks are recomputed from m_headers when spliced
+       */
+    }
 
-    template<typename T>
+    virtual
     void
-    pack_state_data_from_value(const T &st, uint32_t &location)
+    draw(void) const
     {
-      fastuidraw::c_array<fastuidraw::generic_data> dst;
-      unsigned int data_sz;
+      assert(!"A RecordedDraw cannot be drawn, it must be spliced");
+    }
 
-      location = current_block();
-      data_sz = st.data_size(m_alignment);
-      dst = allocate_store(data_sz);
-      st.pack_data(m_alignment, dst);
+    /* the attributes and indices of the header h are those
+       written from m_headers[h].m_attributes_written and
+       m_headers[h].m_indices_written up to these values.
+     */
+    unsigned int
+    attributes_end(unsigned int h) const
+    {
+      return (h + 1 < m_headers.size()) ? m_headers[h + 1].m_attributes_written : m_attributes_written;
     }
 
-    template<typename T>
-    void
-    pack_state_data(PainterPackerPrivate *p,
-                    const fastuidraw::PainterData::value<T> &obj,
-                    uint32_t &location)
+    unsigned int
+    indices_end(unsigned int h) const
     {
-      if(obj.m_packed_value)
-        {
-          EntryBase *e;
-          e = reinterpret_cast<EntryBase*>(obj.m_packed_value.opaque_data());
-          pack_state_data(p, e, location);
-        }
-      else if(obj.m_value != NULL)
-        {
-          pack_state_data_from_value(*obj.m_value, location);
-        }
-      else
-        {
-          static T v;
-          pack_state_data_from_value(v, location);
-        }
+      return (h + 1 < m_headers.size()) ? m_headers[h + 1].m_indices_written : m_indices_written;
     }
 
-    unsigned int m_store_blocks_written;
-    unsigned int m_alignment;
-    uint32_t m_brush_shader_mask;
-    PainterShaderGroupPrivate m_prev_state;
-    fastuidraw::BlendMode m_prev_blend_mode;
-  };
+    std::vector<RecordedHeader> m_headers;
+    mutable unsigned int m_attributes_written, m_indices_written, m_store_written;
 
-  class PainterPackerPrivateWorkroom
-  {
-  public:
-    std::vector<unsigned int> m_attribs_loaded;
+    /* the distinct locations of the item matrices used
+       by the headers and for each header the index into
+       m_matrix_locations of its item matrix, filled when
+       the recording ends
+     */
+    std::vector<unsigned int> m_matrix_locations;
+    std::vector<unsigned int> m_header_matrix_index;
+
+    /* the Images and color stops of the brushes used by the
+       headers; the store holds their locations on the ImageAtlas
+       and ColorStopAtlas, which stay valid only as long as the
+       Images and ColorStopSequenceOnAtlas objects exist.
+     */
+    std::vector<fastuidraw::reference_counted_ptr<const fastuidraw::Image> > m_images;
+    std::vector<fastuidraw::reference_counted_ptr<const fastuidraw::ColorStopSequenceOnAtlas> > m_color_stops;
+
+  protected:
+    virtual
+    void
+    unmap_implement(unsigned int attributes_written,
+                    unsigned int indices_written,
+                    unsigned int data_store_written) const
+    {
+      m_attributes_written = attributes_written;
+      m_indices_written = indices_written;
+      m_store_written = data_store_written;
+    }
   };
 
-  class PainterPackerPrivate
+  class PainterRecordingPrivate
   {
   public:
-    explicit
-    PainterPackerPrivate(fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> backend,
-                         fastuidraw::PainterPacker *p);
+    PainterRecordingPrivate(unsigned int attributes_per_buffer,
+                            unsigned int indices_per_buffer,
+                            unsigned int data_blocks_per_store_buffer):
+      m_attributes_per_buffer(attributes_per_buffer),
+      m_indices_per_buffer(indices_per_buffer),
+      m_data_blocks_per_store_buffer(data_blocks_per_store_buffer),
+      m_max_z(0),
+      m_recording(false),
+      m_capture_storage(NULL)
+    {}
+
+    ~PainterRecordingPrivate();
+
+    /* maps a RecordedDraw with room for at least the
+       buffer sizes of this recording, and for at least
+       min_attributes attributes and min_indices indices,
+       but for no more than max_room.
+     */
+    fastuidraw::reference_counted_ptr<RecordedDraw>
+    map_draw(unsigned int alignment, unsigned int min_attributes,
+             unsigned int min_indices, const DrawRoom &max_room);
 
     void
-    start_new_command(void);
+    clear(void);
 
     void
-    upload_draw_state(const fastuidraw::PainterPackerData &draw_state);
+    finalize(unsigned int alignment);
 
-    unsigned int
+    void
+    shrink(void);
+
+    /* copies the recorded content out of the storage of
+       m_capture_storage into storage of this recording
+       sized to what is recorded and stops using
+       m_capture_storage.
+     */
+    void
+    end_capture_storage(void);
+
+    /* makes the storage of dst hold only the recorded
+       content of draw, copied from src
+     */
+    static
+    void
+    copy_used(RecordedDraw &draw, const RecordedStorage &src, RecordedStorage *dst);
+
+    unsigned int m_attributes_per_buffer;
+    unsigned int m_indices_per_buffer;
+    unsigned int m_data_blocks_per_store_buffer;
+
+    /* the RecordedDraw m_draws[i] uses the memory of m_storage[i]
+     */
+    std::vector<fastuidraw::reference_counted_ptr<RecordedDraw> > m_draws;
+    std::vector<RecordedStorage*> m_storage;
+    unsigned int m_max_z;
+    bool m_recording;
+
+    /* if non-NULL, the RecordedDraw m_draws[i] uses the memory
+       of (*m_capture_storage)[i] instead of m_storage[i]; used
+       by PainterPacker::begin_capture() so that captures record
+       to buffers of full size that are reused across captures.
+     */
+    std::vector<RecordedStorage*> *m_capture_storage;
+  };
+
+  class painter_state_location
+  {
+  public:
+    uint32_t m_clipping_data_loc;
+    uint32_t m_item_matrix_data_loc;
+    uint32_t m_brush_shader_data_loc;
+    uint32_t m_item_shader_data_loc;
+    uint32_t m_blend_shader_data_loc;
+  };
+
+  /* A StateValueCache remembers the state values packed
+     by value (i.e. not from a PainterPackedValue) onto the
+     store of a PainterDraw so that values with the same
+     content share the same location on the store. Values
+     are first packed to the cache and the cache keeps that
+     copy because the store of a PainterDraw may be mapped
+     write-only. The cache is direct mapped by the hash of
+     the packed data, a newer value replaces an older value
+     with the same slot.
+   */
+  class StateValueCache
+  {
+  public:
+    StateValueCache(void):
+      m_pending_offset(0),
+      m_pending_hash(0)
+    {}
+
+    static
+    bool
+    equal_data(fastuidraw::generic_data a, fastuidraw::generic_data b)
+    {
+      return a.u == b.u;
+    }
+
+    enum
+      {
+        number_slots = 256,
+        max_data_size = 16 * 1024
+      };
+
+    /* returns the array to which to pack the next value */
+    fastuidraw::c_array<fastuidraw::generic_data>
+    pending(unsigned int data_sz);
+
+    /* returns true if the value packed to the array returned
+       by pending() is already on the store, and if so removes
+       it from the cache and sets location to where it is on
+       the store
+     */
+    bool
+    find_pending(uint32_t &location);
+
+    /* record that the value packed to the array returned by
+       pending() is at the location on the store
+     */
+    void
+    insert_pending(uint32_t location);
+
+  private:
+    class slot
+    {
+    public:
+      slot(void):
+        m_hash(0),
+        m_location(0),
+        m_offset(0),
+        m_size(0)
+      {}
+
+      uint32_t m_hash;
+      uint32_t m_location;
+      unsigned int m_offset, m_size;
+    };
+
+    std::vector<slot> m_slots;
+    std::vector<fastuidraw::generic_data> m_data;
+    unsigned int m_pending_offset;
+    uint32_t m_pending_hash;
+  };
+
+  /* unmaps and draws the PainterDraw objects of a frame on
+     a dedicated thread, see PainterPacker::pipelined_submission();
+     at most one frame is handed to the thread at a time.
+   */
+  class SubmissionThread:fastuidraw::noncopyable
+  {
+  public:
+    class entry
+    {
+    public:
+      fastuidraw::reference_counted_ptr<const fastuidraw::PainterDraw> m_draw;
+      bool m_unmap;
+      unsigned int m_attributes_written, m_indices_written, m_store_written;
+    };
+
+    explicit
+    SubmissionThread(fastuidraw::PainterBackend *backend);
+
+    ~SubmissionThread();
+
+    /* blocks until the entries of the last call to submit()
+       are drawn; adds to unmap_time and draw_time the time,
+       in nanoseconds, spent unmapping and drawing them.
+     */
+    void
+    wait(uint64_t &unmap_time, uint64_t &draw_time);
+
+    /* hand the entries to the thread; must only be called
+       after wait(), entries is emptied.
+     */
+    void
+    submit(std::vector<entry> &entries);
+
+  private:
+    static
+    void
+    thread_main(SubmissionThread *p);
+
+    void
+    draw_entries(void);
+
+    fastuidraw::PainterBackend *m_backend;
+    boost::mutex m_mutex;
+    boost::condition_variable m_condition;
+    std::vector<entry> m_entries;
+    bool m_pending, m_quit;
+    uint64_t m_unmap_time, m_draw_time;
+    boost::thread m_thread;
+  };
+
+  class PainterPackerPrivate;
+
+  class per_draw_command
+  {
+  public:
+    per_draw_command(const fastuidraw::reference_counted_ptr<const fastuidraw::PainterDraw> &r,
+                     const fastuidraw::PainterBackend::ConfigurationBase &config,
+                     unsigned int *stats,
+                     RecordedDraw *recorded = NULL);
+
+    unsigned int
+    attribute_room(void)
+    {
+      assert(m_attributes_written <= m_draw_command->m_attributes.size());
+      return m_draw_command->m_attributes.size() - m_attributes_written;
+    }
+
+    unsigned int
+    index_room(void)
+    {
+      assert(m_indices_written <= m_draw_command->m_indices.size());
+      return m_draw_command->m_indices.size() - m_indices_written;
+    }
+
+    unsigned int
+    store_room(void)
+    {
+      unsigned int s;
+      s = store_written();
+      assert(s <= m_draw_command->m_store.size());
+      return m_draw_command->m_store.size() - s;
+    }
+
+    unsigned int
+    store_written(void)
+    {
+      return current_block() * m_alignment;
+    }
+
+    void
+    unmap(void)
+    {
+      m_draw_command->unmap(m_attributes_written, m_indices_written, store_written());
+    }
+
+    void
+    pack_painter_state(const fastuidraw::PainterPackerData &state,
+                       PainterPackerPrivate *p, painter_state_location &out_data);
+
+    unsigned int
+    pack_header(unsigned int header_size,
+                uint32_t brush_shader,
+                const fastuidraw::reference_counted_ptr<fastuidraw::PainterBlendShader> &blend_shader,
+                uint64_t blend_mode,
+                const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &item_shader,
+                unsigned int z,
+                const painter_state_location &loc,
+                const ItemBounds &bounds,
+                const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back);
+
+    void
+    splice(const RecordedDraw &src, int z_adjust,
+           PainterPackerPrivate *p,
+           const fastuidraw::PainterPackerData *replay,
+           fastuidraw::const_c_array<unsigned int> order);
+
+    fastuidraw::reference_counted_ptr<const fastuidraw::PainterDraw> m_draw_command;
+    unsigned int m_attributes_written, m_indices_written;
+
+    /* true if the stats of the draw are counted, but the
+       call to PainterDraw::unmap() is left to the submission
+       of the draw, see PainterPackerPrivate::unmap_current_command()
+     */
+    bool m_unmap_deferred;
+
+  private:
+    void
+    set_shader_group(const PainterShaderGroupPrivate &current);
+
+    fastuidraw::c_array<fastuidraw::generic_data>
+    allocate_store(unsigned int num_elements);
+
+    unsigned int
+    current_block(void)
+    {
+      return m_store_blocks_written;
+    }
+
+    void
+    pack_state_data(PainterPackerPrivate *p, EntryBase *st_d, uint32_t &location);
+
+    template<typename T>
+    void
+    pack_state_data_from_value(const T &st, uint32_t &location)
+    {
+      fastuidraw::c_array<fastuidraw::generic_data> src, dst;
+      unsigned int data_sz;
+
+      data_sz = st.data_size(m_alignment);
+      if(data_sz == 0)
+        {
+          /* nothing to share; an empty slot of the cache
+             would otherwise match an empty value
+           */
+          location = current_block();
+          return;
+        }
+
+      src = m_value_cache.pending(data_sz);
+      st.pack_data(m_alignment, src);
+      if(m_value_cache.find_pending(location))
+        {
+          m_stats[fastuidraw::PainterPacker::num_generic_datas_deduplicated] += data_sz;
+          return;
+        }
+
+      location = current_block();
+      dst = allocate_store(data_sz);
+      std::copy(src.begin(), src.end(), dst.begin());
+      m_value_cache.insert_pending(location);
+    }
+
+    template<typename T>
+    void
+    pack_state_data(PainterPackerPrivate *p,
+                    const fastuidraw::PainterData::value<T> &obj,
+                    uint32_t &location)
+    {
+      if(obj.m_packed_value)
+        {
+          EntryBase *e;
+          e = reinterpret_cast<EntryBase*>(obj.m_packed_value.opaque_data());
+          pack_state_data(p, e, location);
+        }
+      else if(obj.m_value != NULL)
+        {
+          pack_state_data_from_value(*obj.m_value, location);
+        }
+      else
+        {
+          static T v;
+          pack_state_data_from_value(v, location);
+        }
+    }
+
+    unsigned int m_store_blocks_written;
+    unsigned int m_alignment;
+    uint32_t m_brush_shader_mask;
+    PainterShaderGroupPrivate m_prev_state;
+    fastuidraw::BlendMode m_prev_blend_mode;
+
+    /* non-NULL if m_draw_command is a RecordedDraw
+     */
+    RecordedDraw *m_recorded;
+
+    /* the stats of the PainterPacker, indexed by
+       PainterPacker::stats_t
+     */
+    unsigned int *m_stats;
+
+    /* work room for splice()
+     */
+    std::vector<uint32_t> m_replay_matrix_locations;
+
+    /* values packed by value onto m_draw_command
+     */
+    StateValueCache m_value_cache;
+  };
+
+  class PainterPackerPrivateWorkroom
+  {
+  public:
+    std::vector<unsigned int> m_attribs_loaded;
+    std::vector<fastuidraw::range_type<unsigned int> > m_static_index_ranges;
+    std::vector<fastuidraw::range_type<unsigned int> > m_static_attrib_ranges;
+    std::vector<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > m_static_attrib_chunks;
+    std::vector<fastuidraw::const_c_array<fastuidraw::PainterIndex> > m_static_index_chunks;
+    std::vector<int> m_static_index_adjusts;
+    std::vector<unsigned int> m_static_selector;
+    std::vector<unsigned int> m_splice_order, m_splice_late;
+    std::vector<SubmissionThread::entry> m_submission;
+  };
+
+  class PainterPackerPrivate
+  {
+  public:
+    explicit
+    PainterPackerPrivate(fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> backend,
+                         fastuidraw::PainterPacker *p);
+
+    ~PainterPackerPrivate();
+
+    /* starts a new draw command; when recording, the
+       draw command has room for at least min_attributes
+       attributes and min_indices indices, but for no more
+       than m_backend_room (the room of the draw commands
+       of the backend is fixed).
+     */
+    void
+    start_new_command(unsigned int min_attributes = 0,
+                      unsigned int min_indices = 0);
+
+    void
+    flush(bool pipelined);
+
+    void
+    wait_submission(void);
+
+    void
+    unmap_current_command(void);
+
+    unsigned int
+    compute_room_needed_for_splice(const RecordedDraw &src,
+                                   const fastuidraw::PainterPackerData *replay);
+
+    void
+    draw_recorded(const RecordedDraw &src, int z_adjust,
+                  const fastuidraw::PainterPackerData *replay,
+                  bool sort = false, bool occlusion = false);
+
+    /* splices the headers of src listed in order (all of
+       them if order is empty), a range of headers at a time,
+       into as many draw commands as needed.
+     */
+    void
+    draw_recorded_split(const RecordedDraw &src, int z_adjust,
+                        const fastuidraw::PainterPackerData *replay,
+                        fastuidraw::const_c_array<unsigned int> order);
+
+    /* prints a warning (once for the PainterPacker) that
+       content needing the given room is not drawn because
+       the room is more than a draw command has
+     */
+    void
+    warn_content_dropped(const char *what, unsigned int attributes,
+                         unsigned int indices, unsigned int store);
+
+    void
+    compute_sorted_order(const RecordedDraw &src, bool sort);
+
+    void
+    compute_occlusion(PainterRecordingPrivate *rec);
+
+    bool
+    compare_groups(const PainterShaderGroupValues &lhs,
+                   const PainterShaderGroupValues &rhs) const;
+
+    void
+    splice_sort_recording(void);
+
+    void
+    reset_stats(void);
+
+    uint64_t*
+    timer(enum fastuidraw::PainterPacker::timer_t t)
+    {
+      return (m_timers_enabled) ? &m_timers[t] : NULL;
+    }
+
+    void
+    count_item(const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &shader)
+    {
+      unsigned int id(shader->ID());
+      if(id >= m_item_shader_stats.size())
+        {
+          m_item_shader_stats.resize(id + 1, 0u);
+        }
+      ++m_item_shader_stats[id];
+    }
+
+    void
+    upload_draw_state(const fastuidraw::PainterPackerData &draw_state);
+
+    unsigned int
     compute_room_needed_for_packing(const fastuidraw::PainterPackerData &draw_state);
 
-    template<typename T>
-    unsigned int
-    compute_room_needed_for_packing(const fastuidraw::PainterData::value<T> &obj)
+    template<typename T>
+    unsigned int
+    compute_room_needed_for_packing(const fastuidraw::PainterData::value<T> &obj)
+    {
+      if(obj.m_packed_value)
+        {
+          EntryBase *d;
+          d = reinterpret_cast<EntryBase*>(obj.m_packed_value.opaque_data());
+          if(d->m_painter == m_p && d->m_begin_id == m_number_begins
+             && d->m_draw_command_id == m_accumulated_draws.size())
+            {
+              return 0;
+            }
+          else
+            {
+              return d->m_data.size();
+            }
+        }
+      else if(obj.m_value != NULL)
+        {
+          return obj.m_value->data_size(m_alignment);
+        }
+      else
+        {
+          static T v;
+          return v.data_size(m_alignment);
+        }
+    };
+
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> m_backend;
+    fastuidraw::PainterShaderSet m_default_shaders;
+    unsigned int m_alignment;
+    unsigned int m_header_size;
+
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterBlendShader> m_blend_shader;
+    uint64_t m_blend_mode;
+    painter_state_location m_painter_state_location;
+    int m_number_begins;
+
+    std::vector<per_draw_command> m_accumulated_draws;
+    fastuidraw::PainterPacker *m_p;
+
+    /* non-NULL when recording
+     */
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterRecording> m_recording;
+    PainterRecordingPrivate *m_recording_d;
+
+    /* holds the draws of the frame and the recording
+       (if any) of the frame while capturing
+     */
+    std::vector<per_draw_command> m_draws_before_capture;
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterRecording> m_recording_before_capture;
+    PainterRecordingPrivate *m_recording_d_before_capture;
+
+    /* the storage to which begin_capture() records, the content
+       is copied to the PainterRecording at end_capture()
+     */
+    std::vector<RecordedStorage*> m_capture_storage;
+
+    /* if m_sort_by_shader_group is true, begin() records
+       to m_sort_recording which is spliced, with the headers
+       reordered, into draws of m_backend by flush()
+     */
+    bool m_sort_by_shader_group;
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterRecording> m_sort_recording;
+
+    /* if m_occlusion_culling is true, begin() also records to
+       m_sort_recording and flush() drops the headers hidden by
+       opaque items drawn after them; m_item_bounds is the value
+       set by PainterPacker::item_bounds() for the next item and
+       m_number_items the number of items drawn since begin().
+     */
+    bool m_occlusion_culling;
+    ItemBounds m_item_bounds;
+    unsigned int m_number_items;
+    OcclusionGrid m_occlusion_grid;
+
+    /* if m_pipelined_submission is true (and the backend supports
+       it), the draws of a frame are unmapped and drawn by
+       m_submission_thread (made on first use) and m_pipelined_frame
+       is true between begin() and end(). m_pending_undelays is the
+       number of frames whose atlas freeing is to be undelayed
+       once their submission completes.
+     */
+    bool m_pipelined_submission;
+    bool m_pipelined_frame;
+    SubmissionThread *m_submission_thread;
+    unsigned int m_pending_undelays;
+
+    PainterPackerPrivateWorkroom m_work_room;
+    fastuidraw::vecN<unsigned int, fastuidraw::PainterPacker::num_stats> m_stats;
+
+    /* timers (with the sampler picking the items whose
+       packing is timed) and the number of items drawn
+       per item shader, indexed by shader ID
+     */
+    bool m_timers_enabled;
+    fastuidraw::vecN<uint64_t, fastuidraw::PainterPacker::num_timers> m_timers;
+    fastuidraw::timer_sampler m_packing_sampler;
+    std::vector<unsigned int> m_item_shader_stats;
+
+    /* true once warn_content_dropped() has printed
+     */
+    bool m_warned_content_dropped;
+
+    /* the room of the draw command last mapped from the
+       backend; a recorded draw command with more room could
+       not be spliced into one of the backend in one go.
+     */
+    DrawRoom m_backend_room;
+  };
+}
+
+
+//////////////////////////////////
+// SubmissionThread methods
+SubmissionThread::
+SubmissionThread(fastuidraw::PainterBackend *backend):
+  m_backend(backend),
+  m_pending(false),
+  m_quit(false),
+  m_unmap_time(0),
+  m_draw_time(0)
+{
+  m_thread = boost::thread(thread_main, this);
+}
+
+SubmissionThread::
+~SubmissionThread()
+{
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    m_quit = true;
+    m_condition.notify_all();
+  }
+  m_thread.join();
+}
+
+void
+SubmissionThread::
+wait(uint64_t &unmap_time, uint64_t &draw_time)
+{
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+  while(m_pending)
+    {
+      m_condition.wait(lock);
+    }
+  unmap_time += m_unmap_time;
+  draw_time += m_draw_time;
+  m_unmap_time = 0;
+  m_draw_time = 0;
+}
+
+void
+SubmissionThread::
+submit(std::vector<entry> &entries)
+{
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+
+  assert(!m_pending);
+  assert(m_entries.empty());
+  m_entries.swap(entries);
+  m_pending = true;
+  m_condition.notify_all();
+}
+
+void
+SubmissionThread::
+thread_main(SubmissionThread *p)
+{
+  boost::unique_lock<boost::mutex> lock(p->m_mutex);
+  for(;;)
+    {
+      while(!p->m_pending && !p->m_quit)
+        {
+          p->m_condition.wait(lock);
+        }
+
+      if(!p->m_pending)
+        {
+          return;
+        }
+
+      /* m_entries is not touched by the other thread
+         while m_pending is true
+       */
+      lock.unlock();
+      p->draw_entries();
+      lock.lock();
+
+      p->m_pending = false;
+      p->m_condition.notify_all();
+    }
+}
+
+void
+SubmissionThread::
+draw_entries(void)
+{
+  uint64_t start_time, unmap_end_time;
+
+  start_time = fastuidraw::timer_nanoseconds();
+  for(std::vector<entry>::const_iterator iter = m_entries.begin(),
+        end = m_entries.end(); iter != end; ++iter)
+    {
+      if(iter->m_unmap)
+        {
+          iter->m_draw->unmap(iter->m_attributes_written,
+                              iter->m_indices_written,
+                              iter->m_store_written);
+        }
+    }
+
+  unmap_end_time = fastuidraw::timer_nanoseconds();
+  m_backend->on_pre_draw();
+  for(std::vector<entry>::const_iterator iter = m_entries.begin(),
+        end = m_entries.end(); iter != end; ++iter)
+    {
+      assert(iter->m_draw->unmapped());
+      iter->m_draw->draw();
+    }
+  m_backend->on_post_draw();
+
+  /* release the PainterDraw objects from this thread as well
+   */
+  m_entries.clear();
+  m_unmap_time += unmap_end_time - start_time;
+  m_draw_time += fastuidraw::timer_nanoseconds() - unmap_end_time;
+}
+
+//////////////////////////////////
+// OcclusionGrid methods
+void
+OcclusionGrid::
+add_occluder(const fastuidraw::vec2 &pmin, const fastuidraw::vec2 &pmax)
+{
+  int x0, x1, y0, y1;
+  uint64_t mask;
+
+  x0 = fastuidraw::t_max(0, cell_ceil(pmin.x()));
+  x1 = fastuidraw::t_min(int(grid_size), cell_floor(pmax.x()));
+  y0 = fastuidraw::t_max(0, cell_ceil(pmin.y()));
+  y1 = fastuidraw::t_min(int(grid_size), cell_floor(pmax.y()));
+  if(x0 >= x1 || y0 >= y1)
+    {
+      return;
+    }
+
+  mask = row_mask(x0, x1);
+  for(int y = y0; y < y1; ++y)
+    {
+      m_rows[y] |= mask;
+    }
+}
+
+bool
+OcclusionGrid::
+covered(const fastuidraw::vec2 &pmin, const fastuidraw::vec2 &pmax) const
+{
+  int x0, x1, y0, y1;
+  uint64_t mask;
+
+  /* a region outside of [-1, 1]x[-1, 1] is not visible,
+     thus it is enough to check the cells along the
+     boundary that it is closest to.
+   */
+  x0 = fastuidraw::t_min(int(grid_size) - 1, fastuidraw::t_max(0, cell_floor(pmin.x())));
+  x1 = fastuidraw::t_max(x0 + 1, fastuidraw::t_min(int(grid_size), cell_ceil(pmax.x())));
+  y0 = fastuidraw::t_min(int(grid_size) - 1, fastuidraw::t_max(0, cell_floor(pmin.y())));
+  y1 = fastuidraw::t_max(y0 + 1, fastuidraw::t_min(int(grid_size), cell_ceil(pmax.y())));
+
+  mask = row_mask(x0, x1);
+  for(int y = y0; y < y1; ++y)
+    {
+      if((m_rows[y] & mask) != mask)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+/////////////////////////////////////////
+// StateValueCache methods
+fastuidraw::c_array<fastuidraw::generic_data>
+StateValueCache::
+pending(unsigned int data_sz)
+{
+  if(m_slots.empty() || m_data.size() + data_sz > max_data_size)
+    {
+      /* drop all values from the cache
+       */
+      m_slots.clear();
+      m_slots.resize(number_slots);
+      m_data.clear();
+    }
+
+  m_pending_offset = m_data.size();
+  m_data.resize(m_pending_offset + data_sz);
+  return fastuidraw::make_c_array(m_data).sub_array(m_pending_offset, data_sz);
+}
+
+bool
+StateValueCache::
+find_pending(uint32_t &location)
+{
+  fastuidraw::const_c_array<fastuidraw::generic_data> value;
+
+  value = fastuidraw::make_c_array(m_data).sub_array(m_pending_offset);
+
+  /* FNV-1a hash of the packed data */
+  m_pending_hash = 2166136261u;
+  for(unsigned int i = 0; i < value.size(); ++i)
+    {
+      m_pending_hash ^= value[i].u;
+      m_pending_hash *= 16777619u;
+    }
+
+  const slot &S(m_slots[m_pending_hash % number_slots]);
+  if(S.m_size == value.size() && S.m_hash == m_pending_hash
+     && std::equal(value.begin(), value.end(), m_data.begin() + S.m_offset, equal_data))
+    {
+      location = S.m_location;
+      m_data.resize(m_pending_offset);
+      return true;
+    }
+  return false;
+}
+
+void
+StateValueCache::
+insert_pending(uint32_t location)
+{
+  slot &S(m_slots[m_pending_hash % number_slots]);
+
+  S.m_hash = m_pending_hash;
+  S.m_location = location;
+  S.m_offset = m_pending_offset;
+  S.m_size = m_data.size() - m_pending_offset;
+}
+
+//////////////////////////////////////////
+// per_draw_command methods
+per_draw_command::
+per_draw_command(const fastuidraw::reference_counted_ptr<const fastuidraw::PainterDraw> &r,
+                 const fastuidraw::PainterBackend::ConfigurationBase &config,
+                 unsigned int *stats,
+                 RecordedDraw *recorded):
+  m_draw_command(r),
+  m_attributes_written(0),
+  m_indices_written(0),
+  m_unmap_deferred(false),
+  m_store_blocks_written(0),
+  m_alignment(config.alignment()),
+  m_brush_shader_mask(config.brush_shader_mask()),
+  m_recorded(recorded),
+  m_stats(stats)
+{
+  m_prev_state.m_item_group = 0;
+  m_prev_state.m_brush = 0;
+  m_prev_state.m_blend_group = 0;
+  m_prev_state.m_blend_mode = 0;
+}
+
+
+fastuidraw::c_array<fastuidraw::generic_data>
+per_draw_command::
+allocate_store(unsigned int num_elements)
+{
+  fastuidraw::c_array<fastuidraw::generic_data> return_value;
+  assert(num_elements % m_alignment == 0);
+  return_value = m_draw_command->m_store.sub_array(store_written(), num_elements);
+  m_store_blocks_written += num_elements / m_alignment;
+  return return_value;
+}
+
+void
+per_draw_command::
+pack_state_data(PainterPackerPrivate *p,
+                EntryBase *d, uint32_t &location)
+{
+  assert(d->valid());
+  if(d->m_painter == p->m_p && d->m_begin_id == p->m_number_begins
+     && d->m_draw_command_id == p->m_accumulated_draws.size())
+    {
+      m_stats[fastuidraw::PainterPacker::num_generic_datas_reused] += d->m_data.size();
+      location = d->m_offset;
+      return;
+    }
+
+  /* data not in current data store add
+     it to the current store.
+   */
+  fastuidraw::const_c_array<fastuidraw::generic_data> src;
+  fastuidraw::c_array<fastuidraw::generic_data> dst;
+
+  location = current_block();
+  src = fastuidraw::make_c_array(d->m_data);
+  dst = allocate_store(src.size());
+  std::copy(src.begin(), src.end(), dst.begin());
+
+  d->m_painter = p->m_p;
+  d->m_begin_id = p->m_number_begins;
+  d->m_draw_command_id = p->m_accumulated_draws.size();
+  d->m_offset = location;
+}
+
+void
+per_draw_command::
+pack_painter_state(const fastuidraw::PainterPackerData &state,
+                   PainterPackerPrivate *p, painter_state_location &out_data)
+{
+  pack_state_data(p, state.m_clip, out_data.m_clipping_data_loc);
+  pack_state_data(p, state.m_matrix, out_data.m_item_matrix_data_loc);
+  pack_state_data(p, state.m_item_shader_data, out_data.m_item_shader_data_loc);
+  pack_state_data(p, state.m_blend_shader_data, out_data.m_blend_shader_data_loc);
+  pack_state_data(p, state.m_brush, out_data.m_brush_shader_data_loc);
+  if(m_recorded)
+    {
+      const fastuidraw::PainterBrush &brush(fetch_value(state.m_brush));
+
+      /* consecutive items mostly share their brush */
+      if(brush.image() && (m_recorded->m_images.empty() || m_recorded->m_images.back() != brush.image()))
+        {
+          m_recorded->m_images.push_back(brush.image());
+        }
+      if(brush.color_stops()
+         && (m_recorded->m_color_stops.empty() || m_recorded->m_color_stops.back() != brush.color_stops()))
+        {
+          m_recorded->m_color_stops.push_back(brush.color_stops());
+        }
+    }
+}
+
+unsigned int
+per_draw_command::
+pack_header(unsigned int header_size,
+            uint32_t brush_shader,
+            const fastuidraw::reference_counted_ptr<fastuidraw::PainterBlendShader> &blend_shader,
+            uint64_t blend_mode,
+            const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &item_shader,
+            unsigned int z,
+            const painter_state_location &loc,
+            const ItemBounds &bounds,
+            const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back)
+{
+  unsigned int return_value;
+  fastuidraw::c_array<fastuidraw::generic_data> dst;
+  fastuidraw::PainterHeader header;
+
+  return_value = current_block();
+  dst = allocate_store(header_size);
+
+  if(call_back)
+    {
+      call_back->current_draw(m_draw_command);
+    }
+
+  PainterShaderGroupPrivate current;
+  fastuidraw::PainterShader::Tag blend;
+
+  if(blend_shader)
+    {
+      blend = blend_shader->tag();
+    }
+  current.m_item_group = item_shader->group();
+  current.m_brush = brush_shader;
+  current.m_blend_group = blend.m_group;
+  current.m_blend_mode = blend_mode;
+
+  header.m_clip_equations_location = loc.m_clipping_data_loc;
+  header.m_item_matrix_location = loc.m_item_matrix_data_loc;
+  header.m_brush_shader_data_location = loc.m_brush_shader_data_loc;
+  header.m_item_shader_data_location = loc.m_item_shader_data_loc;
+  header.m_blend_shader_data_location = loc.m_blend_shader_data_loc;
+  header.m_item_shader = item_shader->ID();
+  header.m_brush_shader = current.m_brush;
+  header.m_blend_shader = blend.m_ID;
+  header.m_z = z;
+  header.pack_data(m_alignment, dst);
+
+  set_shader_group(current);
+  if(m_recorded)
+    {
+      RecordedHeader h;
+
+      h.m_location = return_value;
+      h.m_attributes_written = m_attributes_written;
+      h.m_indices_written = m_indices_written;
+      h.m_group = current;
+      h.m_dst_independent = blend_independent_of_dst(blend_shader, blend_mode);
+      h.m_bounds = bounds;
+      h.m_hidden = false;
+      m_recorded->m_headers.push_back(h);
+    }
+
+  if(call_back)
+    {
+      call_back->header_added(header, dst);
+    }
+
+  return return_value;
+}
+
+void
+per_draw_command::
+set_shader_group(const PainterShaderGroupPrivate &current)
+{
+  bool item_changed, blend_changed, brush_changed, blend_mode_changed;
+
+  item_changed = (current.m_item_group != m_prev_state.m_item_group);
+  blend_changed = (current.m_blend_group != m_prev_state.m_blend_group);
+  brush_changed = ((m_brush_shader_mask & (current.m_brush ^ m_prev_state.m_brush)) != 0u);
+  blend_mode_changed = (current.m_blend_mode != m_prev_state.m_blend_mode);
+
+  if(item_changed || blend_changed || brush_changed || blend_mode_changed)
+    {
+      ++m_stats[fastuidraw::PainterPacker::num_draw_breaks];
+      m_stats[fastuidraw::PainterPacker::num_draw_breaks_item_group] += item_changed;
+      m_stats[fastuidraw::PainterPacker::num_draw_breaks_blend_group] += blend_changed;
+      m_stats[fastuidraw::PainterPacker::num_draw_breaks_brush] += brush_changed;
+      m_stats[fastuidraw::PainterPacker::num_draw_breaks_blend_mode] += blend_mode_changed;
+      m_draw_command->draw_break(m_prev_state, current,
+                                 m_attributes_written,
+                                 m_indices_written);
+    }
+  m_prev_state = current;
+}
+
+void
+per_draw_command::
+splice(const RecordedDraw &src, int z_adjust,
+       PainterPackerPrivate *p,
+       const fastuidraw::PainterPackerData *replay,
+       fastuidraw::const_c_array<unsigned int> order)
+{
+  unsigned int block_offset;
+  fastuidraw::c_array<fastuidraw::generic_data> dst_store;
+  uint32_t clip_location(0);
+
+  assert(src.unmapped());
+  assert(src.m_store_written % m_alignment == 0);
+  assert(!order.empty() || attribute_room() >= src.m_attributes_written);
+  assert(!order.empty() || index_room() >= src.m_indices_written);
+  assert(store_room() >= src.m_store_written);
+  assert(order.size() <= src.m_headers.size());
+
+  /* copy the store in one go and then relocate the
+     locations and z-values of each of the headers.
+   */
+  block_offset = current_block();
+  dst_store = allocate_store(src.m_store_written);
+  if(m_recorded)
+    {
+      m_recorded->m_images.insert(m_recorded->m_images.end(),
+                                  src.m_images.begin(), src.m_images.end());
+      m_recorded->m_color_stops.insert(m_recorded->m_color_stops.end(),
+                                       src.m_color_stops.begin(), src.m_color_stops.end());
+    }
+  std::memcpy(dst_store.c_ptr(), src.m_store.c_ptr(),
+              sizeof(fastuidraw::generic_data) * src.m_store_written);
+
+  if(replay)
+    {
+      const fastuidraw::float3x3 &base(fetch_value(replay->m_matrix).m_item_matrix);
+
+      /* pack the clip equations and for each distinct recorded
+         transformation, the product of the replay transformation
+         with the recorded transformation.
+       */
+      pack_state_data(p, replay->m_clip, clip_location);
+      m_replay_matrix_locations.resize(src.m_matrix_locations.size());
+      for(unsigned int i = 0, endi = src.m_matrix_locations.size(); i < endi; ++i)
+        {
+          fastuidraw::PainterItemMatrix M;
+          fastuidraw::const_c_array<fastuidraw::generic_data> R;
+
+          R = src.m_store.sub_array(src.m_matrix_locations[i] * m_alignment,
+                                    fastuidraw::PainterItemMatrix::matrix_data_size);
+          M.m_item_matrix(0, 0) = R[fastuidraw::PainterItemMatrix::matrix00_offset].f;
+          M.m_item_matrix(0, 1) = R[fastuidraw::PainterItemMatrix::matrix01_offset].f;
+          M.m_item_matrix(0, 2) = R[fastuidraw::PainterItemMatrix::matrix02_offset].f;
+          M.m_item_matrix(1, 0) = R[fastuidraw::PainterItemMatrix::matrix10_offset].f;
+          M.m_item_matrix(1, 1) = R[fastuidraw::PainterItemMatrix::matrix11_offset].f;
+          M.m_item_matrix(1, 2) = R[fastuidraw::PainterItemMatrix::matrix12_offset].f;
+          M.m_item_matrix(2, 0) = R[fastuidraw::PainterItemMatrix::matrix20_offset].f;
+          M.m_item_matrix(2, 1) = R[fastuidraw::PainterItemMatrix::matrix21_offset].f;
+          M.m_item_matrix(2, 2) = R[fastuidraw::PainterItemMatrix::matrix22_offset].f;
+          M.m_item_matrix = base * M.m_item_matrix;
+          pack_state_data_from_value(M, m_replay_matrix_locations[i]);
+        }
+    }
+
+  for(unsigned int h = 0, endh = src.m_headers.size(); h < endh; ++h)
+    {
+      fastuidraw::c_array<fastuidraw::generic_data> dst;
+
+      dst = dst_store.sub_array(src.m_headers[h].m_location * m_alignment,
+                                fastuidraw::PainterHeader::header_size);
+      if(replay)
+        {
+          dst[fastuidraw::PainterHeader::item_matrix_location_offset].u =
+            m_replay_matrix_locations[src.m_header_matrix_index[h]];
+          dst[fastuidraw::PainterHeader::clip_equations_location_offset].u = clip_location;
+        }
+      else
+        {
+          dst[fastuidraw::PainterHeader::clip_equations_location_offset].u += block_offset;
+          dst[fastuidraw::PainterHeader::item_matrix_location_offset].u += block_offset;
+        }
+      dst[fastuidraw::PainterHeader::brush_shader_data_location_offset].u += block_offset;
+      dst[fastuidraw::PainterHeader::item_shader_data_location_offset].u += block_offset;
+      dst[fastuidraw::PainterHeader::blend_shader_data_location_offset].u += block_offset;
+      dst[fastuidraw::PainterHeader::z_offset].u += z_adjust;
+    }
+
+  /* copy the attributes and indices of each header one header at
+     a time, in the order given by order, so that the draw breaks
+     are issued at the correct locations. The indices of a header
+     only refer to the attributes written after the header was
+     added and before the next header was added. If order is
+     non-empty, the headers not listed in order are not drawn.
+   */
+  unsigned int endh(src.m_headers.size());
+  for(unsigned int k = 0, endk = (order.empty()) ? endh : order.size(); k < endk; ++k)
     {
-      if(obj.m_packed_value)
+      unsigned int h, attr_begin, attr_end, index_begin, index_end;
+      int index_adjust;
+
+      h = (order.empty()) ? k : order[k];
+      attr_begin = src.m_headers[h].m_attributes_written;
+      index_begin = src.m_headers[h].m_indices_written;
+      attr_end = src.attributes_end(h);
+      index_end = src.indices_end(h);
+      index_adjust = int(m_attributes_written) - int(attr_begin);
+      assert(attribute_room() >= attr_end - attr_begin);
+      assert(index_room() >= index_end - index_begin);
+
+      set_shader_group(PainterShaderGroupPrivate(src.m_headers[h].m_group));
+      if(m_recorded)
         {
-          EntryBase *d;
-          d = reinterpret_cast<EntryBase*>(obj.m_packed_value.opaque_data());
-          if(d->m_painter == m_p && d->m_begin_id == m_number_begins
-             && d->m_draw_command_id == m_accumulated_draws.size())
+          RecordedHeader rh(src.m_headers[h]);
+
+          /* the bounds are in the clip coordinates of the
+             recording, which are not those of the destination
+           */
+          rh.m_bounds = ItemBounds();
+          rh.m_location += block_offset;
+          rh.m_attributes_written = m_attributes_written;
+          rh.m_indices_written = m_indices_written;
+          m_recorded->m_headers.push_back(rh);
+        }
+
+      if(attr_end > attr_begin)
+        {
+          fastuidraw::const_c_array<uint32_t> src_headers;
+          fastuidraw::c_array<uint32_t> dst_headers;
+
+          /* PainterAttribute is plain data, but vecN's assignment
+             operator makes it not trivially copyable; copying
+             through void* lets memcpy copy the range in one go
+             without a -Wclass-memaccess warning.
+           */
+          std::memcpy(static_cast<void*>(m_draw_command->m_attributes.c_ptr() + m_attributes_written),
+                      static_cast<const void*>(src.m_attributes.c_ptr() + attr_begin),
+                      sizeof(fastuidraw::PainterAttribute) * (attr_end - attr_begin));
+
+          src_headers = src.m_header_attributes.sub_array(attr_begin, attr_end - attr_begin);
+          dst_headers = m_draw_command->m_header_attributes.sub_array(m_attributes_written, attr_end - attr_begin);
+          for(unsigned int i = 0, endi = src_headers.size(); i < endi; ++i)
             {
-              return 0;
+              dst_headers[i] = src_headers[i] + block_offset;
             }
-          else
+          m_attributes_written += attr_end - attr_begin;
+        }
+
+      if(index_end > index_begin)
+        {
+          fastuidraw::const_c_array<fastuidraw::PainterIndex> src_indices;
+          fastuidraw::c_array<fastuidraw::PainterIndex> dst_indices;
+
+          src_indices = src.m_indices.sub_array(index_begin, index_end - index_begin);
+          dst_indices = m_draw_command->m_indices.sub_array(m_indices_written, index_end - index_begin);
+          for(unsigned int i = 0, endi = src_indices.size(); i < endi; ++i)
             {
-              return d->m_data.size();
+              assert(src_indices[i] >= attr_begin && src_indices[i] < attr_end);
+              dst_indices[i] = int(src_indices[i]) + index_adjust;
             }
+          m_indices_written += index_end - index_begin;
         }
-      else if(obj.m_value != NULL)
+    }
+}
+
+///////////////////////////////////////////
+// PainterPackerPrivate methods
+PainterPackerPrivate::
+PainterPackerPrivate(fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> backend,
+                     fastuidraw::PainterPacker *p):
+  m_backend(backend),
+  m_p(p)
+{
+  m_alignment = m_backend->configuration_base().alignment();
+  m_header_size = fastuidraw::PainterHeader::data_size(m_alignment);
+  // By calling PainterBackend::default_shaders(), we make the shaders
+  // registered. By setting m_default_shaders to its return value,
+  // and using that for the return value of PainterPacker::default_shaders(),
+  // we skip the check in PainterBackend::default_shaders() to register
+  // the shaders as well.
+  m_default_shaders = m_backend->default_shaders();
+  m_number_begins = 0;
+  m_recording_d = NULL;
+  m_recording_d_before_capture = NULL;
+  m_sort_by_shader_group = false;
+  m_occlusion_culling = false;
+  m_number_items = 0;
+  m_pipelined_submission = false;
+  m_pipelined_frame = false;
+  m_submission_thread = NULL;
+  m_pending_undelays = 0;
+  m_timers_enabled = false;
+  m_timers = fastuidraw::vecN<uint64_t, fastuidraw::PainterPacker::num_timers>(0);
+  m_warned_content_dropped = false;
+}
+
+PainterPackerPrivate::
+~PainterPackerPrivate()
+{
+  if(m_submission_thread)
+    {
+      wait_submission();
+      FASTUIDRAWdelete(m_submission_thread);
+    }
+
+  for(unsigned int i = 0, endi = m_capture_storage.size(); i < endi; ++i)
+    {
+      FASTUIDRAWdelete(m_capture_storage[i]);
+    }
+}
+
+void
+PainterPackerPrivate::
+reset_stats(void)
+{
+  std::fill(m_stats.begin(), m_stats.end(), 0u);
+  std::fill(m_timers.begin(), m_timers.end(), 0u);
+  std::fill(m_item_shader_stats.begin(), m_item_shader_stats.end(), 0u);
+}
+
+void
+PainterPackerPrivate::
+unmap_current_command(void)
+{
+  if(!m_accumulated_draws.empty())
+    {
+      fastuidraw::scoped_timer timer_unmap(timer(fastuidraw::PainterPacker::unmap_time));
+      per_draw_command &c(m_accumulated_draws.back());
+
+      m_stats[fastuidraw::PainterPacker::num_attributes] += c.m_attributes_written;
+      m_stats[fastuidraw::PainterPacker::num_indices] += c.m_indices_written;
+      m_stats[fastuidraw::PainterPacker::num_generic_datas] += c.store_written();
+      m_stats[fastuidraw::PainterPacker::num_draws] += 1u;
+
+      /* the draws sent to the backend in a pipelined frame
+         are unmapped by the submission thread
+       */
+      if(m_pipelined_frame && m_recording_d == NULL)
         {
-          return obj.m_value->data_size(m_alignment);
+          c.m_unmap_deferred = true;
         }
       else
         {
-          static T v;
-          return v.data_size(m_alignment);
+          c.unmap();
         }
-    };
+    }
+}
 
-    fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> m_backend;
-    fastuidraw::PainterShaderSet m_default_shaders;
-    unsigned int m_alignment;
-    unsigned int m_header_size;
+void
+PainterPackerPrivate::
+flush(bool pipelined)
+{
+  assert(m_draws_before_capture.empty());
+  unmap_current_command();
 
-    fastuidraw::reference_counted_ptr<fastuidraw::PainterBlendShader> m_blend_shader;
-    uint64_t m_blend_mode;
-    painter_state_location m_painter_state_location;
-    int m_number_begins;
+  if(m_recording_d)
+    {
+      /* the recorded draws are held by the PainterRecording
+       */
+      m_accumulated_draws.clear();
+      if(m_recording != m_sort_recording)
+        {
+          return;
+        }
+      splice_sort_recording();
+    }
 
-    std::vector<per_draw_command> m_accumulated_draws;
-    fastuidraw::PainterPacker *m_p;
+  if(m_backend->hints().thread_safe_submission())
+    {
+      /* such a backend leaves flushing the atlases to us,
+         see PainterBackend::PerformanceHints::thread_safe_submission()
+       */
+      m_backend->glyph_atlas()->flush();
+      m_backend->image_atlas()->flush();
+      m_backend->colorstop_atlas()->flush();
+    }
 
-    PainterPackerPrivateWorkroom m_work_room;
-    fastuidraw::vecN<unsigned int, fastuidraw::PainterPacker::num_stats> m_stats;
-  };
-}
+  /* the draws of the previous frame are to be drawn
+     before those of this flush.
+   */
+  wait_submission();
 
+  if(pipelined)
+    {
+      std::vector<SubmissionThread::entry> &entries(m_work_room.m_submission);
 
-//////////////////////////////////////////
-// per_draw_command methods
-per_draw_command::
-per_draw_command(const fastuidraw::reference_counted_ptr<const fastuidraw::PainterDraw> &r,
-                 const fastuidraw::PainterBackend::ConfigurationBase &config):
-  m_draw_command(r),
-  m_attributes_written(0),
-  m_indices_written(0),
-  m_store_blocks_written(0),
-  m_alignment(config.alignment()),
-  m_brush_shader_mask(config.brush_shader_mask())
+      entries.resize(m_accumulated_draws.size());
+      for(unsigned int i = 0, endi = m_accumulated_draws.size(); i < endi; ++i)
+        {
+          per_draw_command &c(m_accumulated_draws[i]);
+
+          entries[i].m_draw = c.m_draw_command;
+          entries[i].m_unmap = c.m_unmap_deferred;
+          entries[i].m_attributes_written = c.m_attributes_written;
+          entries[i].m_indices_written = c.m_indices_written;
+          entries[i].m_store_written = c.store_written();
+        }
+      m_accumulated_draws.clear();
+
+      if(!m_submission_thread)
+        {
+          m_submission_thread = FASTUIDRAWnew SubmissionThread(m_backend.get());
+        }
+      m_submission_thread->submit(entries);
+      return;
+    }
+
+  {
+    fastuidraw::scoped_timer timer_unmap(timer(fastuidraw::PainterPacker::unmap_time));
+    for(std::vector<per_draw_command>::iterator iter = m_accumulated_draws.begin(),
+          end = m_accumulated_draws.end(); iter != end; ++iter)
+      {
+        if(iter->m_unmap_deferred)
+          {
+            iter->m_unmap_deferred = false;
+            iter->unmap();
+          }
+      }
+  }
+
+  fastuidraw::scoped_timer timer_draw(timer(fastuidraw::PainterPacker::draw_time));
+  m_backend->on_pre_draw();
+  for(std::vector<per_draw_command>::iterator iter = m_accumulated_draws.begin(),
+        end = m_accumulated_draws.end(); iter != end; ++iter)
+    {
+      assert(iter->m_draw_command->unmapped());
+      iter->m_draw_command->draw();
+    }
+  m_backend->on_post_draw();
+  m_accumulated_draws.clear();
+}
+
+void
+PainterPackerPrivate::
+wait_submission(void)
 {
-  m_prev_state.m_item_group = 0;
-  m_prev_state.m_brush = 0;
-  m_prev_state.m_blend_group = 0;
-  m_prev_state.m_blend_mode = 0;
+  if(!m_submission_thread)
+    {
+      return;
+    }
+
+  uint64_t unmap_time(0), draw_time(0);
+  m_submission_thread->wait(unmap_time, draw_time);
+  if(m_timers_enabled)
+    {
+      m_timers[fastuidraw::PainterPacker::unmap_time] += unmap_time;
+      m_timers[fastuidraw::PainterPacker::draw_time] += draw_time;
+    }
+
+  for(; m_pending_undelays > 0; --m_pending_undelays)
+    {
+      m_backend->image_atlas()->undelay_tile_freeing();
+      m_backend->colorstop_atlas()->undelay_interval_freeing();
+    }
 }
 
+void
+PainterPackerPrivate::
+start_new_command(unsigned int min_attributes, unsigned int min_indices)
+{
+  if(!m_accumulated_draws.empty())
+    {
+      ++m_stats[fastuidraw::PainterPacker::num_draws_room_exhausted];
+    }
+  unmap_current_command();
+
+  if(m_recording_d)
+    {
+      fastuidraw::reference_counted_ptr<RecordedDraw> r;
+      r = m_recording_d->map_draw(m_alignment, min_attributes, min_indices, m_backend_room);
+      m_accumulated_draws.push_back(per_draw_command(r, m_backend->configuration_base(), m_stats.c_ptr(), r.get()));
+    }
+  else
+    {
+      fastuidraw::reference_counted_ptr<const fastuidraw::PainterDraw> r;
+      r = m_backend->map_draw();
+      m_backend_room.m_attributes = r->m_attributes.size();
+      m_backend_room.m_indices = r->m_indices.size();
+      m_backend_room.m_store = r->m_store.size();
+      m_accumulated_draws.push_back(per_draw_command(r, m_backend->configuration_base(), m_stats.c_ptr()));
+    }
+}
 
-fastuidraw::c_array<fastuidraw::generic_data>
-per_draw_command::
-allocate_store(unsigned int num_elements)
+unsigned int
+PainterPackerPrivate::
+compute_room_needed_for_splice(const RecordedDraw &src,
+                               const fastuidraw::PainterPackerData *replay)
 {
-  fastuidraw::c_array<fastuidraw::generic_data> return_value;
-  assert(num_elements % m_alignment == 0);
-  return_value = m_draw_command->m_store.sub_array(store_written(), num_elements);
-  m_store_blocks_written += num_elements / m_alignment;
-  return return_value;
+  unsigned int R(src.m_store_written);
+  if(replay)
+    {
+      /* the replay clip equations and a transformation for
+         each distinct recorded transformation are packed as well
+       */
+      R += compute_room_needed_for_packing(replay->m_clip);
+      R += src.m_matrix_locations.size() * fastuidraw::PainterItemMatrix().data_size(m_alignment);
+    }
+  return R;
 }
 
-void
-per_draw_command::
-pack_state_data(PainterPackerPrivate *p,
-                EntryBase *d, uint32_t &location)
+bool
+PainterPackerPrivate::
+compare_groups(const PainterShaderGroupValues &lhs,
+               const PainterShaderGroupValues &rhs) const
 {
-  if(d->m_painter == p->m_p && d->m_begin_id == p->m_number_begins
-     && d->m_draw_command_id == p->m_accumulated_draws.size())
+  uint32_t brush_mask, lhs_brush, rhs_brush;
+
+  if(lhs.m_blend_mode != rhs.m_blend_mode)
     {
-      location = d->m_offset;
-      return;
+      return lhs.m_blend_mode < rhs.m_blend_mode;
     }
 
-  /* data not in current data store add
-     it to the current store.
-   */
-  fastuidraw::const_c_array<fastuidraw::generic_data> src;
-  fastuidraw::c_array<fastuidraw::generic_data> dst;
+  if(lhs.m_item_group != rhs.m_item_group)
+    {
+      return lhs.m_item_group < rhs.m_item_group;
+    }
 
-  location = current_block();
-  src = fastuidraw::make_c_array(d->m_data);
-  dst = allocate_store(src.size());
-  std::copy(src.begin(), src.end(), dst.begin());
+  if(lhs.m_blend_group != rhs.m_blend_group)
+    {
+      return lhs.m_blend_group < rhs.m_blend_group;
+    }
 
-  d->m_painter = p->m_p;
-  d->m_begin_id = p->m_number_begins;
-  d->m_draw_command_id = p->m_accumulated_draws.size();
-  d->m_offset = location;
+  brush_mask = m_backend->configuration_base().brush_shader_mask();
+  lhs_brush = lhs.m_brush & brush_mask;
+  rhs_brush = rhs.m_brush & brush_mask;
+  return lhs_brush < rhs_brush;
 }
 
 void
-per_draw_command::
-pack_painter_state(const fastuidraw::PainterPackerData &state,
-                   PainterPackerPrivate *p, painter_state_location &out_data)
+PainterPackerPrivate::
+compute_sorted_order(const RecordedDraw &src, bool sort)
 {
-  pack_state_data(p, state.m_clip, out_data.m_clipping_data_loc);
-  pack_state_data(p, state.m_matrix, out_data.m_item_matrix_data_loc);
-  pack_state_data(p, state.m_item_shader_data, out_data.m_item_shader_data_loc);
-  pack_state_data(p, state.m_blend_shader_data, out_data.m_blend_shader_data_loc);
-  pack_state_data(p, state.m_brush, out_data.m_brush_shader_data_loc);
+  /* Moving an item A to be drawn before an item B that was
+     added before it does not change the rendered result if
+     A's z-value is strictly larger than that of B (so B is
+     depth-rejected wherever A is drawn) and the color A writes
+     does not depend on the framebuffer. Thus those headers
+     whose z-value is strictly larger than that of every header
+     before them and whose blending does not read the framebuffer
+     can all be drawn first, in any order; we sort them by shader
+     group and draw the remaining headers after them in the
+     order they were added. Headers hidden by occlusion are
+     not drawn and thus do not constrain the order.
+   */
+  std::vector<unsigned int> &order(m_work_room.m_splice_order);
+  std::vector<unsigned int> &late(m_work_room.m_splice_late);
+  uint32_t max_z(0);
+  bool first(true);
+
+  order.clear();
+  late.clear();
+  for(unsigned int h = 0, endh = src.m_headers.size(); h < endh; ++h)
+    {
+      uint32_t z;
+
+      if(src.m_headers[h].m_hidden)
+        {
+          ++m_stats[fastuidraw::PainterPacker::num_headers_occluded];
+          continue;
+        }
+
+      if(!sort)
+        {
+          order.push_back(h);
+          continue;
+        }
+
+      z = src.m_store[src.m_headers[h].m_location * m_alignment + fastuidraw::PainterHeader::z_offset].u;
+      if(src.m_headers[h].m_dst_independent && (first || z > max_z))
+        {
+          order.push_back(h);
+        }
+      else
+        {
+          late.push_back(h);
+        }
+      max_z = fastuidraw::t_max(max_z, z);
+      first = false;
+    }
+
+  /* without sorting, the visible headers stay in the
+     order they were added
+   */
+  if(!sort)
+    {
+      return;
+    }
+
+  /* insertion sort, stable and the number of
+     headers per recorded buffer is modest.
+   */
+  for(unsigned int i = 1, endi = order.size(); i < endi; ++i)
+    {
+      unsigned int v(order[i]), j(i);
+      for(; j > 0 && compare_groups(src.m_headers[v].m_group, src.m_headers[order[j - 1]].m_group); --j)
+        {
+          order[j] = order[j - 1];
+        }
+      order[j] = v;
+    }
+  order.insert(order.end(), late.begin(), late.end());
 }
 
-unsigned int
-per_draw_command::
-pack_header(unsigned int header_size,
-            uint32_t brush_shader,
-            const fastuidraw::reference_counted_ptr<fastuidraw::PainterBlendShader> &blend_shader,
-            uint64_t blend_mode,
-            const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &item_shader,
-            unsigned int z,
-            const painter_state_location &loc,
-            const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back)
+void
+PainterPackerPrivate::
+splice_sort_recording(void)
 {
-  unsigned int return_value;
-  fastuidraw::c_array<fastuidraw::generic_data> dst;
-  fastuidraw::PainterHeader header;
+  PainterRecordingPrivate *rec(m_recording_d);
 
-  return_value = current_block();
-  dst = allocate_store(header_size);
+  assert(m_recording == m_sort_recording);
+  assert(m_accumulated_draws.empty());
 
-  if(call_back)
+  rec->finalize(m_alignment);
+  m_recording_d = NULL;
+  m_recording = fastuidraw::reference_counted_ptr<fastuidraw::PainterRecording>();
+
+  /* the stats reflect the draws sent to the backend, but the
+     data store values reused are only known while recording
+   */
+  unsigned int reused(m_stats[fastuidraw::PainterPacker::num_generic_datas_reused]);
+  unsigned int deduplicated(m_stats[fastuidraw::PainterPacker::num_generic_datas_deduplicated]);
+  std::fill(m_stats.begin(), m_stats.end(), 0u);
+  m_stats[fastuidraw::PainterPacker::num_generic_datas_reused] = reused;
+  m_stats[fastuidraw::PainterPacker::num_generic_datas_deduplicated] = deduplicated;
+  if(m_occlusion_culling)
     {
-      call_back->current_draw(m_draw_command);
+      compute_occlusion(rec);
     }
 
-  PainterShaderGroupPrivate current;
-  fastuidraw::PainterShader::Tag blend;
+  start_new_command();
+  for(unsigned int i = 0, endi = rec->m_draws.size(); i < endi; ++i)
+    {
+      draw_recorded(*rec->m_draws[i], 0, NULL, m_sort_by_shader_group, m_occlusion_culling);
+    }
+  unmap_current_command();
+}
 
-  if(blend_shader)
+void
+PainterPackerPrivate::
+compute_occlusion(PainterRecordingPrivate *rec)
+{
+  /* The z-value of an item is no smaller than that of every
+     item drawn before it and the depth test passes on equal
+     values, thus an opaque item hides everything drawn before
+     it that is within it. We walk the headers
+     from the last drawn to the first drawn, marking those
+     whose bounds are covered by the opaque items drawn after
+     them. The occluder of an item is only added once all the
+     headers of the item are visited, so that an item does
+     not hide itself.
+   */
+  const unsigned int no_item = ~0u;
+  unsigned int current_item(no_item);
+  ItemBounds current_occluder;
+
+  m_occlusion_grid.clear();
+  for(unsigned int d = rec->m_draws.size(); d > 0; --d)
     {
-      blend = blend_shader->tag();
+      std::vector<RecordedHeader> &headers(rec->m_draws[d - 1]->m_headers);
+      for(unsigned int h = headers.size(); h > 0; --h)
+        {
+          RecordedHeader &header(headers[h - 1]);
+
+          if(header.m_bounds.m_item != current_item || !header.m_bounds.m_has_bounds)
+            {
+              if(current_occluder.m_occluder)
+                {
+                  m_occlusion_grid.add_occluder(current_occluder.m_min, current_occluder.m_max);
+                }
+              current_occluder = header.m_bounds;
+              current_item = (header.m_bounds.m_has_bounds) ? header.m_bounds.m_item : no_item;
+            }
+
+          header.m_hidden = header.m_bounds.m_has_bounds
+            && m_occlusion_grid.covered(header.m_bounds.m_min, header.m_bounds.m_max);
+        }
     }
-  current.m_item_group = item_shader->group();
-  current.m_brush = brush_shader;
-  current.m_blend_group = blend.m_group;
-  current.m_blend_mode = blend_mode;
+}
 
-  header.m_clip_equations_location = loc.m_clipping_data_loc;
-  header.m_item_matrix_location = loc.m_item_matrix_data_loc;
-  header.m_brush_shader_data_location = loc.m_brush_shader_data_loc;
-  header.m_item_shader_data_location = loc.m_item_shader_data_loc;
-  header.m_blend_shader_data_location = loc.m_blend_shader_data_loc;
-  header.m_item_shader = item_shader->ID();
-  header.m_brush_shader = current.m_brush;
-  header.m_blend_shader = blend.m_ID;
-  header.m_z = z;
-  header.pack_data(m_alignment, dst);
+void
+PainterPackerPrivate::
+draw_recorded(const RecordedDraw &src, int z_adjust,
+              const fastuidraw::PainterPackerData *replay,
+              bool sort, bool occlusion)
+{
+  fastuidraw::scoped_timer timer_packing(timer(fastuidraw::PainterPacker::packing_time));
+  unsigned int store_needed;
 
-  if(current.m_item_group != m_prev_state.m_item_group
-     || current.m_blend_group != m_prev_state.m_blend_group
-     || (m_brush_shader_mask & (current.m_brush ^ m_prev_state.m_brush)) != 0u
-     || current.m_blend_mode != m_prev_state.m_blend_mode)
+  fastuidraw::const_c_array<unsigned int> order;
+
+  assert(!m_accumulated_draws.empty());
+  if(sort || occlusion)
     {
-      m_draw_command->draw_break(m_prev_state, current,
-                                 m_attributes_written,
-                                 m_indices_written);
+      compute_sorted_order(src, sort);
+      if(m_work_room.m_splice_order.empty())
+        {
+          return;
+        }
+      order = fastuidraw::make_c_array(m_work_room.m_splice_order);
     }
 
-  m_prev_state = current;
+  store_needed = compute_room_needed_for_splice(src, replay);
+  if(m_accumulated_draws.back().attribute_room() < src.m_attributes_written
+     || m_accumulated_draws.back().index_room() < src.m_indices_written
+     || m_accumulated_draws.back().store_room() < store_needed)
+    {
+      start_new_command();
+      store_needed = compute_room_needed_for_splice(src, replay);
+    }
 
-  if(call_back)
+  per_draw_command &cmd(m_accumulated_draws.back());
+  if(cmd.attribute_room() < src.m_attributes_written
+     || cmd.index_room() < src.m_indices_written
+     || cmd.store_room() < store_needed)
     {
-      call_back->header_added(header, dst);
+      /* the recorded buffer is larger than a draw command of
+         the backend, which happens if the PainterRecording
+         was made with larger buffer sizes than the backend
+         has, or a chunk was recorded to a buffer of its own
+         size; it is spliced a range of headers at a time.
+       */
+      draw_recorded_split(src, z_adjust, replay, order);
+      return;
     }
 
-  return return_value;
+  m_stats[fastuidraw::PainterPacker::num_headers] += (order.empty()) ? src.m_headers.size() : order.size();
+  cmd.splice(src, z_adjust, this, replay, order);
 }
 
-///////////////////////////////////////////
-// PainterPackerPrivate methods
+void
 PainterPackerPrivate::
-PainterPackerPrivate(fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> backend,
-                     fastuidraw::PainterPacker *p):
-  m_backend(backend),
-  m_p(p)
+draw_recorded_split(const RecordedDraw &src, int z_adjust,
+                    const fastuidraw::PainterPackerData *replay,
+                    fastuidraw::const_c_array<unsigned int> order)
 {
-  m_alignment = m_backend->configuration_base().alignment();
-  m_header_size = fastuidraw::PainterHeader::data_size(m_alignment);
-  // By calling PainterBackend::default_shaders(), we make the shaders
-  // registered. By setting m_default_shaders to its return value,
-  // and using that for the return value of PainterPacker::default_shaders(),
-  // we skip the check in PainterBackend::default_shaders() to register
-  // the shaders as well.
-  m_default_shaders = m_backend->default_shaders();
-  m_number_begins = 0;
+  unsigned int store_needed;
+
+  if(order.empty())
+    {
+      m_work_room.m_splice_order.resize(src.m_headers.size());
+      for(unsigned int h = 0, endh = src.m_headers.size(); h < endh; ++h)
+        {
+          m_work_room.m_splice_order[h] = h;
+        }
+      order = fastuidraw::make_c_array(m_work_room.m_splice_order);
+    }
+
+  /* the headers of a range may refer to any of the store
+     of src, so all of it is spliced with each range; the
+     current draw command is fresh, see draw_recorded().
+   */
+  store_needed = compute_room_needed_for_splice(src, replay);
+  for(unsigned int k = 0, endk = order.size(); k < endk;)
+    {
+      per_draw_command &cmd(m_accumulated_draws.back());
+      unsigned int attribs(0), indices(0), k_end;
+
+      if(cmd.store_room() < store_needed)
+        {
+          warn_content_dropped("a recorded buffer", src.m_attributes_written,
+                               src.m_indices_written, store_needed);
+          return;
+        }
+
+      for(k_end = k; k_end < endk; ++k_end)
+        {
+          unsigned int h(order[k_end]);
+          unsigned int a(src.attributes_end(h) - src.m_headers[h].m_attributes_written);
+          unsigned int i(src.indices_end(h) - src.m_headers[h].m_indices_written);
+
+          if(attribs + a > cmd.attribute_room() || indices + i > cmd.index_room())
+            {
+              break;
+            }
+          attribs += a;
+          indices += i;
+        }
+
+      if(k_end == k)
+        {
+          unsigned int h(order[k]);
+
+          /* the header alone does not fit the fresh draw command */
+          warn_content_dropped("a recorded item",
+                               src.attributes_end(h) - src.m_headers[h].m_attributes_written,
+                               src.indices_end(h) - src.m_headers[h].m_indices_written,
+                               store_needed);
+          ++k;
+          continue;
+        }
+
+      m_stats[fastuidraw::PainterPacker::num_headers] += k_end - k;
+      cmd.splice(src, z_adjust, this, replay, order.sub_array(k, k_end - k));
+      k = k_end;
+      if(k < endk)
+        {
+          start_new_command();
+          store_needed = compute_room_needed_for_splice(src, replay);
+        }
+    }
 }
 
 void
 PainterPackerPrivate::
-start_new_command(void)
+warn_content_dropped(const char *what, unsigned int attributes,
+                     unsigned int indices, unsigned int store)
 {
-  if(!m_accumulated_draws.empty())
+  if(!m_warned_content_dropped)
     {
-      per_draw_command &c(m_accumulated_draws.back());
-
-      m_stats[fastuidraw::PainterPacker::num_attributes] += c.m_attributes_written;
-      m_stats[fastuidraw::PainterPacker::num_indices] += c.m_indices_written;
-      m_stats[fastuidraw::PainterPacker::num_generic_datas] += c.store_written();
-      m_stats[fastuidraw::PainterPacker::num_draws] += 1u;
-
-      c.unmap();
+      m_warned_content_dropped = true;
+      std::cerr << "[" << __FILE__ << ", " << __LINE__
+                << "] PainterPacker: " << what << " needs room for "
+                << attributes << " attributes, " << indices << " indices and "
+                << store << " generic_data values of the data store, more than "
+                << "a PainterDraw of the PainterBackend has; it is not drawn\n";
     }
-
-  fastuidraw::reference_counted_ptr<const fastuidraw::PainterDraw> r;
-  r = m_backend->map_draw();
-  m_accumulated_draws.push_back(per_draw_command(r, m_backend->configuration_base()));
 }
 
 unsigned int
@@ -720,6 +2487,179 @@ upload_draw_state(const fastuidraw::PainterPackerData &draw_state)
   m_accumulated_draws.back().pack_painter_state(draw_state, this, m_painter_state_location);
 }
 
+///////////////////////////////////////////
+// PainterRecordingPrivate methods
+PainterRecordingPrivate::
+~PainterRecordingPrivate()
+{
+  assert(!m_recording);
+  m_draws.clear();
+  for(unsigned int i = 0, endi = m_storage.size(); i < endi; ++i)
+    {
+      FASTUIDRAWdelete(m_storage[i]);
+    }
+}
+
+fastuidraw::reference_counted_ptr<RecordedDraw>
+PainterRecordingPrivate::
+map_draw(unsigned int alignment, unsigned int min_attributes,
+         unsigned int min_indices, const DrawRoom &max_room)
+{
+  RecordedStorage *storage;
+  unsigned int store_size;
+  fastuidraw::reference_counted_ptr<RecordedDraw> return_value;
+  std::vector<RecordedStorage*> &pool(m_capture_storage ? *m_capture_storage : m_storage);
+
+  assert(m_recording);
+  if(m_draws.size() == pool.size())
+    {
+      pool.push_back(FASTUIDRAWnew RecordedStorage());
+    }
+
+  /* the storage may have been shrunk by shrink(), if
+     not the resizes do not allocate; a chunk larger than
+     the buffers (for example the chunk of all of a stroked
+     path that is not culled within a display list) gets
+     buffers of its size. No buffer is made larger than
+     max_room, since a recorded buffer is spliced into
+     the draw commands of a backend.
+   */
+  min_attributes = fastuidraw::t_max(min_attributes, m_attributes_per_buffer);
+  min_indices = fastuidraw::t_max(min_indices, m_indices_per_buffer);
+  store_size = m_data_blocks_per_store_buffer * alignment;
+  if(max_room.m_attributes != 0)
+    {
+      min_attributes = fastuidraw::t_min(min_attributes, max_room.m_attributes);
+    }
+  if(max_room.m_indices != 0)
+    {
+      min_indices = fastuidraw::t_min(min_indices, max_room.m_indices);
+    }
+  if(max_room.m_store != 0)
+    {
+      store_size = fastuidraw::t_min(store_size, max_room.m_store);
+    }
+
+  storage = pool[m_draws.size()];
+  storage->m_attributes.resize(min_attributes);
+  storage->m_header_attributes.resize(min_attributes);
+  storage->m_indices.resize(min_indices);
+  storage->m_store.resize(store_size);
+
+  return_value = FASTUIDRAWnew RecordedDraw(storage);
+  m_draws.push_back(return_value);
+  return return_value;
+}
+
+void
+PainterRecordingPrivate::
+clear(void)
+{
+  assert(!m_recording);
+  m_draws.clear();
+  m_max_z = 0;
+}
+
+void
+PainterRecordingPrivate::
+shrink(void)
+{
+  assert(!m_recording);
+  assert(!m_capture_storage);
+  for(unsigned int i = 0, endi = m_draws.size(); i < endi; ++i)
+    {
+      copy_used(*m_draws[i], *m_storage[i], m_storage[i]);
+    }
+
+  for(unsigned int i = m_draws.size(), endi = m_storage.size(); i < endi; ++i)
+    {
+      FASTUIDRAWdelete(m_storage[i]);
+    }
+  m_storage.resize(m_draws.size());
+}
+
+void
+PainterRecordingPrivate::
+end_capture_storage(void)
+{
+  assert(m_capture_storage);
+  for(unsigned int i = 0, endi = m_draws.size(); i < endi; ++i)
+    {
+      if(i == m_storage.size())
+        {
+          m_storage.push_back(FASTUIDRAWnew RecordedStorage());
+        }
+      copy_used(*m_draws[i], *(*m_capture_storage)[i], m_storage[i]);
+    }
+
+  for(unsigned int i = m_draws.size(), endi = m_storage.size(); i < endi; ++i)
+    {
+      FASTUIDRAWdelete(m_storage[i]);
+    }
+  m_storage.resize(m_draws.size());
+  m_capture_storage = NULL;
+}
+
+void
+PainterRecordingPrivate::
+copy_used(RecordedDraw &draw, const RecordedStorage &src, RecordedStorage *dst)
+{
+  std::vector<fastuidraw::PainterAttribute>(src.m_attributes.begin(),
+                                            src.m_attributes.begin() + draw.m_attributes_written).swap(dst->m_attributes);
+  std::vector<uint32_t>(src.m_header_attributes.begin(),
+                        src.m_header_attributes.begin() + draw.m_attributes_written).swap(dst->m_header_attributes);
+  std::vector<fastuidraw::PainterIndex>(src.m_indices.begin(),
+                                        src.m_indices.begin() + draw.m_indices_written).swap(dst->m_indices);
+  std::vector<fastuidraw::generic_data>(src.m_store.begin(),
+                                        src.m_store.begin() + draw.m_store_written).swap(dst->m_store);
+
+  draw.m_attributes = fastuidraw::make_c_array(dst->m_attributes);
+  draw.m_header_attributes = fastuidraw::make_c_array(dst->m_header_attributes);
+  draw.m_indices = fastuidraw::make_c_array(dst->m_indices);
+  draw.m_store = fastuidraw::make_c_array(dst->m_store);
+}
+
+void
+PainterRecordingPrivate::
+finalize(unsigned int alignment)
+{
+  /* the z-values of headers may be modified by actions
+     (see PainterDraw::DelayedAction), thus the largest
+     z-value is fetched only after each recorded draw
+     has been unmapped.
+   */
+  m_max_z = 0;
+  for(unsigned int d = 0, endd = m_draws.size(); d < endd; ++d)
+    {
+      RecordedDraw &draw(*m_draws[d]);
+      std::map<uint32_t, unsigned int> matrix_index;
+
+      assert(draw.unmapped());
+      draw.m_matrix_locations.clear();
+      draw.m_header_matrix_index.resize(draw.m_headers.size());
+      for(unsigned int h = 0, endh = draw.m_headers.size(); h < endh; ++h)
+        {
+          fastuidraw::const_c_array<fastuidraw::generic_data> header;
+          uint32_t matrix_location;
+          std::map<uint32_t, unsigned int>::iterator iter;
+
+          header = draw.m_store.sub_array(draw.m_headers[h].m_location * alignment,
+                                          fastuidraw::PainterHeader::header_size);
+          m_max_z = fastuidraw::t_max(m_max_z, header[fastuidraw::PainterHeader::z_offset].u);
+
+          matrix_location = header[fastuidraw::PainterHeader::item_matrix_location_offset].u;
+          iter = matrix_index.find(matrix_location);
+          if(iter == matrix_index.end())
+            {
+              iter = matrix_index.insert(std::make_pair(matrix_location, draw.m_matrix_locations.size())).first;
+              draw.m_matrix_locations.push_back(matrix_location);
+            }
+          draw.m_header_matrix_index[h] = iter->second;
+        }
+    }
+  m_recording = false;
+}
+
 /////////////////////////////////////////
 // fastuidraw::PainterShaderGroup methods
 uint32_t
@@ -786,65 +2726,207 @@ begin(void)
   assert(d->m_accumulated_draws.empty());
   d->m_backend->image_atlas()->delay_tile_freeing();
   d->m_backend->colorstop_atlas()->delay_interval_freeing();
-  std::fill(d->m_stats.begin(), d->m_stats.end(), 0u);
+  d->reset_stats();
+  d->m_item_bounds = ItemBounds();
+  d->m_number_items = 0;
+  d->m_pipelined_frame = d->m_pipelined_submission
+    && d->m_backend->hints().thread_safe_submission();
+  if(d->m_sort_by_shader_group || d->m_occlusion_culling)
+    {
+      if(!d->m_sort_recording)
+        {
+          d->m_sort_recording = FASTUIDRAWnew PainterRecording();
+        }
+      d->m_recording = d->m_sort_recording;
+      d->m_recording_d = reinterpret_cast<PainterRecordingPrivate*>(d->m_sort_recording->m_d);
+      d->m_recording_d->clear();
+      d->m_recording_d->m_recording = true;
+    }
+  d->start_new_command();
+  ++d->m_number_begins;
+}
+
+void
+fastuidraw::PainterPacker::
+begin(const reference_counted_ptr<PainterRecording> &recording)
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+
+  assert(recording);
+  assert(d->m_accumulated_draws.empty());
+
+  d->m_recording = recording;
+  d->m_recording_d = reinterpret_cast<PainterRecordingPrivate*>(recording->m_d);
+  d->m_recording_d->clear();
+  d->m_recording_d->m_recording = true;
+
+  d->reset_stats();
   d->start_new_command();
   ++d->m_number_begins;
 }
 
 unsigned int
 fastuidraw::PainterPacker::
-query_stat(enum stats_t st) const
+query_stat(enum stats_t st) const
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+
+  vecN<unsigned int, num_stats> tmp(0);
+  if(!d->m_accumulated_draws.empty())
+    {
+      per_draw_command &c(d->m_accumulated_draws.back());
+      tmp[num_attributes] = c.m_attributes_written;
+      tmp[num_indices] = c.m_indices_written;
+      tmp[num_generic_datas] = c.store_written();
+    }
+  return d->m_stats[st] + tmp[st];
+}
+
+void
+fastuidraw::PainterPacker::
+flush(void)
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+  d->flush(false);
+}
+
+void
+fastuidraw::PainterPacker::
+end(void)
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+
+  d->flush(d->m_pipelined_frame);
+  if(d->m_recording_d)
+    {
+      assert(d->m_recording != d->m_sort_recording);
+      d->m_recording_d->finalize(d->m_alignment);
+      d->m_recording_d = NULL;
+      d->m_recording = reference_counted_ptr<PainterRecording>();
+    }
+  else if(d->m_pipelined_frame)
+    {
+      /* the submission thread may still read the atlases
+         for the draws of this frame
+       */
+      ++d->m_pending_undelays;
+    }
+  else
+    {
+      image_atlas()->undelay_tile_freeing();
+      colorstop_atlas()->undelay_interval_freeing();
+    }
+  d->m_pipelined_frame = false;
+}
+
+void
+fastuidraw::PainterPacker::
+wait_submission(void)
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+  d->wait_submission();
+}
+
+void
+fastuidraw::PainterPacker::
+begin_capture(const reference_counted_ptr<PainterRecording> &recording)
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+
+  assert(recording);
+  assert(recording != d->m_recording);
+  assert(!d->m_accumulated_draws.empty());
+
+  /* the frame itself may be recording (for example if
+     sort_by_shader_group() is true)
+   */
+  d->m_recording_before_capture = d->m_recording;
+  d->m_recording_d_before_capture = d->m_recording_d;
+  d->m_recording = recording;
+  d->m_recording_d = reinterpret_cast<PainterRecordingPrivate*>(recording->m_d);
+  d->m_recording_d->clear();
+  d->m_recording_d->m_recording = true;
+  d->m_recording_d->m_capture_storage = &d->m_capture_storage;
+
+  /* incrementing m_number_begins makes the packed values
+     already packed into the draws of the frame get packed
+     again into the recording.
+   */
+  d->m_draws_before_capture.swap(d->m_accumulated_draws);
+  ++d->m_number_begins;
+  d->start_new_command();
+}
+
+void
+fastuidraw::PainterPacker::
+end_capture(void)
 {
   PainterPackerPrivate *d;
   d = reinterpret_cast<PainterPackerPrivate*>(m_d);
 
-  vecN<unsigned int, num_stats> tmp(0);
-  if(!d->m_accumulated_draws.empty())
-    {
-      per_draw_command &c(d->m_accumulated_draws.back());
-      tmp[num_attributes] = c.m_attributes_written;
-      tmp[num_indices] = c.m_indices_written;
-      tmp[num_generic_datas] = c.store_written();
-    }
-  return d->m_stats[st] + tmp[st];
+  assert(d->m_recording_d);
+  assert(!d->m_draws_before_capture.empty());
+
+  d->unmap_current_command();
+  d->m_accumulated_draws.clear();
+  d->m_recording_d->finalize(d->m_alignment);
+  d->m_recording_d->end_capture_storage();
+  d->m_recording_d = d->m_recording_d_before_capture;
+  d->m_recording = d->m_recording_before_capture;
+  d->m_recording_d_before_capture = NULL;
+  d->m_recording_before_capture = reference_counted_ptr<PainterRecording>();
+
+  d->m_accumulated_draws.swap(d->m_draws_before_capture);
+  ++d->m_number_begins;
 }
 
 void
 fastuidraw::PainterPacker::
-flush(void)
+draw_recording(const PainterRecording &recording,
+               const PainterData::value<PainterItemMatrix> &matrix,
+               const PainterData::value<PainterClipEquations> &clip,
+               int z_adjust)
 {
   PainterPackerPrivate *d;
-  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
-  if(!d->m_accumulated_draws.empty())
-    {
-      per_draw_command &c(d->m_accumulated_draws.back());
+  PainterRecordingPrivate *rec;
+  PainterPackerData replay;
 
-      d->m_stats[fastuidraw::PainterPacker::num_attributes] += c.m_attributes_written;
-      d->m_stats[fastuidraw::PainterPacker::num_indices] += c.m_indices_written;
-      d->m_stats[fastuidraw::PainterPacker::num_generic_datas] += c.store_written();
-      d->m_stats[fastuidraw::PainterPacker::num_draws] += 1u;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+  rec = reinterpret_cast<PainterRecordingPrivate*>(recording.m_d);
 
-      c.unmap();
-    }
+  assert(!rec->m_recording);
+  assert(rec != d->m_recording_d);
 
-  d->m_backend->on_pre_draw();
-  for(std::vector<per_draw_command>::iterator iter = d->m_accumulated_draws.begin(),
-        end = d->m_accumulated_draws.end(); iter != end; ++iter)
+  replay.m_matrix = matrix;
+  replay.m_clip = clip;
+  for(unsigned int i = 0, endi = rec->m_draws.size(); i < endi; ++i)
     {
-      assert(iter->m_draw_command->unmapped());
-      iter->m_draw_command->draw();
+      d->draw_recorded(*rec->m_draws[i], z_adjust, &replay);
     }
-  d->m_backend->on_post_draw();
-  d->m_accumulated_draws.clear();
 }
 
 void
 fastuidraw::PainterPacker::
-end(void)
+draw_recording(const PainterRecording &recording, int z_adjust)
 {
-  flush();
-  image_atlas()->undelay_tile_freeing();
-  colorstop_atlas()->undelay_interval_freeing();
+  PainterPackerPrivate *d;
+  PainterRecordingPrivate *rec;
+
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+  rec = reinterpret_cast<PainterRecordingPrivate*>(recording.m_d);
+
+  assert(!rec->m_recording);
+  assert(rec != d->m_recording_d);
+  for(unsigned int i = 0, endi = rec->m_draws.size(); i < endi; ++i)
+    {
+      d->draw_recorded(*rec->m_draws[i], z_adjust, NULL);
+    }
 }
 
 void
@@ -884,6 +2966,10 @@ draw_generic(const reference_counted_ptr<PainterItemShader> &shader,
          || (attrib_chunk_selector.size() == index_chunks.size()) );
   assert(index_adjusts.size() == index_chunks.size());
 
+  ItemBounds bounds(d->m_item_bounds);
+  d->m_item_bounds = ItemBounds();
+  bounds.m_item = d->m_number_items++;
+
   if(attrib_chunks.empty() || !shader)
     {
       /* should we emit a warning message that the PainterItemShader
@@ -892,6 +2978,9 @@ draw_generic(const reference_counted_ptr<PainterItemShader> &shader,
       return;
     }
 
+  sampled_scoped_timer timer_packing(d->timer(packing_time), d->m_packing_sampler);
+  d->count_item(shader);
+
   d->m_work_room.m_attribs_loaded.clear();
   d->m_work_room.m_attribs_loaded.resize(attrib_chunk_selector.size(), NOT_LOADED);
 
@@ -930,7 +3019,7 @@ draw_generic(const reference_counted_ptr<PainterItemShader> &shader,
       if(attrib_room < needed_attrib_room || index_room < index_chunks[chunk].size()
          || (allocate_header && data_room < d->m_header_size))
         {
-          d->start_new_command();
+          d->start_new_command(attrib_chunks[attrib_src].size(), index_chunks[chunk].size());
           d->upload_draw_state(draw);
 
           /* reset attribs_loaded[] and recompute needed_attrib_room
@@ -948,7 +3037,8 @@ draw_generic(const reference_counted_ptr<PainterItemShader> &shader,
 
           if(attrib_room < needed_attrib_room || index_room < index_chunks[chunk].size())
             {
-              assert(!"Unable to fit chunk into freshly allocated draw command, not good!");
+              d->warn_content_dropped("a chunk of an item", needed_attrib_room,
+                                      index_chunks[chunk].size(), d->m_header_size);
               continue;
             }
 
@@ -966,7 +3056,7 @@ draw_generic(const reference_counted_ptr<PainterItemShader> &shader,
                                        d->m_blend_mode,
                                        shader,
                                        z, d->m_painter_state_location,
-                                       call_back);
+                                       bounds, call_back);
         }
 
       /* copy attribute data and get offset into attribute buffer
@@ -984,7 +3074,10 @@ draw_generic(const reference_counted_ptr<PainterItemShader> &shader,
           attrib_dst_ptr = cmd.m_draw_command->m_attributes.sub_array(cmd.m_attributes_written, attrib_src_ptr.size());
           header_dst_ptr = cmd.m_draw_command->m_header_attributes.sub_array(cmd.m_attributes_written, attrib_src_ptr.size());
 
-          std::memcpy(attrib_dst_ptr.c_ptr(), attrib_src_ptr.c_ptr(), sizeof(PainterAttribute) * attrib_dst_ptr.size());
+          /* see per_draw_command::splice() for the casts to void* */
+          std::memcpy(static_cast<void*>(attrib_dst_ptr.c_ptr()),
+                      static_cast<const void*>(attrib_src_ptr.c_ptr()),
+                      sizeof(PainterAttribute) * attrib_dst_ptr.size());
           std::fill(header_dst_ptr.begin(), header_dst_ptr.end(), header_loc);
 
           if(!attrib_chunk_selector.empty())
@@ -1019,6 +3112,131 @@ draw_generic(const reference_counted_ptr<PainterItemShader> &shader,
     }
 }
 
+void
+fastuidraw::PainterPacker::
+draw_generic(const reference_counted_ptr<PainterItemShader> &shader,
+             const PainterPackerData &draw,
+             const reference_counted_ptr<const PainterStaticAttributeData> &static_data,
+             const_c_array<unsigned int> chunks,
+             unsigned int z,
+             const reference_counted_ptr<DataCallBack> &call_back)
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+
+  if(!static_data || !shader)
+    {
+      return;
+    }
+
+  d->m_work_room.m_static_index_ranges.clear();
+  d->m_work_room.m_static_attrib_ranges.clear();
+  for(unsigned int i = 0, endi = chunks.size(); i < endi; ++i)
+    {
+      range_type<unsigned int> R;
+
+      R = static_data->index_data_chunk(chunks[i]);
+      if(R.m_end > R.m_begin)
+        {
+          d->m_work_room.m_static_index_ranges.push_back(R);
+          d->m_work_room.m_static_attrib_ranges.push_back(static_data->attribute_data_chunk(chunks[i]));
+        }
+    }
+
+  if(d->m_work_room.m_static_index_ranges.empty())
+    {
+      return;
+    }
+
+  if(d->m_recording_d || !static_data->backend_resident())
+    {
+      /* copy only the attributes referenced by each chunk drawn;
+         chunks that reference the same attributes (for example
+         the index chunks of a FilledPath) share one copy. The
+         indices of static_data are relative to the start of
+         attribute_data() and so are rebased to the start of
+         the attributes of their chunk.
+       */
+      const_c_array<PainterAttribute> attributes(static_data->attribute_data());
+      const_c_array<PainterIndex> indices(static_data->index_data());
+
+      d->m_work_room.m_static_attrib_chunks.clear();
+      d->m_work_room.m_static_index_chunks.clear();
+      d->m_work_room.m_static_index_adjusts.clear();
+      d->m_work_room.m_static_selector.clear();
+      for(unsigned int i = 0, endi = d->m_work_room.m_static_index_ranges.size(); i < endi; ++i)
+        {
+          const range_type<unsigned int> &R(d->m_work_room.m_static_index_ranges[i]);
+          const range_type<unsigned int> &A(d->m_work_room.m_static_attrib_ranges[i]);
+          unsigned int K;
+
+          for(K = 0; K < i; ++K)
+            {
+              const range_type<unsigned int> &B(d->m_work_room.m_static_attrib_ranges[K]);
+              if(A.m_begin == B.m_begin && A.m_end == B.m_end)
+                {
+                  break;
+                }
+            }
+
+          if(K == i)
+            {
+              d->m_work_room.m_static_selector.push_back(d->m_work_room.m_static_attrib_chunks.size());
+              d->m_work_room.m_static_attrib_chunks.push_back(attributes.sub_array(A.m_begin, A.difference()));
+            }
+          else
+            {
+              d->m_work_room.m_static_selector.push_back(d->m_work_room.m_static_selector[K]);
+            }
+          d->m_work_room.m_static_index_chunks.push_back(indices.sub_array(R.m_begin, R.difference()));
+          d->m_work_room.m_static_index_adjusts.push_back(-int(A.m_begin));
+        }
+
+      draw_generic(shader, draw,
+                   make_c_array(d->m_work_room.m_static_attrib_chunks),
+                   make_c_array(d->m_work_room.m_static_index_chunks),
+                   make_c_array(d->m_work_room.m_static_index_adjusts),
+                   make_c_array(d->m_work_room.m_static_selector),
+                   z, call_back);
+      return;
+    }
+
+  /* only the painter state and the header are packed, the
+     attributes and indices are drawn directly from static_data.
+   */
+  sampled_scoped_timer timer_packing(d->timer(packing_time), d->m_packing_sampler);
+  d->count_item(shader);
+  d->upload_draw_state(draw);
+  if(d->m_accumulated_draws.back().store_room() < d->m_header_size)
+    {
+      d->start_new_command();
+      d->upload_draw_state(draw);
+    }
+
+  per_draw_command &cmd(d->m_accumulated_draws.back());
+  unsigned int header_loc;
+
+  /* bounds are only used when recording
+   */
+  d->m_item_bounds = ItemBounds();
+  ++d->m_number_items;
+
+  assert(cmd.store_room() >= d->m_header_size);
+  ++d->m_stats[num_headers];
+  header_loc = cmd.pack_header(d->m_header_size,
+                               fetch_value(draw.m_brush).shader(),
+                               d->m_blend_shader,
+                               d->m_blend_mode,
+                               shader,
+                               z, d->m_painter_state_location,
+                               ItemBounds(), call_back);
+  cmd.m_draw_command->draw_static(static_data,
+                                  make_c_array(d->m_work_room.m_static_index_ranges),
+                                  header_loc,
+                                  cmd.m_attributes_written,
+                                  cmd.m_indices_written);
+}
+
 const fastuidraw::reference_counted_ptr<fastuidraw::GlyphAtlas>&
 fastuidraw::PainterPacker::
 glyph_atlas(void) const
@@ -1166,6 +3384,208 @@ target_resolution(int w, int h)
   d->m_backend->target_resolution(w, h);
 }
 
+uint64_t
+fastuidraw::PainterPacker::
+query_timer(enum timer_t t) const
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+  return d->m_timers[t];
+}
+
+void
+fastuidraw::PainterPacker::
+accumulate_timer(enum timer_t t, uint64_t nanoseconds)
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+  if(d->m_timers_enabled)
+    {
+      d->m_timers[t] += nanoseconds;
+    }
+}
+
+void
+fastuidraw::PainterPacker::
+timers_enabled(bool v)
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+  d->m_timers_enabled = v;
+}
+
+bool
+fastuidraw::PainterPacker::
+timers_enabled(void) const
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+  return d->m_timers_enabled;
+}
+
+fastuidraw::const_c_array<unsigned int>
+fastuidraw::PainterPacker::
+item_shader_stats(void) const
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+  return make_c_array(d->m_item_shader_stats);
+}
+
+const char*
+fastuidraw::PainterPacker::
+stat_name(enum stats_t st)
+{
+  #define CASE(X) case X: return #X
+
+  switch(st)
+    {
+    default:
+      return "UNKNOWN_STAT";
+
+      CASE(num_attributes);
+      CASE(num_indices);
+      CASE(num_generic_datas);
+      CASE(num_draws);
+      CASE(num_headers);
+      CASE(num_draw_breaks);
+      CASE(num_draw_breaks_blend_mode);
+      CASE(num_draw_breaks_item_group);
+      CASE(num_draw_breaks_blend_group);
+      CASE(num_draw_breaks_brush);
+      CASE(num_draws_room_exhausted);
+      CASE(num_generic_datas_reused);
+      CASE(num_generic_datas_deduplicated);
+      CASE(num_headers_occluded);
+    }
+
+  #undef CASE
+}
+
+const char*
+fastuidraw::PainterPacker::
+timer_name(enum timer_t t)
+{
+  #define CASE(X) case X: return #X
+
+  switch(t)
+    {
+    default:
+      return "UNKNOWN_TIMER";
+
+      CASE(packing_time);
+      CASE(unmap_time);
+      CASE(draw_time);
+      CASE(clip_culling_time);
+    }
+
+  #undef CASE
+}
+
+void
+fastuidraw::PainterPacker::
+print_stats(std::ostream &str) const
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+
+  for(unsigned int i = 0; i < num_stats; ++i)
+    {
+      enum stats_t st(static_cast<enum stats_t>(i));
+      str << stat_name(st) << ": " << query_stat(st) << "\n";
+    }
+
+  if(d->m_timers_enabled)
+    {
+      for(unsigned int i = 0; i < num_timers; ++i)
+        {
+          enum timer_t t(static_cast<enum timer_t>(i));
+          str << timer_name(t) << ": " << double(d->m_timers[t]) / 1000.0 << " us\n";
+        }
+    }
+
+  for(unsigned int i = 0, endi = d->m_item_shader_stats.size(); i < endi; ++i)
+    {
+      if(d->m_item_shader_stats[i] != 0)
+        {
+          str << "item_shader #" << i << ": " << d->m_item_shader_stats[i] << "\n";
+        }
+    }
+}
+
+void
+fastuidraw::PainterPacker::
+sort_by_shader_group(bool v)
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+  assert(d->m_accumulated_draws.empty());
+  d->m_sort_by_shader_group = v;
+}
+
+bool
+fastuidraw::PainterPacker::
+sort_by_shader_group(void) const
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+  return d->m_sort_by_shader_group;
+}
+
+void
+fastuidraw::PainterPacker::
+occlusion_culling(bool v)
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+  assert(d->m_accumulated_draws.empty());
+  d->m_occlusion_culling = v;
+}
+
+bool
+fastuidraw::PainterPacker::
+occlusion_culling(void) const
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+  return d->m_occlusion_culling;
+}
+
+void
+fastuidraw::PainterPacker::
+pipelined_submission(bool v)
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+  assert(d->m_accumulated_draws.empty());
+  if(!v)
+    {
+      d->wait_submission();
+    }
+  d->m_pipelined_submission = v;
+}
+
+bool
+fastuidraw::PainterPacker::
+pipelined_submission(void) const
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+  return d->m_pipelined_submission;
+}
+
+void
+fastuidraw::PainterPacker::
+item_bounds(const vec2 &pmin, const vec2 &pmax, bool opaque)
+{
+  PainterPackerPrivate *d;
+  d = reinterpret_cast<PainterPackerPrivate*>(m_d);
+  d->m_item_bounds.m_has_bounds = true;
+  d->m_item_bounds.m_occluder = opaque;
+  d->m_item_bounds.m_min = pmin;
+  d->m_item_bounds.m_max = pmax;
+}
+
 //////////////////////////////////////////
 // fastuidraw::PainterPackedValueBase methods
 fastuidraw::PainterPackedValueBase::
@@ -1272,6 +3692,42 @@ fastuidraw::PainterPackedValuePool::
   m_d = NULL;
 }
 
+void
+fastuidraw::PainterPackedValuePool::
+begin_arena(void)
+{
+  PainterPackedValuePoolPrivate *d;
+  d = reinterpret_cast<PainterPackedValuePoolPrivate*>(m_d);
+  assert(!d->m_arena_active);
+  d->m_arena_active = true;
+}
+
+void
+fastuidraw::PainterPackedValuePool::
+end_arena(void)
+{
+  PainterPackedValuePoolPrivate *d;
+  d = reinterpret_cast<PainterPackedValuePoolPrivate*>(m_d);
+  assert(d->m_arena_active);
+
+  d->m_arena_active = false;
+  ++d->m_arena_generation;
+  d->m_brush_pool.m_arena.clear();
+  d->m_clip_equations_pool.m_arena.clear();
+  d->m_item_matrix_pool.m_arena.clear();
+  d->m_item_shader_data_pool.m_arena.clear();
+  d->m_blend_shader_data_pool.m_arena.clear();
+}
+
+bool
+fastuidraw::PainterPackedValuePool::
+arena_active(void) const
+{
+  PainterPackedValuePoolPrivate *d;
+  d = reinterpret_cast<PainterPackedValuePoolPrivate*>(m_d);
+  return d->m_arena_active;
+}
+
 fastuidraw::PainterPackedValue<fastuidraw::PainterBrush>
 fastuidraw::PainterPackedValuePool::
 create_packed_value(const PainterBrush &value)
@@ -1280,7 +3736,7 @@ create_packed_value(const PainterBrush &value)
   Entry<PainterBrush> *e;
 
   d = reinterpret_cast<PainterPackedValuePoolPrivate*>(m_d);
-  e = d->m_brush_pool.allocate(value, d->m_alignment);
+  e = d->allocate(d->m_brush_pool, value);
   return fastuidraw::PainterPackedValue<PainterBrush>(e);
 }
 
@@ -1292,7 +3748,7 @@ create_packed_value(const PainterClipEquations &value)
   Entry<PainterClipEquations> *e;
 
   d = reinterpret_cast<PainterPackedValuePoolPrivate*>(m_d);
-  e = d->m_clip_equations_pool.allocate(value, d->m_alignment);
+  e = d->allocate(d->m_clip_equations_pool, value);
   return fastuidraw::PainterPackedValue<PainterClipEquations>(e);
 }
 
@@ -1304,7 +3760,7 @@ create_packed_value(const PainterItemMatrix &value)
   Entry<PainterItemMatrix> *e;
 
   d = reinterpret_cast<PainterPackedValuePoolPrivate*>(m_d);
-  e = d->m_item_matrix_pool.allocate(value, d->m_alignment);
+  e = d->allocate(d->m_item_matrix_pool, value);
   return fastuidraw::PainterPackedValue<PainterItemMatrix>(e);
 }
 
@@ -1316,7 +3772,7 @@ create_packed_value(const PainterItemShaderData &value)
   Entry<PainterItemShaderData> *e;
 
   d = reinterpret_cast<PainterPackedValuePoolPrivate*>(m_d);
-  e = d->m_item_shader_data_pool.allocate(value, d->m_alignment);
+  e = d->allocate(d->m_item_shader_data_pool, value);
   return fastuidraw::PainterPackedValue<PainterItemShaderData>(e);
 }
 
@@ -1328,6 +3784,81 @@ create_packed_value(const PainterBlendShaderData &value)
   Entry<PainterBlendShaderData> *e;
 
   d = reinterpret_cast<PainterPackedValuePoolPrivate*>(m_d);
-  e = d->m_blend_shader_data_pool.allocate(value, d->m_alignment);
+  e = d->allocate(d->m_blend_shader_data_pool, value);
   return fastuidraw::PainterPackedValue<PainterBlendShaderData>(e);
 }
+
+////////////////////////////////////////////
+// fastuidraw::PainterRecording methods
+fastuidraw::PainterRecording::
+PainterRecording(unsigned int attributes_per_buffer,
+                 unsigned int indices_per_buffer,
+                 unsigned int data_blocks_per_store_buffer)
+{
+  m_d = FASTUIDRAWnew PainterRecordingPrivate(attributes_per_buffer,
+                                              indices_per_buffer,
+                                              data_blocks_per_store_buffer);
+}
+
+fastuidraw::PainterRecording::
+~PainterRecording()
+{
+  PainterRecordingPrivate *d;
+  d = reinterpret_cast<PainterRecordingPrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = NULL;
+}
+
+void
+fastuidraw::PainterRecording::
+clear(void)
+{
+  PainterRecordingPrivate *d;
+  d = reinterpret_cast<PainterRecordingPrivate*>(m_d);
+  d->clear();
+}
+
+void
+fastuidraw::PainterRecording::
+shrink(void)
+{
+  PainterRecordingPrivate *d;
+  d = reinterpret_cast<PainterRecordingPrivate*>(m_d);
+  d->shrink();
+}
+
+bool
+fastuidraw::PainterRecording::
+empty(void) const
+{
+  PainterRecordingPrivate *d;
+  d = reinterpret_cast<PainterRecordingPrivate*>(m_d);
+  return d->m_draws.empty();
+}
+
+bool
+fastuidraw::PainterRecording::
+recording(void) const
+{
+  PainterRecordingPrivate *d;
+  d = reinterpret_cast<PainterRecordingPrivate*>(m_d);
+  return d->m_recording;
+}
+
+unsigned int
+fastuidraw::PainterRecording::
+number_buffers(void) const
+{
+  PainterRecordingPrivate *d;
+  d = reinterpret_cast<PainterRecordingPrivate*>(m_d);
+  return d->m_draws.size();
+}
+
+unsigned int
+fastuidraw::PainterRecording::
+max_z(void) const
+{
+  PainterRecordingPrivate *d;
+  d = reinterpret_cast<PainterRecordingPrivate*>(m_d);
+  return d->m_max_z;
+}
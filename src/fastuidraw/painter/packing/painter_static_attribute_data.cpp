@@ -0,0 +1,170 @@
+/*!
+ * \file painter_static_attribute_data.cpp
+ * \brief file painter_static_attribute_data.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+#include <vector>
+#include <fastuidraw/util/math.hpp>
+#include <fastuidraw/painter/packing/painter_static_attribute_data.hpp>
+#include "../../private/util_private.hpp"
+
+namespace
+{
+  class PainterStaticAttributeDataPrivate
+  {
+  public:
+    std::vector<fastuidraw::PainterAttribute> m_attributes;
+    std::vector<fastuidraw::PainterIndex> m_indices;
+    std::vector<fastuidraw::range_type<unsigned int> > m_index_chunks;
+    std::vector<fastuidraw::range_type<unsigned int> > m_attribute_chunks;
+  };
+}
+
+///////////////////////////////////////////////
+// fastuidraw::PainterStaticAttributeData methods
+fastuidraw::PainterStaticAttributeData::
+PainterStaticAttributeData(const PainterAttributeData &data,
+                           const_c_array<unsigned int> attrib_chunk_selector)
+{
+  PainterStaticAttributeDataPrivate *d;
+  const_c_array<const_c_array<PainterAttribute> > attribs(data.attribute_data_chunks());
+  const_c_array<const_c_array<PainterIndex> > indices(data.index_data_chunks());
+  std::vector<unsigned int> attrib_offsets(attribs.size());
+  unsigned int num_attribs(0), num_indices(0);
+
+  d = FASTUIDRAWnew PainterStaticAttributeDataPrivate();
+  m_d = d;
+
+  assert(attrib_chunk_selector.empty() || attrib_chunk_selector.size() == indices.size());
+  for(unsigned int i = 0, endi = attribs.size(); i < endi; ++i)
+    {
+      attrib_offsets[i] = num_attribs;
+      num_attribs += attribs[i].size();
+    }
+
+  for(unsigned int i = 0, endi = indices.size(); i < endi; ++i)
+    {
+      num_indices += indices[i].size();
+    }
+
+  d->m_attributes.reserve(num_attribs);
+  for(unsigned int i = 0, endi = attribs.size(); i < endi; ++i)
+    {
+      d->m_attributes.insert(d->m_attributes.end(), attribs[i].begin(), attribs[i].end());
+    }
+
+  d->m_indices.reserve(num_indices);
+  d->m_index_chunks.resize(indices.size());
+  d->m_attribute_chunks.resize(indices.size());
+  for(unsigned int i = 0, endi = indices.size(); i < endi; ++i)
+    {
+      unsigned int K, lo, hi;
+      int adjust;
+
+      K = (attrib_chunk_selector.empty()) ? i : attrib_chunk_selector[i];
+      d->m_index_chunks[i].m_begin = d->m_indices.size();
+      if(K >= attribs.size() || attribs[K].empty())
+        {
+          d->m_index_chunks[i].m_end = d->m_index_chunks[i].m_begin;
+          d->m_attribute_chunks[i] = range_type<unsigned int>(0, 0);
+          continue;
+        }
+
+      adjust = data.index_adjust_chunk(i) + int(attrib_offsets[K]);
+      lo = ~0u;
+      hi = 0;
+      for(unsigned int j = 0, endj = indices[i].size(); j < endj; ++j)
+        {
+          PainterIndex v;
+
+          assert(int(indices[i][j]) + data.index_adjust_chunk(i) >= 0);
+          assert(int(indices[i][j]) + data.index_adjust_chunk(i) < int(attribs[K].size()));
+          v = int(indices[i][j]) + adjust;
+          lo = t_min(lo, v);
+          hi = t_max(hi, v + 1);
+          d->m_indices.push_back(v);
+        }
+      d->m_index_chunks[i].m_end = d->m_indices.size();
+      d->m_attribute_chunks[i] = (hi > lo) ?
+        range_type<unsigned int>(lo, hi) :
+        range_type<unsigned int>(0, 0);
+    }
+}
+
+fastuidraw::PainterStaticAttributeData::
+~PainterStaticAttributeData()
+{
+  PainterStaticAttributeDataPrivate *d;
+  d = reinterpret_cast<PainterStaticAttributeDataPrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = NULL;
+}
+
+fastuidraw::const_c_array<fastuidraw::PainterAttribute>
+fastuidraw::PainterStaticAttributeData::
+attribute_data(void) const
+{
+  PainterStaticAttributeDataPrivate *d;
+  d = reinterpret_cast<PainterStaticAttributeDataPrivate*>(m_d);
+  return make_c_array(d->m_attributes);
+}
+
+fastuidraw::const_c_array<fastuidraw::PainterIndex>
+fastuidraw::PainterStaticAttributeData::
+index_data(void) const
+{
+  PainterStaticAttributeDataPrivate *d;
+  d = reinterpret_cast<PainterStaticAttributeDataPrivate*>(m_d);
+  return make_c_array(d->m_indices);
+}
+
+unsigned int
+fastuidraw::PainterStaticAttributeData::
+number_index_data_chunks(void) const
+{
+  PainterStaticAttributeDataPrivate *d;
+  d = reinterpret_cast<PainterStaticAttributeDataPrivate*>(m_d);
+  return d->m_index_chunks.size();
+}
+
+fastuidraw::range_type<unsigned int>
+fastuidraw::PainterStaticAttributeData::
+index_data_chunk(unsigned int i) const
+{
+  PainterStaticAttributeDataPrivate *d;
+  d = reinterpret_cast<PainterStaticAttributeDataPrivate*>(m_d);
+  return (i < d->m_index_chunks.size()) ?
+    d->m_index_chunks[i] :
+    range_type<unsigned int>(0, 0);
+}
+
+fastuidraw::range_type<unsigned int>
+fastuidraw::PainterStaticAttributeData::
+attribute_data_chunk(unsigned int i) const
+{
+  PainterStaticAttributeDataPrivate *d;
+  d = reinterpret_cast<PainterStaticAttributeDataPrivate*>(m_d);
+  return (i < d->m_attribute_chunks.size()) ?
+    d->m_attribute_chunks[i] :
+    range_type<unsigned int>(0, 0);
+}
+
+bool
+fastuidraw::PainterStaticAttributeData::
+backend_resident(void) const
+{
+  return false;
+}
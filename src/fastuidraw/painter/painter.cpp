@@ -18,14 +18,19 @@
 
 
 #include <vector>
+#include <map>
+#include <algorithm>
 #include <bitset>
+#include <iostream>
 
 #include <fastuidraw/util/math.hpp>
 #include <fastuidraw/painter/painter_header.hpp>
 #include <fastuidraw/painter/painter.hpp>
 
 #include "../private/util_private.hpp"
+#include "../private/small_vector.hpp"
 #include "../private/clip.hpp"
+#include "../private/bounding_box.hpp"
 
 namespace
 {
@@ -106,6 +111,50 @@ namespace
     fastuidraw::reference_counted_ptr<ZDelayedAction> m_current;
   };
 
+  /* adds the time elapsed between ctor and dtor to
+     PainterPacker::clip_culling_time of a PainterPacker
+     if its timers are enabled. Culling a quad or a convex
+     polygon takes about as long as reading the clock, so
+     only the tasks picked by a timer_sampler are timed.
+   */
+  class culling_timer:fastuidraw::noncopyable
+  {
+  public:
+    culling_timer(fastuidraw::PainterPacker *core, fastuidraw::timer_sampler &sampler):
+      m_core(core->timers_enabled() && sampler.sample() ? core : NULL),
+      m_start(m_core ? fastuidraw::timer_nanoseconds() : 0)
+    {}
+
+    ~culling_timer()
+    {
+      if(m_core)
+        {
+          m_core->accumulate_timer(fastuidraw::PainterPacker::clip_culling_time,
+                                   (fastuidraw::timer_nanoseconds() - m_start)
+                                   * fastuidraw::timer_sampler::period);
+        }
+    }
+
+  private:
+    fastuidraw::PainterPacker *m_core;
+    uint64_t m_start;
+  };
+
+  /* returns true if two transformations differ by
+     at most a translation in clip coordinates
+   */
+  bool
+  same_up_to_translation(const fastuidraw::float3x3 &a, const fastuidraw::float3x3 &b)
+  {
+    bool affine;
+
+    affine = (a(2, 0) == 0.0f && a(2, 1) == 0.0f);
+    return a(0, 0) == b(0, 0) && a(0, 1) == b(0, 1)
+      && a(1, 0) == b(1, 0) && a(1, 1) == b(1, 1)
+      && a(2, 0) == b(2, 0) && a(2, 1) == b(2, 1) && a(2, 2) == b(2, 2)
+      && (affine || (a(0, 2) == b(0, 2) && a(1, 2) == b(1, 2)));
+  }
+
   bool
   all_pts_culled_by_one_half_plane(const fastuidraw::vecN<fastuidraw::vec3, 4> &pts,
                                    const fastuidraw::PainterClipEquations &eq)
@@ -259,6 +308,10 @@ namespace
      - the clippin rectangle in local coordinates; this value
        only "makes sense" if m_item_matrix_transition_tricky
        is false
+     The inverse-transpose of the transformation and the clip
+     equations of the clipping rectangle are computed on first
+     use after they change, so that changes to the transformation
+     that are not followed by drawing cost little.
    */
   class clip_rect_state
   {
@@ -266,7 +319,8 @@ namespace
     clip_rect_state(void):
       m_all_content_culled(false),
       m_item_matrix_transition_tricky(false),
-      m_inverse_transpose_not_ready(false)
+      m_inverse_transpose_not_ready(false),
+      m_clip_equations_not_ready(false)
     {}
 
     void
@@ -275,6 +329,7 @@ namespace
       m_all_content_culled = false;
       m_item_matrix_transition_tricky = false;
       m_inverse_transpose_not_ready = false;
+      m_clip_equations_not_ready = false;
       m_clip_rect.m_enabled = false;
       item_matrix(fastuidraw::float3x3(), false);
 
@@ -286,6 +341,9 @@ namespace
       clip_equations(clip_eq);
     }
 
+    /* marks the clip equations to be computed from
+       m_clip_rect on first use.
+     */
     void
     set_clip_equations_to_clip_rect(void);
 
@@ -293,16 +351,16 @@ namespace
     set_clip_equations_to_clip_rect(const fastuidraw::PainterPackedValue<fastuidraw::PainterClipEquations> &prev_clip);
 
     const fastuidraw::float3x3&
-    item_matrix_inverse_transpose(void);
+    item_matrix_inverse_transpose(void) const;
 
     const fastuidraw::PainterItemMatrix&
-    current_painter_item_matrix(void)
+    current_painter_item_matrix(void) const
     {
       return m_item_matrix;
     }
 
     const fastuidraw::float3x3&
-    item_matrix(void)
+    item_matrix(void) const
     {
       return m_item_matrix.m_item_matrix;
     }
@@ -310,27 +368,58 @@ namespace
     void
     item_matrix(const fastuidraw::float3x3 &v, bool trick_transition)
     {
+      /* m_clip_rect does not track the clipping rectangle
+         across a change of the matrix other than a translation,
+         so compute the clip equations before the change.
+       */
+      ready_clip_equations();
       m_item_matrix_transition_tricky = m_item_matrix_transition_tricky || trick_transition;
       m_inverse_transpose_not_ready = true;
       m_item_matrix.m_item_matrix = v;
       m_item_matrix_state = fastuidraw::PainterPackedValue<fastuidraw::PainterItemMatrix>();
     }
 
+    /* post-multiply the matrix by a translation; the clip
+       equations, if not ready, stay not ready because m_clip_rect
+       is translated along with the matrix.
+     */
+    void
+    translate_item_matrix(const fastuidraw::vec2 &p)
+    {
+      m_item_matrix.m_item_matrix.translate(p.x(), p.y());
+      m_inverse_transpose_not_ready = true;
+      m_item_matrix_state = fastuidraw::PainterPackedValue<fastuidraw::PainterItemMatrix>();
+      m_clip_rect.translate(-p);
+    }
+
     const fastuidraw::PainterClipEquations&
-    clip_equations(void)
+    clip_equations(void) const
     {
+      ready_clip_equations();
       return m_clip_equations;
     }
 
     void
     clip_equations(const fastuidraw::PainterClipEquations &v)
     {
+      m_clip_equations_not_ready = false;
       m_clip_equations = v;
       m_clip_equations_state = fastuidraw::PainterPackedValue<fastuidraw::PainterClipEquations>();
     }
 
+    /* drop the handles to the packed values without
+       changing the values, the packed values are
+       recreated when next needed.
+     */
+    void
+    release_packed_values(void)
+    {
+      m_item_matrix_state = fastuidraw::PainterPackedValue<fastuidraw::PainterItemMatrix>();
+      m_clip_equations_state = fastuidraw::PainterPackedValue<fastuidraw::PainterClipEquations>();
+    }
+
     const fastuidraw::PainterPackedValue<fastuidraw::PainterItemMatrix>&
-    current_item_marix_state(fastuidraw::PainterPackedValuePool &pool)
+    current_item_marix_state(fastuidraw::PainterPackedValuePool &pool) const
     {
       if(!m_item_matrix_state)
         {
@@ -343,6 +432,7 @@ namespace
     item_matrix_state(const fastuidraw::PainterPackedValue<fastuidraw::PainterItemMatrix> &v,
                               bool mark_dirty)
     {
+      ready_clip_equations();
       m_item_matrix_transition_tricky = m_item_matrix_transition_tricky || mark_dirty;
       m_inverse_transpose_not_ready = m_inverse_transpose_not_ready || mark_dirty;
       m_item_matrix_state = v;
@@ -350,8 +440,9 @@ namespace
     }
 
     const fastuidraw::PainterPackedValue<fastuidraw::PainterClipEquations>&
-    clip_equations_state(fastuidraw::PainterPackedValuePool &pool)
+    clip_equations_state(fastuidraw::PainterPackedValuePool &pool) const
     {
+      ready_clip_equations();
       if(!m_clip_equations_state)
         {
           m_clip_equations_state = pool.create_packed_value(m_clip_equations);
@@ -362,37 +453,69 @@ namespace
     void
     clip_equations_state(const fastuidraw::PainterPackedValue<fastuidraw::PainterClipEquations> &v)
     {
+      m_clip_equations_not_ready = false;
       m_clip_equations_state = v;
       m_clip_equations = v.value();
     }
 
     bool
-    item_matrix_transition_tricky(void)
+    item_matrix_transition_tricky(void) const
     {
       return m_item_matrix_transition_tricky;
     }
 
     void
     clip_polygon(fastuidraw::const_c_array<fastuidraw::vec2> pts,
-                 std::vector<fastuidraw::vec2> &out_pts,
-                 std::vector<fastuidraw::vec2> &work_vec2s,
-                 std::vector<float> &work_floats);
+                 fastuidraw::small_vector_base<fastuidraw::vec2> &out_pts,
+                 fastuidraw::vecN<fastuidraw::detail::clip_points, 2> &work_vec2s,
+                 fastuidraw::small_vector_base<float> &work_floats) const;
+
+    bool
+    rect_is_culled(const fastuidraw::vec2 &pmin, const fastuidraw::vec2 &wh) const;
 
     bool
-    rect_is_culled(const fastuidraw::vec2 &pmin, const fastuidraw::vec2 &wh);
+    all_content_culled(void) const
+    {
+      ready_clip_equations();
+      return m_all_content_culled;
+    }
+
+    void
+    cull_all_content(void)
+    {
+      m_all_content_culled = true;
+    }
 
     clip_rect m_clip_rect;
-    bool m_all_content_culled;
 
   private:
+    void
+    ready_clip_equations(void) const
+    {
+      if(m_clip_equations_not_ready)
+        {
+          m_clip_equations_not_ready = false;
+          compute_clip_equations_from_clip_rect();
+        }
+    }
+
+    void
+    compute_clip_equations_from_clip_rect(void) const;
 
+    /* the values computed lazily by the const methods
+       (the clip equations from m_clip_rect, the inverse
+       transpose and the packed values) are mutable; they
+       are determined by the other fields.
+     */
+    mutable bool m_all_content_culled;
     bool m_item_matrix_transition_tricky;
     fastuidraw::PainterItemMatrix m_item_matrix;
-    fastuidraw::PainterPackedValue<fastuidraw::PainterItemMatrix> m_item_matrix_state;
-    fastuidraw::PainterClipEquations m_clip_equations;
-    fastuidraw::PainterPackedValue<fastuidraw::PainterClipEquations> m_clip_equations_state;
-    bool m_inverse_transpose_not_ready;
-    fastuidraw::float3x3 m_item_matrix_inverse_transpose;
+    mutable fastuidraw::PainterPackedValue<fastuidraw::PainterItemMatrix> m_item_matrix_state;
+    mutable fastuidraw::PainterClipEquations m_clip_equations;
+    mutable fastuidraw::PainterPackedValue<fastuidraw::PainterClipEquations> m_clip_equations_state;
+    mutable bool m_inverse_transpose_not_ready;
+    mutable fastuidraw::float3x3 m_item_matrix_inverse_transpose;
+    mutable bool m_clip_equations_not_ready;
   };
 
   class occluder_stack_entry
@@ -423,6 +546,14 @@ namespace
     fastuidraw::BlendMode::packed_value m_blend_mode;
     fastuidraw::range_type<unsigned int> m_clip_equation_series;
 
+    /* m_clip_rect_state is only copied from the Painter
+       when the Painter first changes its clip_rect_state
+       after the save(); until then m_clip_rect_state_saved
+       is false and the saved value is the same as the
+       value of the entry above it in the stack (or the
+       current value for the top of the stack).
+     */
+    bool m_clip_rect_state_saved;
     clip_rect_state m_clip_rect_state;
     float m_curve_flatness;
   };
@@ -516,8 +647,8 @@ namespace
      */
     unsigned int
     clip_against_current(const fastuidraw::float3x3 &clip_matrix_local,
-                         fastuidraw::vecN<std::vector<fastuidraw::vec2>, 2> &in_out_pts,
-                         std::vector<float> &work_floats);
+                         fastuidraw::vecN<fastuidraw::detail::clip_points, 2> &in_out_pts,
+                         fastuidraw::small_vector_base<float> &work_floats);
 
   private:
     std::vector<fastuidraw::vec3> m_store;
@@ -525,25 +656,122 @@ namespace
     std::vector<fastuidraw::vec3> m_current;
   };
 
+  class cached_item
+  {
+  public:
+    cached_item(void):
+      m_state_hash(0),
+      m_frame(0)
+    {}
+
+    uint64_t m_state_hash;
+    unsigned int m_frame;
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterRecording> m_recording;
+  };
+
+  /* a layer kept across frames, see Painter::begin_layer()
+   */
+  class cached_layer
+  {
+  public:
+    cached_layer(void):
+      m_clamped(false),
+      m_frame(0)
+    {}
+
+    fastuidraw::reference_counted_ptr<fastuidraw::Image> m_image;
+
+    /* the transformation with which the content of the
+       layer was drawn to m_image and if the layer was
+       clamped to the target surface.
+     */
+    fastuidraw::float3x3 m_item_matrix;
+    bool m_clamped;
+    unsigned int m_frame;
+  };
+
+  /* the layer between Painter::begin_layer() and Painter::end_layer()
+   */
+  class layer_state
+  {
+  public:
+    layer_state(void):
+      m_active(false),
+      m_to_image(false),
+      m_draw_content(false),
+      m_clamped(false),
+      m_opacity(1.0f)
+    {}
+
+    bool m_active;
+
+    /* if false, the content is drawn directly to the target
+       surface (or was clipped away) and end_layer() does nothing
+     */
+    bool m_to_image;
+
+    /* if true, the content is captured with begin_display_list()
+       and drawn to m_image by end_layer()
+     */
+    bool m_draw_content;
+
+    bool m_clamped;
+    float m_opacity;
+    fastuidraw::reference_counted_ptr<fastuidraw::Image> m_image;
+
+    /* the rect of the layer in clip coordinates (aligned to pixels)
+       and its size in pixels
+     */
+    fastuidraw::vec2 m_clip_min, m_clip_max;
+    fastuidraw::ivec2 m_size;
+
+    /* the transformation at begin_layer()
+     */
+    fastuidraw::float3x3 m_item_matrix;
+  };
+
+  /* Scratch buffers of Painter; the inline capacities are
+     chosen so that typical calls do not touch the heap.
+   */
   class PainterWorkRoom
   {
   public:
-    std::vector<unsigned int> m_selector;
-    std::vector<fastuidraw::const_c_array<fastuidraw::PainterIndex> > m_index_chunks;
-    std::vector<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > m_attrib_chunks;
-    std::vector<int> m_index_adjusts;
-    std::vector<fastuidraw::vec2> m_pts_draw_convex_polygon;
-    fastuidraw::vecN<std::vector<fastuidraw::vec2>, 2> m_pts_update_clip_series;
-    std::vector<float> m_clipper_floats;
-    fastuidraw::vecN<std::vector<fastuidraw::vec2>, 2> m_clipper_vec2s;
-    std::vector<fastuidraw::PainterIndex> m_indices;
-    std::vector<fastuidraw::PainterAttribute> m_attribs;
-    std::vector<unsigned int> m_edge_chunks;
-    std::vector<unsigned int> m_stroke_dashed_join_chunks;
-    std::vector<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > m_stroke_attrib_chunks;
-    std::vector<fastuidraw::const_c_array<fastuidraw::PainterIndex> > m_stroke_index_chunks;
-    std::vector<int> m_stroke_index_adjusts;
+    fastuidraw::small_vector<unsigned int, 32> m_selector;
+    fastuidraw::small_vector<fastuidraw::const_c_array<fastuidraw::PainterIndex>, 32> m_index_chunks;
+    fastuidraw::small_vector<fastuidraw::const_c_array<fastuidraw::PainterAttribute>, 32> m_attrib_chunks;
+    fastuidraw::small_vector<int, 32> m_index_adjusts;
+    fastuidraw::detail::clip_points m_pts_draw_convex_polygon;
+    fastuidraw::detail::clip_points m_pts_item_bounds;
+
+    /* the polygons of a batch (see PainterPrivate::begin_batch())
+       together with where each chunk of the batch begins; if
+       m_batch_track_box is true, m_batch_box is the bounding
+       box of the polygons.
+     */
+    fastuidraw::small_vector<fastuidraw::PainterAttribute, 64> m_batch_attribs;
+    fastuidraw::small_vector<fastuidraw::PainterIndex, 96> m_batch_indices;
+    fastuidraw::small_vector<unsigned int, 8> m_batch_attrib_begins, m_batch_index_begins;
+    fastuidraw::detail::BoundingBox m_batch_box;
+    bool m_batch_track_box;
+    fastuidraw::vecN<fastuidraw::detail::clip_points, 2> m_pts_update_clip_series;
+    fastuidraw::small_vector<float, 16> m_clipper_floats;
+    fastuidraw::vecN<fastuidraw::detail::clip_points, 2> m_clipper_vec2s;
+    fastuidraw::small_vector<fastuidraw::PainterIndex, 48> m_indices;
+    fastuidraw::small_vector<fastuidraw::PainterAttribute, 16> m_attribs;
+    fastuidraw::small_vector<unsigned int, 64> m_edge_chunks;
+    fastuidraw::small_vector<unsigned int, 64> m_stroke_dashed_join_chunks;
+    fastuidraw::small_vector<fastuidraw::const_c_array<fastuidraw::PainterAttribute>, 64> m_stroke_attrib_chunks;
+    fastuidraw::small_vector<fastuidraw::const_c_array<fastuidraw::PainterIndex>, 64> m_stroke_index_chunks;
+    fastuidraw::small_vector<int, 64> m_stroke_index_adjusts;
     fastuidraw::StrokedPath::ScratchSpace m_path_scratch;
+    fastuidraw::small_vector<unsigned int, 64> m_glyph_chunks;
+    fastuidraw::small_vector<fastuidraw::const_c_array<fastuidraw::PainterAttribute>, 64> m_glyph_attrib_chunks;
+    fastuidraw::small_vector<fastuidraw::const_c_array<fastuidraw::PainterIndex>, 64> m_glyph_index_chunks;
+    fastuidraw::small_vector<int, 64> m_glyph_index_adjusts;
+    fastuidraw::PainterGlyphChunks::ScratchSpace m_glyph_scratch;
+    std::vector<fastuidraw::u8vec4> m_layer_clear_texels;
+    std::vector<float> m_dirty_rect_xs, m_dirty_rect_ys;
+    std::vector<clip_rect> m_dirty_rect_gaps;
   };
 
   class PainterPrivate
@@ -572,10 +800,132 @@ namespace
                  unsigned int z,
                  const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back);
 
+    /* m_clip_rect_state is private so that every change
+       to it goes through writable_clip_rect_state() (or
+       restore_clip_rect_state()); reads go through
+       current_clip_rect_state().
+     */
+    const clip_rect_state&
+    current_clip_rect_state(void) const
+    {
+      return m_clip_rect_state;
+    }
+
+    /* returns m_clip_rect_state for changing, first saving
+       it to the top of m_state_stack if it has not yet been
+       saved since the last save().
+     */
+    clip_rect_state&
+    writable_clip_rect_state(void)
+    {
+      if(!m_state_stack.empty() && !m_state_stack.back().m_clip_rect_state_saved)
+        {
+          m_state_stack.back().m_clip_rect_state = m_clip_rect_state;
+          m_state_stack.back().m_clip_rect_state_saved = true;
+        }
+      return m_clip_rect_state;
+    }
+
+    /* called by restore() with the value saved in
+       the popped state_stack_entry.
+     */
+    void
+    restore_clip_rect_state(const clip_rect_state &v)
+    {
+      m_clip_rect_state = v;
+    }
+
     bool
     update_clip_equation_series(const fastuidraw::vec2 &pmin,
                                 const fastuidraw::vec2 &pmax);
 
+    /* pass to m_core the bounds, in clip coordinates, of a
+       convex polygon to be drawn; if pts_clipped is false, pts
+       is clipped against the clipping rectangle when it is not
+       within it.
+     */
+    void
+    convex_polygon_bounds(const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &shader,
+                          const fastuidraw::PainterData &draw,
+                          fastuidraw::const_c_array<fastuidraw::vec2> pts,
+                          bool pts_clipped);
+
+    /* pass to m_core the bounds, in clip coordinates, of
+       m_item_box pushed out by m_item_box_pixel_room pixels
+       (and an extra pixel for anti-aliasing); the item is
+       never an occluder.
+     */
+    void
+    item_box_bounds(void);
+
+    /* set m_work_room.m_pts_item_bounds to pts in (normalized)
+       clip coordinates; returns false if a point is behind the
+       eye or, if check_clip is true, is outside of the clipping
+       rectangle.
+     */
+    bool
+    clip_coordinates(fastuidraw::const_c_array<fastuidraw::vec2> pts, bool check_clip);
+
+    /* A batch is a set of convex polygons that are drawn with a
+       single call to draw_generic(); the polygons are split into
+       chunks of at most max_batch_chunk_attributes attributes so
+       that each chunk fits into a PainterDraw.
+     */
+    enum
+      {
+        max_batch_chunk_attributes = 4096
+      };
+
+    void
+    begin_batch(void);
+
+    /* add a quad to the batch; the quad is culled if it is
+       outside of the clipping rectangle and is clipped on the
+       CPU if it crosses the clipping rectangle and clip_on_cpu
+       is true. local_clip_equations are the clip equations
+       in local coordinates, see local_clip_equations().
+     */
+    void
+    add_quad_to_batch(const fastuidraw::vecN<fastuidraw::vec2, 4> &quad,
+                      const fastuidraw::vecN<fastuidraw::vec3, 4> &local_clip_equations,
+                      bool clip_on_cpu);
+
+    /* the culling and clipping of add_quad_to_batch(), returns
+       the polygon to add which is empty if the quad is culled.
+     */
+    fastuidraw::const_c_array<fastuidraw::vec2>
+    cull_quad_for_batch(const fastuidraw::vecN<fastuidraw::vec2, 4> &quad,
+                        const fastuidraw::vecN<fastuidraw::vec3, 4> &local_clip_equations,
+                        bool clip_on_cpu);
+
+    void
+    add_polygon_to_batch(fastuidraw::const_c_array<fastuidraw::vec2> pts);
+
+    void
+    draw_batch(const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &shader,
+               const fastuidraw::PainterData &draw,
+               const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back);
+
+    void
+    local_clip_equations(fastuidraw::vecN<fastuidraw::vec3, 4> &out);
+
+    static
+    fastuidraw::vecN<fastuidraw::vec2, 4>
+    rect_quad(fastuidraw::const_c_array<fastuidraw::vec2> p,
+              fastuidraw::const_c_array<fastuidraw::vec2> wh,
+              unsigned int i)
+    {
+      fastuidraw::vecN<fastuidraw::vec2, 4> quad;
+      const fastuidraw::vec2 &q(p[i]);
+      const fastuidraw::vec2 &sz((wh.size() == 1) ? wh[0] : wh[i]);
+
+      quad[0] = q;
+      quad[1] = fastuidraw::vec2(q.x(), q.y() + sz.y());
+      quad[2] = q + sz;
+      quad[3] = fastuidraw::vec2(q.x() + sz.x(), q.y());
+      return quad;
+    }
+
     float
     select_path_thresh(const fastuidraw::Path &path);
 
@@ -585,26 +935,205 @@ namespace
     float
     select_path_thresh_perspective(const fastuidraw::Path &path);
 
+    /* returns the level of detail of path to draw for thresh;
+       if m_path_prefetcher is non-NULL, a missing level of detail
+       is scheduled on it instead of waited for, together with the
+       finer level that m_zoom_velocity predicts.
+     */
+    fastuidraw::reference_counted_ptr<const fastuidraw::TessellatedPath>
+    fetch_tessellation(const fastuidraw::Path &path, float thresh,
+                       uint32_t prefetch_flags);
+
     void
     compute_edge_chunks(const fastuidraw::StrokedPath &stroked_path,
                         const fastuidraw::PainterShaderData::DataBase *raw_data,
                         const fastuidraw::StrokingDataSelectorBase &selector,
                         bool close_countours,
-                        std::vector<unsigned int> &out_chunks);
+                        fastuidraw::small_vector_base<unsigned int> &out_chunks);
+
+    /* returns true if the bounding box in clip coordinates
+       of pts, pushed out by pixel_slack pixels (and an extra
+       pixel for anti-aliasing), intersects none of m_dirty_rects;
+       always false when not culling by dirty rects.
+     */
+    bool
+    culled_by_dirty_rects(fastuidraw::const_c_array<fastuidraw::vec2> pts,
+                          float pixel_slack = 0.0f);
+
+    /* culled_by_dirty_rects() for a box in local coordinates;
+       an empty box is never culled.
+     */
+    bool
+    box_culled_by_dirty_rects(const fastuidraw::detail::BoundingBox &box,
+                              float pixel_slack);
+
+    /* computes the approximate bounding box, in local coordinates,
+       of a path as drawn; if selector is non-NULL the path is
+       stroked, with the item data of draw, and the box is inflated
+       by how much the selector says stroking thickens the path,
+       with out_pixel_room set to the thickening in pixels. The
+       box is left empty if the path has no bounding box.
+     */
+    void
+    path_box(const fastuidraw::Path &path,
+             const fastuidraw::PainterData &draw,
+             const fastuidraw::StrokingDataSelectorBase *selector,
+             fastuidraw::detail::BoundingBox &out_box,
+             float &out_pixel_room);
+
+    /* compute into m_work_room.m_dirty_rect_gaps rects covering
+       the region within the bounding box of m_dirty_rects that is
+       not within any of the m_dirty_rects.
+     */
+    void
+    compute_dirty_rect_gaps(void);
+
+    /* compute m_layer.m_clip_min, m_layer.m_clip_max, m_layer.m_size
+       and m_layer.m_clamped from a rect in local coordinates; returns
+       false if the layer is empty.
+     */
+    bool
+    compute_layer_rect(const fastuidraw::vec2 &pmin, const fastuidraw::vec2 &wh);
+
+    /* called when the content of a layer is drawn directly
+       to the target surface; prints a warning (once for the
+       Painter) if the opacity of the layer is then lost.
+     */
+    void
+    warn_layer_opacity_ignored(const char *reason);
+
+    /* returns an Image for a layer from m_free_layer_images
+       or a new Image if there is none of the size
+     */
+    fastuidraw::reference_counted_ptr<fastuidraw::Image>
+    fetch_layer_image(const fastuidraw::ivec2 &sz);
+
+    /* draw the content captured to m_layer_recording to m_layer.m_image
+     */
+    void
+    draw_layer_content(void);
 
     fastuidraw::vec2 m_resolution;
     fastuidraw::vec2 m_one_pixel_width;
     float m_curve_flatness;
     unsigned int m_current_z;
-    clip_rect_state m_clip_rect_state;
+
+    /* values of m_current_z and m_state_stack.size()
+       when begin_display_list() was called
+     */
+    unsigned int m_display_list_z;
+    unsigned int m_display_list_state_depth;
+
+    /* items cached across frames, an item not drawn in a frame
+       is released at end() with its PainterRecording kept in
+       m_free_cached_recordings for reuse, up to
+       max_free_cached_recordings of them.
+     */
+    enum
+      {
+        max_free_cached_recordings = 8
+      };
+
+    std::map<uint64_t, cached_item> m_cached_items;
+    std::vector<fastuidraw::reference_counted_ptr<fastuidraw::PainterRecording> > m_free_cached_recordings;
+    cached_item *m_capturing_cached_item;
+    unsigned int m_frame;
+
+    /* the current layer, the layers kept across frames and
+       the images of the layers that are not kept; the draws
+       of a frame use the images of its layers, so the images
+       of m_frame_layer_images are only reused (by being moved
+       to m_free_layer_images) after end(). The content of a
+       layer is drawn to its image by m_layer_core.
+     */
+    layer_state m_layer;
+    std::map<uint64_t, cached_layer> m_cached_layers;
+    std::vector<fastuidraw::reference_counted_ptr<fastuidraw::Image> > m_frame_layer_images;
+    std::vector<fastuidraw::reference_counted_ptr<fastuidraw::Image> > m_free_layer_images;
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterRecording> m_layer_recording;
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker> m_layer_core;
+
+    /* the dirty rects, in clip coordinates, of the frame;
+       items are only culled against them if
+       m_cull_by_dirty_rects is true, i.e. between a begin()
+       with dirty rects and end().
+     */
+    std::vector<clip_rect> m_dirty_rects;
+    bool m_cull_by_dirty_rects;
+
+    /* the number of entries at the bottom of m_occluder_stack
+       that stay until end(), i.e. the occluders of the gaps
+       between the dirty rects. Every item of the frame is
+       clipped by them, so they do not prevent an item from
+       being an occluder for occlusion culling.
+     */
+    unsigned int m_frame_occluders;
+
+    /* if true, items are drawn without bounds for occlusion
+       culling; set while drawing the occluders of m_frame_occluders
+       so that those are never hidden by the items they clip.
+     */
+    bool m_no_item_bounds;
+
+    /* if m_item_box is not empty, the bounding box in local
+       coordinates of the item being drawn, see item_box_scope;
+       draw_generic() then gives it to m_core as the bounds of
+       each of its draws (see item_box_bounds()).
+     */
+    fastuidraw::detail::BoundingBox m_item_box;
+    float m_item_box_pixel_room;
+
+    fastuidraw::reference_counted_ptr<fastuidraw::PathPrefetcher> m_path_prefetcher;
+    float m_zoom_velocity;
+    unsigned int m_path_prefetch_frames;
+
+    /* if true, begin() begins an arena on m_pool
+       that is ended by end()
+     */
+    bool m_packed_value_arena;
+
+    /* true once warn_layer_opacity_ignored() has printed
+     */
+    bool m_warned_layer_opacity;
     std::vector<occluder_stack_entry> m_occluder_stack;
     std::vector<state_stack_entry> m_state_stack;
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> m_backend;
     fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker> m_core;
+
+    /* picks the culling tasks timed by culling_timer */
+    fastuidraw::timer_sampler m_culling_sampler;
+
     fastuidraw::PainterPackedValuePool m_pool;
     fastuidraw::PainterPackedValue<fastuidraw::PainterBrush> m_reset_brush, m_black_brush;
     fastuidraw::PainterPackedValue<fastuidraw::PainterItemMatrix> m_identiy_matrix;
     ClipEquationStore m_clip_store;
     PainterWorkRoom m_work_room;
+
+  private:
+    clip_rect_state m_clip_rect_state;
+  };
+
+  /* sets PainterPrivate::m_item_box for the lifetime
+     of the item_box_scope.
+   */
+  class item_box_scope:fastuidraw::noncopyable
+  {
+  public:
+    item_box_scope(PainterPrivate *d, const fastuidraw::detail::BoundingBox &box,
+                   float pixel_room):
+      m_d(d)
+    {
+      m_d->m_item_box = box;
+      m_d->m_item_box_pixel_room = pixel_room;
+    }
+
+    ~item_box_scope()
+    {
+      m_d->m_item_box = fastuidraw::detail::BoundingBox();
+    }
+
+  private:
+    PainterPrivate *m_d;
   };
 
   inline
@@ -693,7 +1222,7 @@ on_pop(fastuidraw::Painter *p)
 // clip_rect_stat methods
 const fastuidraw::float3x3&
 clip_rect_state::
-item_matrix_inverse_transpose(void)
+item_matrix_inverse_transpose(void) const
 {
   if(m_inverse_transpose_not_ready)
     {
@@ -706,23 +1235,22 @@ item_matrix_inverse_transpose(void)
 void
 clip_rect_state::
 set_clip_equations_to_clip_rect(void)
-{
-  fastuidraw::PainterPackedValue<fastuidraw::PainterClipEquations> null;
-  set_clip_equations_to_clip_rect(null);
-}
-
-
-std::bitset<4>
-clip_rect_state::
-set_clip_equations_to_clip_rect(const fastuidraw::PainterPackedValue<fastuidraw::PainterClipEquations> &pcl)
 {
   if(m_clip_rect.empty())
     {
       m_all_content_culled = true;
-      return std::bitset<4>();
+      return;
     }
 
   m_item_matrix_transition_tricky = false;
+  m_clip_equations_not_ready = true;
+  m_clip_equations_state = fastuidraw::PainterPackedValue<fastuidraw::PainterClipEquations>();
+}
+
+void
+clip_rect_state::
+compute_clip_equations_from_clip_rect(void) const
+{
   const fastuidraw::float3x3 &inverse_transpose(item_matrix_inverse_transpose());
   /* The clipping window is given by:
        w * min_x <= x <= w * max_x
@@ -741,16 +1269,36 @@ set_clip_equations_to_clip_rect(const fastuidraw::PainterPackedValue<fastuidraw:
   cl.m_clip_equations[1] = inverse_transpose * fastuidraw::vec3(-1.0f,  0.0f,  m_clip_rect.m_max.x());
   cl.m_clip_equations[2] = inverse_transpose * fastuidraw::vec3( 0.0f,  1.0f, -m_clip_rect.m_min.y());
   cl.m_clip_equations[3] = inverse_transpose * fastuidraw::vec3( 0.0f, -1.0f,  m_clip_rect.m_max.y());
-  clip_equations(cl);
+  m_clip_equations_not_ready = false;
+  m_clip_equations = cl;
+  m_clip_equations_state = fastuidraw::PainterPackedValue<fastuidraw::PainterClipEquations>();
 
   for(int i = 0; i < 4; ++i)
     {
       if(clip_equation_clips_everything(cl.m_clip_equations[i]))
         {
           m_all_content_culled = true;
-          return std::bitset<4>();
+          return;
         }
     }
+}
+
+std::bitset<4>
+clip_rect_state::
+set_clip_equations_to_clip_rect(const fastuidraw::PainterPackedValue<fastuidraw::PainterClipEquations> &pcl)
+{
+  if(m_clip_rect.empty())
+    {
+      m_all_content_culled = true;
+      return std::bitset<4>();
+    }
+
+  m_item_matrix_transition_tricky = false;
+  compute_clip_equations_from_clip_rect();
+  if(m_all_content_culled)
+    {
+      return std::bitset<4>();
+    }
 
   if(!pcl)
     {
@@ -787,12 +1335,13 @@ set_clip_equations_to_clip_rect(const fastuidraw::PainterPackedValue<fastuidraw:
 void
 clip_rect_state::
 clip_polygon(fastuidraw::const_c_array<fastuidraw::vec2> pts,
-             std::vector<fastuidraw::vec2> &out_pts,
-             std::vector<fastuidraw::vec2> &work_vec2s,
-             std::vector<float> &work_floats)
+             fastuidraw::small_vector_base<fastuidraw::vec2> &out_pts,
+             fastuidraw::vecN<fastuidraw::detail::clip_points, 2> &work_vec2s,
+             fastuidraw::small_vector_base<float> &work_floats) const
 {
-  const fastuidraw::PainterClipEquations &eqs(m_clip_equations);
+  const fastuidraw::PainterClipEquations &eqs(clip_equations());
   const fastuidraw::float3x3 &m(item_matrix());
+  fastuidraw::vecN<fastuidraw::vec3, 4> local_eqs;
 
   /* Clip planes are in clip coordinates, i.e.
        ClipDistance[i] = dot(M * p, clip_equation[i])
@@ -801,25 +1350,23 @@ clip_polygon(fastuidraw::const_c_array<fastuidraw::vec2> pts,
      the transpose of m_item_matrix to the clip planes
      which is the same as post-multiplying the matrix.
    */
-  fastuidraw::detail::clip_against_plane(eqs.m_clip_equations[0] * m, pts,
-                                         work_vec2s, work_floats);
-
-  fastuidraw::detail::clip_against_plane(eqs.m_clip_equations[1] * m,
-                                         fastuidraw::make_c_array(work_vec2s),
-                                         out_pts, work_floats);
-
-  fastuidraw::detail::clip_against_plane(eqs.m_clip_equations[2] * m,
-                                         fastuidraw::make_c_array(out_pts),
-                                         work_vec2s, work_floats);
+  for(unsigned int i = 0; i < 4; ++i)
+    {
+      local_eqs[i] = eqs.m_clip_equations[i] * m;
+    }
 
-  fastuidraw::detail::clip_against_plane(eqs.m_clip_equations[3] * m,
-                                         fastuidraw::make_c_array(work_vec2s),
-                                         out_pts, work_floats);
+  /* clip_against_planes() classifies the points against all
+     four planes at once, so that polygons that are entirely
+     within (or entirely outside of) the clipping region are
+     handled without clipping against each plane.
+   */
+  fastuidraw::detail::clip_against_planes(fastuidraw::const_c_array<fastuidraw::vec3>(local_eqs.c_ptr(), 4),
+                                          pts, out_pts, work_floats, work_vec2s);
 }
 
 bool
 clip_rect_state::
-rect_is_culled(const fastuidraw::vec2 &pmin, const fastuidraw::vec2 &wh)
+rect_is_culled(const fastuidraw::vec2 &pmin, const fastuidraw::vec2 &wh) const
 {
   /* apply the current transformation matrix to
      the corners of the clipping rectangle and check
@@ -833,21 +1380,11 @@ rect_is_culled(const fastuidraw::vec2 &pmin, const fastuidraw::vec2 &wh)
   pts[2] = m_item_matrix.m_item_matrix * fastuidraw::vec3(pmax.x(), pmax.y(), 1.0f);
   pts[3] = m_item_matrix.m_item_matrix * fastuidraw::vec3(pmax.x(), pmin.y(), 1.0f);
 
-  if(m_clip_rect.m_enabled)
-    {
-      /* use equations from clip state
-       */
-      return all_pts_culled_by_one_half_plane(pts, m_clip_equations);
-    }
-  else
-    {
-      fastuidraw::PainterClipEquations clip_eq;
-      clip_eq.m_clip_equations[0] = fastuidraw::vec3( 1.0f,  0.0f, 1.0f);
-      clip_eq.m_clip_equations[1] = fastuidraw::vec3(-1.0f,  0.0f, 1.0f);
-      clip_eq.m_clip_equations[2] = fastuidraw::vec3( 0.0f,  1.0f, 1.0f);
-      clip_eq.m_clip_equations[3] = fastuidraw::vec3( 0.0f, -1.0f, 1.0f);
-      return all_pts_culled_by_one_half_plane(pts, clip_eq);
-    }
+  /* when no clipping rect is set, the clip equations are
+     those the frame (or display list) began with, which
+     for a frame with dirty rects is their bounding box.
+   */
+  return all_pts_culled_by_one_half_plane(pts, clip_equations());
 }
 
 /////////////////////////////////
@@ -855,8 +1392,8 @@ rect_is_culled(const fastuidraw::vec2 &pmin, const fastuidraw::vec2 &wh)
 unsigned int
 ClipEquationStore::
 clip_against_current(const fastuidraw::float3x3 &clip_matrix_local,
-                    fastuidraw::vecN<std::vector<fastuidraw::vec2>, 2> &in_out_pts,
-                    std::vector<float> &work_floats)
+                    fastuidraw::vecN<fastuidraw::detail::clip_points, 2> &in_out_pts,
+                    fastuidraw::small_vector_base<float> &work_floats)
 {
   fastuidraw::const_c_array<fastuidraw::vec3> clips(current());
   unsigned int src, dst, i;
@@ -879,6 +1416,9 @@ PainterPrivate(fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> bac
   m_resolution(1.0f, 1.0f),
   m_one_pixel_width(1.0f, 1.0f),
   m_curve_flatness(1.0f),
+  m_zoom_velocity(1.0f),
+  m_path_prefetch_frames(8),
+  m_backend(backend),
   m_pool(backend->configuration_base().alignment())
 {
   m_core = FASTUIDRAWnew fastuidraw::PainterPacker(backend);
@@ -887,6 +1427,16 @@ PainterPrivate(fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> bac
                                              .pen(0.0f, 0.0f, 0.0f, 0.0f));
   m_identiy_matrix = m_pool.create_packed_value(fastuidraw::PainterItemMatrix());
   m_current_z = 1;
+  m_display_list_z = 0;
+  m_display_list_state_depth = 0;
+  m_capturing_cached_item = NULL;
+  m_frame = 0;
+  m_cull_by_dirty_rects = false;
+  m_frame_occluders = 0;
+  m_no_item_bounds = false;
+  m_item_box_pixel_room = 0.0f;
+  m_packed_value_arena = false;
+  m_warned_layer_opacity = false;
 }
 
 bool
@@ -902,7 +1452,7 @@ update_clip_equation_series(const fastuidraw::vec2 &pmin,
   m_work_room.m_pts_update_clip_series[0][1] = fastuidraw::vec2(pmin.x(), pmax.y());
   m_work_room.m_pts_update_clip_series[0][2] = pmax;
   m_work_room.m_pts_update_clip_series[0][3] = fastuidraw::vec2(pmax.x(), pmin.y());
-  src = m_clip_store.clip_against_current(m_clip_rect_state.item_matrix(),
+  src = m_clip_store.clip_against_current(current_clip_rect_state().item_matrix(),
                                           m_work_room.m_pts_update_clip_series,
                                           m_work_room.m_clipper_floats);
 
@@ -930,7 +1480,7 @@ update_clip_equation_series(const fastuidraw::vec2 &pmin,
     }
   center /= static_cast<float>(poly.size());
 
-  const fastuidraw::float3x3 &inverse_transpose(m_clip_rect_state.item_matrix_inverse_transpose());
+  const fastuidraw::float3x3 &inverse_transpose(current_clip_rect_state().item_matrix_inverse_transpose());
   /* extract the normal vectors of the polygon sides with
      correct orientation.
    */
@@ -971,7 +1521,7 @@ PainterPrivate::
 select_path_thresh_non_perspective(void)
 {
   float d;
-  const fastuidraw::float3x3 &m(m_clip_rect_state.item_matrix());
+  const fastuidraw::float3x3 &m(current_clip_rect_state().item_matrix());
 
   /* Use the sqrt of the area distortion to determine the dividing factor,
      for matrices with a great deal of skew, this will choose a lower a
@@ -1020,7 +1570,7 @@ select_path_thresh_perspective(const fastuidraw::Path &path)
      of the path by how much slack the stroking parameters
      require.
   */
-  const fastuidraw::float3x3 &m(m_clip_rect_state.item_matrix());
+  const fastuidraw::float3x3 &m(current_clip_rect_state().item_matrix());
   src = m_clip_store.clip_against_current(m,
                                           m_work_room.m_clipper_vec2s,
                                           m_work_room.m_clipper_floats);
@@ -1078,164 +1628,1444 @@ select_path_thresh_perspective(const fastuidraw::Path &path)
   return m_curve_flatness * fastuidraw::t_sqrt(ratio);
 }
 
-float
+fastuidraw::reference_counted_ptr<const fastuidraw::TessellatedPath>
 PainterPrivate::
-select_path_thresh(const fastuidraw::Path &path)
+fetch_tessellation(const fastuidraw::Path &path, float thresh,
+                   uint32_t prefetch_flags)
 {
-  bool no_perspective;
-  const fastuidraw::float3x3 &m(m_clip_rect_state.item_matrix());
+  fastuidraw::reference_counted_ptr<const fastuidraw::TessellatedPath> return_value;
+  bool ready;
+  float prefetch_thresh(thresh);
 
-  no_perspective = (m(2, 0) == 0.0f && m(2, 1) == 0.0f);
-  if(no_perspective)
+  if(!m_path_prefetcher)
     {
-      return select_path_thresh_non_perspective();
+      return path.tessellation(thresh);
     }
-  else
+
+  return_value = path.tessellation_if_ready(thresh, &ready);
+  if(!return_value)
     {
-      return select_path_thresh_perspective(path);
+      /* the first level is made here, before the prefetch
+         is scheduled, so that the worker thread is not
+         holding the Path while it is made.
+       */
+      path.tessellation();
+      return_value = path.tessellation_if_ready(thresh, &ready);
+      assert(return_value);
     }
-}
 
-void
-PainterPrivate::
-compute_edge_chunks(const fastuidraw::StrokedPath &stroked_path,
-                    const fastuidraw::PainterShaderData::DataBase *raw_data,
-                    const fastuidraw::StrokingDataSelectorBase &selector,
-                    bool close_countours,
-                    std::vector<unsigned int> &out_chunks)
-{
-  float pixels_additional_room(0.0f), item_space_additional_room(0.0f);
+  if(thresh > 0.0f && m_zoom_velocity > 1.0f)
+    {
+      /* the levels of detail halve their threshhold,
+         so a factor of 4 is two levels finer.
+       */
+      float factor(1.0f);
+      for(unsigned int i = 0; i < m_path_prefetch_frames && factor < 4.0f; ++i)
+        {
+          factor *= m_zoom_velocity;
+        }
+      prefetch_thresh = thresh / fastuidraw::t_min(factor, 4.0f);
+      if(ready)
+        {
+          path.tessellation_if_ready(prefetch_thresh, &ready);
+        }
+    }
+
+  if(!ready)
+    {
+      m_path_prefetcher->prefetch(path, prefetch_thresh, prefetch_flags);
+    }
+  return return_value;
+}
+
+float
+PainterPrivate::
+select_path_thresh(const fastuidraw::Path &path)
+{
+  bool no_perspective;
+  const fastuidraw::float3x3 &m(current_clip_rect_state().item_matrix());
+
+  no_perspective = (m(2, 0) == 0.0f && m(2, 1) == 0.0f);
+  if(no_perspective)
+    {
+      return select_path_thresh_non_perspective();
+    }
+  else
+    {
+      return select_path_thresh_perspective(path);
+    }
+}
+
+void
+PainterPrivate::
+compute_edge_chunks(const fastuidraw::StrokedPath &stroked_path,
+                    const fastuidraw::PainterShaderData::DataBase *raw_data,
+                    const fastuidraw::StrokingDataSelectorBase &selector,
+                    bool close_countours,
+                    fastuidraw::small_vector_base<unsigned int> &out_chunks)
+{
+  culling_timer timer(m_core.get(), m_culling_sampler);
+  float pixels_additional_room(0.0f), item_space_additional_room(0.0f);
   unsigned int sz;
 
-  out_chunks.resize(stroked_path.maximum_edge_chunks());
-  selector.stroking_distances(raw_data,
-                              &pixels_additional_room,
-                              &item_space_additional_room);
+  out_chunks.resize(stroked_path.maximum_edge_chunks());
+  selector.stroking_distances(raw_data,
+                              &pixels_additional_room,
+                              &item_space_additional_room);
+
+  sz = stroked_path.edge_chunks(m_work_room.m_path_scratch,
+                                m_clip_store.current(),
+                                current_clip_rect_state().item_matrix(),
+                                m_one_pixel_width,
+                                pixels_additional_room,
+                                item_space_additional_room,
+                                close_countours,
+                                fastuidraw::make_c_array(out_chunks));
+  assert(sz <= out_chunks.size());
+  out_chunks.resize(sz);
+}
+
+bool
+PainterPrivate::
+culled_by_dirty_rects(fastuidraw::const_c_array<fastuidraw::vec2> pts,
+                      float pixel_slack)
+{
+  /* display lists are drawn later with a transformation
+     not known yet, so their content is never culled here.
+   */
+  if(!m_cull_by_dirty_rects || m_display_list_state_depth > 0 || pts.empty())
+    {
+      return false;
+    }
+
+  if(!clip_coordinates(pts, false))
+    {
+      return false;
+    }
+
+  fastuidraw::detail::BoundingBox bb;
+  fastuidraw::vec2 slack;
+
+  for(unsigned int i = 0, endi = pts.size(); i < endi; ++i)
+    {
+      bb.union_point(m_work_room.m_pts_item_bounds[i]);
+    }
+
+  /* a pixel is 2 * m_one_pixel_width in clip coordinates
+   */
+  slack = 2.0f * (1.0f + pixel_slack) * m_one_pixel_width;
+  for(unsigned int i = 0, endi = m_dirty_rects.size(); i < endi; ++i)
+    {
+      const clip_rect &R(m_dirty_rects[i]);
+      if(bb.m_min.x() - slack.x() <= R.m_max.x()
+         && bb.m_max.x() + slack.x() >= R.m_min.x()
+         && bb.m_min.y() - slack.y() <= R.m_max.y()
+         && bb.m_max.y() + slack.y() >= R.m_min.y())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+bool
+PainterPrivate::
+box_culled_by_dirty_rects(const fastuidraw::detail::BoundingBox &box,
+                          float pixel_slack)
+{
+  fastuidraw::vecN<fastuidraw::vec2, 4> pts;
+
+  if(!m_cull_by_dirty_rects || box.m_empty)
+    {
+      return false;
+    }
+
+  box.inflated_polygon(pts, 0.0f);
+  return culled_by_dirty_rects(fastuidraw::const_c_array<fastuidraw::vec2>(pts.c_ptr(), 4), pixel_slack);
+}
+
+void
+PainterPrivate::
+path_box(const fastuidraw::Path &path,
+         const fastuidraw::PainterData &draw,
+         const fastuidraw::StrokingDataSelectorBase *selector,
+         fastuidraw::detail::BoundingBox &out_box,
+         float &out_pixel_room)
+{
+  fastuidraw::vec2 bb_min, bb_max;
+  float item_space_room(0.0f);
+
+  out_box = fastuidraw::detail::BoundingBox();
+  out_pixel_room = 0.0f;
+
+  /* the box is only used to cull against the dirty rects
+     and for occlusion culling
+   */
+  if((!m_cull_by_dirty_rects && !m_core->occlusion_culling())
+     || !path.approximate_bounding_box(&bb_min, &bb_max))
+    {
+      return;
+    }
+
+  if(selector != NULL)
+    {
+      selector->stroking_distances(draw.m_item_shader_data.data().data_base(),
+                                   &out_pixel_room, &item_space_room);
+    }
+
+  out_box.union_point(bb_min - fastuidraw::vec2(item_space_room, item_space_room));
+  out_box.union_point(bb_max + fastuidraw::vec2(item_space_room, item_space_room));
+}
+
+void
+PainterPrivate::
+compute_dirty_rect_gaps(void)
+{
+  std::vector<float> &xs(m_work_room.m_dirty_rect_xs);
+  std::vector<float> &ys(m_work_room.m_dirty_rect_ys);
+  std::vector<clip_rect> &gaps(m_work_room.m_dirty_rect_gaps);
+
+  /* the edges of the dirty rects cut their bounding box into
+     cells each of which is either within a dirty rect or not;
+     the gaps are the runs of cells on each row not within one.
+   */
+  xs.clear();
+  ys.clear();
+  gaps.clear();
+  for(unsigned int i = 0, endi = m_dirty_rects.size(); i < endi; ++i)
+    {
+      xs.push_back(m_dirty_rects[i].m_min.x());
+      xs.push_back(m_dirty_rects[i].m_max.x());
+      ys.push_back(m_dirty_rects[i].m_min.y());
+      ys.push_back(m_dirty_rects[i].m_max.y());
+    }
+  std::sort(xs.begin(), xs.end());
+  xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+  std::sort(ys.begin(), ys.end());
+  ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+  for(unsigned int j = 0; j + 1 < ys.size(); ++j)
+    {
+      float cy(0.5f * (ys[j] + ys[j + 1]));
+      int run_start(-1);
+
+      for(unsigned int i = 0; i + 1 < xs.size(); ++i)
+        {
+          float cx(0.5f * (xs[i] + xs[i + 1]));
+          bool covered(false);
+
+          for(unsigned int r = 0, endr = m_dirty_rects.size(); r < endr && !covered; ++r)
+            {
+              const clip_rect &R(m_dirty_rects[r]);
+              covered = (R.m_min.x() <= cx && cx <= R.m_max.x()
+                         && R.m_min.y() <= cy && cy <= R.m_max.y());
+            }
+
+          if(!covered && run_start < 0)
+            {
+              run_start = i;
+            }
+          else if(covered && run_start >= 0)
+            {
+              gaps.push_back(clip_rect(fastuidraw::vec2(xs[run_start], ys[j]),
+                                       fastuidraw::vec2(xs[i], ys[j + 1])));
+              run_start = -1;
+            }
+        }
+
+      if(run_start >= 0)
+        {
+          gaps.push_back(clip_rect(fastuidraw::vec2(xs[run_start], ys[j]),
+                                   fastuidraw::vec2(xs.back(), ys[j + 1])));
+        }
+    }
+}
+
+bool
+PainterPrivate::
+compute_layer_rect(const fastuidraw::vec2 &pmin, const fastuidraw::vec2 &wh)
+{
+  const fastuidraw::float3x3 &m(current_clip_rect_state().item_matrix());
+  fastuidraw::vecN<fastuidraw::vec2, 4> pts;
+  fastuidraw::vec2 min_px, max_px;
+  bool behind_eye(false);
+
+  pts[0] = pmin;
+  pts[1] = fastuidraw::vec2(pmin.x(), pmin.y() + wh.y());
+  pts[2] = pmin + wh;
+  pts[3] = fastuidraw::vec2(pmin.x() + wh.x(), pmin.y());
+
+  /* the bounding box of the rect in pixels, where pixel
+     (0, 0) is at clip coordinate (-1, -1).
+   */
+  min_px = m_resolution;
+  max_px = fastuidraw::vec2(0.0f, 0.0f);
+  for(unsigned int i = 0; i < 4; ++i)
+    {
+      fastuidraw::vec3 q;
+      fastuidraw::vec2 p;
+
+      q = m * fastuidraw::vec3(pts[i].x(), pts[i].y(), 1.0f);
+      if(q.z() <= 0.0f)
+        {
+          behind_eye = true;
+          break;
+        }
+      p = fastuidraw::vec2(q.x(), q.y()) / q.z();
+      p = (p + fastuidraw::vec2(1.0f, 1.0f)) * 0.5f * m_resolution;
+      for(unsigned int c = 0; c < 2; ++c)
+        {
+          min_px[c] = (i == 0) ? p[c] : fastuidraw::t_min(min_px[c], p[c]);
+          max_px[c] = (i == 0) ? p[c] : fastuidraw::t_max(max_px[c], p[c]);
+        }
+    }
+
+  if(behind_eye)
+    {
+      min_px = fastuidraw::vec2(0.0f, 0.0f);
+      max_px = m_resolution;
+    }
+
+  m_layer.m_clamped = behind_eye;
+  for(unsigned int c = 0; c < 2; ++c)
+    {
+      float lo, hi;
+
+      lo = std::floor(min_px[c]);
+      hi = std::ceil(max_px[c]);
+      if(lo < 0.0f || hi > m_resolution[c])
+        {
+          m_layer.m_clamped = true;
+          lo = fastuidraw::t_max(lo, 0.0f);
+          hi = fastuidraw::t_min(hi, m_resolution[c]);
+        }
+
+      if(hi <= lo)
+        {
+          return false;
+        }
+      m_layer.m_size[c] = static_cast<int>(hi - lo);
+      m_layer.m_clip_min[c] = 2.0f * lo / m_resolution[c] - 1.0f;
+      m_layer.m_clip_max[c] = 2.0f * hi / m_resolution[c] - 1.0f;
+    }
+  return true;
+}
+
+void
+PainterPrivate::
+warn_layer_opacity_ignored(const char *reason)
+{
+  if(m_layer.m_opacity < 1.0f && !m_warned_layer_opacity)
+    {
+      m_warned_layer_opacity = true;
+      std::cerr << "[" << __FILE__ << ", " << __LINE__
+                << "] Painter::begin_layer(): " << reason
+                << ", the layer is drawn directly and its opacity "
+                << m_layer.m_opacity << " is ignored\n";
+    }
+}
+
+fastuidraw::reference_counted_ptr<fastuidraw::Image>
+PainterPrivate::
+fetch_layer_image(const fastuidraw::ivec2 &sz)
+{
+  for(unsigned int i = 0, endi = m_free_layer_images.size(); i < endi; ++i)
+    {
+      if(m_free_layer_images[i]->dimensions() == sz)
+        {
+          fastuidraw::reference_counted_ptr<fastuidraw::Image> return_value;
+
+          return_value = m_free_layer_images[i];
+          m_free_layer_images[i] = m_free_layer_images.back();
+          m_free_layer_images.pop_back();
+          return return_value;
+        }
+    }
+
+  /* the content of an image is cleared when drawn to,
+     so the values given here are never seen.
+   */
+  m_work_room.m_layer_clear_texels.resize(sz.x() * sz.y(), fastuidraw::u8vec4(0, 0, 0, 0));
+  return fastuidraw::Image::create(m_backend->image_atlas(), sz.x(), sz.y(),
+                                   fastuidraw::make_c_array(m_work_room.m_layer_clear_texels), 0);
+}
+
+void
+PainterPrivate::
+draw_layer_content(void)
+{
+  fastuidraw::float3x3 to_layer;
+  fastuidraw::PainterItemMatrix matrix;
+  fastuidraw::PainterClipEquations clip_eq;
+  fastuidraw::vec2 sz(m_layer.m_clip_max - m_layer.m_clip_min);
+
+  /* map the rect of the layer in clip coordinates
+     to the clip coordinates of the image
+   */
+  to_layer(0, 0) = 2.0f / sz.x();
+  to_layer(0, 2) = -2.0f * m_layer.m_clip_min.x() / sz.x() - 1.0f;
+  to_layer(1, 1) = 2.0f / sz.y();
+  to_layer(1, 2) = -2.0f * m_layer.m_clip_min.y() / sz.y() - 1.0f;
+  matrix.m_item_matrix = to_layer * m_layer.m_item_matrix;
+
+  /* the image itself clips the content
+   */
+  clip_eq.m_clip_equations[0] = fastuidraw::vec3(0.0f, 0.0f, 1.0f);
+  clip_eq.m_clip_equations[1] = fastuidraw::vec3(0.0f, 0.0f, 1.0f);
+  clip_eq.m_clip_equations[2] = fastuidraw::vec3(0.0f, 0.0f, 1.0f);
+  clip_eq.m_clip_equations[3] = fastuidraw::vec3(0.0f, 0.0f, 1.0f);
+
+  /* the backend draws to the image right away, so any
+     submission of the previous frame must complete first.
+   */
+  m_core->wait_submission();
+  if(!m_layer_core)
+    {
+      m_layer_core = FASTUIDRAWnew fastuidraw::PainterPacker(m_backend);
+    }
+
+  m_layer_core->begin();
+  if(m_layer_recording->max_z() > 0)
+    {
+      m_layer_core->draw_recording(*m_layer_recording,
+                                   fastuidraw::PainterData::value<fastuidraw::PainterItemMatrix>(&matrix),
+                                   fastuidraw::PainterData::value<fastuidraw::PainterClipEquations>(&clip_eq),
+                                   0);
+    }
+  m_backend->begin_draw_to_image(m_layer.m_image);
+  m_layer_core->end();
+  m_backend->end_draw_to_image();
+}
+
+void
+PainterPrivate::
+begin_batch(void)
+{
+  m_work_room.m_batch_attribs.clear();
+  m_work_room.m_batch_indices.clear();
+  m_work_room.m_batch_attrib_begins.clear();
+  m_work_room.m_batch_index_begins.clear();
+  m_work_room.m_batch_attrib_begins.push_back(0);
+  m_work_room.m_batch_index_begins.push_back(0);
+  m_work_room.m_batch_box = fastuidraw::detail::BoundingBox();
+  m_work_room.m_batch_track_box = m_core->occlusion_culling();
+}
+
+void
+PainterPrivate::
+local_clip_equations(fastuidraw::vecN<fastuidraw::vec3, 4> &out)
+{
+  const fastuidraw::PainterClipEquations &eqs(current_clip_rect_state().clip_equations());
+  const fastuidraw::float3x3 &m(current_clip_rect_state().item_matrix());
+
+  /* see clip_rect_state::clip_polygon()
+   */
+  for(unsigned int k = 0; k < 4; ++k)
+    {
+      out[k] = eqs.m_clip_equations[k] * m;
+    }
+}
+
+void
+PainterPrivate::
+add_quad_to_batch(const fastuidraw::vecN<fastuidraw::vec2, 4> &quad,
+                  const fastuidraw::vecN<fastuidraw::vec3, 4> &local_clip_equations,
+                  bool clip_on_cpu)
+{
+  fastuidraw::const_c_array<fastuidraw::vec2> pts;
+
+  {
+    culling_timer timer(m_core.get(), m_culling_sampler);
+    pts = cull_quad_for_batch(quad, local_clip_equations, clip_on_cpu);
+  }
+
+  if(pts.size() >= 3)
+    {
+      add_polygon_to_batch(pts);
+    }
+}
+
+fastuidraw::const_c_array<fastuidraw::vec2>
+PainterPrivate::
+cull_quad_for_batch(const fastuidraw::vecN<fastuidraw::vec2, 4> &quad,
+                    const fastuidraw::vecN<fastuidraw::vec3, 4> &local_clip_equations,
+                    bool clip_on_cpu)
+{
+  bool inside(true);
+
+  for(unsigned int k = 0; k < 4; ++k)
+    {
+      const fastuidraw::vec3 &e(local_clip_equations[k]);
+      unsigned int num_outside(0);
+
+      for(unsigned int v = 0; v < 4; ++v)
+        {
+          num_outside += (e.x() * quad[v].x() + e.y() * quad[v].y() + e.z() < 0.0f) ? 1u : 0u;
+        }
+
+      if(num_outside == 4)
+        {
+          return fastuidraw::const_c_array<fastuidraw::vec2>();
+        }
+      inside = inside && (num_outside == 0);
+    }
+
+  if(culled_by_dirty_rects(fastuidraw::const_c_array<fastuidraw::vec2>(quad.c_ptr(), 4)))
+    {
+      return fastuidraw::const_c_array<fastuidraw::vec2>();
+    }
+
+  if(inside || !clip_on_cpu)
+    {
+      return fastuidraw::const_c_array<fastuidraw::vec2>(quad.c_ptr(), 4);
+    }
+
+  fastuidraw::detail::clip_against_planes(fastuidraw::const_c_array<fastuidraw::vec3>(local_clip_equations.c_ptr(), 4),
+                                          fastuidraw::const_c_array<fastuidraw::vec2>(quad.c_ptr(), 4),
+                                          m_work_room.m_pts_draw_convex_polygon,
+                                          m_work_room.m_clipper_floats,
+                                          m_work_room.m_clipper_vec2s);
+  return fastuidraw::make_c_array(m_work_room.m_pts_draw_convex_polygon);
+}
+
+void
+PainterPrivate::
+add_polygon_to_batch(fastuidraw::const_c_array<fastuidraw::vec2> pts)
+{
+  fastuidraw::small_vector_base<fastuidraw::PainterAttribute> &attribs(m_work_room.m_batch_attribs);
+  fastuidraw::small_vector_base<fastuidraw::PainterIndex> &indices(m_work_room.m_batch_indices);
+  unsigned int base;
+
+  if(attribs.size() + pts.size() > m_work_room.m_batch_attrib_begins.back() + max_batch_chunk_attributes)
+    {
+      m_work_room.m_batch_attrib_begins.push_back(attribs.size());
+      m_work_room.m_batch_index_begins.push_back(indices.size());
+    }
+
+  /* the indices of a chunk are relative to the
+     first attribute of the chunk
+   */
+  base = attribs.size() - m_work_room.m_batch_attrib_begins.back();
+  for(unsigned int i = 0; i < pts.size(); ++i)
+    {
+      fastuidraw::PainterAttribute A;
+
+      A.m_attrib0 = fastuidraw::pack_vec4(pts[i].x(), pts[i].y(), 0.0f, 0.0f);
+      A.m_attrib1 = fastuidraw::uvec4(0u, 0u, 0u, 0u);
+      A.m_attrib2 = fastuidraw::uvec4(0u, 0u, 0u, 0u);
+      attribs.push_back(A);
+    }
+
+  if(m_work_room.m_batch_track_box)
+    {
+      for(unsigned int i = 0; i < pts.size(); ++i)
+        {
+          m_work_room.m_batch_box.union_point(pts[i]);
+        }
+    }
+
+  for(unsigned int i = 2; i < pts.size(); ++i)
+    {
+      indices.push_back(base);
+      indices.push_back(base + i - 1);
+      indices.push_back(base + i);
+    }
+}
+
+void
+PainterPrivate::
+draw_batch(const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &shader,
+           const fastuidraw::PainterData &draw,
+           const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back)
+{
+  const fastuidraw::small_vector_base<unsigned int> &attrib_begins(m_work_room.m_batch_attrib_begins);
+  const fastuidraw::small_vector_base<unsigned int> &index_begins(m_work_room.m_batch_index_begins);
+  fastuidraw::const_c_array<fastuidraw::PainterAttribute> attribs(fastuidraw::make_c_array(m_work_room.m_batch_attribs));
+  fastuidraw::const_c_array<fastuidraw::PainterIndex> indices(fastuidraw::make_c_array(m_work_room.m_batch_indices));
+
+  if(indices.empty())
+    {
+      return;
+    }
+
+  m_work_room.m_attrib_chunks.clear();
+  m_work_room.m_index_chunks.clear();
+  m_work_room.m_index_adjusts.clear();
+  for(unsigned int c = 0, endc = attrib_begins.size(); c < endc; ++c)
+    {
+      unsigned int attrib_end, index_end;
+
+      attrib_end = (c + 1 < endc) ? attrib_begins[c + 1] : attribs.size();
+      index_end = (c + 1 < endc) ? index_begins[c + 1] : indices.size();
+      m_work_room.m_attrib_chunks.push_back(attribs.sub_array(attrib_begins[c], attrib_end - attrib_begins[c]));
+      m_work_room.m_index_chunks.push_back(indices.sub_array(index_begins[c], index_end - index_begins[c]));
+      m_work_room.m_index_adjusts.push_back(0);
+    }
+
+  item_box_scope item_box(this, m_work_room.m_batch_box, 0.0f);
+  draw_generic(shader, draw,
+               fastuidraw::make_c_array(m_work_room.m_attrib_chunks),
+               fastuidraw::make_c_array(m_work_room.m_index_chunks),
+               fastuidraw::make_c_array(m_work_room.m_index_adjusts),
+               fastuidraw::const_c_array<unsigned int>(),
+               m_current_z, call_back);
+}
+
+bool
+PainterPrivate::
+clip_coordinates(fastuidraw::const_c_array<fastuidraw::vec2> pts, bool check_clip)
+{
+  const fastuidraw::float3x3 &m(current_clip_rect_state().item_matrix());
+  const fastuidraw::PainterClipEquations &eqs(current_clip_rect_state().clip_equations());
+
+  m_work_room.m_pts_item_bounds.resize(pts.size());
+  for(unsigned int i = 0, endi = pts.size(); i < endi; ++i)
+    {
+      fastuidraw::vec3 q;
+
+      q = m * fastuidraw::vec3(pts[i].x(), pts[i].y(), 1.0f);
+      if(q.z() <= 0.0f)
+        {
+          return false;
+        }
+
+      if(check_clip)
+        {
+          for(unsigned int k = 0; k < 4; ++k)
+            {
+              if(fastuidraw::dot(eqs.m_clip_equations[k], q) < 0.0f)
+                {
+                  return false;
+                }
+            }
+        }
+      m_work_room.m_pts_item_bounds[i] = fastuidraw::vec2(q.x(), q.y()) / q.z();
+    }
+  return true;
+}
+
+void
+PainterPrivate::
+convex_polygon_bounds(const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &shader,
+                      const fastuidraw::PainterData &draw,
+                      fastuidraw::const_c_array<fastuidraw::vec2> pts,
+                      bool pts_clipped)
+{
+  fastuidraw::detail::BoundingBox bb;
+  float area(0.0f);
+  bool opaque;
+
+  if(!clip_coordinates(pts, !pts_clipped))
+    {
+      if(pts_clipped)
+        {
+          return;
+        }
+
+      /* the drawn region is the polygon clipped to the
+         clipping rectangle, use that for the bounds.
+       */
+      current_clip_rect_state().clip_polygon(pts, m_work_room.m_pts_draw_convex_polygon,
+                                     m_work_room.m_clipper_vec2s,
+                                     m_work_room.m_clipper_floats);
+      pts = fastuidraw::make_c_array(m_work_room.m_pts_draw_convex_polygon);
+      if(pts.size() < 3 || !clip_coordinates(pts, false))
+        {
+          return;
+        }
+    }
+
+  fastuidraw::const_c_array<fastuidraw::vec2> cpts(fastuidraw::make_c_array(m_work_room.m_pts_item_bounds));
+  for(unsigned int i = 0, endi = cpts.size(); i < endi; ++i)
+    {
+      const fastuidraw::vec2 &p(cpts[i]);
+      const fastuidraw::vec2 &q(cpts[(i + 1 == endi) ? 0 : i + 1]);
+
+      area += p.x() * q.y() - q.x() * p.y();
+      bb.union_point(p);
+    }
+
+  /* the polygon is convex, it covers its bounding box
+     exactly when their areas are the same.
+   */
+  float bb_area;
+
+  area = fastuidraw::t_abs(0.5f * area);
+  bb_area = (bb.m_max.x() - bb.m_min.x()) * (bb.m_max.y() - bb.m_min.y());
+
+  /* the item hides what is behind it if it draws each pixel
+     of its bounding box with an opaque color that replaces the
+     color of the framebuffer: the default fill shader with a
+     brush that is only an opaque color, blended with
+     Porter-Duff src or src-over and not clipped by occluders.
+   */
+  opaque = m_occluder_stack.size() <= m_frame_occluders
+    && bb_area > 0.0f
+    && area >= (1.0f - 1e-5f) * bb_area
+    && shader == m_core->default_shaders().fill_shader().item_shader();
+
+  if(opaque)
+    {
+      const fastuidraw::PainterBlendShaderSet &blend(m_core->default_shaders().blend_shaders());
+      const fastuidraw::PainterBrush *brush;
+      fastuidraw::PainterBrush default_brush;
+
+      if(draw.m_brush.m_packed_value)
+        {
+          brush = &draw.m_brush.m_packed_value.value();
+        }
+      else if(draw.m_brush.m_value != NULL)
+        {
+          brush = draw.m_brush.m_value;
+        }
+      else
+        {
+          brush = &default_brush;
+        }
+
+      opaque = (brush->shader() & (fastuidraw::PainterBrush::image_mask | fastuidraw::PainterBrush::gradient_mask)) == 0u
+        && brush->pen().w() >= 1.0f
+        && ((m_core->blend_shader() == blend.shader(fastuidraw::PainterEnums::blend_porter_duff_src_over)
+             && m_core->blend_mode() == blend.blend_mode(fastuidraw::PainterEnums::blend_porter_duff_src_over))
+            || (m_core->blend_shader() == blend.shader(fastuidraw::PainterEnums::blend_porter_duff_src)
+                && m_core->blend_mode() == blend.blend_mode(fastuidraw::PainterEnums::blend_porter_duff_src)));
+    }
+
+  m_core->item_bounds(bb.m_min, bb.m_max, opaque);
+}
+
+void
+PainterPrivate::
+item_box_bounds(void)
+{
+  fastuidraw::vecN<fastuidraw::vec2, 4> pts;
+  fastuidraw::detail::BoundingBox bb;
+  fastuidraw::vec2 slack;
+
+  m_item_box.inflated_polygon(pts, 0.0f);
+  if(!clip_coordinates(fastuidraw::const_c_array<fastuidraw::vec2>(pts.c_ptr(), 4), false))
+    {
+      return;
+    }
+
+  for(unsigned int i = 0; i < 4; ++i)
+    {
+      bb.union_point(m_work_room.m_pts_item_bounds[i]);
+    }
+
+  /* a pixel is 2 * m_one_pixel_width in clip coordinates
+   */
+  slack = 2.0f * (1.0f + m_item_box_pixel_room) * m_one_pixel_width;
+  m_core->item_bounds(bb.m_min - slack, bb.m_max + slack, false);
+}
+
+void
+PainterPrivate::
+draw_generic(const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &shader,
+             const fastuidraw::PainterData &draw,
+             fastuidraw::const_c_array<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > attrib_chunks,
+             fastuidraw::const_c_array<fastuidraw::const_c_array<fastuidraw::PainterIndex> > index_chunks,
+             fastuidraw::const_c_array<int> index_adjusts,
+             fastuidraw::const_c_array<unsigned int> attrib_chunk_selector,
+             unsigned int z,
+             const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back)
+{
+  fastuidraw::PainterPackerData p(draw);
+  p.m_clip = current_clip_rect_state().clip_equations_state(m_pool);
+  p.m_matrix = current_clip_rect_state().current_item_marix_state(m_pool);
+  if(!m_item_box.m_empty && !m_no_item_bounds && m_core->occlusion_culling())
+    {
+      item_box_bounds();
+    }
+  m_core->draw_generic(shader, p, attrib_chunks, index_chunks, index_adjusts, attrib_chunk_selector, z, call_back);
+}
+
+void
+PainterPrivate::
+draw_generic_check(const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &shader,
+                   const fastuidraw::PainterData &draw,
+                   fastuidraw::const_c_array<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > attrib_chunks,
+                   fastuidraw::const_c_array<fastuidraw::const_c_array<fastuidraw::PainterIndex> > index_chunks,
+                   fastuidraw::const_c_array<int> index_adjusts,
+                   fastuidraw::const_c_array<unsigned int> attrib_chunk_selector,
+                   unsigned int z,
+                   const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back)
+{
+  if(!current_clip_rect_state().all_content_culled())
+    {
+      draw_generic(shader, draw, attrib_chunks, index_chunks, index_adjusts, attrib_chunk_selector, z, call_back);
+    }
+}
+
+//////////////////////////////////
+// fastuidraw::Painter methods
+fastuidraw::Painter::
+Painter(reference_counted_ptr<PainterBackend> backend)
+{
+  m_d = FASTUIDRAWnew PainterPrivate(backend);
+}
+
+fastuidraw::Painter::
+~Painter()
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = NULL;
+}
+
+fastuidraw::PainterPackedValuePool&
+fastuidraw::Painter::
+packed_value_pool(void)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  return d->m_pool;
+}
+
+void
+fastuidraw::Painter::
+target_resolution(int w, int h)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+
+  w = t_max(w, 1);
+  h = t_max(h, 1);
+  d->m_resolution.x() = static_cast<float>(w);
+  d->m_resolution.y() = static_cast<float>(h);
+  d->m_one_pixel_width = 1.0f / d->m_resolution;
+  d->m_core->target_resolution(w, h);
+}
+
+void
+fastuidraw::Painter::
+sort_by_shader_group(bool v)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  d->m_core->sort_by_shader_group(v);
+}
+
+bool
+fastuidraw::Painter::
+sort_by_shader_group(void) const
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  return d->m_core->sort_by_shader_group();
+}
+
+void
+fastuidraw::Painter::
+occlusion_culling(bool v)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  d->m_core->occlusion_culling(v);
+}
+
+bool
+fastuidraw::Painter::
+occlusion_culling(void) const
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  return d->m_core->occlusion_culling();
+}
+
+void
+fastuidraw::Painter::
+pipelined_submission(bool v)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  d->m_core->pipelined_submission(v);
+}
+
+bool
+fastuidraw::Painter::
+pipelined_submission(void) const
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  return d->m_core->pipelined_submission();
+}
+
+void
+fastuidraw::Painter::
+wait_submission(void)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  d->m_core->wait_submission();
+}
+
+void
+fastuidraw::Painter::
+packed_value_arena(bool v)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  assert(!d->m_pool.arena_active());
+  d->m_packed_value_arena = v;
+}
+
+bool
+fastuidraw::Painter::
+packed_value_arena(void) const
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  return d->m_packed_value_arena;
+}
+
+void
+fastuidraw::Painter::
+begin(bool reset_z)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+
+  if(d->m_packed_value_arena)
+    {
+      d->m_pool.begin_arena();
+    }
+  d->m_core->begin();
+  ++d->m_frame;
+
+  if(reset_z)
+    {
+      d->m_current_z = 1;
+    }
+  d->m_cull_by_dirty_rects = false;
+  d->writable_clip_rect_state().reset();
+  d->m_clip_store.set_current(d->current_clip_rect_state().clip_equations().m_clip_equations);
+  blend_shader(PainterEnums::blend_porter_duff_src_over);
+}
+
+void
+fastuidraw::Painter::
+begin(const_c_array<vec2> dirty_pmin, const_c_array<vec2> dirty_wh, bool reset_z)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+
+  assert(dirty_pmin.size() == dirty_wh.size());
+  begin(reset_z);
+  if(dirty_pmin.empty())
+    {
+      return;
+    }
+
+  /* convert the dirty rects to clip coordinates
+   */
+  clip_rect bbox;
+  d->m_dirty_rects.clear();
+  for(unsigned int i = 0, endi = dirty_pmin.size(); i < endi; ++i)
+    {
+      if(dirty_wh[i].x() <= 0.0f || dirty_wh[i].y() <= 0.0f)
+        {
+          continue;
+        }
+
+      vec2 pmin(2.0f * dirty_pmin[i] * d->m_one_pixel_width - vec2(1.0f, 1.0f));
+      vec2 pmax(2.0f * (dirty_pmin[i] + dirty_wh[i]) * d->m_one_pixel_width - vec2(1.0f, 1.0f));
+
+      d->m_dirty_rects.push_back(clip_rect(pmin, pmax));
+      if(bbox.m_enabled)
+        {
+          bbox.m_min.x() = t_min(bbox.m_min.x(), pmin.x());
+          bbox.m_min.y() = t_min(bbox.m_min.y(), pmin.y());
+          bbox.m_max.x() = t_max(bbox.m_max.x(), pmax.x());
+          bbox.m_max.y() = t_max(bbox.m_max.y(), pmax.y());
+        }
+      else
+        {
+          bbox = clip_rect(pmin, pmax);
+        }
+    }
+
+  if(d->m_dirty_rects.empty())
+    {
+      /* nothing is dirty, so nothing is drawn
+       */
+      d->writable_clip_rect_state().cull_all_content();
+      return;
+    }
+
+  /* the frame is clipped to the bounding box of the dirty
+     rects, so that all the culling against the clip equations
+     (clipInRect(), draw_rects(), stroking edge chunks, glyph
+     chunks) culls against it.
+   */
+  PainterClipEquations clip_eq;
+  clip_eq.m_clip_equations[0] = vec3( 1.0f,  0.0f, -bbox.m_min.x());
+  clip_eq.m_clip_equations[1] = vec3(-1.0f,  0.0f,  bbox.m_max.x());
+  clip_eq.m_clip_equations[2] = vec3( 0.0f,  1.0f, -bbox.m_min.y());
+  clip_eq.m_clip_equations[3] = vec3( 0.0f, -1.0f,  bbox.m_max.y());
+  d->writable_clip_rect_state().clip_equations(clip_eq);
+  d->m_clip_store.set_current(clip_eq.m_clip_equations);
+
+  /* draw_convex_polygon() and the like rely on clipping
+     instead of culling against the clip equations, so they
+     are culled against the dirty rects even if there is
+     only one.
+   */
+  if(d->m_dirty_rects.size() == 1)
+    {
+      d->m_cull_by_dirty_rects = true;
+      return;
+    }
+
+  /* occlude the gaps between the dirty rects with occluders
+     that stay until end(), so that items culled against the
+     dirty rects do not leave the gaps changed by the items
+     that are not culled.
+   */
+  d->compute_dirty_rect_gaps();
+  if(!d->m_work_room.m_dirty_rect_gaps.empty())
+    {
+      reference_counted_ptr<PainterBlendShader> old_blend;
+      BlendMode::packed_value old_blend_mode;
+      reference_counted_ptr<ZDataCallBack> zdatacallback;
+
+      zdatacallback = FASTUIDRAWnew ZDataCallBack();
+      old_blend = blend_shader();
+      old_blend_mode = blend_mode();
+      blend_shader(PainterEnums::blend_porter_duff_dst);
+      d->m_no_item_bounds = true;
+      for(unsigned int i = 0, endi = d->m_work_room.m_dirty_rect_gaps.size(); i < endi; ++i)
+        {
+          const clip_rect &R(d->m_work_room.m_dirty_rect_gaps[i]);
+          draw_rect(PainterData(d->m_black_brush), R.m_min, R.m_max - R.m_min, zdatacallback);
+        }
+      d->m_no_item_bounds = false;
+      blend_shader(old_blend, old_blend_mode);
+      d->m_occluder_stack.push_back(occluder_stack_entry(zdatacallback->m_actions));
+      d->m_frame_occluders = d->m_occluder_stack.size();
+    }
+  d->m_cull_by_dirty_rects = true;
+}
+
+void
+fastuidraw::Painter::
+begin(const reference_counted_ptr<PainterRecording> &recording)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
 
-  sz = stroked_path.edge_chunks(m_work_room.m_path_scratch,
-                                m_clip_store.current(),
-                                m_clip_rect_state.item_matrix(),
-                                m_one_pixel_width,
-                                pixels_additional_room,
-                                item_space_additional_room,
-                                close_countours,
-                                fastuidraw::make_c_array(out_chunks));
-  assert(sz <= out_chunks.size());
-  out_chunks.resize(sz);
+  if(d->m_packed_value_arena)
+    {
+      d->m_pool.begin_arena();
+    }
+  d->m_core->begin(recording);
+  d->m_current_z = 1;
+  d->m_cull_by_dirty_rects = false;
+  d->writable_clip_rect_state().reset();
+  d->m_clip_store.set_current(d->current_clip_rect_state().clip_equations().m_clip_equations);
+  blend_shader(PainterEnums::blend_porter_duff_src_over);
 }
 
 void
-PainterPrivate::
-draw_generic(const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &shader,
-             const fastuidraw::PainterData &draw,
-             fastuidraw::const_c_array<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > attrib_chunks,
-             fastuidraw::const_c_array<fastuidraw::const_c_array<fastuidraw::PainterIndex> > index_chunks,
-             fastuidraw::const_c_array<int> index_adjusts,
-             fastuidraw::const_c_array<unsigned int> attrib_chunk_selector,
-             unsigned int z,
-             const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back)
+fastuidraw::Painter::
+end(void)
 {
-  fastuidraw::PainterPackerData p(draw);
-  p.m_clip = m_clip_rect_state.clip_equations_state(m_pool);
-  p.m_matrix = m_clip_rect_state.current_item_marix_state(m_pool);
-  m_core->draw_generic(shader, p, attrib_chunks, index_chunks, index_adjusts, attrib_chunk_selector, z, call_back);
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+
+  /* pop m_clip_stack to perform necessary writes
+   */
+  while(!d->m_occluder_stack.empty())
+    {
+      d->m_occluder_stack.back().on_pop(this);
+      d->m_occluder_stack.pop_back();
+    }
+  d->m_frame_occluders = 0;
+  /* clear state stack as well.
+   */
+  d->m_clip_store.clear();
+  d->m_state_stack.clear();
+  d->m_cull_by_dirty_rects = false;
+  d->m_core->end();
+
+  /* the packed values made since begin() are released
+     all at once by ending the arena; the only handles to
+     them that Painter keeps are those of current_clip_rect_state().
+   */
+  if(d->m_pool.arena_active())
+    {
+      d->writable_clip_rect_state().release_packed_values();
+      d->m_pool.end_arena();
+    }
+
+  /* the images of the layers of this frame that are not kept
+     can be reused by the next frame, as can those of the kept
+     layers not drawn this frame.
+   */
+  assert(!d->m_layer.m_active);
+  d->m_free_layer_images.swap(d->m_frame_layer_images);
+  d->m_frame_layer_images.clear();
+  for(std::map<uint64_t, cached_layer>::iterator iter = d->m_cached_layers.begin();
+      iter != d->m_cached_layers.end();)
+    {
+      if(iter->second.m_frame != d->m_frame)
+        {
+          d->m_free_layer_images.push_back(iter->second.m_image);
+          d->m_cached_layers.erase(iter++);
+        }
+      else
+        {
+          ++iter;
+        }
+    }
+
+  /* release the cached items not drawn this frame
+   */
+  assert(d->m_capturing_cached_item == NULL);
+  for(std::map<uint64_t, cached_item>::iterator iter = d->m_cached_items.begin();
+      iter != d->m_cached_items.end();)
+    {
+      if(iter->second.m_frame != d->m_frame)
+        {
+          if(d->m_free_cached_recordings.size() < PainterPrivate::max_free_cached_recordings)
+            {
+              d->m_free_cached_recordings.push_back(iter->second.m_recording);
+            }
+          d->m_cached_items.erase(iter++);
+        }
+      else
+        {
+          ++iter;
+        }
+    }
 }
 
 void
-PainterPrivate::
-draw_generic_check(const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &shader,
-                   const fastuidraw::PainterData &draw,
-                   fastuidraw::const_c_array<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > attrib_chunks,
-                   fastuidraw::const_c_array<fastuidraw::const_c_array<fastuidraw::PainterIndex> > index_chunks,
-                   fastuidraw::const_c_array<int> index_adjusts,
-                   fastuidraw::const_c_array<unsigned int> attrib_chunk_selector,
-                   unsigned int z,
-                   const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back)
+fastuidraw::Painter::
+end(std::ostream &stats)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+
+  end();
+  d->m_core->print_stats(stats);
+}
+
+void
+fastuidraw::Painter::
+draw_recording(const PainterRecording &recording)
 {
-  if(!m_clip_rect_state.m_all_content_culled)
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+
+  if(d->current_clip_rect_state().all_content_culled() || recording.max_z() == 0)
     {
-      draw_generic(shader, draw, attrib_chunks, index_chunks, index_adjusts, attrib_chunk_selector, z, call_back);
+      return;
     }
+
+  /* the recorded z-values start at 1, shift them so that
+     the smallest is current_z() and make current_z() the
+     largest shifted value.
+   */
+  d->m_core->draw_recording(recording, int(d->m_current_z) - 1);
+  d->m_current_z += recording.max_z() - 1;
 }
 
-//////////////////////////////////
-// fastuidraw::Painter methods
+void
 fastuidraw::Painter::
-Painter(reference_counted_ptr<PainterBackend> backend)
+begin_display_list(const reference_counted_ptr<PainterRecording> &display_list)
 {
-  m_d = FASTUIDRAWnew PainterPrivate(backend);
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+
+  save();
+  d->m_display_list_z = d->m_current_z;
+  d->m_display_list_state_depth = d->m_state_stack.size();
+  d->m_current_z = 1;
+
+  /* the transformation and clipping are applied when
+     the display list is drawn, so capture with the identity
+     transformation and with clip equations that clip nothing.
+   */
+  PainterClipEquations clip_eq;
+  clip_eq.m_clip_equations[0] = vec3(0.0f, 0.0f, 1.0f);
+  clip_eq.m_clip_equations[1] = vec3(0.0f, 0.0f, 1.0f);
+  clip_eq.m_clip_equations[2] = vec3(0.0f, 0.0f, 1.0f);
+  clip_eq.m_clip_equations[3] = vec3(0.0f, 0.0f, 1.0f);
+  d->writable_clip_rect_state().reset();
+  d->writable_clip_rect_state().clip_equations(clip_eq);
+  d->m_clip_store.set_current(clip_eq.m_clip_equations);
+
+  d->m_core->begin_capture(display_list);
 }
 
+void
 fastuidraw::Painter::
-~Painter()
+end_display_list(void)
 {
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
-  FASTUIDRAWdelete(d);
-  m_d = NULL;
+
+  assert(d->m_display_list_state_depth == d->m_state_stack.size());
+  assert(d->m_display_list_state_depth > 0);
+
+  /* restore() pops the occluders made while capturing
+     and thus must be called before ending the capture.
+   */
+  restore();
+  d->m_core->end_capture();
+  d->m_current_z = d->m_display_list_z;
+  d->m_display_list_state_depth = 0;
 }
 
-fastuidraw::PainterPackedValuePool&
+void
 fastuidraw::Painter::
-packed_value_pool(void)
+draw_display_list(const PainterRecording &display_list)
 {
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
-  return d->m_pool;
+
+  if(d->current_clip_rect_state().all_content_culled() || display_list.max_z() == 0)
+    {
+      return;
+    }
+
+  d->m_core->draw_recording(display_list,
+                            d->current_clip_rect_state().current_item_marix_state(d->m_pool),
+                            d->current_clip_rect_state().clip_equations_state(d->m_pool),
+                            int(d->m_current_z) - 1);
+  d->m_current_z += display_list.max_z() - 1;
 }
 
-void
+bool
 fastuidraw::Painter::
-target_resolution(int w, int h)
+draw_cached_item(uint64_t key, uint64_t state_hash)
 {
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
 
-  w = t_max(w, 1);
-  h = t_max(h, 1);
-  d->m_resolution.x() = static_cast<float>(w);
-  d->m_resolution.y() = static_cast<float>(h);
-  d->m_one_pixel_width = 1.0f / d->m_resolution;
-  d->m_core->target_resolution(w, h);
+  std::map<uint64_t, cached_item>::iterator iter;
+  iter = d->m_cached_items.find(key);
+  if(iter == d->m_cached_items.end() || iter->second.m_state_hash != state_hash)
+    {
+      return false;
+    }
+
+  iter->second.m_frame = d->m_frame;
+  draw_display_list(*iter->second.m_recording);
+  return true;
 }
 
 void
 fastuidraw::Painter::
-begin(bool reset_z)
+begin_cached_item(uint64_t key, uint64_t state_hash)
 {
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
 
-  d->m_core->begin();
+  assert(d->m_capturing_cached_item == NULL);
 
-  if(reset_z)
+  cached_item &item(d->m_cached_items[key]);
+  if(!item.m_recording)
     {
-      d->m_current_z = 1;
+      if(d->m_free_cached_recordings.empty())
+        {
+          item.m_recording = FASTUIDRAWnew PainterRecording();
+        }
+      else
+        {
+          item.m_recording = d->m_free_cached_recordings.back();
+          d->m_free_cached_recordings.pop_back();
+        }
     }
-  d->m_clip_rect_state.reset();
-  d->m_clip_store.set_current(d->m_clip_rect_state.clip_equations().m_clip_equations);
-  blend_shader(PainterEnums::blend_porter_duff_src_over);
+  item.m_state_hash = state_hash;
+  item.m_frame = d->m_frame;
+  d->m_capturing_cached_item = &item;
+  begin_display_list(item.m_recording);
 }
 
 void
 fastuidraw::Painter::
-end(void)
+end_cached_item(void)
 {
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
 
-  /* pop m_clip_stack to perform necessary writes
+  assert(d->m_capturing_cached_item != NULL);
+
+  /* the recording only holds the memory of its content,
+     see PainterPacker::begin_capture()
    */
-  while(!d->m_occluder_stack.empty())
+  end_display_list();
+  draw_display_list(*d->m_capturing_cached_item->m_recording);
+  d->m_capturing_cached_item = NULL;
+}
+
+bool
+fastuidraw::Painter::
+begin_layer(const vec2 &pmin, const vec2 &wh, float opacity,
+            uint64_t key, bool contents_unchanged)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+
+  layer_state &layer(d->m_layer);
+  std::map<uint64_t, cached_layer>::iterator iter;
+
+  assert(!layer.m_active);
+  assert(d->m_display_list_state_depth == 0);
+
+  layer.m_active = true;
+  layer.m_to_image = false;
+  layer.m_draw_content = false;
+  layer.m_opacity = opacity;
+  layer.m_image = reference_counted_ptr<Image>();
+
+  if(!d->m_backend->hints().draw_to_image())
     {
-      d->m_occluder_stack.back().on_pop(this);
-      d->m_occluder_stack.pop_back();
+      d->warn_layer_opacity_ignored("the PainterBackend cannot draw to an Image");
+      return !d->current_clip_rect_state().all_content_culled();
     }
-  /* clear state stack as well.
+
+  iter = (key != 0) ? d->m_cached_layers.find(key) : d->m_cached_layers.end();
+  if(iter != d->m_cached_layers.end())
+    {
+      /* keep the layer even if it is clipped away this frame
+       */
+      iter->second.m_frame = d->m_frame;
+    }
+
+  if(d->current_clip_rect_state().all_content_culled() || !d->compute_layer_rect(pmin, wh))
+    {
+      return false;
+    }
+
+  layer.m_item_matrix = d->current_clip_rect_state().item_matrix();
+  layer.m_to_image = true;
+  if(iter != d->m_cached_layers.end())
+    {
+      cached_layer &C(iter->second);
+
+      if(contents_unchanged
+         && C.m_image->dimensions() == layer.m_size
+         && !C.m_clamped && !layer.m_clamped
+         && same_up_to_translation(C.m_item_matrix, layer.m_item_matrix))
+        {
+          layer.m_image = C.m_image;
+          return false;
+        }
+
+      if(C.m_image->dimensions() != layer.m_size)
+        {
+          /* the previous frame was the last to draw the image
+           */
+          d->m_free_layer_images.push_back(C.m_image);
+          C.m_image = d->fetch_layer_image(layer.m_size);
+        }
+      layer.m_image = C.m_image;
+    }
+  else
+    {
+      layer.m_image = d->fetch_layer_image(layer.m_size);
+      if(layer.m_image && key != 0)
+        {
+          cached_layer &C(d->m_cached_layers[key]);
+          C.m_image = layer.m_image;
+          C.m_frame = d->m_frame;
+        }
+      else if(layer.m_image)
+        {
+          d->m_frame_layer_images.push_back(layer.m_image);
+        }
+    }
+
+  if(!layer.m_image)
+    {
+      /* no room on the atlas for the layer, draw the content directly
+       */
+      if(key != 0)
+        {
+          d->m_cached_layers.erase(key);
+        }
+      layer.m_to_image = false;
+      d->warn_layer_opacity_ignored("no room on the ImageAtlas for the layer");
+      return true;
+    }
+
+  if(key != 0)
+    {
+      cached_layer &C(d->m_cached_layers[key]);
+      C.m_item_matrix = layer.m_item_matrix;
+      C.m_clamped = layer.m_clamped;
+    }
+
+  if(!d->m_layer_recording)
+    {
+      d->m_layer_recording = FASTUIDRAWnew PainterRecording();
+    }
+  layer.m_draw_content = true;
+  begin_display_list(d->m_layer_recording);
+  return true;
+}
+
+void
+fastuidraw::Painter::
+end_layer(void)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+
+  layer_state &layer(d->m_layer);
+
+  assert(layer.m_active);
+  layer.m_active = false;
+  if(!layer.m_to_image)
+    {
+      return;
+    }
+
+  if(layer.m_draw_content)
+    {
+      end_display_list();
+      d->draw_layer_content();
+    }
+
+  /* draw the image as a rect whose local coordinates
+     are the texel coordinates of the image.
    */
-  d->m_clip_store.clear();
-  d->m_state_stack.clear();
-  d->m_core->end();
+  float3x3 m;
+  PainterBrush brush;
+  vec2 sz(layer.m_size);
+
+  m(0, 0) = (layer.m_clip_max.x() - layer.m_clip_min.x()) / sz.x();
+  m(0, 2) = layer.m_clip_min.x();
+  m(1, 1) = (layer.m_clip_max.y() - layer.m_clip_min.y()) / sz.y();
+  m(1, 2) = layer.m_clip_min.y();
+  brush
+    .image(layer.m_image)
+    .pen(1.0f, 1.0f, 1.0f, layer.m_opacity);
+
+  save();
+  transformation(m);
+  draw_rect(PainterData(&brush), vec2(0.0f, 0.0f), sz);
+  restore();
+  layer.m_image = reference_counted_ptr<Image>();
+}
+
+void
+fastuidraw::Painter::
+draw_generic(const reference_counted_ptr<PainterItemShader> &shader, const PainterData &draw,
+             const_c_array<const_c_array<PainterAttribute> > attrib_chunks,
+             const_c_array<const_c_array<PainterIndex> > index_chunks,
+             const_c_array<int> index_adjusts,
+             const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  d->draw_generic_check(shader, draw, attrib_chunks, index_chunks,
+                        index_adjusts, const_c_array<unsigned int>(),
+                        current_z(), call_back);
 }
 
 void
@@ -1244,29 +3074,64 @@ draw_generic(const reference_counted_ptr<PainterItemShader> &shader, const Paint
              const_c_array<const_c_array<PainterAttribute> > attrib_chunks,
              const_c_array<const_c_array<PainterIndex> > index_chunks,
              const_c_array<int> index_adjusts,
+             const_c_array<unsigned int> attrib_chunk_selector,
+             const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  d->draw_generic_check(shader, draw, attrib_chunks, index_chunks,
+                        index_adjusts, attrib_chunk_selector,
+                        current_z(), call_back);
+}
+
+void
+fastuidraw::Painter::
+draw_generic(const reference_counted_ptr<PainterItemShader> &shader, const PainterData &draw,
+             const reference_counted_ptr<const PainterStaticAttributeData> &data,
+             const_c_array<unsigned int> chunks,
              const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
 {
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
-  d->draw_generic_check(shader, draw, attrib_chunks, index_chunks,
-                        index_adjusts, const_c_array<unsigned int>(),
-                        current_z(), call_back);
+
+  if(d->current_clip_rect_state().all_content_culled())
+    {
+      return;
+    }
+
+  PainterPackerData p(draw);
+  p.m_clip = d->current_clip_rect_state().clip_equations_state(d->m_pool);
+  p.m_matrix = d->current_clip_rect_state().current_item_marix_state(d->m_pool);
+  d->m_core->draw_generic(shader, p, data, chunks, current_z(), call_back);
+}
+
+fastuidraw::reference_counted_ptr<const fastuidraw::PainterStaticAttributeData>
+fastuidraw::Painter::
+create_static_attribute_data(const PainterAttributeData &data,
+                             const_c_array<unsigned int> attrib_chunk_selector)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  return d->m_backend->create_static_attribute_data(data, attrib_chunk_selector);
 }
 
-void
+fastuidraw::reference_counted_ptr<const fastuidraw::PainterStaticAttributeData>
 fastuidraw::Painter::
-draw_generic(const reference_counted_ptr<PainterItemShader> &shader, const PainterData &draw,
-             const_c_array<const_c_array<PainterAttribute> > attrib_chunks,
-             const_c_array<const_c_array<PainterIndex> > index_chunks,
-             const_c_array<int> index_adjusts,
-             const_c_array<unsigned int> attrib_chunk_selector,
-             const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
+create_static_attribute_data(const PainterFillShader &shader,
+                             const PainterAttributeData &data)
 {
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
-  d->draw_generic_check(shader, draw, attrib_chunks, index_chunks,
-                        index_adjusts, attrib_chunk_selector,
-                        current_z(), call_back);
+
+  if(shader.chunk_selector()->common_attribute_data())
+    {
+      /* each index chunk indexes into attribute chunk 0
+       */
+      d->m_work_room.m_selector.clear();
+      d->m_work_room.m_selector.resize(data.index_data_chunks().size(), 0);
+      return create_static_attribute_data(data, make_c_array(d->m_work_room.m_selector));
+    }
+  return create_static_attribute_data(data);
 }
 
 void
@@ -1283,16 +3148,32 @@ draw_convex_polygon(const reference_counted_ptr<PainterItemShader> &shader,
       return;
     }
 
-  if(!d->m_core->hints().clipping_via_hw_clip_planes())
+  {
+    culling_timer timer(d->m_core.get(), d->m_culling_sampler);
+
+    if(d->culled_by_dirty_rects(pts))
+      {
+        return;
+      }
+
+    if(!d->m_core->hints().clipping_via_hw_clip_planes())
+      {
+        d->current_clip_rect_state().clip_polygon(pts, d->m_work_room.m_pts_draw_convex_polygon,
+                                          d->m_work_room.m_clipper_vec2s,
+                                          d->m_work_room.m_clipper_floats);
+        pts = make_c_array(d->m_work_room.m_pts_draw_convex_polygon);
+        if(pts.size() < 3)
+          {
+            return;
+          }
+      }
+  }
+
+  if(d->m_core->occlusion_culling() && !d->m_no_item_bounds
+     && !d->current_clip_rect_state().all_content_culled())
     {
-      d->m_clip_rect_state.clip_polygon(pts, d->m_work_room.m_pts_draw_convex_polygon,
-                                        d->m_work_room.m_clipper_vec2s[0],
-                                        d->m_work_room.m_clipper_floats);
-      pts = make_c_array(d->m_work_room.m_pts_draw_convex_polygon);
-      if(pts.size() < 3)
-        {
-          return;
-        }
+      d->convex_polygon_bounds(shader, draw, pts,
+                               !d->m_core->hints().clipping_via_hw_clip_planes());
     }
 
   /* Draw a triangle fan centered at pts[0]
@@ -1369,6 +3250,132 @@ draw_rect(const PainterData &draw, const vec2 &p, const vec2 &wh,
   draw_rect(default_shaders().fill_shader().item_shader(), draw, p, wh, call_back);
 }
 
+void
+fastuidraw::Painter::
+draw_quads(const reference_counted_ptr<PainterItemShader> &shader,
+           const PainterData &draw, const_c_array<vec2> pts,
+           const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+
+  if(d->current_clip_rect_state().all_content_culled())
+    {
+      return;
+    }
+
+  vecN<vec3, 4> local_eqs;
+  bool clip_on_cpu(!d->m_core->hints().clipping_via_hw_clip_planes());
+
+  assert(pts.size() % 4 == 0);
+  d->local_clip_equations(local_eqs);
+  d->begin_batch();
+  for(unsigned int i = 0, endi = pts.size() / 4; i < endi; ++i)
+    {
+      vecN<vec2, 4> quad;
+
+      quad[0] = pts[4 * i];
+      quad[1] = pts[4 * i + 1];
+      quad[2] = pts[4 * i + 2];
+      quad[3] = pts[4 * i + 3];
+      d->add_quad_to_batch(quad, local_eqs, clip_on_cpu);
+    }
+  d->draw_batch(shader, draw, call_back);
+}
+
+void
+fastuidraw::Painter::
+draw_quads(const PainterData &draw, const_c_array<vec2> pts,
+           const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
+{
+  draw_quads(default_shaders().fill_shader().item_shader(), draw, pts, call_back);
+}
+
+void
+fastuidraw::Painter::
+draw_rects(const reference_counted_ptr<PainterItemShader> &shader,
+           const PainterData &draw, const_c_array<vec2> p, const_c_array<vec2> wh,
+           const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+
+  if(d->current_clip_rect_state().all_content_culled() || p.empty())
+    {
+      return;
+    }
+
+  vecN<vec3, 4> local_eqs;
+  bool clip_on_cpu(!d->m_core->hints().clipping_via_hw_clip_planes());
+
+  assert(wh.size() == 1 || wh.size() == p.size());
+  d->local_clip_equations(local_eqs);
+  d->begin_batch();
+  for(unsigned int i = 0, endi = p.size(); i < endi; ++i)
+    {
+      d->add_quad_to_batch(PainterPrivate::rect_quad(p, wh, i), local_eqs, clip_on_cpu);
+    }
+  d->draw_batch(shader, draw, call_back);
+}
+
+void
+fastuidraw::Painter::
+draw_rects(const PainterData &draw, const_c_array<vec2> p, const_c_array<vec2> wh,
+           const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
+{
+  draw_rects(default_shaders().fill_shader().item_shader(), draw, p, wh, call_back);
+}
+
+void
+fastuidraw::Painter::
+draw_rects(const reference_counted_ptr<PainterItemShader> &shader,
+           const_c_array<PainterData> draws, const_c_array<unsigned int> draw_selector,
+           const_c_array<vec2> p, const_c_array<vec2> wh,
+           const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+
+  if(d->current_clip_rect_state().all_content_culled() || p.empty())
+    {
+      return;
+    }
+
+  vecN<vec3, 4> local_eqs;
+  bool clip_on_cpu(!d->m_core->hints().clipping_via_hw_clip_planes());
+  unsigned int current;
+
+  assert(draw_selector.size() == p.size());
+  assert(wh.size() == 1 || wh.size() == p.size());
+  d->local_clip_equations(local_eqs);
+
+  /* each run of rects with the same value of
+     draw_selector is drawn as one batch
+   */
+  current = draw_selector[0];
+  d->begin_batch();
+  for(unsigned int i = 0, endi = p.size(); i < endi; ++i)
+    {
+      if(draw_selector[i] != current)
+        {
+          d->draw_batch(shader, draws[current], call_back);
+          d->begin_batch();
+          current = draw_selector[i];
+        }
+      d->add_quad_to_batch(PainterPrivate::rect_quad(p, wh, i), local_eqs, clip_on_cpu);
+    }
+  d->draw_batch(shader, draws[current], call_back);
+}
+
+void
+fastuidraw::Painter::
+draw_rects(const_c_array<PainterData> draws, const_c_array<unsigned int> draw_selector,
+           const_c_array<vec2> p, const_c_array<vec2> wh,
+           const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
+{
+  draw_rects(default_shaders().fill_shader().item_shader(), draws, draw_selector, p, wh, call_back);
+}
+
 void
 fastuidraw::Painter::
 stroke_path(const PainterStrokeShader &shader, const PainterData &draw,
@@ -1381,7 +3388,7 @@ stroke_path(const PainterStrokeShader &shader, const PainterData &draw,
 {
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
-  if(d->m_clip_rect_state.m_all_content_culled)
+  if(d->current_clip_rect_state().all_content_culled())
     {
       return;
     }
@@ -1534,7 +3541,7 @@ stroke_path(const PainterStrokeShader &shader, const PainterData &draw,
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
 
-  if(d->m_clip_rect_state.m_all_content_culled)
+  if(d->current_clip_rect_state().all_content_culled())
     {
       return;
     }
@@ -1618,9 +3625,25 @@ stroke_path(const PainterStrokeShader &shader, const PainterData &draw, const Pa
   PainterPrivate *d;
   float thresh;
 
+  detail::BoundingBox box;
+  float pixel_room(0.0f);
+
   d = reinterpret_cast<PainterPrivate*>(m_d);
+
+  /* stroking_distances() does not account for miter joins
+   */
+  if(js != PainterEnums::miter_joins)
+    {
+      d->path_box(path, draw, shader.stroking_data_selector().get(), box, pixel_room);
+      if(d->box_culled_by_dirty_rects(box, pixel_room))
+        {
+          return;
+        }
+    }
+
+  item_box_scope item_box(d, box, pixel_room);
   thresh = d->select_path_thresh(path);
-  stroke_path(shader, draw, *path.tessellation(thresh)->stroked(), thresh,
+  stroke_path(shader, draw, *d->fetch_tessellation(path, thresh, PathPrefetcher::prefetch_stroked)->stroked(), thresh,
               close_contours, cp, js, with_anti_aliasing, call_back);
 }
 
@@ -1664,7 +3687,7 @@ stroke_dashed_path(const PainterStrokeShader &shader, const PainterData &draw,
    */
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
-  if(d->m_clip_rect_state.m_all_content_culled)
+  if(d->current_clip_rect_state().all_content_culled())
     {
       return;
     }
@@ -1716,7 +3739,7 @@ stroke_dashed_path(const PainterDashedStrokeShaderSet &shader, const PainterData
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
 
-  if(d->m_clip_rect_state.m_all_content_culled)
+  if(d->current_clip_rect_state().all_content_culled())
     {
       return;
     }
@@ -1778,9 +3801,22 @@ stroke_dashed_path(const PainterDashedStrokeShaderSet &shader, const PainterData
   PainterPrivate *d;
   float thresh;
 
+  detail::BoundingBox box;
+  float pixel_room(0.0f);
+
   d = reinterpret_cast<PainterPrivate*>(m_d);
+  if(js != PainterEnums::miter_joins)
+    {
+      d->path_box(path, draw, shader.shader(cp).stroking_data_selector().get(), box, pixel_room);
+      if(d->box_culled_by_dirty_rects(box, pixel_room))
+        {
+          return;
+        }
+    }
+
+  item_box_scope item_box(d, box, pixel_room);
   thresh = d->select_path_thresh(path);
-  stroke_dashed_path(shader, draw, *path.tessellation(thresh)->stroked(), thresh,
+  stroke_dashed_path(shader, draw, *d->fetch_tessellation(path, thresh, PathPrefetcher::prefetch_stroked)->stroked(), thresh,
                      close_contours, cp, js, with_anti_aliasing, call_back);
 }
 
@@ -1823,6 +3859,19 @@ fill_path(const PainterFillShader &shader, const PainterData &draw,
                call_back);
 }
 
+void
+fastuidraw::Painter::
+fill_path(const PainterFillShader &shader, const PainterData &draw,
+          const reference_counted_ptr<const PainterStaticAttributeData> &data,
+          enum PainterEnums::fill_rule_t fill_rule,
+          const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
+{
+  vecN<unsigned int, 1> chunk;
+
+  chunk[0] = shader.chunk_selector()->chunk_from_fill_rule(fill_rule);
+  draw_generic(shader.item_shader(), draw, data, chunk, call_back);
+}
+
 void
 fastuidraw::Painter::
 fill_path(const PainterFillShader &shader, const PainterData &draw,
@@ -1832,9 +3881,21 @@ fill_path(const PainterFillShader &shader, const PainterData &draw,
   PainterPrivate *d;
   float thresh;
 
+  detail::BoundingBox box;
+  float pixel_room(0.0f);
+
   d = reinterpret_cast<PainterPrivate*>(m_d);
+  d->path_box(path, draw, NULL, box, pixel_room);
+  if(d->box_culled_by_dirty_rects(box, pixel_room))
+    {
+      return;
+    }
+
+  item_box_scope item_box(d, box, pixel_room);
   thresh = d->select_path_thresh(path);
-  fill_path(shader, draw, path.tessellation(thresh)->filled()->painter_data(), fill_rule, call_back);
+  fill_path(shader, draw,
+            d->fetch_tessellation(path, thresh, PathPrefetcher::prefetch_filled)->filled()->painter_data(),
+            fill_rule, call_back);
 }
 
 void
@@ -1854,7 +3915,7 @@ fill_path(const PainterFillShader &shader, const PainterData &draw,
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
 
-  if(d->m_clip_rect_state.m_all_content_culled)
+  if(d->current_clip_rect_state().all_content_culled())
     {
       return;
     }
@@ -1931,9 +3992,21 @@ fill_path(const PainterFillShader &shader,
   PainterPrivate *d;
   float thresh;
 
+  detail::BoundingBox box;
+  float pixel_room(0.0f);
+
   d = reinterpret_cast<PainterPrivate*>(m_d);
+  d->path_box(path, draw, NULL, box, pixel_room);
+  if(d->box_culled_by_dirty_rects(box, pixel_room))
+    {
+      return;
+    }
+
+  item_box_scope item_box(d, box, pixel_room);
   thresh = d->select_path_thresh(path);
-  fill_path(shader, draw, path.tessellation(thresh)->filled()->painter_data(), fill_rule, call_back);
+  fill_path(shader, draw,
+            d->fetch_tessellation(path, thresh, PathPrefetcher::prefetch_filled)->filled()->painter_data(),
+            fill_rule, call_back);
 }
 
 void
@@ -1953,7 +4026,7 @@ draw_glyphs(const PainterGlyphShader &shader, const PainterData &draw,
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
 
-  if(d->m_clip_rect_state.m_all_content_culled)
+  if(d->current_clip_rect_state().all_content_culled())
     {
       return;
     }
@@ -1989,13 +4062,92 @@ draw_glyphs(const PainterData &draw,
     }
 }
 
+void
+fastuidraw::Painter::
+draw_glyphs(const PainterGlyphShader &shader, const PainterData &draw,
+            const PainterGlyphChunks &data,
+            const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+
+  if(d->current_clip_rect_state().all_content_culled())
+    {
+      return;
+    }
+
+  PainterWorkRoom &work_room(d->m_work_room);
+  const_c_array<enum glyph_type> types(data.glyph_types());
+
+  work_room.m_glyph_chunks.resize(data.maximum_chunks());
+  for(unsigned int i = 0; i < types.size(); ++i)
+    {
+      unsigned int num_chunks;
+
+      {
+        culling_timer timer(d->m_core.get(), d->m_culling_sampler);
+        num_chunks = data.chunks(work_room.m_glyph_scratch, types[i],
+                                 d->m_clip_store.current(),
+                                 d->current_clip_rect_state().item_matrix(),
+                                 make_c_array(work_room.m_glyph_chunks));
+      }
+      if(num_chunks == 0)
+        {
+          continue;
+        }
+
+      work_room.m_glyph_attrib_chunks.resize(num_chunks);
+      work_room.m_glyph_index_chunks.resize(num_chunks);
+      work_room.m_glyph_index_adjusts.resize(num_chunks);
+      detail::BoundingBox box;
+      for(unsigned int c = 0; c < num_chunks; ++c)
+        {
+          unsigned int k(work_room.m_glyph_chunks[c]);
+          vec2 bb_min, bb_max;
+
+          work_room.m_glyph_attrib_chunks[c] = data.attribute_data_chunk(k);
+          work_room.m_glyph_index_chunks[c] = data.index_data_chunk(k);
+          work_room.m_glyph_index_adjusts[c] = data.index_adjust_chunk(k);
+          if(d->m_core->occlusion_culling() && data.bounding_box_chunk(k, &bb_min, &bb_max))
+            {
+              box.union_point(bb_min);
+              box.union_point(bb_max);
+            }
+        }
+
+      item_box_scope item_box(d, box, 0.0f);
+      draw_generic(shader.shader(types[i]), draw,
+                   make_c_array(work_room.m_glyph_attrib_chunks),
+                   make_c_array(work_room.m_glyph_index_chunks),
+                   make_c_array(work_room.m_glyph_index_adjusts),
+                   call_back);
+      increment_z(data.data().increment_z_value(types[i]));
+    }
+}
+
+void
+fastuidraw::Painter::
+draw_glyphs(const PainterData &draw,
+            const PainterGlyphChunks &data, bool use_anistopic_antialias,
+            const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
+{
+  if(use_anistopic_antialias)
+    {
+      draw_glyphs(default_shaders().glyph_shader_anisotropic(), draw, data, call_back);
+    }
+  else
+    {
+      draw_glyphs(default_shaders().glyph_shader(), draw, data, call_back);
+    }
+}
+
 const fastuidraw::PainterItemMatrix&
 fastuidraw::Painter::
 transformation(void)
 {
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
-  return d->m_clip_rect_state.current_painter_item_matrix();
+  return d->current_clip_rect_state().current_painter_item_matrix();
 }
 
 void
@@ -2004,7 +4156,7 @@ transformation(const float3x3 &m)
 {
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
-  d->m_clip_rect_state.item_matrix(m, true);
+  d->writable_clip_rect_state().item_matrix(m, true);
 }
 
 const fastuidraw::PainterPackedValue<fastuidraw::PainterItemMatrix>&
@@ -2013,7 +4165,7 @@ transformation_state(void)
 {
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
-  return d->m_clip_rect_state.current_item_marix_state(d->m_pool);
+  return d->current_clip_rect_state().current_item_marix_state(d->m_pool);
 }
 
 void
@@ -2022,7 +4174,7 @@ transformation_state(const PainterPackedValue<PainterItemMatrix> &h)
 {
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
-  d->m_clip_rect_state.item_matrix_state(h, true);
+  d->writable_clip_rect_state().item_matrix_state(h, true);
 }
 
 void
@@ -2039,13 +4191,13 @@ concat(const float3x3 &tr)
             || tr(2, 0) != 0.0f || tr(2, 1) != 0.0f
             || tr(2, 2) != 1.0f);
 
-  m = d->m_clip_rect_state.item_matrix() * tr;
-  d->m_clip_rect_state.item_matrix(m, tricky);
+  m = d->current_clip_rect_state().item_matrix() * tr;
+  d->writable_clip_rect_state().item_matrix(m, tricky);
 
   if(!tricky)
     {
-      d->m_clip_rect_state.m_clip_rect.translate(vec2(-tr(0, 2), -tr(1, 2)));
-      d->m_clip_rect_state.m_clip_rect.shear(1.0f / tr(0,0), 1.0f / tr(1,1));
+      d->writable_clip_rect_state().m_clip_rect.translate(vec2(-tr(0, 2), -tr(1, 2)));
+      d->writable_clip_rect_state().m_clip_rect.shear(1.0f / tr(0,0), 1.0f / tr(1,1));
     }
 }
 
@@ -2056,10 +4208,7 @@ translate(const vec2 &p)
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
 
-  float3x3 m(d->m_clip_rect_state.item_matrix());
-  m.translate(p.x(), p.y());
-  d->m_clip_rect_state.item_matrix(m, false);
-  d->m_clip_rect_state.m_clip_rect.translate(-p);
+  d->writable_clip_rect_state().translate_item_matrix(p);
 }
 
 void
@@ -2069,10 +4218,10 @@ scale(float s)
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
 
-  float3x3 m(d->m_clip_rect_state.item_matrix());
+  float3x3 m(d->current_clip_rect_state().item_matrix());
   m.scale(s);
-  d->m_clip_rect_state.item_matrix(m, false);
-  d->m_clip_rect_state.m_clip_rect.scale(1.0f / s);
+  d->writable_clip_rect_state().item_matrix(m, false);
+  d->writable_clip_rect_state().m_clip_rect.scale(1.0f / s);
 }
 
 void
@@ -2082,10 +4231,10 @@ shear(float sx, float sy)
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
 
-  float3x3 m(d->m_clip_rect_state.item_matrix());
+  float3x3 m(d->current_clip_rect_state().item_matrix());
   m.shear(sx, sy);
-  d->m_clip_rect_state.item_matrix(m, false);
-  d->m_clip_rect_state.m_clip_rect.shear(1.0f / sx, 1.0f / sy);
+  d->writable_clip_rect_state().item_matrix(m, false);
+  d->writable_clip_rect_state().m_clip_rect.shear(1.0f / sx, 1.0f / sy);
 }
 
 void
@@ -2107,9 +4256,9 @@ rotate(float angle)
   tr(0, 1) = -s;
   tr(1, 1) = c;
 
-  float3x3 m(d->m_clip_rect_state.item_matrix());
+  float3x3 m(d->current_clip_rect_state().item_matrix());
   m = m * tr;
-  d->m_clip_rect_state.item_matrix(m, true);
+  d->writable_clip_rect_state().item_matrix(m, true);
 }
 
 void
@@ -2130,6 +4279,60 @@ curveFlatness(void)
   return d->m_curve_flatness;
 }
 
+void
+fastuidraw::Painter::
+path_prefetcher(const reference_counted_ptr<PathPrefetcher> &p)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  d->m_path_prefetcher = p;
+}
+
+const fastuidraw::reference_counted_ptr<fastuidraw::PathPrefetcher>&
+fastuidraw::Painter::
+path_prefetcher(void) const
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  return d->m_path_prefetcher;
+}
+
+void
+fastuidraw::Painter::
+zoom_velocity(float v)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  d->m_zoom_velocity = v;
+}
+
+float
+fastuidraw::Painter::
+zoom_velocity(void) const
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  return d->m_zoom_velocity;
+}
+
+void
+fastuidraw::Painter::
+path_prefetch_frames(unsigned int v)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  d->m_path_prefetch_frames = v;
+}
+
+unsigned int
+fastuidraw::Painter::
+path_prefetch_frames(void) const
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  return d->m_path_prefetch_frames;
+}
+
 void
 fastuidraw::Painter::
 save(void)
@@ -2137,14 +4340,14 @@ save(void)
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
 
-  state_stack_entry st;
+  d->m_state_stack.push_back(state_stack_entry());
+
+  state_stack_entry &st(d->m_state_stack.back());
   st.m_occluder_stack_position = d->m_occluder_stack.size();
   st.m_blend = d->m_core->blend_shader();
   st.m_blend_mode = d->m_core->blend_mode();
-  st.m_clip_rect_state = d->m_clip_rect_state;
+  st.m_clip_rect_state_saved = false;
   st.m_curve_flatness = d->m_curve_flatness;
-
-  d->m_state_stack.push_back(st);
   d->m_clip_store.push();
 }
 
@@ -2158,7 +4361,13 @@ restore(void)
   assert(!d->m_state_stack.empty());
   const state_stack_entry &st(d->m_state_stack.back());
 
-  d->m_clip_rect_state = st.m_clip_rect_state;
+  /* if the clip_rect_state was not changed since the save(),
+     then the current value is the saved value.
+   */
+  if(st.m_clip_rect_state_saved)
+    {
+      d->restore_clip_rect_state(st.m_clip_rect_state);
+    }
   d->m_core->blend_shader(st.m_blend, st.m_blend_mode);
   d->m_curve_flatness = st.m_curve_flatness;
   while(d->m_occluder_stack.size() > st.m_occluder_stack_position)
@@ -2202,7 +4411,7 @@ clipOutPath(const Path &path, enum PainterEnums::fill_rule_t fill_rule)
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
 
-  if(d->m_clip_rect_state.m_all_content_culled)
+  if(d->current_clip_rect_state().all_content_culled())
     {
       /* everything is clipped anyways, adding more clipping does not matter
        */
@@ -2236,7 +4445,7 @@ clipOutPath(const Path &path, const CustomFillRuleBase &fill_rule)
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
 
-  if(d->m_clip_rect_state.m_all_content_culled)
+  if(d->current_clip_rect_state().all_content_culled())
     {
       /* everything is clipped anyways, adding more clipping does not matter
        */
@@ -2270,7 +4479,7 @@ clipInPath(const Path &path, enum PainterEnums::fill_rule_t fill_rule)
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
 
-  if(d->m_clip_rect_state.m_all_content_culled)
+  if(d->current_clip_rect_state().all_content_culled())
     {
       /* everything is clipped anyways, adding more clipping does not matter
        */
@@ -2291,7 +4500,7 @@ clipInPath(const Path &path, const CustomFillRuleBase &fill_rule)
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
 
-  if(d->m_clip_rect_state.m_all_content_culled)
+  if(d->current_clip_rect_state().all_content_culled())
     {
       /* everything is clipped anyways, adding more clipping does not matter
        */
@@ -2312,47 +4521,54 @@ clipInRect(const vec2 &pmin, const vec2 &wh)
   PainterPrivate *d;
   d = reinterpret_cast<PainterPrivate*>(m_d);
 
+  clip_rect_state &clip_state(d->writable_clip_rect_state());
+
   vec2 pmax(pmin + wh);
 
-  d->m_clip_rect_state.m_all_content_culled =
-    d->m_clip_rect_state.m_all_content_culled ||
-    wh.x() <= 0.0f || wh.y() <= 0.0f ||
-    d->m_clip_rect_state.rect_is_culled(pmin, wh) ||
-    d->update_clip_equation_series(pmin, pmax);
+  {
+    culling_timer timer(d->m_core.get(), d->m_culling_sampler);
+    if(!clip_state.all_content_culled()
+       && (wh.x() <= 0.0f || wh.y() <= 0.0f
+           || clip_state.rect_is_culled(pmin, wh)
+           || d->update_clip_equation_series(pmin, pmax)))
+      {
+        clip_state.cull_all_content();
+      }
+  }
 
-  if(d->m_clip_rect_state.m_all_content_culled)
+  if(clip_state.all_content_culled())
     {
       /* everything is clipped anyways, adding more clipping does not matter
        */
       return;
     }
 
-  if(!d->m_clip_rect_state.m_clip_rect.m_enabled)
+  if(!clip_state.m_clip_rect.m_enabled)
     {
       /* no clipped rect defined yet, just take the arguments
          as the clipping window
        */
-      d->m_clip_rect_state.m_clip_rect = clip_rect(pmin, pmax);
-      d->m_clip_rect_state.set_clip_equations_to_clip_rect();
+      clip_state.m_clip_rect = clip_rect(pmin, pmax);
+      clip_state.set_clip_equations_to_clip_rect();
       return;
     }
-  else if(!d->m_clip_rect_state.item_matrix_transition_tricky())
+  else if(!clip_state.item_matrix_transition_tricky())
     {
       /* a previous clipping window (defined in m_clip_rect_state),
          but transformation takes screen aligned rectangles to
          screen aligned rectangles, thus the current value of
-         m_clip_rect_state.m_clip_rect is the clipping rect
+         current_clip_rect_state().m_clip_rect is the clipping rect
          in local coordinates, so we can intersect it with
          the passed rectangle.
        */
-      d->m_clip_rect_state.m_clip_rect.intersect(clip_rect(pmin, pmax));
-      d->m_clip_rect_state.set_clip_equations_to_clip_rect();
+      clip_state.m_clip_rect.intersect(clip_rect(pmin, pmax));
+      clip_state.set_clip_equations_to_clip_rect();
       return;
     }
 
 
   /* the transformation is tricky, thus the current value of
-     m_clip_rect_state.m_clip_rect does NOT reflect the actual
+     current_clip_rect_state().m_clip_rect does NOT reflect the actual
      clipping rectangle.
 
      The clipping is done as follows:
@@ -2362,16 +4578,16 @@ clipInRect(const vec2 &pmin, const vec2 &wh)
    */
   PainterPackedValue<PainterClipEquations> prev_clip, current_clip;
 
-  prev_clip = d->m_clip_rect_state.clip_equations_state(d->m_pool);
+  prev_clip = clip_state.clip_equations_state(d->m_pool);
   assert(prev_clip);
 
-  d->m_clip_rect_state.m_clip_rect = clip_rect(pmin, pmax);
+  clip_state.m_clip_rect = clip_rect(pmin, pmax);
 
   std::bitset<4> skip_occluder;
-  skip_occluder = d->m_clip_rect_state.set_clip_equations_to_clip_rect(prev_clip);
-  current_clip = d->m_clip_rect_state.clip_equations_state(d->m_pool);
+  skip_occluder = clip_state.set_clip_equations_to_clip_rect(prev_clip);
+  current_clip = clip_state.clip_equations_state(d->m_pool);
 
-  if(d->m_clip_rect_state.m_all_content_culled)
+  if(clip_state.all_content_culled())
     {
       /* The clip equations coming from the new clipping
          rectangle degenerate into an empty clipping region
@@ -2396,9 +4612,9 @@ clipInRect(const vec2 &pmin, const vec2 &wh)
      state from being marked as dirty.
    */
   PainterPackedValue<PainterItemMatrix> matrix_state;
-  matrix_state = d->m_clip_rect_state.current_item_marix_state(d->m_pool);
+  matrix_state = clip_state.current_item_marix_state(d->m_pool);
   assert(matrix_state);
-  d->m_clip_rect_state.item_matrix_state(d->m_identiy_matrix, false);
+  clip_state.item_matrix_state(d->m_identiy_matrix, false);
 
   reference_counted_ptr<ZDataCallBack> zdatacallback;
   zdatacallback = FASTUIDRAWnew ZDataCallBack();
@@ -2423,7 +4639,7 @@ clipInRect(const vec2 &pmin, const vec2 &wh)
       f = fastuidraw::t_abs(eq.x()) * d->m_one_pixel_width.x() + fastuidraw::t_abs(eq.y()) * d->m_one_pixel_width.y();
       eq.z() += f;
     }
-  d->m_clip_rect_state.clip_equations(slightly_bigger);
+  clip_state.clip_equations(slightly_bigger);
 
   /* draw the half plane occluders
    */
@@ -2436,13 +4652,13 @@ clipInRect(const vec2 &pmin, const vec2 &wh)
         }
     }
 
-  d->m_clip_rect_state.clip_equations_state(current_clip);
+  clip_state.clip_equations_state(current_clip);
 
   /* add to occluder stack.
    */
   d->m_occluder_stack.push_back(occluder_stack_entry(zdatacallback->m_actions));
 
-  d->m_clip_rect_state.item_matrix_state(matrix_state, false);
+  clip_state.item_matrix_state(matrix_state, false);
   blend_shader(old_blend, old_blend_mode);
 }
 
@@ -2528,6 +4744,42 @@ current_z(void) const
   return d->m_current_z;
 }
 
+uint64_t
+fastuidraw::Painter::
+query_timer(enum PainterPacker::timer_t t) const
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  return d->m_core->query_timer(t);
+}
+
+void
+fastuidraw::Painter::
+timers_enabled(bool v)
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  d->m_core->timers_enabled(v);
+}
+
+bool
+fastuidraw::Painter::
+timers_enabled(void) const
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  return d->m_core->timers_enabled();
+}
+
+fastuidraw::const_c_array<unsigned int>
+fastuidraw::Painter::
+item_shader_stats(void) const
+{
+  PainterPrivate *d;
+  d = reinterpret_cast<PainterPrivate*>(m_d);
+  return d->m_core->item_shader_stats();
+}
+
 void
 fastuidraw::Painter::
 increment_z(int amount)
@@ -0,0 +1,385 @@
+/*!
+ * \file painter_glyph_chunks.cpp
+ * \brief file painter_glyph_chunks.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+#include <vector>
+#include <fastuidraw/painter/painter_glyph_chunks.hpp>
+#include "../private/util_private.hpp"
+#include "../private/clip.hpp"
+#include "../private/bounding_box.hpp"
+
+namespace
+{
+  class ScratchSpacePrivate
+  {
+  public:
+    fastuidraw::small_vector<fastuidraw::vec3, 8> m_adjusted_clip_eqs;
+    fastuidraw::detail::clip_points m_clipped_rect;
+
+    fastuidraw::vecN<fastuidraw::detail::clip_points, 2> m_clip_scratch_vec2s;
+    fastuidraw::small_vector<float, 16> m_clip_scratch_floats;
+  };
+
+  /* A ChunkNode is a node of the culling hierarchy
+     of a single glyph type; it holds the glyphs
+     [m_glyphs.m_begin, m_glyphs.m_end) of the chunk
+     of that glyph type.
+   */
+  class ChunkNode
+  {
+  public:
+    fastuidraw::detail::BoundingBox m_bb;
+    fastuidraw::range_type<unsigned int> m_glyphs;
+    fastuidraw::const_c_array<fastuidraw::PainterAttribute> m_attributes;
+    fastuidraw::const_c_array<fastuidraw::PainterIndex> m_indices;
+    int m_index_adjust;
+
+    /* indices into PainterGlyphChunksPrivate::m_nodes,
+       or -1 if the node is a leaf
+     */
+    fastuidraw::vecN<int, 2> m_children;
+  };
+
+  class PainterGlyphChunksPrivate
+  {
+  public:
+    enum
+      {
+        attributes_per_glyph = 4,
+        indices_per_glyph = 6
+      };
+
+    PainterGlyphChunksPrivate(const fastuidraw::PainterAttributeDataFillerGlyphs &filler,
+                              unsigned int max_glyphs_per_chunk);
+
+    unsigned int
+    build_hierarchy(unsigned int tp, unsigned int begin, unsigned int end);
+
+    void
+    chunks_implement(ScratchSpacePrivate &scratch, unsigned int node,
+                     fastuidraw::c_array<unsigned int> dst,
+                     unsigned int &current) const;
+
+    fastuidraw::PainterAttributeData m_data;
+    unsigned int m_number_glyphs;
+    unsigned int m_max_glyphs_per_chunk;
+    unsigned int m_maximum_chunks;
+    std::vector<enum fastuidraw::glyph_type> m_glyph_types;
+
+    /* m_roots[t] is the root node of glyph type t,
+       or -1 if there are no glyphs of type t.
+     */
+    std::vector<int> m_roots;
+    std::vector<ChunkNode> m_nodes;
+  };
+}
+
+///////////////////////////////////////////
+// PainterGlyphChunksPrivate methods
+PainterGlyphChunksPrivate::
+PainterGlyphChunksPrivate(const fastuidraw::PainterAttributeDataFillerGlyphs &filler,
+                          unsigned int max_glyphs_per_chunk):
+  m_max_glyphs_per_chunk(fastuidraw::t_max(1u, max_glyphs_per_chunk)),
+  m_maximum_chunks(0)
+{
+  fastuidraw::const_c_array<unsigned int> chks;
+
+  m_data.set_data(filler);
+  m_number_glyphs = filler.number_glyphs();
+  m_roots.resize(m_data.attribute_data_chunks().size(), -1);
+
+  chks = m_data.non_empty_index_data_chunks();
+  for(unsigned int i = 0; i < chks.size(); ++i)
+    {
+      unsigned int t, num_glyphs, num_leaves;
+
+      t = chks[i];
+      num_glyphs = m_data.attribute_data_chunk(t).size() / attributes_per_glyph;
+      assert(m_data.index_data_chunk(t).size() == num_glyphs * indices_per_glyph);
+
+      m_glyph_types.push_back(static_cast<enum fastuidraw::glyph_type>(t));
+      m_roots[t] = build_hierarchy(t, 0, num_glyphs);
+
+      num_leaves = (num_glyphs + m_max_glyphs_per_chunk - 1) / m_max_glyphs_per_chunk;
+      m_maximum_chunks = fastuidraw::t_max(m_maximum_chunks, num_leaves);
+    }
+}
+
+unsigned int
+PainterGlyphChunksPrivate::
+build_hierarchy(unsigned int tp, unsigned int begin, unsigned int end)
+{
+  unsigned int return_value(m_nodes.size());
+  fastuidraw::const_c_array<fastuidraw::PainterAttribute> attributes;
+  fastuidraw::const_c_array<fastuidraw::PainterIndex> indices;
+  ChunkNode node;
+
+  assert(begin < end);
+  attributes = m_data.attribute_data_chunk(tp);
+  indices = m_data.index_data_chunk(tp);
+
+  /* the indices of a glyph type chunk are relative to the
+     start of the attributes of the chunk, thus the indices of
+     the glyphs [begin, end) need to be adjusted by the number
+     of attributes before the glyph begin.
+   */
+  node.m_glyphs = fastuidraw::range_type<unsigned int>(begin, end);
+  node.m_attributes = attributes.sub_array(attributes_per_glyph * begin,
+                                           attributes_per_glyph * (end - begin));
+  node.m_indices = indices.sub_array(indices_per_glyph * begin,
+                                     indices_per_glyph * (end - begin));
+  node.m_index_adjust = m_data.index_adjust_chunk(tp) - int(attributes_per_glyph * begin);
+  node.m_children = fastuidraw::vecN<int, 2>(-1, -1);
+  m_nodes.push_back(node);
+
+  if(end - begin <= m_max_glyphs_per_chunk)
+    {
+      /* leaf; the bounding box is that of the quads of the glyphs,
+         whose positions are in PainterAttribute::m_attrib1.xy
+       */
+      fastuidraw::detail::BoundingBox bb;
+      for(unsigned int i = 0, endi = m_nodes[return_value].m_attributes.size(); i < endi; ++i)
+        {
+          const fastuidraw::PainterAttribute &A(m_nodes[return_value].m_attributes[i]);
+          bb.union_point(fastuidraw::vec2(fastuidraw::unpack_float(A.m_attrib1.x()),
+                                          fastuidraw::unpack_float(A.m_attrib1.y())));
+        }
+      m_nodes[return_value].m_bb = bb;
+    }
+  else
+    {
+      unsigned int num_blocks, split;
+      int child0, child1;
+
+      /* split on a block boundary so that the leaves are the
+         blocks of m_max_glyphs_per_chunk glyphs
+       */
+      num_blocks = (end - begin + m_max_glyphs_per_chunk - 1) / m_max_glyphs_per_chunk;
+      split = begin + m_max_glyphs_per_chunk * (num_blocks / 2);
+
+      child0 = build_hierarchy(tp, begin, split);
+      child1 = build_hierarchy(tp, split, end);
+      m_nodes[return_value].m_children = fastuidraw::vecN<int, 2>(child0, child1);
+      m_nodes[return_value].m_bb.union_box(m_nodes[child0].m_bb);
+      m_nodes[return_value].m_bb.union_box(m_nodes[child1].m_bb);
+    }
+
+  return return_value;
+}
+
+void
+PainterGlyphChunksPrivate::
+chunks_implement(ScratchSpacePrivate &scratch, unsigned int node,
+                 fastuidraw::c_array<unsigned int> dst,
+                 unsigned int &current) const
+{
+  using namespace fastuidraw;
+  using namespace fastuidraw::detail;
+
+  const ChunkNode &N(m_nodes[node]);
+  vecN<vec2, 4> bb;
+  bool unclipped;
+
+  if(N.m_bb.m_empty)
+    {
+      return;
+    }
+
+  N.m_bb.inflated_polygon(bb, 0.0f);
+  unclipped = clip_against_planes(make_c_array(scratch.m_adjusted_clip_eqs),
+                                  bb, scratch.m_clipped_rect,
+                                  scratch.m_clip_scratch_floats,
+                                  scratch.m_clip_scratch_vec2s);
+  //completely clipped
+  if(!unclipped && scratch.m_clipped_rect.empty())
+    {
+      return;
+    }
+
+  //completely unclipped or a leaf
+  if(unclipped || N.m_children[0] == -1)
+    {
+      dst[current] = node;
+      ++current;
+      return;
+    }
+
+  chunks_implement(scratch, N.m_children[0], dst, current);
+  chunks_implement(scratch, N.m_children[1], dst, current);
+}
+
+/////////////////////////////////////////////////////////
+// fastuidraw::PainterGlyphChunks::ScratchSpace methods
+fastuidraw::PainterGlyphChunks::ScratchSpace::
+ScratchSpace(void)
+{
+  m_d = FASTUIDRAWnew ScratchSpacePrivate();
+}
+
+fastuidraw::PainterGlyphChunks::ScratchSpace::
+~ScratchSpace()
+{
+  ScratchSpacePrivate *d;
+  d = reinterpret_cast<ScratchSpacePrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = NULL;
+}
+
+//////////////////////////////////////////
+// fastuidraw::PainterGlyphChunks methods
+fastuidraw::PainterGlyphChunks::
+PainterGlyphChunks(const PainterAttributeDataFillerGlyphs &filler,
+                   unsigned int max_glyphs_per_chunk)
+{
+  m_d = FASTUIDRAWnew PainterGlyphChunksPrivate(filler, max_glyphs_per_chunk);
+}
+
+fastuidraw::PainterGlyphChunks::
+~PainterGlyphChunks()
+{
+  PainterGlyphChunksPrivate *d;
+  d = reinterpret_cast<PainterGlyphChunksPrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = NULL;
+}
+
+const fastuidraw::PainterAttributeData&
+fastuidraw::PainterGlyphChunks::
+data(void) const
+{
+  PainterGlyphChunksPrivate *d;
+  d = reinterpret_cast<PainterGlyphChunksPrivate*>(m_d);
+  return d->m_data;
+}
+
+unsigned int
+fastuidraw::PainterGlyphChunks::
+number_glyphs(void) const
+{
+  PainterGlyphChunksPrivate *d;
+  d = reinterpret_cast<PainterGlyphChunksPrivate*>(m_d);
+  return d->m_number_glyphs;
+}
+
+unsigned int
+fastuidraw::PainterGlyphChunks::
+max_glyphs_per_chunk(void) const
+{
+  PainterGlyphChunksPrivate *d;
+  d = reinterpret_cast<PainterGlyphChunksPrivate*>(m_d);
+  return d->m_max_glyphs_per_chunk;
+}
+
+fastuidraw::const_c_array<enum fastuidraw::glyph_type>
+fastuidraw::PainterGlyphChunks::
+glyph_types(void) const
+{
+  PainterGlyphChunksPrivate *d;
+  d = reinterpret_cast<PainterGlyphChunksPrivate*>(m_d);
+  return make_c_array(d->m_glyph_types);
+}
+
+fastuidraw::const_c_array<fastuidraw::PainterAttribute>
+fastuidraw::PainterGlyphChunks::
+attribute_data_chunk(unsigned int chunk) const
+{
+  PainterGlyphChunksPrivate *d;
+  d = reinterpret_cast<PainterGlyphChunksPrivate*>(m_d);
+  assert(chunk < d->m_nodes.size());
+  return d->m_nodes[chunk].m_attributes;
+}
+
+fastuidraw::const_c_array<fastuidraw::PainterIndex>
+fastuidraw::PainterGlyphChunks::
+index_data_chunk(unsigned int chunk) const
+{
+  PainterGlyphChunksPrivate *d;
+  d = reinterpret_cast<PainterGlyphChunksPrivate*>(m_d);
+  assert(chunk < d->m_nodes.size());
+  return d->m_nodes[chunk].m_indices;
+}
+
+int
+fastuidraw::PainterGlyphChunks::
+index_adjust_chunk(unsigned int chunk) const
+{
+  PainterGlyphChunksPrivate *d;
+  d = reinterpret_cast<PainterGlyphChunksPrivate*>(m_d);
+  assert(chunk < d->m_nodes.size());
+  return d->m_nodes[chunk].m_index_adjust;
+}
+
+bool
+fastuidraw::PainterGlyphChunks::
+bounding_box_chunk(unsigned int chunk, vec2 *out_min_bb, vec2 *out_max_bb) const
+{
+  PainterGlyphChunksPrivate *d;
+  d = reinterpret_cast<PainterGlyphChunksPrivate*>(m_d);
+  assert(chunk < d->m_nodes.size());
+
+  const detail::BoundingBox &bb(d->m_nodes[chunk].m_bb);
+  if(bb.m_empty)
+    {
+      return false;
+    }
+  *out_min_bb = bb.m_min;
+  *out_max_bb = bb.m_max;
+  return true;
+}
+
+unsigned int
+fastuidraw::PainterGlyphChunks::
+chunks(ScratchSpace &scratch_space,
+       enum glyph_type tp,
+       const_c_array<vec3> clip_equations,
+       const float3x3 &clip_matrix_local,
+       c_array<unsigned int> dst) const
+{
+  PainterGlyphChunksPrivate *d;
+  ScratchSpacePrivate *scratch;
+  unsigned int return_value(0u);
+
+  d = reinterpret_cast<PainterGlyphChunksPrivate*>(m_d);
+  scratch = reinterpret_cast<ScratchSpacePrivate*>(scratch_space.m_d);
+
+  if(static_cast<unsigned int>(tp) >= d->m_roots.size() || d->m_roots[tp] == -1)
+    {
+      return 0;
+    }
+
+  /* transform clip equations from clip coordinates to
+     local coordinates.
+   */
+  scratch->m_adjusted_clip_eqs.resize(clip_equations.size());
+  for(unsigned int i = 0; i < clip_equations.size(); ++i)
+    {
+      scratch->m_adjusted_clip_eqs[i] = clip_equations[i] * clip_matrix_local;
+    }
+
+  d->chunks_implement(*scratch, d->m_roots[tp], dst, return_value);
+  assert(return_value <= d->m_maximum_chunks);
+  return return_value;
+}
+
+unsigned int
+fastuidraw::PainterGlyphChunks::
+maximum_chunks(void) const
+{
+  PainterGlyphChunksPrivate *d;
+  d = reinterpret_cast<PainterGlyphChunksPrivate*>(m_d);
+  return d->m_maximum_chunks;
+}
@@ -19,6 +19,7 @@
 
 #include <vector>
 #include <complex>
+#include <boost/atomic.hpp>
 
 #include <fastuidraw/tessellated_path.hpp>
 #include <fastuidraw/path.hpp>
@@ -28,6 +29,7 @@
 #include "../private/util_private.hpp"
 #include "../private/path_util_private.hpp"
 #include "../private/clip.hpp"
+#include "../private/bounding_box.hpp"
 
 namespace
 {
@@ -125,59 +127,14 @@ namespace
     fastuidraw::vec2 m_bevel_normal;
   };
 
-  class BoundingBox
-  {
-  public:
-    BoundingBox(void):
-      m_empty(true)
-    {}
-
-    void
-    inflated_polygon(fastuidraw::vecN<fastuidraw::vec2, 4> &out_data, float rad)
-    {
-      assert(!m_empty);
-      out_data[0] = fastuidraw::vec2(m_min.x() - rad, m_min.y() - rad);
-      out_data[1] = fastuidraw::vec2(m_max.x() + rad, m_min.y() - rad);
-      out_data[2] = fastuidraw::vec2(m_max.x() + rad, m_max.y() + rad);
-      out_data[3] = fastuidraw::vec2(m_min.x() - rad, m_max.y() + rad);
-    }
-
-    void
-    union_point(const fastuidraw::vec2 &pt)
-    {
-      if(m_empty)
-        {
-          m_empty = false;
-          m_min = m_max = pt;
-        }
-      else
-        {
-          m_min.x() = fastuidraw::t_min(m_min.x(), pt.x());
-          m_min.y() = fastuidraw::t_min(m_min.y(), pt.y());
-
-          m_max.x() = fastuidraw::t_max(m_max.x(), pt.x());
-          m_max.y() = fastuidraw::t_max(m_max.y(), pt.y());
-        }
-    }
-
-    void
-    union_box(const BoundingBox &b)
-    {
-      if(!b.m_empty)
-        {
-          union_point(b.m_min);
-          union_point(b.m_max);
-        }
-    }
-
-    fastuidraw::vec2 m_min, m_max;
-    bool m_empty;
-  };
+  typedef fastuidraw::detail::BoundingBox BoundingBox;
 
   class EdgeStore
   {
   public:
-    EdgeStore(const fastuidraw::TessellatedPath &P, PathData &path_data);
+    EdgeStore(const fastuidraw::TessellatedPath &P,
+              fastuidraw::const_c_array<fastuidraw::TessellatedPath::point> src_pts,
+              PathData &path_data);
 
     fastuidraw::const_c_array<SingleSubEdge>
     sub_edges(bool with_closing_edges)
@@ -200,7 +157,9 @@ namespace
   private:
 
     void
-    process_edge(const fastuidraw::TessellatedPath &P, PathData &path_data,
+    process_edge(const fastuidraw::TessellatedPath &P,
+                 fastuidraw::const_c_array<fastuidraw::TessellatedPath::point> src_pts,
+                 PathData &path_data,
                  unsigned int contour, unsigned int edge,
                  std::vector<SingleSubEdge> &dst, BoundingBox &bx);
 
@@ -244,11 +203,11 @@ namespace
   class ScratchSpacePrivate
   {
   public:
-    std::vector<fastuidraw::vec3> m_adjusted_clip_eqs;
-    std::vector<fastuidraw::vec2> m_clipped_rect;
+    fastuidraw::small_vector<fastuidraw::vec3, 8> m_adjusted_clip_eqs;
+    fastuidraw::detail::clip_points m_clipped_rect;
 
-    fastuidraw::vecN<std::vector<fastuidraw::vec2>, 2> m_clip_scratch_vec2s;
-    std::vector<float> m_clip_scratch_floats;
+    fastuidraw::vecN<fastuidraw::detail::clip_points, 2> m_clip_scratch_vec2s;
+    fastuidraw::small_vector<float, 16> m_clip_scratch_floats;
   };
 
   class EdgesElement
@@ -326,7 +285,7 @@ namespace
   public:
     explicit
     EdgesElementFiller(EdgesElement *src,
-                       const fastuidraw::TessellatedPath &P);
+                       fastuidraw::const_c_array<fastuidraw::TessellatedPath::point> src_pts);
 
     virtual
     void
@@ -359,7 +318,7 @@ namespace
                      unsigned int &vertex_offset, unsigned int &index_offset) const;
 
     EdgesElement *m_src;
-    const fastuidraw::TessellatedPath &m_P;
+    fastuidraw::const_c_array<fastuidraw::TessellatedPath::point> m_src_pts;
   };
 
   class JoinCount
@@ -767,6 +726,47 @@ namespace
     float m_thresh;
   };
 
+  /* The levels of detail of the rounded joins or caps, from
+     coarsest to finest. A level is written before m_size is
+     incremented past it and is not changed after, so that the
+     levels are read without a lock. The threshhold is at least
+     1e-6 (see StrokedPathPrivate::fetch_create()) and halves
+     from 1.0 with each level, so max_levels is never reached.
+   */
+  class ThreshWithDataList
+  {
+  public:
+    enum
+      {
+        max_levels = 32
+      };
+
+    ThreshWithDataList(void):
+      m_size(0u)
+    {}
+
+    ~ThreshWithDataList()
+    {
+      for(unsigned int i = 0, endi = m_size.load(); i < endi; ++i)
+        {
+          FASTUIDRAWdelete(m_values[i].m_data);
+        }
+    }
+
+    void
+    push_back(const ThreshWithData &v)
+    {
+      unsigned int n(m_size.load(boost::memory_order_relaxed));
+
+      assert(n < max_levels);
+      m_values[n] = v;
+      m_size.store(n + 1, boost::memory_order_release);
+    }
+
+    fastuidraw::vecN<ThreshWithData, max_levels> m_values;
+    boost::atomic<unsigned int> m_size;
+  };
+
   class StrokedPathPrivate
   {
   public:
@@ -777,9 +777,12 @@ namespace
     void
     create_edges(const fastuidraw::TessellatedPath &P);
 
+    /* returns the data of values for thresh, making the
+       missing levels with m_mutex locked
+     */
     template<typename T>
     const fastuidraw::PainterAttributeData&
-    fetch_create(float thresh, std::vector<ThreshWithData> &values);
+    fetch_create(float thresh, ThreshWithDataList &values);
 
     fastuidraw::vecN<EdgesElement*, 2> m_edge_culler;
     fastuidraw::vecN<fastuidraw::PainterAttributeData, 2> m_edges;
@@ -788,8 +791,9 @@ namespace
     fastuidraw::PainterAttributeData m_square_caps, m_adjustable_caps;
     PathData m_path_data;
 
-    std::vector<ThreshWithData> m_rounded_joins;
-    std::vector<ThreshWithData> m_rounded_caps;
+    ThreshWithDataList m_rounded_joins;
+    ThreshWithDataList m_rounded_caps;
+    boost::mutex m_mutex;
 
     float m_effective_curve_distance_threshhold;
   };
@@ -943,7 +947,9 @@ compute_lambda(const fastuidraw::vec2 &n0, const fastuidraw::vec2 &n1)
 const float EdgeStore::sm_mag_tol = 0.000001f;
 
 EdgeStore::
-EdgeStore(const fastuidraw::TessellatedPath &P, PathData &path_data)
+EdgeStore(const fastuidraw::TessellatedPath &P,
+          fastuidraw::const_c_array<fastuidraw::TessellatedPath::point> src_pts,
+          PathData &path_data)
 {
   std::vector<SingleSubEdge> closing_edges, non_closing_edges;
   BoundingBox closing_edges_bb, non_closing_edges_bb;
@@ -952,17 +958,20 @@ EdgeStore(const fastuidraw::TessellatedPath &P, PathData &path_data)
   for(unsigned int o = 0; o < P.number_contours(); ++o)
     {
       path_data.m_per_contour_data[o].m_edge_data_store.resize(P.number_edges(o));
-      path_data.m_per_contour_data[o].m_start_contour_pt = P.unclosed_contour_point_data(o).front();
-      path_data.m_per_contour_data[o].m_end_contour_pt = P.unclosed_contour_point_data(o).back();
+      fastuidraw::const_c_array<fastuidraw::TessellatedPath::point> unclosed;
+
+      unclosed = src_pts.sub_array(P.unclosed_contour_range(o));
+      path_data.m_per_contour_data[o].m_start_contour_pt = unclosed.front();
+      path_data.m_per_contour_data[o].m_end_contour_pt = unclosed.back();
       for(unsigned int e = 0; e < P.number_edges(o); ++e)
         {
           if(e + 1 == P.number_edges(o))
             {
-              process_edge(P, path_data, o, e, closing_edges, closing_edges_bb);
+              process_edge(P, src_pts, path_data, o, e, closing_edges, closing_edges_bb);
             }
           else
             {
-              process_edge(P, path_data, o, e, non_closing_edges, non_closing_edges_bb);
+              process_edge(P, src_pts, path_data, o, e, non_closing_edges, non_closing_edges_bb);
             }
         }
     }
@@ -987,12 +996,13 @@ EdgeStore(const fastuidraw::TessellatedPath &P, PathData &path_data)
 
 void
 EdgeStore::
-process_edge(const fastuidraw::TessellatedPath &P, PathData &path_data,
+process_edge(const fastuidraw::TessellatedPath &P,
+             fastuidraw::const_c_array<fastuidraw::TessellatedPath::point> src_pts,
+             PathData &path_data,
              unsigned int contour, unsigned int edge,
              std::vector<SingleSubEdge> &dst, BoundingBox &bx)
 {
   fastuidraw::range_type<unsigned int> R;
-  fastuidraw::const_c_array<fastuidraw::TessellatedPath::point> src_pts(P.point_data());
   fastuidraw::vec2 normal(1.0f, 0.0f), last_normal(1.0f, 0.0f);
 
   R = P.edge_range(contour, edge);
@@ -1361,9 +1371,9 @@ count_vertices_indices(SubEdgeCullingHierarchy *src,
 // EdgesElementFiller methods
 EdgesElementFiller::
 EdgesElementFiller(EdgesElement *src,
-                   const fastuidraw::TessellatedPath &P):
+                   fastuidraw::const_c_array<fastuidraw::TessellatedPath::point> src_pts):
   m_src(src),
-  m_P(P)
+  m_src_pts(src_pts)
 {
 }
 
@@ -1450,7 +1460,7 @@ process_sub_edge(const SingleSubEdge &sub_edge, unsigned int raw_depth,
                  fastuidraw::c_array<fastuidraw::PainterIndex> indices,
                  unsigned int &vert_offset, unsigned int &index_offset) const
 {
-  fastuidraw::const_c_array<fastuidraw::TessellatedPath::point> src_pts(m_P.point_data());
+  fastuidraw::const_c_array<fastuidraw::TessellatedPath::point> src_pts(m_src_pts);
   const int boundary_values[3] = { 1, 1, 0 };
   const float normal_sign[3] = { 1.0f, -1.0f, 0.0f };
   fastuidraw::vecN<fastuidraw::StrokedPath::point, 6> pts;
@@ -2538,15 +2548,6 @@ StrokedPathPrivate(const fastuidraw::TessellatedPath &P)
 StrokedPathPrivate::
 ~StrokedPathPrivate()
 {
-  for(unsigned int i = 0, endi = m_rounded_joins.size(); i < endi; ++i)
-    {
-      FASTUIDRAWdelete(m_rounded_joins[i].m_data);
-    }
-
-  for(unsigned int i = 0, endi = m_rounded_caps.size(); i < endi; ++i)
-    {
-      FASTUIDRAWdelete(m_rounded_caps[i].m_data);
-    }
   FASTUIDRAWdelete(m_edge_culler[0]);
   FASTUIDRAWdelete(m_edge_culler[1]);
 }
@@ -2555,16 +2556,22 @@ void
 StrokedPathPrivate::
 create_edges(const fastuidraw::TessellatedPath &P)
 {
-  EdgeStore edge_store(P, m_path_data);
+  /* the points are only needed while the edges are made
+   */
+  std::vector<fastuidraw::TessellatedPath::point> work_room;
+  fastuidraw::const_c_array<fastuidraw::TessellatedPath::point> src_pts;
+
+  src_pts = fastuidraw::detail::point_data(P, work_room);
+  EdgeStore edge_store(P, src_pts, m_path_data);
 
   for(unsigned int i = 0; i < 2; ++i)
     {
       SubEdgeCullingHierarchy *s;
       s = FASTUIDRAWnew SubEdgeCullingHierarchy(edge_store.bounding_box(i != 0),
                                                 0, edge_store.sub_edges(i != 0),
-                                                P.point_data());
+                                                src_pts);
       m_edge_culler[i] = EdgesElement::create(s);
-      m_edges[i].set_data(EdgesElementFiller(m_edge_culler[i], P));
+      m_edges[i].set_data(EdgesElementFiller(m_edge_culler[i], src_pts));
       FASTUIDRAWdelete(s);
     }
 }
@@ -2572,35 +2579,34 @@ create_edges(const fastuidraw::TessellatedPath &P)
 template<typename T>
 const fastuidraw::PainterAttributeData&
 StrokedPathPrivate::
-fetch_create(float thresh, std::vector<ThreshWithData> &values)
+fetch_create(float thresh, ThreshWithDataList &values)
 {
-  if(values.empty())
-    {
-      fastuidraw::PainterAttributeData *newD;
-      newD = FASTUIDRAWnew fastuidraw::PainterAttributeData();
-      newD->set_data(T(m_path_data, 1.0f));
-      values.push_back(ThreshWithData(newD, 1.0f));
-    }
+  unsigned int n;
 
   /* we set a hard tolerance of 1e-6. Should we
      set it as a ratio of the bounding box of
      the underlying tessellated path?
    */
   thresh = fastuidraw::t_max(thresh, float(1e-6));
-  if(values.back().m_thresh <= thresh)
-    {
-      std::vector<ThreshWithData>::const_iterator iter;
-      iter = std::lower_bound(values.begin(), values.end(), thresh,
-                              ThreshWithData::reverse_compare_against_thresh);
-      assert(iter != values.end());
-      assert(iter->m_thresh <= thresh);
-      assert(iter->m_data != NULL);
-      return *iter->m_data;
-    }
-  else
+
+  n = values.m_size.load(boost::memory_order_acquire);
+  if(n == 0 || values.m_values[n - 1].m_thresh > thresh)
     {
+      boost::lock_guard<boost::mutex> lock(m_mutex);
+
+      /* another thread may have made the levels while
+         this thread waited for the lock
+       */
+      if(values.m_size.load(boost::memory_order_relaxed) == 0)
+        {
+          fastuidraw::PainterAttributeData *newD;
+          newD = FASTUIDRAWnew fastuidraw::PainterAttributeData();
+          newD->set_data(T(m_path_data, 1.0f));
+          values.push_back(ThreshWithData(newD, 1.0f));
+        }
+
       float t;
-      t = values.back().m_thresh;
+      t = values.m_values[values.m_size.load(boost::memory_order_relaxed) - 1].m_thresh;
       while(t > thresh)
         {
           fastuidraw::PainterAttributeData *newD;
@@ -2610,8 +2616,16 @@ fetch_create(float thresh, std::vector<ThreshWithData> &values)
           newD->set_data(T(m_path_data, t));
           values.push_back(ThreshWithData(newD, t));
         }
-      return *values.back().m_data;
+      n = values.m_size.load(boost::memory_order_relaxed);
     }
+
+  const ThreshWithData *iter;
+  iter = std::lower_bound(values.m_values.c_ptr(), values.m_values.c_ptr() + n, thresh,
+                          ThreshWithData::reverse_compare_against_thresh);
+  assert(iter != values.m_values.c_ptr() + n);
+  assert(iter->m_thresh <= thresh);
+  assert(iter->m_data != NULL);
+  return *iter->m_data;
 }
 
 //////////////////////////////////////
@@ -20,8 +20,11 @@
 #include <algorithm>
 #include <cmath>
 #include <vector>
+#include <iostream>
+#include <boost/atomic.hpp>
 #include <fastuidraw/path.hpp>
 #include <fastuidraw/tessellated_path.hpp>
+#include <fastuidraw/path_prefetcher.hpp>
 #include "private/util_private.hpp"
 #include "private/path_util_private.hpp"
 
@@ -262,15 +265,60 @@ namespace
   class BezierPrivate
   {
   public:
+    typedef fastuidraw::vecN<double, 2> dvec2;
+
     void
     init(void);
 
+    /* tessellate a quadratic or cubic curve into uniform
+       segments by forward differencing, the number of
+       segments is computed directly from the control points.
+       Returns 0 if uniform segments cannot meet the threshhold
+       within the maximum number of segments, in which case the
+       curve is to be tessellated by adaptive subdivision.
+     */
+    unsigned int
+    forward_difference_tessellation(const fastuidraw::TessellatedPath::TessellationParams &tess_params,
+                                    fastuidraw::c_array<fastuidraw::TessellatedPath::point> out_data,
+                                    float *out_effective_curve_distance,
+                                    float *out_effective_curvature) const;
+
+    /* evaluate the curve at N + 1 uniform times into out_data
+       and return the largest curvature of the N segments; sets
+       out_cusp to true if the curve may have a cusp, i.e. the
+       speed at a sample is (nearly) zero or the tangent reverses
+       between two samples, in which case the curvature returned
+       is not to be trusted.
+     */
+    float
+    forward_difference(unsigned int N,
+                       fastuidraw::c_array<fastuidraw::TessellatedPath::point> out_data,
+                       bool *out_cusp) const;
+
     fastuidraw::vec2 m_min_bb, m_max_bb;
     BezierTessRegion m_start_region;
     std::vector<fastuidraw::vec2> m_poly;
     std::vector<fastuidraw::vec2> m_poly_prime;
     std::vector<fastuidraw::vec2> m_poly_prime_prime;
-    fastuidraw::vecN<std::vector<fastuidraw::vec2>, 2> m_work_room;
+
+    /* only for quadratic and cubic curves: the curve in the
+       power basis, p(t) = ((m_a * t + m_b) * t + m_c) * t + m_d,
+       the bound of Wang's formula, i.e. n(n-1)/8 times the
+       largest second difference of the control points so that
+       N uniform segments are within m_wang_bound / N^2 of the
+       curve, and a bound on the angle the tangent turns, i.e.
+       the angle the control polygon turns.
+     */
+    dvec2 m_a, m_b, m_c, m_d;
+    float m_wang_bound;
+    float m_turn_angle;
+
+    /* a squared speed at or below m_min_speed_sq is taken
+       as zero, it is relative to the length of the control
+       polygon so that it does not depend on the scale of
+       the curve.
+     */
+    float m_min_speed_sq;
   };
 
   class ArcPrivate
@@ -299,43 +347,110 @@ namespace
     typedef fastuidraw::TessellatedPath TessellatedPath;
     typedef fastuidraw::reference_counted_ptr<const TessellatedPath> tessellated_path_ref;
 
-    PathPrivate(void):
+    /* the number of levels of detail is bounded so that the
+       levels are never moved once made, which is what allows
+       reading them without a lock.
+     */
+    enum
+      {
+        max_tessellation_levels = 64
+      };
+
+    explicit
+    PathPrivate(const fastuidraw::Path *owner):
+      m_owner(owner),
+      m_number_tessellation(0u),
       m_tessellation_done(false),
-      m_start_check_bb(0)
+      m_start_check_bb(0),
+      m_tessellation_threads(1u),
+      m_compact_tessellation(false)
     {}
 
-    PathPrivate(const PathPrivate &obj);
+    PathPrivate(const fastuidraw::Path *owner, const PathPrivate &obj);
 
     const fastuidraw::reference_counted_ptr<fastuidraw::PathContour>&
     current_contour(void)
     {
       assert(!m_contours.empty());
-      m_tessellation.clear();
-      m_tessellation_done = false;
+      clear_tessellation();
       return m_contours.back();
     }
 
     void
     move_common(const fastuidraw::vec2 &pt)
     {
-      m_tessellation.clear();
-      m_tessellation_done = false;
+      clear_tessellation();
       m_contours.push_back(FASTUIDRAWnew fastuidraw::PathContour());
       m_contours.back()->start(pt);
     }
+
+    /* only to be called when no other thread uses the Path
+       other than the worker threads of m_prefetcher.
+     */
+    void
+    clear_tessellation(void);
+
+    /* drops the reference to m_prefetcher, then cancels the
+       work scheduled on it for m_owner and waits for the work
+       on it in progress.
+     */
+    void
+    release_prefetcher(void);
+
+    /* sets m_prefetcher to p and returns the previous value
+       (or NULL if it was already p); m_prefetcher is only read
+       and written with m_mutex locked because several threads
+       may schedule the same Path on PathPrefetcher objects. The
+       work of the returned PathPrefetcher is to be cancelled by
+       the caller with m_mutex NOT locked, as that work itself
+       locks m_mutex.
+     */
+    fastuidraw::reference_counted_ptr<fastuidraw::PathPrefetcher>
+    exchange_prefetcher(fastuidraw::PathPrefetcher *p);
+
+    /* the Path whose m_d is this, the work of a PathPrefetcher
+       is on the Path object.
+     */
+    const fastuidraw::Path *m_owner;
+    fastuidraw::reference_counted_ptr<fastuidraw::PathPrefetcher> m_prefetcher;
+
+    /* make, if not yet made, the levels of detail needed for
+       thresh; takes m_mutex.
+     */
+    void
+    create_tessellation(const fastuidraw::Path &path, float thresh);
+
     std::vector<fastuidraw::reference_counted_ptr<fastuidraw::PathContour> > m_contours;
 
-    /* m_tessellation are gauranteed to be sorted from lowest to highest LOD.
+    /* m_tessellation are gauranteed to be sorted from lowest to
+       highest LOD. Only the first m_number_tessellation elements
+       are made; an element is written before m_number_tessellation
+       is (with release semantics) incremented past it and is not
+       changed after, until the Path changes.
      */
-    std::vector<tessellated_path_ref> m_tessellation;
-    bool m_tessellation_done;
+    fastuidraw::vecN<tessellated_path_ref, max_tessellation_levels> m_tessellation;
+    boost::atomic<unsigned int> m_number_tessellation;
+    boost::atomic<bool> m_tessellation_done;
 
     /* m_start_check_bb gives the index into m_contours that
        have not had their bounding box absorbed into
-       m_max_bb and m_min_bb.
+       m_max_bb and m_min_bb; it is only incremented with
+       m_mutex locked, after writing m_max_bb and m_min_bb.
      */
-    unsigned int m_start_check_bb;
+    boost::atomic<unsigned int> m_start_check_bb;
     fastuidraw::vec2 m_max_bb, m_min_bb;
+
+    /* number of threads with which to make a TessellatedPath
+     */
+    unsigned int m_tessellation_threads;
+
+    /* if a TessellatedPath stores its points compactly
+     */
+    bool m_compact_tessellation;
+
+    /* serializes making the values above that are made lazily
+     */
+    boost::mutex m_mutex;
   };
 
   inline
@@ -731,8 +846,210 @@ init(void)
   BC.prepare_bernstein(m_poly_prime);
   BC.prepare_bernstein(m_poly_prime_prime);
 
-  m_work_room[0].resize(m_poly.size());
-  m_work_room[1].resize(m_poly.size());
+  if(m_poly.size() == 3 || m_poly.size() == 4)
+    {
+      /* m_poly is pre-multiplied by the binomial coefficients,
+         so use m_start_region.m_pts which holds the control points.
+       */
+      const std::vector<fastuidraw::vec2> &P(m_start_region.m_pts);
+      float degree(static_cast<float>(P.size() - 1));
+      float max_second_diff(0.0f), polygon_length(0.0f);
+      fastuidraw::vec2 prev_edge(0.0f, 0.0f);
+
+      m_turn_angle = 0.0f;
+      for(unsigned int i = 0, endi = P.size(); i + 1 < endi; ++i)
+        {
+          fastuidraw::vec2 edge(P[i + 1] - P[i]);
+          polygon_length += edge.magnitude();
+          if(edge.x() != 0.0f || edge.y() != 0.0f)
+            {
+              if(prev_edge.x() != 0.0f || prev_edge.y() != 0.0f)
+                {
+                  float cross(prev_edge.x() * edge.y() - prev_edge.y() * edge.x());
+                  m_turn_angle += std::atan2(fastuidraw::t_abs(cross), fastuidraw::dot(prev_edge, edge));
+                }
+              prev_edge = edge;
+            }
+          if(i + 2 < endi)
+            {
+              max_second_diff = fastuidraw::t_max(max_second_diff, (P[i] - 2.0f * P[i + 1] + P[i + 2]).magnitude());
+            }
+        }
+      m_wang_bound = degree * (degree - 1.0f) * max_second_diff / 8.0f;
+      m_min_speed_sq = 1e-8f * polygon_length * polygon_length;
+
+      dvec2 p0(P[0].x(), P[0].y()), p1(P[1].x(), P[1].y()), p2(P[2].x(), P[2].y());
+      if(P.size() == 3)
+        {
+          m_a = dvec2(0.0, 0.0);
+          m_b = p0 - 2.0 * p1 + p2;
+          m_c = 2.0 * (p1 - p0);
+        }
+      else
+        {
+          dvec2 p3(P[3].x(), P[3].y());
+          m_a = -p0 + 3.0 * p1 - 3.0 * p2 + p3;
+          m_b = 3.0 * p0 - 6.0 * p1 + 3.0 * p2;
+          m_c = 3.0 * (p1 - p0);
+        }
+      m_d = p0;
+    }
+  else
+    {
+      m_a = m_b = m_c = m_d = dvec2(0.0, 0.0);
+      m_wang_bound = 0.0f;
+      m_turn_angle = 0.0f;
+      m_min_speed_sq = 0.0f;
+    }
+}
+
+unsigned int
+BezierPrivate::
+forward_difference_tessellation(const fastuidraw::TessellatedPath::TessellationParams &tess_params,
+                                fastuidraw::c_array<fastuidraw::TessellatedPath::point> out_data,
+                                float *out_effective_curve_distance,
+                                float *out_effective_curvature) const
+{
+  float needed, curvature, h;
+  unsigned int N, max_N;
+  bool cusp(false);
+
+  assert(m_poly.size() == 3 || m_poly.size() == 4);
+  max_N = fastuidraw::t_max(1u, tess_params.m_max_segments);
+  if(tess_params.m_threshhold <= 0.0f)
+    {
+      needed = static_cast<float>(max_N);
+    }
+  else if(tess_params.m_curvature_tessellation)
+    {
+      needed = std::ceil(m_turn_angle / tess_params.m_threshhold);
+    }
+  else
+    {
+      needed = std::ceil(fastuidraw::t_sqrt(m_wang_bound / tess_params.m_threshhold));
+    }
+  if(needed > static_cast<float>(max_N))
+    {
+      return 0;
+    }
+  N = static_cast<unsigned int>(fastuidraw::t_max(1.0f, needed));
+  assert(N + 1 <= out_data.size());
+  curvature = forward_difference(N, out_data, &cusp);
+
+  /* compute_K_times_speed() clamps the speed away from zero,
+     so near a cusp the curvature of the samples does not see
+     the tangent flip; let adaptive subdivision handle such
+     curves. Tessellating by distance does not look at the
+     curvature and Wang's bound holds across a cusp.
+   */
+  if(tess_params.m_curvature_tessellation && cusp)
+    {
+      return 0;
+    }
+
+  /* the turn angle only gives how many segments are needed
+     if the curve turns at a uniform rate; when a segment
+     turns more than the threshhold, the number of segments
+     is increased by how much it is over.
+   */
+  while(tess_params.m_curvature_tessellation
+        && tess_params.m_threshhold > 0.0f
+        && curvature > tess_params.m_threshhold)
+    {
+      if(N == max_N)
+        {
+          return 0;
+        }
+      needed = std::ceil(static_cast<float>(N) * curvature / tess_params.m_threshhold);
+      needed = fastuidraw::t_max(needed, static_cast<float>(N + 1));
+      N = static_cast<unsigned int>(fastuidraw::t_min(needed, static_cast<float>(max_N)));
+      curvature = forward_difference(N, out_data, &cusp);
+      if(cusp)
+        {
+          return 0;
+        }
+    }
+
+  /* the distance reported is the bound from Wang's formula,
+     not the distance measured from the segments to the curve;
+     it is never smaller than the measured distance.
+   */
+  h = 1.0f / static_cast<float>(N);
+  *out_effective_curve_distance = m_wang_bound * h * h;
+  *out_effective_curvature = curvature;
+  return N + 1;
+}
+
+float
+BezierPrivate::
+forward_difference(unsigned int N,
+                   fastuidraw::c_array<fastuidraw::TessellatedPath::point> out_data,
+                   bool *out_cusp) const
+{
+  double h(1.0 / static_cast<double>(N));
+
+  /* forward differences of the position (cubic), derivative
+     (quadratic) and second derivative (linear) with step h;
+     they are accumulated in double precision so that the
+     rounding error does not grow with N.
+   */
+  dvec2 p(m_d), p_t(m_c), p_tt(2.0 * m_b);
+  dvec2 dp1(m_a * (h * h * h) + m_b * (h * h) + m_c * h);
+  dvec2 dp2(m_a * (6.0 * h * h * h) + m_b * (2.0 * h * h));
+  dvec2 dp3(m_a * (6.0 * h * h * h));
+  dvec2 dp_t1(m_a * (3.0 * h * h) + m_b * (2.0 * h));
+  dvec2 dp_t2(m_a * (6.0 * h * h));
+  dvec2 dp_tt1(m_a * (6.0 * h));
+  float K_prev(0.0f), curvature(0.0f);
+  fastuidraw::vec2 pt_t_prev(0.0f, 0.0f);
+
+  *out_cusp = false;
+  for(unsigned int k = 0; k <= N; ++k)
+    {
+      fastuidraw::vec2 pt_t(p_t.x(), p_t.y()), pt_tt(p_tt.x(), p_tt.y());
+      float K;
+
+      out_data[k].m_p = fastuidraw::vec2(p.x(), p.y());
+      out_data[k].m_p_t = pt_t;
+
+      if(dot(pt_t, pt_t) <= m_min_speed_sq
+         || (k > 0 && dot(pt_t, pt_t_prev) < 0.0f))
+        {
+          *out_cusp = true;
+        }
+      pt_t_prev = pt_t;
+
+      /* the angle the tangent turns over a segment is
+         approximated by the trapezoid rule
+       */
+      K = analytic_point_data::compute_K_times_speed(pt_t, pt_tt);
+      if(k > 0)
+        {
+          curvature = fastuidraw::t_max(curvature, 0.5f * static_cast<float>(h) * (K_prev + K));
+        }
+      K_prev = K;
+
+      p += dp1;
+      dp1 += dp2;
+      dp2 += dp3;
+      p_t += dp_t1;
+      dp_t1 += dp_t2;
+      p_tt += dp_tt1;
+    }
+
+  /* enforce start and end point values
+   */
+  out_data[0].m_p = m_start_region.m_pts.front();
+  out_data[N].m_p = m_start_region.m_pts.back();
+
+  out_data[0].m_distance_from_edge_start = 0.0f;
+  for(unsigned int k = 1; k <= N; ++k)
+    {
+      out_data[k].m_distance_from_edge_start = out_data[k - 1].m_distance_from_edge_start
+        + (out_data[k].m_p - out_data[k - 1].m_p).magnitude();
+    }
+
+  return curvature;
 }
 
 ////////////////////////////////////////////
@@ -918,11 +1235,14 @@ tessellate(tessellated_region *in_region,
   newA = FASTUIDRAWnew BezierTessRegion(in_region_casted, true);
   newB = FASTUIDRAWnew BezierTessRegion(in_region_casted, false);
 
-  c_array<vec2> dst, src;
-  src = make_c_array(in_region_casted->m_pts);
+  /* De Casteljau is done in place on a copy of the points of
+     the region, this method must not write to d since several
+     threads may tessellate the same curve at once.
+   */
+  std::vector<vec2> work(in_region_casted->m_pts);
 
-  newA->m_pts.push_back(src.front());
-  newB->m_pts.push_back(src.back());
+  newA->m_pts.push_back(work.front());
+  newB->m_pts.push_back(work.back());
 
   /* For a Bezier curve, given by points p(0), .., p(n),
      and a time 0 <= t <= 1, De Casteljau's algorithm is
@@ -939,16 +1259,14 @@ tessellate(tessellated_region *in_region,
          the curve evaluated at t is given by q(n, 0).
      We use t = 0.5 because we are always doing mid-point cutting.
    */
-  for(unsigned int i = 0, endi = src.size(), sz = endi - 1; sz > 0 && i < endi; ++i, --sz)
+  for(unsigned int sz = work.size() - 1; sz > 0; --sz)
     {
-      dst = make_c_array(d->m_work_room[i & 1]).sub_array(0, sz);
-      for(unsigned int j = 0; j < dst.size(); ++j)
+      for(unsigned int j = 0; j < sz; ++j)
         {
-          dst[j] = 0.5f * src[j] + 0.5f * src[j + 1];
+          work[j] = 0.5f * work[j] + 0.5f * work[j + 1];
         }
-      newA->m_pts.push_back(dst.front());
-      newB->m_pts.push_back(dst.back());
-      src = dst;
+      newA->m_pts.push_back(work.front());
+      newB->m_pts.push_back(work[sz - 1]);
     }
   std::reverse(newB->m_pts.begin(), newB->m_pts.end());
 
@@ -962,6 +1280,32 @@ tessellate(tessellated_region *in_region,
   *out_effective_curve_distance = fastuidraw::t_max(newA->compute_curve_distance(), newB->compute_curve_distance());
 }
 
+unsigned int
+fastuidraw::PathContour::bezier::
+produce_tessellation(const TessellatedPath::TessellationParams &tess_params,
+                     c_array<TessellatedPath::point> out_data,
+                     float *out_effective_curve_distance,
+                     float *out_effective_curvature) const
+{
+  BezierPrivate *d;
+  d = reinterpret_cast<BezierPrivate*>(m_d);
+
+  if(d->m_poly.size() == 3 || d->m_poly.size() == 4)
+    {
+      unsigned int return_value;
+      return_value = d->forward_difference_tessellation(tess_params, out_data,
+                                                        out_effective_curve_distance,
+                                                        out_effective_curvature);
+      if(return_value != 0)
+        {
+          return return_value;
+        }
+    }
+  return interpolator_generic::produce_tessellation(tess_params, out_data,
+                                                    out_effective_curve_distance,
+                                                    out_effective_curvature);
+}
+
 fastuidraw::PathContour::interpolator_base*
 fastuidraw::PathContour::bezier::
 deep_copy(const reference_counted_ptr<const interpolator_base> &prev) const
@@ -1455,14 +1799,139 @@ approximate_bounding_box(vec2 *out_min_bb, vec2 *out_max_bb) const
 
 /////////////////////////////////
 // PathPrivate methods
+void
+PathPrivate::
+clear_tessellation(void)
+{
+  release_prefetcher();
+  for(unsigned int i = 0, endi = m_number_tessellation.load(); i < endi; ++i)
+    {
+      m_tessellation[i] = tessellated_path_ref();
+    }
+  m_number_tessellation.store(0u);
+  m_tessellation_done.store(false);
+}
+
+void
+PathPrivate::
+create_tessellation(const fastuidraw::Path &path, float thresh)
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  unsigned int n(m_number_tessellation.load(boost::memory_order_relaxed));
+
+  /* another thread may have made the levels needed
+     while this thread waited for the lock.
+   */
+  if(n == 0)
+    {
+      TessellatedPath::TessellationParams params;
+
+      params
+        .max_threads(m_tessellation_threads)
+        .compact_point_data(m_compact_tessellation);
+      m_tessellation[0] = FASTUIDRAWnew TessellatedPath(path, params);
+      m_number_tessellation.store(1u, boost::memory_order_release);
+      n = 1;
+    }
+
+  if(thresh <= 0.0f
+     || m_tessellation_done.load(boost::memory_order_relaxed)
+     || m_tessellation[n - 1]->effective_curve_distance_threshhold() <= thresh)
+    {
+      return;
+    }
+
+  tessellated_path_ref ref;
+  TessellatedPath::TessellationParams params;
+  bool done(false);
+
+  ref = m_tessellation[n - 1];
+  params
+    .max_threads(m_tessellation_threads)
+    .compact_point_data(m_compact_tessellation)
+    .max_segments(2 * ref->max_segments())
+    .curve_distance_tessellate(ref->effective_curve_distance_threshhold());
+
+  while(!done && ref->effective_curve_distance_threshhold() > thresh)
+    {
+      float last_tess;
+
+      params.m_threshhold *= 0.5f;
+      last_tess = ref->effective_curve_distance_threshhold();
+      ref = FASTUIDRAWnew TessellatedPath(path, params);
+      done = (last_tess <= ref->effective_curve_distance_threshhold());
+
+      while(!done && ref->effective_curve_distance_threshhold() > params.m_threshhold)
+        {
+          params.m_max_segments *= 2;
+          last_tess = ref->effective_curve_distance_threshhold();
+          ref = FASTUIDRAWnew TessellatedPath(path, params);
+          done = (last_tess <= ref->effective_curve_distance_threshhold());
+        }
+
+      if(done)
+        {
+          std::cout << "Tapped out at (max_segs = "
+                    << ref->max_segments() << ", tess_factor = "
+                    << ref->effective_curve_distance_threshhold()
+                    << ", num_points = " << ref->number_points()
+                    << ")\n";
+        }
+
+      m_tessellation[n] = ref;
+      ++n;
+      done = done || (n == max_tessellation_levels);
+
+      /* the level is visible to the other threads once
+         m_number_tessellation is incremented past it; a
+         thread that sees m_tessellation_done as true also
+         sees the last level.
+       */
+      m_number_tessellation.store(n, boost::memory_order_release);
+      m_tessellation_done.store(done, boost::memory_order_release);
+    }
+}
+
+void
+PathPrivate::
+release_prefetcher(void)
+{
+  fastuidraw::reference_counted_ptr<fastuidraw::PathPrefetcher> prev;
+
+  prev = exchange_prefetcher(NULL);
+  if(prev)
+    {
+      prev->cancel(*m_owner);
+    }
+}
+
+fastuidraw::reference_counted_ptr<fastuidraw::PathPrefetcher>
+PathPrivate::
+exchange_prefetcher(fastuidraw::PathPrefetcher *p)
+{
+  fastuidraw::reference_counted_ptr<fastuidraw::PathPrefetcher> return_value;
+
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  if(m_prefetcher.get() != p)
+    {
+      return_value = m_prefetcher;
+      m_prefetcher = p;
+    }
+  return return_value;
+}
+
 PathPrivate::
-PathPrivate(const PathPrivate &obj):
+PathPrivate(const fastuidraw::Path *owner, const PathPrivate &obj):
+  m_owner(owner),
   m_contours(obj.m_contours),
   m_tessellation(obj.m_tessellation),
-  m_tessellation_done(obj.m_tessellation_done),
-  m_start_check_bb(obj.m_start_check_bb),
+  m_number_tessellation(obj.m_number_tessellation.load()),
+  m_tessellation_done(obj.m_tessellation_done.load()),
+  m_start_check_bb(obj.m_start_check_bb.load()),
   m_max_bb(obj.m_max_bb),
-  m_min_bb(obj.m_min_bb)
+  m_min_bb(obj.m_min_bb),
+  m_tessellation_threads(obj.m_tessellation_threads),
+  m_compact_tessellation(obj.m_compact_tessellation)
 {
   /* if the last contour is not ended, we need to do a
      deep copy on it.
@@ -1478,7 +1947,7 @@ PathPrivate(const PathPrivate &obj):
 fastuidraw::Path::
 Path(void)
 {
-  m_d = FASTUIDRAWnew PathPrivate();
+  m_d = FASTUIDRAWnew PathPrivate(this);
 }
 
 fastuidraw::Path::
@@ -1486,14 +1955,25 @@ Path(const Path &obj)
 {
   PathPrivate *obj_d;
   obj_d = reinterpret_cast<PathPrivate*>(obj.m_d);
-  m_d = FASTUIDRAWnew PathPrivate(*obj_d);
+  m_d = FASTUIDRAWnew PathPrivate(this, *obj_d);
 }
 
 void
 fastuidraw::Path::
 swap(Path &obj)
 {
+  PathPrivate *d, *obj_d;
+
+  /* the work of a PathPrefetcher is on the Path object,
+     not on its PathPrivate.
+   */
+  d = reinterpret_cast<PathPrivate*>(m_d);
+  obj_d = reinterpret_cast<PathPrivate*>(obj.m_d);
+  d->release_prefetcher();
+  obj_d->release_prefetcher();
   std::swap(obj.m_d, m_d);
+  d->m_owner = &obj;
+  obj_d->m_owner = this;
 }
 
 const fastuidraw::Path&
@@ -1510,19 +1990,34 @@ fastuidraw::Path::
 {
   PathPrivate *d;
   d = reinterpret_cast<PathPrivate*>(m_d);
+  d->release_prefetcher();
   FASTUIDRAWdelete(d);
   m_d = NULL;
 }
 
+void
+fastuidraw::Path::
+prefetcher(PathPrefetcher *p) const
+{
+  PathPrivate *d;
+  reference_counted_ptr<PathPrefetcher> prev;
+
+  d = reinterpret_cast<PathPrivate*>(m_d);
+  prev = d->exchange_prefetcher(p);
+  if(prev)
+    {
+      prev->cancel(*this);
+    }
+}
+
 void
 fastuidraw::Path::
 clear(void)
 {
   PathPrivate *d;
   d = reinterpret_cast<PathPrivate*>(m_d);
-  d->m_tessellation.clear();
+  d->clear_tessellation();
   d->m_contours.clear();
-  d->m_tessellation_done = false;
   d->m_start_check_bb = 0u;
 }
 
@@ -1541,7 +2036,7 @@ add_contour(const reference_counted_ptr<const PathContour> &pcontour)
   reference_counted_ptr<PathContour> contour;
   contour = pcontour.const_cast_ptr<PathContour>();
 
-  d->m_tessellation.clear();
+  d->clear_tessellation();
   if(d->m_contours.empty() || d->m_contours.back()->ended())
     {
       d->m_contours.push_back(contour);
@@ -1567,7 +2062,7 @@ add_contours(const Path &path)
 
   if(d != pd && !pd->m_contours.empty())
     {
-      d->m_tessellation.clear();
+      d->clear_tessellation();
       d->m_contours.reserve(d->m_contours.size() + pd->m_contours.size());
 
       reference_counted_ptr<PathContour> r;
@@ -1647,79 +2142,137 @@ fastuidraw::Path::
 tessellation(float thresh) const
 {
   PathPrivate *d;
+  unsigned int n;
+
   d = reinterpret_cast<PathPrivate*>(m_d);
+  n = d->m_number_tessellation.load(boost::memory_order_acquire);
 
-  if(d->m_tessellation.empty())
+  /* the lock is only taken if a level of detail is missing
+   */
+  if(n == 0
+     || (thresh > 0.0f
+         && d->m_tessellation[n - 1]->effective_curve_distance_threshhold() > thresh
+         && !d->m_tessellation_done.load(boost::memory_order_acquire)))
     {
-      PathPrivate::tessellated_path_ref ref;
-      TessellatedPath::TessellationParams params;
-      ref = FASTUIDRAWnew TessellatedPath(*this, params);
-      d->m_tessellation.push_back(ref);
+      d->create_tessellation(*this, thresh);
+      n = d->m_number_tessellation.load(boost::memory_order_acquire);
     }
 
+  assert(n > 0);
   if(thresh <= 0.0f)
     {
-      return d->m_tessellation.front();
+      return d->m_tessellation[0];
     }
 
-  if(d->m_tessellation.back()->effective_curve_distance_threshhold() <= thresh)
+  if(d->m_tessellation[n - 1]->effective_curve_distance_threshhold() <= thresh)
     {
-      std::vector<PathPrivate::tessellated_path_ref>::const_iterator iter;
-      iter = std::lower_bound(d->m_tessellation.begin(),
-                              d->m_tessellation.end(),
+      const PathPrivate::tessellated_path_ref *iter;
+      iter = std::lower_bound(d->m_tessellation.c_ptr(),
+                              d->m_tessellation.c_ptr() + n,
                               thresh,
                               reverse_compare_curve_distance_thresh);
 
-      assert(iter != d->m_tessellation.end());
+      assert(iter != d->m_tessellation.c_ptr() + n);
       assert(*iter);
       assert((*iter)->effective_curve_distance_threshhold() <= thresh);
       return *iter;
     }
   else
     {
-      if(d->m_tessellation_done)
-        {
-          return d->m_tessellation.back();
-        }
+      /* tapped out, the finest level is returned; the levels
+         may have been finished after n was read.
+       */
+      n = d->m_number_tessellation.load(boost::memory_order_acquire);
+      return d->m_tessellation[n - 1];
+    }
+}
 
-      PathPrivate::tessellated_path_ref prev_ref, ref;
-      TessellatedPath::TessellationParams params;
+void
+fastuidraw::Path::
+tessellation_threads(unsigned int v)
+{
+  PathPrivate *d;
+  d = reinterpret_cast<PathPrivate*>(m_d);
+  d->m_tessellation_threads = v;
+}
 
-      ref = d->m_tessellation.back();
-      params
-        .max_segments(2 * ref->max_segments())
-        .curve_distance_tessellate(ref->effective_curve_distance_threshhold());
+unsigned int
+fastuidraw::Path::
+tessellation_threads(void) const
+{
+  PathPrivate *d;
+  d = reinterpret_cast<PathPrivate*>(m_d);
+  return d->m_tessellation_threads;
+}
 
-      while(!d->m_tessellation_done
-            && ref->effective_curve_distance_threshhold() > thresh)
-        {
-          float last_tess;
+void
+fastuidraw::Path::
+compact_tessellation(bool v)
+{
+  PathPrivate *d;
+  d = reinterpret_cast<PathPrivate*>(m_d);
+  d->m_compact_tessellation = v;
+}
 
-          params.m_threshhold *= 0.5f;
-          last_tess = ref->effective_curve_distance_threshhold();
-          ref = FASTUIDRAWnew TessellatedPath(*this, params);
-          d->m_tessellation_done = (last_tess <= ref->effective_curve_distance_threshhold());
+bool
+fastuidraw::Path::
+compact_tessellation(void) const
+{
+  PathPrivate *d;
+  d = reinterpret_cast<PathPrivate*>(m_d);
+  return d->m_compact_tessellation;
+}
 
-          while(!d->m_tessellation_done && ref->effective_curve_distance_threshhold() > params.m_threshhold)
-            {
-              params.m_max_segments *= 2;
-              last_tess = ref->effective_curve_distance_threshhold();
-              ref = FASTUIDRAWnew TessellatedPath(*this, params);
-              d->m_tessellation_done = (last_tess <= ref->effective_curve_distance_threshhold());
-            }
+fastuidraw::reference_counted_ptr<const fastuidraw::TessellatedPath>
+fastuidraw::Path::
+tessellation_if_ready(float thresh, bool *out_ready) const
+{
+  PathPrivate *d;
+  unsigned int n;
+  bool ready;
+  reference_counted_ptr<const TessellatedPath> return_value;
 
-          if(d->m_tessellation_done)
-            {
-              std::cout << "Tapped out at (max_segs = "
-                        << ref->max_segments() << ", tess_factor = "
-                        << ref->effective_curve_distance_threshhold()
-                        << ", num_points = " << ref->point_data().size()
-                        << ")\n";
-            }
-          d->m_tessellation.push_back(ref);
+  d = reinterpret_cast<PathPrivate*>(m_d);
+  n = d->m_number_tessellation.load(boost::memory_order_acquire);
+  if(n == 0)
+    {
+      ready = false;
+    }
+  else if(thresh <= 0.0f)
+    {
+      ready = true;
+      return_value = d->m_tessellation[0];
+    }
+  else if(d->m_tessellation[n - 1]->effective_curve_distance_threshhold() <= thresh)
+    {
+      const PathPrivate::tessellated_path_ref *iter;
+      iter = std::lower_bound(d->m_tessellation.c_ptr(),
+                              d->m_tessellation.c_ptr() + n,
+                              thresh,
+                              reverse_compare_curve_distance_thresh);
+      assert(iter != d->m_tessellation.c_ptr() + n);
+      ready = true;
+      return_value = *iter;
+    }
+  else
+    {
+      /* the finest level is what tessellation() returns
+         only if the levels are tapped out; the last level
+         is visible once m_tessellation_done is.
+       */
+      ready = d->m_tessellation_done.load(boost::memory_order_acquire);
+      if(ready)
+        {
+          n = d->m_number_tessellation.load(boost::memory_order_acquire);
         }
-      return d->m_tessellation.back();
+      return_value = d->m_tessellation[n - 1];
     }
+
+  if(out_ready)
+    {
+      *out_ready = ready;
+    }
+  return return_value;
 }
 
 bool
@@ -1729,15 +2282,31 @@ approximate_bounding_box(vec2 *out_min_bb, vec2 *out_max_bb) const
   PathPrivate *d;
   d = reinterpret_cast<PathPrivate*>(m_d);
 
-  bool assigned_value(d->m_start_check_bb != 0u);
+  unsigned int start(d->m_start_check_bb.load(boost::memory_order_acquire));
+  if(start == d->m_contours.size())
+    {
+      /* all contours absorbed, no lock needed
+       */
+      if(start != 0u)
+        {
+          *out_min_bb = d->m_min_bb;
+          *out_max_bb = d->m_max_bb;
+        }
+      return start != 0u;
+    }
+
+  boost::lock_guard<boost::mutex> lock(d->m_mutex);
+  unsigned int next(d->m_start_check_bb.load(boost::memory_order_relaxed));
+  bool assigned_value(next != 0u);
+
   for(unsigned endi = d->m_contours.size();
-      d->m_start_check_bb < endi && d->m_contours[d->m_start_check_bb]->ended();
-      ++d->m_start_check_bb)
+      next < endi && d->m_contours[next]->ended();
+      ++next)
     {
       vec2 p0, p1;
       bool value_valid;
 
-      value_valid = d->m_contours[d->m_start_check_bb]->approximate_bounding_box(&p0, &p1);
+      value_valid = d->m_contours[next]->approximate_bounding_box(&p0, &p1);
       assert(value_valid);
       FASTUIDRAWunused(value_valid);
 
@@ -1756,6 +2325,7 @@ approximate_bounding_box(vec2 *out_min_bb, vec2 *out_max_bb) const
           assigned_value = true;
         }
     }
+  d->m_start_check_bb.store(next, boost::memory_order_release);
 
   if(assigned_value)
     {
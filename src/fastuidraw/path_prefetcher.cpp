@@ -0,0 +1,369 @@
+/*!
+ * \file path_prefetcher.cpp
+ * \brief file path_prefetcher.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <fastuidraw/util/math.hpp>
+#include <fastuidraw/path.hpp>
+#include <fastuidraw/path_prefetcher.hpp>
+#include <fastuidraw/painter/filled_path.hpp>
+#include <fastuidraw/painter/stroked_path.hpp>
+#include "private/util_private.hpp"
+
+namespace
+{
+  class job
+  {
+  public:
+    job(float thresh, uint32_t flags):
+      m_thresh(thresh),
+      m_flags(flags)
+    {}
+
+    /* a non-positive threshhold is the coarsest level
+       of detail, see Path::tessellation(float).
+     */
+    static
+    float
+    finer_thresh(float a, float b)
+    {
+      if(a <= 0.0f)
+        {
+          return b;
+        }
+      return (b <= 0.0f) ? a : std::min(a, b);
+    }
+
+    /* true if making this makes what v makes
+     */
+    bool
+    covers(const job &v) const
+    {
+      return finer_thresh(m_thresh, v.m_thresh) == m_thresh
+        && (m_flags & v.m_flags) == v.m_flags;
+    }
+
+    void
+    merge(const job &v)
+    {
+      m_thresh = finer_thresh(m_thresh, v.m_thresh);
+      m_flags |= v.m_flags;
+    }
+
+    float m_thresh;
+    uint32_t m_flags;
+  };
+
+  class PathPrefetcherPrivate
+  {
+  public:
+    typedef std::pair<const fastuidraw::Path*, job> active_job;
+
+    explicit
+    PathPrefetcherPrivate(unsigned int number_threads);
+
+    ~PathPrefetcherPrivate();
+
+    static
+    void
+    thread_main(PathPrefetcherPrivate *p);
+
+    /* returns the index into m_active of the job
+       of a Path or m_active.size() if there is none;
+       to be called with m_mutex locked.
+     */
+    unsigned int
+    find_active(const fastuidraw::Path *path) const;
+
+    mutable boost::mutex m_mutex;
+    boost::condition_variable m_condition;
+
+    /* the work not yet started, a Path is in m_queue at
+       least once if it is in m_scheduled; a Path of
+       m_queue that is not in m_scheduled is skipped.
+     */
+    std::map<const fastuidraw::Path*, job> m_scheduled;
+    std::deque<const fastuidraw::Path*> m_queue;
+
+    /* the work in progress
+     */
+    std::vector<active_job> m_active;
+
+    unsigned int m_number_completed;
+    bool m_quit;
+    fastuidraw::reference_counted_ptr<fastuidraw::PathPrefetcher::CallBack> m_call_back;
+    boost::thread_group m_threads;
+  };
+}
+
+//////////////////////////////////////////
+// PathPrefetcherPrivate methods
+PathPrefetcherPrivate::
+PathPrefetcherPrivate(unsigned int number_threads):
+  m_number_completed(0),
+  m_quit(false)
+{
+  number_threads = std::max(1u, number_threads);
+  for(unsigned int i = 0; i < number_threads; ++i)
+    {
+      m_threads.create_thread(boost::bind(thread_main, this));
+    }
+}
+
+PathPrefetcherPrivate::
+~PathPrefetcherPrivate()
+{
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    m_quit = true;
+    m_condition.notify_all();
+  }
+  m_threads.join_all();
+}
+
+unsigned int
+PathPrefetcherPrivate::
+find_active(const fastuidraw::Path *path) const
+{
+  unsigned int i, endi;
+  for(i = 0, endi = m_active.size(); i < endi && m_active[i].first != path; ++i)
+    {}
+  return i;
+}
+
+void
+PathPrefetcherPrivate::
+thread_main(PathPrefetcherPrivate *p)
+{
+  boost::unique_lock<boost::mutex> lock(p->m_mutex);
+  for(;;)
+    {
+      while(p->m_queue.empty() && !p->m_quit)
+        {
+          p->m_condition.wait(lock);
+        }
+
+      if(p->m_quit)
+        {
+          return;
+        }
+
+      const fastuidraw::Path *path(p->m_queue.front());
+      std::map<const fastuidraw::Path*, job>::iterator iter;
+
+      p->m_queue.pop_front();
+      iter = p->m_scheduled.find(path);
+
+      /* skip the Path if its work is taken by another
+         thread, is cancelled or is already in progress;
+         in the last case it is queued again once the
+         work in progress is done.
+       */
+      if(iter == p->m_scheduled.end() || p->find_active(path) != p->m_active.size())
+        {
+          continue;
+        }
+
+      job J(iter->second);
+      fastuidraw::reference_counted_ptr<fastuidraw::PathPrefetcher::CallBack> call_back(p->m_call_back);
+
+      p->m_scheduled.erase(iter);
+      p->m_active.push_back(PathPrefetcherPrivate::active_job(path, J));
+
+      /* the Path stays alive and unchanged while it is in
+         m_active because PathPrefetcher::cancel() waits
+         for it to leave m_active.
+       */
+      lock.unlock();
+      {
+        fastuidraw::reference_counted_ptr<const fastuidraw::TessellatedPath> tess;
+        bool ready;
+
+        /* the levels of detail are made one at a time, each
+           together with the data to draw it, so that a thread
+           drawing the finest level already made finds its data
+           made as well.
+         */
+        tess = path->tessellation_if_ready(J.m_thresh, &ready);
+        do
+          {
+            float thresh(J.m_thresh);
+            if(tess && !ready)
+              {
+                thresh = fastuidraw::t_max(thresh, 0.5f * tess->effective_curve_distance_threshhold());
+              }
+
+            tess = path->tessellation(thresh);
+            if(J.m_flags & fastuidraw::PathPrefetcher::prefetch_filled)
+              {
+                tess->filled()->painter_data();
+              }
+            if(J.m_flags & fastuidraw::PathPrefetcher::prefetch_stroked)
+              {
+                tess->stroked();
+              }
+            path->tessellation_if_ready(J.m_thresh, &ready);
+          }
+        while(!ready);
+
+        if(call_back)
+          {
+            call_back->tessellation_ready(*path, J.m_thresh);
+          }
+        call_back = fastuidraw::reference_counted_ptr<fastuidraw::PathPrefetcher::CallBack>();
+      }
+      lock.lock();
+
+      p->m_active.erase(p->m_active.begin() + p->find_active(path));
+      ++p->m_number_completed;
+      if(p->m_scheduled.find(path) != p->m_scheduled.end())
+        {
+          p->m_queue.push_back(path);
+        }
+      p->m_condition.notify_all();
+    }
+}
+
+//////////////////////////////////////////
+// fastuidraw::PathPrefetcher methods
+fastuidraw::PathPrefetcher::
+PathPrefetcher(unsigned int number_threads)
+{
+  m_d = FASTUIDRAWnew PathPrefetcherPrivate(number_threads);
+}
+
+fastuidraw::PathPrefetcher::
+~PathPrefetcher()
+{
+  PathPrefetcherPrivate *d;
+  d = reinterpret_cast<PathPrefetcherPrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = NULL;
+}
+
+void
+fastuidraw::PathPrefetcher::
+prefetch(const Path &path, float thresh, uint32_t flags)
+{
+  PathPrefetcherPrivate *d;
+  d = reinterpret_cast<PathPrefetcherPrivate*>(m_d);
+
+  /* done outside of the lock because attaching the Path
+     may cancel its work on a different PathPrefetcher
+   */
+  path.prefetcher(this);
+
+  boost::lock_guard<boost::mutex> lock(d->m_mutex);
+  unsigned int a(d->find_active(&path));
+  job J(thresh, flags);
+  std::map<const Path*, job>::iterator iter;
+
+  if(a != d->m_active.size() && d->m_active[a].second.covers(J))
+    {
+      return;
+    }
+
+  iter = d->m_scheduled.find(&path);
+  if(iter != d->m_scheduled.end())
+    {
+      iter->second.merge(J);
+    }
+  else
+    {
+      d->m_scheduled.insert(std::make_pair(&path, J));
+      d->m_queue.push_back(&path);
+      d->m_condition.notify_one();
+    }
+}
+
+void
+fastuidraw::PathPrefetcher::
+cancel(const Path &path)
+{
+  PathPrefetcherPrivate *d;
+  d = reinterpret_cast<PathPrefetcherPrivate*>(m_d);
+
+  boost::unique_lock<boost::mutex> lock(d->m_mutex);
+  d->m_scheduled.erase(&path);
+  while(d->find_active(&path) != d->m_active.size())
+    {
+      d->m_condition.wait(lock);
+    }
+}
+
+void
+fastuidraw::PathPrefetcher::
+wait(void)
+{
+  PathPrefetcherPrivate *d;
+  d = reinterpret_cast<PathPrefetcherPrivate*>(m_d);
+
+  boost::unique_lock<boost::mutex> lock(d->m_mutex);
+  while(!d->m_scheduled.empty() || !d->m_active.empty())
+    {
+      d->m_condition.wait(lock);
+    }
+}
+
+unsigned int
+fastuidraw::PathPrefetcher::
+number_pending(void) const
+{
+  PathPrefetcherPrivate *d;
+  d = reinterpret_cast<PathPrefetcherPrivate*>(m_d);
+
+  boost::lock_guard<boost::mutex> lock(d->m_mutex);
+  return d->m_scheduled.size() + d->m_active.size();
+}
+
+unsigned int
+fastuidraw::PathPrefetcher::
+number_completed(void) const
+{
+  PathPrefetcherPrivate *d;
+  d = reinterpret_cast<PathPrefetcherPrivate*>(m_d);
+
+  boost::lock_guard<boost::mutex> lock(d->m_mutex);
+  return d->m_number_completed;
+}
+
+void
+fastuidraw::PathPrefetcher::
+call_back(const reference_counted_ptr<CallBack> &v)
+{
+  PathPrefetcherPrivate *d;
+  d = reinterpret_cast<PathPrefetcherPrivate*>(m_d);
+
+  boost::lock_guard<boost::mutex> lock(d->m_mutex);
+  d->m_call_back = v;
+}
+
+fastuidraw::reference_counted_ptr<fastuidraw::PathPrefetcher::CallBack>
+fastuidraw::PathPrefetcher::
+call_back(void) const
+{
+  PathPrefetcherPrivate *d;
+  d = reinterpret_cast<PathPrefetcherPrivate*>(m_d);
+
+  boost::lock_guard<boost::mutex> lock(d->m_mutex);
+  return d->m_call_back;
+}
@@ -17,12 +17,14 @@
  */
 
 #include "clip.hpp"
+#include <fastuidraw/util/math.hpp>
 #include "util_private.hpp"
 
 bool
 fastuidraw::detail::
 clip_against_plane(const vec3 &clip_eq, const_c_array<vec2> pts,
-                   std::vector<vec2> &out_pts, std::vector<float> &work_room)
+                   small_vector_base<vec2> &out_pts,
+                   small_vector_base<float> &work_room)
 {
   /* clip the convex polygon of pts, placing the results
      into out_pts.
@@ -162,24 +164,93 @@ clip_against_plane(const vec3 &clip_eq, const_c_array<vec2> pts,
 bool
 fastuidraw::detail::
 clip_against_planes(const_c_array<vec3> clip_eq, const_c_array<vec2> in_pts,
-                    std::vector<vec2> &out_pts,
-                    std::vector<float> &scratch_space_floats,
-                    vecN<std::vector<vec2>, 2> &scratch_space_vec2s)
+                    small_vector_base<vec2> &out_pts,
+                    small_vector_base<float> &scratch_space_floats,
+                    vecN<clip_points, 2> &scratch_space_vec2s)
 {
-  unsigned int src(0), dst(1), i;
-  bool return_value(true);
+  /* the planes for which we track which points are clipped
+     are those that fit within the bits of a uint32_t; planes
+     past that are always clipped against.
+   */
+  const unsigned int max_masked_planes(32);
+  unsigned int num_masked, src, dst;
+  uint32_t all_clipped, any_clipped;
+  const_c_array<vec2> current;
+  bool return_value;
+
+  if(in_pts.empty())
+    {
+      out_pts.resize(0);
+      return clip_eq.empty();
+    }
+
+  /* First evaluate every point against every plane in a single
+     pass over the points, recording for each point a bit-mask of
+     the planes that clip it. A plane that clips every point
+     clips away the entire convex polygon and a plane that clips
+     no point does not change it; thus only those planes that the
+     polygon crosses need to be clipped against.
+   */
+  num_masked = t_min(static_cast<unsigned int>(clip_eq.size()), max_masked_planes);
+  all_clipped = (num_masked < max_masked_planes) ?
+    (uint32_t(1u) << num_masked) - uint32_t(1u) :
+    ~uint32_t(0u);
+  any_clipped = 0u;
 
-  scratch_space_vec2s[src].resize(in_pts.size());
-  std::copy(in_pts.begin(), in_pts.end(), scratch_space_vec2s[src].begin());
+  for(unsigned int i = 0; i < in_pts.size(); ++i)
+    {
+      const vec2 &p(in_pts[i]);
+      uint32_t mask(0u);
+
+      for(unsigned int k = 0; k < num_masked; ++k)
+        {
+          const vec3 &eq(clip_eq[k]);
+          float d;
 
-  for(i = 0; i < clip_eq.size(); ++i, std::swap(src, dst))
+          d = eq.x() * p.x() + eq.y() * p.y() + eq.z();
+          mask |= (d < 0.0f) ? (uint32_t(1u) << k) : uint32_t(0u);
+        }
+      all_clipped &= mask;
+      any_clipped |= mask;
+    }
+
+  if(all_clipped != 0u)
+    {
+      out_pts.resize(0);
+      return false;
+    }
+
+  if(any_clipped == 0u && num_masked == clip_eq.size())
+    {
+      out_pts.resize(in_pts.size());
+      std::copy(in_pts.begin(), in_pts.end(), out_pts.begin());
+      return true;
+    }
+
+  /* clip against those planes the polygon crosses; the first
+     clip reads directly from in_pts, so there is no need to
+     copy in_pts to the scratch space.
+   */
+  return_value = (any_clipped == 0u);
+  current = in_pts;
+  src = dst = 0;
+  for(unsigned int i = 0; i < clip_eq.size() && !current.empty(); ++i)
     {
       bool r;
-      r = clip_against_plane(clip_eq[i], make_c_array(scratch_space_vec2s[src]),
+
+      if(i < num_masked && (any_clipped & (uint32_t(1u) << i)) == 0u)
+        {
+          continue;
+        }
+
+      r = clip_against_plane(clip_eq[i], current,
                              scratch_space_vec2s[dst],
                              scratch_space_floats);
       return_value = return_value && r;
+      current = make_c_array(scratch_space_vec2s[dst]);
+      src = dst;
+      dst = 1 - dst;
     }
-  std::swap(out_pts, scratch_space_vec2s[src]);
+  out_pts.swap(scratch_space_vec2s[src]);
   return return_value;
 }
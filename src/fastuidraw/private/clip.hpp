@@ -19,14 +19,19 @@
 
 #pragma once
 
-#include <vector>
 #include <fastuidraw/util/vecN.hpp>
 #include <fastuidraw/util/c_array.hpp>
+#include "small_vector.hpp"
 
 namespace fastuidraw
 {
   namespace detail
   {
+    /* Point buffer for clipping; a quad clipped by up
+       to 12 planes fits within the inline storage.
+     */
+    typedef small_vector<vec2, 16> clip_points;
+
     /* Clip a polygon against a single plane. The clip equation
        clip_eq and the polygon pts are both in the same coordinate
        system (likely local). Returns true if the polygon is
@@ -34,7 +39,8 @@ namespace fastuidraw
      */
     bool
     clip_against_plane(const vec3 &clip_eq, const_c_array<vec2> pts,
-                       std::vector<vec2> &out_pts, std::vector<float> &scratch_space);
+                       small_vector_base<vec2> &out_pts,
+                       small_vector_base<float> &scratch_space);
 
     /* Clip a polygon against several planes. The clip equations
        clip_eq and the polygon pts are both in the same coordinate
@@ -43,8 +49,8 @@ namespace fastuidraw
      */
     bool
     clip_against_planes(const_c_array<vec3> clip_eq, const_c_array<vec2> in_pts,
-                        std::vector<vec2> &out_pts,
-                        std::vector<float> &scratch_space_floats,
-                        vecN<std::vector<vec2>, 2> &scratch_space_vec2s);
+                        small_vector_base<vec2> &out_pts,
+                        small_vector_base<float> &scratch_space_floats,
+                        vecN<clip_points, 2> &scratch_space_vec2s);
   }
 }
@@ -18,6 +18,7 @@
 
 #include <cmath>
 #include <fastuidraw/util/math.hpp>
+#include "util_private.hpp"
 #include "path_util_private.hpp"
 
 unsigned int
@@ -54,3 +55,18 @@ number_segments_for_tessellation(float arc_angle, float distance_thresh)
   needed_sizef = t_abs(arc_angle) / theta;
   return fastuidraw::t_max(3u, static_cast<unsigned int>(needed_sizef));
 }
+
+fastuidraw::const_c_array<fastuidraw::TessellatedPath::point>
+fastuidraw::detail::
+point_data(const TessellatedPath &P,
+           std::vector<TessellatedPath::point> &work_room)
+{
+  if(!P.tessellation_parameters().m_compact_point_data)
+    {
+      return P.point_data();
+    }
+
+  work_room.resize(P.number_points());
+  P.extract_point_data(make_c_array(work_room));
+  return make_c_array(work_room);
+}
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <vector>
 #include <fastuidraw/tessellated_path.hpp>
 
 namespace fastuidraw
@@ -31,5 +32,13 @@ namespace fastuidraw
 
     unsigned int
     number_segments_for_tessellation(float arc_angle, float distance_thresh);
+
+    /* returns the point data of a TessellatedPath; if its points
+       are stored compactly, they are expanded into work_room so
+       that the TessellatedPath does not keep the expansion.
+     */
+    const_c_array<TessellatedPath::point>
+    point_data(const TessellatedPath &P,
+               std::vector<TessellatedPath::point> &work_room);
   }
 }
@@ -0,0 +1,351 @@
+/*!
+ * \file small_vector.hpp
+ * \brief file small_vector.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#pragma once
+
+#include <new>
+#include <vector>
+#include <algorithm>
+#include <fastuidraw/util/util.hpp>
+#include <fastuidraw/util/vecN.hpp>
+#include <fastuidraw/util/c_array.hpp>
+
+namespace fastuidraw
+{
+  /*!
+    A small_vector_base is the interface of small_vector that
+    does not depend on the inline capacity, so that functions
+    can take a small_vector of any capacity. The elements are
+    stored within the small_vector until there are more than
+    its inline capacity, at which point they are moved to the
+    heap. Once on the heap, the elements stay there and the
+    heap storage is never released by clear() or resize(),
+    so that a small_vector used as scratch space stops
+    allocating once it has reached the largest size it is
+    used with. The type T must be default constructible and
+    copyable; elements past size() are left in place (and
+    not destroyed) by clear(), resize() and pop_back().
+   */
+  template<typename T>
+  class small_vector_base:noncopyable
+  {
+  public:
+    /*!
+      STL compliant typedef
+     */
+    typedef T value_type;
+
+    /*!
+      STL compliant typedef
+     */
+    typedef T* iterator;
+
+    /*!
+      STL compliant typedef
+     */
+    typedef const T* const_iterator;
+
+    /*!
+      STL compliant typedef
+     */
+    typedef size_t size_type;
+
+    /*!
+      Returns the number of elements.
+     */
+    size_type
+    size(void) const
+    {
+      return m_size;
+    }
+
+    /*!
+      Returns true if there are no elements.
+     */
+    bool
+    empty(void) const
+    {
+      return m_size == 0;
+    }
+
+    /*!
+      Returns the number of elements that can be held
+      without allocating.
+     */
+    size_type
+    capacity(void) const
+    {
+      return m_capacity;
+    }
+
+    /*!
+      Returns true if the elements are within the
+      inline storage of the small_vector.
+     */
+    bool
+    is_inline(void) const
+    {
+      return m_data == m_inline;
+    }
+
+    T&
+    operator[](size_type i)
+    {
+      assert(i < m_size);
+      return m_data[i];
+    }
+
+    const T&
+    operator[](size_type i) const
+    {
+      assert(i < m_size);
+      return m_data[i];
+    }
+
+    T&
+    back(void)
+    {
+      assert(m_size > 0);
+      return m_data[m_size - 1];
+    }
+
+    const T&
+    back(void) const
+    {
+      assert(m_size > 0);
+      return m_data[m_size - 1];
+    }
+
+    iterator
+    begin(void)
+    {
+      return m_data;
+    }
+
+    const_iterator
+    begin(void) const
+    {
+      return m_data;
+    }
+
+    iterator
+    end(void)
+    {
+      return m_data + m_size;
+    }
+
+    const_iterator
+    end(void) const
+    {
+      return m_data + m_size;
+    }
+
+    /*!
+      Returns a pointer to the elements.
+     */
+    T*
+    c_ptr(void)
+    {
+      return m_data;
+    }
+
+    /*!
+      Returns a pointer to the elements.
+     */
+    const T*
+    c_ptr(void) const
+    {
+      return m_data;
+    }
+
+    /*!
+      Sets the size to zero, the storage is kept.
+     */
+    void
+    clear(void)
+    {
+      m_size = 0;
+    }
+
+    /*!
+      Makes sure that n elements can be held
+      without allocating.
+     */
+    void
+    reserve(size_type n)
+    {
+      if(n <= m_capacity)
+        {
+          return;
+        }
+
+      n = std::max(n, 2 * m_capacity);
+      if(is_inline())
+        {
+          m_heap.resize(n);
+          std::copy(m_inline, m_inline + m_size, m_heap.begin());
+        }
+      else
+        {
+          m_heap.resize(n);
+        }
+      m_data = &m_heap[0];
+      m_capacity = n;
+    }
+
+    /*!
+      Resize; new elements are default constructed
+      in place, i.e. no temporary T is copied.
+     */
+    void
+    resize(size_type n)
+    {
+      reserve(n);
+      for(size_type i = m_size; i < n; ++i)
+        {
+          m_data[i].~T();
+          new (&m_data[i]) T();
+        }
+      m_size = n;
+    }
+
+    /*!
+      Resize; new elements are set to a value.
+     */
+    void
+    resize(size_type n, const T &value)
+    {
+      reserve(n);
+      if(n > m_size)
+        {
+          std::fill(m_data + m_size, m_data + n, value);
+        }
+      m_size = n;
+    }
+
+    void
+    push_back(const T &value)
+    {
+      if(m_size == m_capacity)
+        {
+          /* value may be an element of this */
+          T v(value);
+
+          reserve(m_size + 1);
+          m_data[m_size] = v;
+        }
+      else
+        {
+          m_data[m_size] = value;
+        }
+      ++m_size;
+    }
+
+    void
+    pop_back(void)
+    {
+      assert(m_size > 0);
+      --m_size;
+    }
+
+    /*!
+      Swap the elements with those of another small_vector_base,
+      the storage is only exchanged if both are on the heap.
+     */
+    void
+    swap(small_vector_base &obj)
+    {
+      if(!is_inline() && !obj.is_inline())
+        {
+          m_heap.swap(obj.m_heap);
+          std::swap(m_capacity, obj.m_capacity);
+          m_data = &m_heap[0];
+          obj.m_data = &obj.m_heap[0];
+        }
+      else
+        {
+          size_type n(std::max(m_size, obj.m_size));
+
+          reserve(n);
+          obj.reserve(n);
+          std::swap_ranges(m_data, m_data + n, obj.m_data);
+        }
+      std::swap(m_size, obj.m_size);
+    }
+
+  protected:
+    small_vector_base(T *inline_storage, size_type inline_capacity):
+      m_data(inline_storage),
+      m_size(0),
+      m_capacity(inline_capacity),
+      m_inline(inline_storage)
+    {}
+
+  private:
+    T *m_data;
+    size_type m_size, m_capacity;
+    T *m_inline;
+    std::vector<T> m_heap;
+  };
+
+  namespace detail
+  {
+    /* holds the inline storage of a small_vector, it is a base
+       class of small_vector so that it is constructed before
+       small_vector_base takes its address.
+     */
+    template<typename T, size_t N>
+    class small_vector_storage
+    {
+    public:
+      vecN<T, N> m_inline_storage;
+    };
+  }
+
+  /*!
+    A small_vector holds up to N elements within itself, i.e.
+    without a heap allocation, see small_vector_base.
+    \tparam T element type
+    \tparam N inline capacity
+   */
+  template<typename T, size_t N>
+  class small_vector:
+    private detail::small_vector_storage<T, N>,
+    public small_vector_base<T>
+  {
+  public:
+    small_vector(void):
+      small_vector_base<T>(this->m_inline_storage.c_ptr(), N)
+    {}
+  };
+
+  template<typename T>
+  c_array<T>
+  make_c_array(small_vector_base<T> &p)
+  {
+    return c_array<T>(p.c_ptr(), p.size());
+  }
+
+  template<typename T>
+  const_c_array<T>
+  make_c_array(const small_vector_base<T> &p)
+  {
+    return const_c_array<T>(p.c_ptr(), p.size());
+  }
+}
@@ -20,8 +20,12 @@
 #pragma once
 
 #include <boost/thread.hpp>
+#include <boost/chrono.hpp>
+
+#include <stdint.h>
 
 #include <vector>
+#include <fastuidraw/util/util.hpp>
 #include <fastuidraw/util/c_array.hpp>
 
 namespace fastuidraw
@@ -70,6 +74,199 @@ namespace fastuidraw
     mutex &m_mutex;
   };
 
+  /*!
+    Returns the value of a monotonic clock in nanoseconds;
+    only differences between values are meaningful.
+   */
+  inline
+  uint64_t
+  timer_nanoseconds(void)
+  {
+    boost::chrono::nanoseconds t;
+    t = boost::chrono::steady_clock::now().time_since_epoch();
+    return t.count();
+  }
+
+  /*!
+    Adds the time elapsed between ctor and dtor to
+    a counter. If the counter is NULL, does nothing.
+   */
+  class scoped_timer:fastuidraw::noncopyable
+  {
+  public:
+    explicit
+    scoped_timer(uint64_t *counter):
+      m_counter(counter),
+      m_start(counter ? timer_nanoseconds() : 0)
+    {}
+
+    ~scoped_timer()
+    {
+      if(m_counter)
+        {
+          *m_counter += timer_nanoseconds() - m_start;
+        }
+    }
+  private:
+    uint64_t *m_counter;
+    uint64_t m_start;
+  };
+
+  /*!
+    Picks which of a sequence of short tasks to time so
+    that timing them costs little: one in every period
+    tasks on average, at pseudo-random intervals so that
+    a sequence of tasks that repeats is not always timed
+    at the same task. The time of a timed task multiplied
+    by period estimates the time of the tasks since the
+    previously timed one.
+   */
+  class timer_sampler
+  {
+  public:
+    enum
+      {
+        period = 64
+      };
+
+    timer_sampler(void):
+      m_countdown(period),
+      m_state(1u)
+    {}
+
+    /*!
+      Returns true if the next task is to be timed.
+     */
+    bool
+    sample(void)
+    {
+      if(--m_countdown != 0u)
+        {
+          return false;
+        }
+
+      /* the next interval is uniform in [1, 2 * period - 1] */
+      m_state = m_state * 1664525u + 1013904223u;
+      m_countdown = 1u + (m_state >> 16u) % (2u * period - 1u);
+      return true;
+    }
+
+  private:
+    uint32_t m_countdown;
+    uint32_t m_state;
+  };
+
+  /*!
+    Adds to a counter the time elapsed between ctor
+    and dtor, multiplied by timer_sampler::period, if
+    the timer_sampler picks the task. If the counter is
+    NULL, does nothing (and does not advance the
+    timer_sampler).
+   */
+  class sampled_scoped_timer:fastuidraw::noncopyable
+  {
+  public:
+    sampled_scoped_timer(uint64_t *counter, timer_sampler &sampler):
+      m_counter(counter && sampler.sample() ? counter : NULL),
+      m_start(m_counter ? timer_nanoseconds() : 0)
+    {}
+
+    ~sampled_scoped_timer()
+    {
+      if(m_counter)
+        {
+          *m_counter += (timer_nanoseconds() - m_start) * timer_sampler::period;
+        }
+    }
+  private:
+    uint64_t *m_counter;
+    uint64_t m_start;
+  };
+
+  /*!
+    Converts a float to a 16-bit float, rounding to nearest
+    even; values too large for a 16-bit float become infinity.
+   */
+  inline
+  uint16_t
+  pack_fp16(float f)
+  {
+    uint32_t u(pack_float(f));
+    uint32_t sign((u >> 16u) & 0x8000u);
+    uint32_t biased_exponent((u >> 23u) & 0xFFu);
+    uint32_t mantissa(u & 0x7FFFFFu);
+    int exponent(int(biased_exponent) - 127 + 15);
+    uint32_t h, rem, half;
+
+    if(biased_exponent == 0xFFu)
+      {
+        /* infinity or NaN */
+        return sign | 0x7C00u | (mantissa != 0u ? 0x200u : 0u);
+      }
+
+    if(exponent >= 31)
+      {
+        return sign | 0x7C00u;
+      }
+
+    if(exponent <= 0)
+      {
+        /* denormal 16-bit float or zero */
+        uint32_t shift;
+
+        if(exponent < -10)
+          {
+            return sign;
+          }
+        mantissa |= 0x800000u;
+        shift = uint32_t(14 - exponent);
+        h = mantissa >> shift;
+        rem = mantissa & ((1u << shift) - 1u);
+        half = 1u << (shift - 1u);
+      }
+    else
+      {
+        h = (uint32_t(exponent) << 10u) | (mantissa >> 13u);
+        rem = mantissa & 0x1FFFu;
+        half = 0x1000u;
+      }
+
+    /* rounding up may carry into the exponent, which
+       is correct, including becoming infinity.
+     */
+    if(rem > half || (rem == half && (h & 1u) != 0u))
+      {
+        ++h;
+      }
+    return sign | h;
+  }
+
+  /*!
+    Converts a 16-bit float to a float.
+   */
+  inline
+  float
+  unpack_fp16(uint16_t v)
+  {
+    uint32_t sign(uint32_t(v & 0x8000u) << 16u);
+    uint32_t exponent((v >> 10u) & 0x1Fu);
+    uint32_t mantissa(v & 0x3FFu);
+
+    if(exponent == 0u)
+      {
+        float f;
+        f = static_cast<float>(mantissa) / 16777216.0f;
+        return (sign != 0u) ? -f : f;
+      }
+
+    if(exponent == 31u)
+      {
+        return unpack_float(sign | 0x7F800000u | (mantissa << 13u));
+      }
+
+    return unpack_float(sign | ((exponent + 112u) << 23u) | (mantissa << 13u));
+  }
+
   template<typename T>
   c_array<T>
   make_c_array(std::vector<T> &p)
@@ -17,8 +17,10 @@
  */
 
 
-#include <list>
+#include <algorithm>
 #include <vector>
+#include <iostream>
+#include <boost/atomic.hpp>
 #include <fastuidraw/tessellated_path.hpp>
 #include <fastuidraw/path.hpp>
 #include <fastuidraw/painter/stroked_path.hpp>
@@ -27,138 +29,454 @@
 
 namespace
 {
+  /* the tessellation of a single contour, the values of
+     m_edge_ranges are relative to the start of the contour.
+   */
+  class ContourTessellation
+  {
+  public:
+    ContourTessellation(void):
+      m_box_min(0.0f, 0.0f),
+      m_box_max(0.0f, 0.0f),
+      m_effective_curve_distance_threshhold(0.0f),
+      m_effective_curvature_threshhold(0.0f),
+      m_max_segments(0u),
+      m_open_contour_length(0.0f),
+      m_closed_contour_length(0.0f)
+    {}
+
+    void
+    tessellate(const fastuidraw::PathContour &contour,
+               const fastuidraw::TessellatedPath::TessellationParams &params,
+               std::vector<fastuidraw::TessellatedPath::point> &work_room);
+
+    std::vector<fastuidraw::TessellatedPath::point> m_points;
+    std::vector<fastuidraw::range_type<unsigned int> > m_edge_ranges;
+    std::vector<float> m_edge_start_distances;
+    fastuidraw::vec2 m_box_min, m_box_max;
+    float m_effective_curve_distance_threshhold;
+    float m_effective_curvature_threshhold;
+    unsigned int m_max_segments;
+    float m_open_contour_length, m_closed_contour_length;
+  };
+
+  /* tessellates the contours of a Path, taking the contours
+     one at a time from a counter shared by the threads.
+   */
+  class ContourTessellator
+  {
+  public:
+    ContourTessellator(const fastuidraw::Path *input,
+                       const fastuidraw::TessellatedPath::TessellationParams *params,
+                       std::vector<ContourTessellation> *contours,
+                       boost::atomic<unsigned int> *next_contour):
+      m_input(input),
+      m_params(params),
+      m_contours(contours),
+      m_next_contour(next_contour)
+    {}
+
+    void
+    operator()(void) const;
+
+  private:
+    const fastuidraw::Path *m_input;
+    const fastuidraw::TessellatedPath::TessellationParams *m_params;
+    std::vector<ContourTessellation> *m_contours;
+    boost::atomic<unsigned int> *m_next_contour;
+  };
+
+  inline
+  bool
+  point_before_range_end(unsigned int i, const fastuidraw::range_type<unsigned int> &R)
+  {
+    return i < R.m_end;
+  }
+
   class TessellatedPathPrivate
   {
   public:
     TessellatedPathPrivate(const fastuidraw::Path &input,
                            fastuidraw::TessellatedPath::TessellationParams TP);
 
+    /* returns the point of the compact point data at index
+       i which is on edge e of contour o
+     */
+    fastuidraw::TessellatedPath::point
+    compact_point(unsigned int o, unsigned int e, unsigned int i) const;
+
+    /* writes the points of the compact point data of the
+       range R to dst
+     */
+    void
+    expand_compact_points(fastuidraw::range_type<unsigned int> R,
+                          fastuidraw::c_array<fastuidraw::TessellatedPath::point> dst) const;
+
+    /* returns the points of the range R, expanding compact
+       point data to work_room if there is no kept expansion
+     */
+    fastuidraw::const_c_array<fastuidraw::TessellatedPath::point>
+    point_range(fastuidraw::range_type<unsigned int> R,
+                fastuidraw::c_array<fastuidraw::TessellatedPath::point> work_room) const;
+
+    /* finds the contour o and edge e of the point at index i
+       by binary search.
+     */
+    void
+    locate_point(unsigned int i, unsigned int *o, unsigned int *e) const;
+
     std::vector<std::vector<fastuidraw::range_type<unsigned int> > > m_edge_ranges;
+    unsigned int m_number_points;
+
+    /* m_contour_ends[o] is one past the index of the last point
+       of contour o (or of the contours before it if it has no
+       points); it is non-decreasing, for locate_point().
+     */
+    std::vector<unsigned int> m_contour_ends;
+
+    /* the points if m_params.m_compact_point_data is false;
+       otherwise the expansion of the compact points made on
+       first use with m_mutex locked, m_point_data_ready is
+       set after.
+     */
     std::vector<fastuidraw::TessellatedPath::point> m_point_data;
+    boost::atomic<bool> m_point_data_ready;
+
+    /* the points if m_params.m_compact_point_data is true: per
+       point the position, the derivative as two 16-bit floats
+       and the distance from the start of the edge; per edge
+       the distance of the start of the edge from the start of
+       the contour and per contour the open and closed lengths.
+     */
+    std::vector<fastuidraw::vec2> m_compact_p;
+    std::vector<uint16_t> m_compact_p_t;
+    std::vector<float> m_compact_distance_from_edge_start;
+    std::vector<std::vector<float> > m_edge_start_distances;
+    std::vector<fastuidraw::vec2> m_contour_lengths;
+
     fastuidraw::vec2 m_box_min, m_box_max;
     fastuidraw::TessellatedPath::TessellationParams m_params;
     float m_effective_curve_distance_threshhold;
     float m_effective_curvature_threshhold;
     unsigned int m_max_segments;
+    /* m_stroked and m_filled are made on first use with m_mutex
+       locked, m_stroked_ready and m_filled_ready are set after
+     */
     fastuidraw::reference_counted_ptr<const fastuidraw::StrokedPath> m_stroked;
     fastuidraw::reference_counted_ptr<const fastuidraw::FilledPath> m_filled;
+    boost::atomic<bool> m_stroked_ready, m_filled_ready;
+    boost::mutex m_mutex;
   };
 }
 
+//////////////////////////////////////////////
+// ContourTessellation methods
+void
+ContourTessellation::
+tessellate(const fastuidraw::PathContour &contour,
+           const fastuidraw::TessellatedPath::TessellationParams &params,
+           std::vector<fastuidraw::TessellatedPath::point> &work_room)
+{
+  float contour_length(0.0f), open_contour_length(0.0f), closed_contour_length(0.0f);
+
+  m_edge_ranges.resize(contour.number_points());
+  m_edge_start_distances.resize(contour.number_points());
+  for(unsigned int loc = 0, e = 0, ende = contour.number_points(); e < ende; ++e)
+    {
+      unsigned int needed;
+      float thresh_dist(0.0f), thresh_curvature(0.0f);
+
+      needed = contour.interpolator(e)->produce_tessellation(params,
+                                                             fastuidraw::make_c_array(work_room),
+                                                             &thresh_dist,
+                                                             &thresh_curvature);
+      m_edge_ranges[e] = fastuidraw::range_type<unsigned int>(loc, loc + needed);
+      m_edge_start_distances[e] = contour_length;
+      loc += needed;
+
+      assert(needed > 0u);
+      m_max_segments = fastuidraw::t_max(m_max_segments, needed - 1);
+      m_effective_curve_distance_threshhold = fastuidraw::t_max(m_effective_curve_distance_threshhold, thresh_dist);
+      m_effective_curvature_threshhold = fastuidraw::t_max(m_effective_curvature_threshhold, thresh_curvature);
+
+      for(unsigned int n = 0; n < needed; ++n)
+        {
+          const fastuidraw::vec2 &pt(work_room[n].m_p);
+
+          work_room[n].m_distance_from_contour_start = contour_length + work_room[n].m_distance_from_edge_start;
+          work_room[n].m_edge_length = work_room[needed - 1].m_distance_from_edge_start;
+
+          if(e == 0 and n == 0)
+            {
+              m_box_min = pt;
+              m_box_max = pt;
+            }
+          else
+            {
+              m_box_min.x() = std::min(m_box_min.x(), pt.x());
+              m_box_min.y() = std::min(m_box_min.y(), pt.y());
+              m_box_max.x() = std::max(m_box_max.x(), pt.x());
+              m_box_max.y() = std::max(m_box_max.y(), pt.y());
+            }
+        }
+      m_points.insert(m_points.end(), work_room.begin(), work_room.begin() + needed);
+
+      contour_length = m_points.back().m_distance_from_contour_start;
+      if(e + 2 == ende)
+        {
+          open_contour_length = contour_length;
+        }
+      else if(e + 1 == ende)
+        {
+          closed_contour_length = contour_length;
+        }
+    }
+
+  m_open_contour_length = open_contour_length;
+  m_closed_contour_length = closed_contour_length;
+  for(unsigned int i = 0, endi = m_points.size(); i < endi; ++i)
+    {
+      m_points[i].m_open_contour_length = open_contour_length;
+      m_points[i].m_closed_contour_length = closed_contour_length;
+    }
+}
+
+//////////////////////////////////////////////
+// ContourTessellator methods
+void
+ContourTessellator::
+operator()(void) const
+{
+  std::vector<fastuidraw::TessellatedPath::point> work_room(m_params->m_max_segments + 1);
+  for(unsigned int o = m_next_contour->fetch_add(1); o < m_contours->size(); o = m_next_contour->fetch_add(1))
+    {
+      (*m_contours)[o].tessellate(*m_input->contour(o), *m_params, work_room);
+    }
+}
+
 //////////////////////////////////////////////
 // TessellatedPathPrivate methods
 TessellatedPathPrivate::
 TessellatedPathPrivate(const fastuidraw::Path &input,
                        fastuidraw::TessellatedPath::TessellationParams TP):
   m_edge_ranges(input.number_contours()),
+  m_number_points(0u),
+  m_contour_ends(input.number_contours(), 0u),
+  m_point_data_ready(!TP.m_compact_point_data),
   m_box_min(0.0f, 0.0f),
   m_box_max(0.0f, 0.0f),
   m_params(TP),
   m_effective_curve_distance_threshhold(0.0f),
   m_effective_curvature_threshhold(0.0f),
-  m_max_segments(0u)
+  m_max_segments(0u),
+  m_stroked_ready(false),
+  m_filled_ready(false)
 {
-  if(input.number_contours() > 0)
+  if(input.number_contours() == 0)
+    {
+      return;
+    }
+
+  /* the contours are tessellated independently, each to its
+     own buffer, and then stitched in order; the result does
+     not depend on the number of threads.
+   */
+  std::vector<ContourTessellation> contours(input.number_contours());
+  boost::atomic<unsigned int> next_contour(0u);
+  ContourTessellator tessellator(&input, &m_params, &contours, &next_contour);
+  unsigned int number_threads;
+
+  number_threads = fastuidraw::t_min(m_params.m_max_threads, input.number_contours());
+  if(number_threads > 1u)
+    {
+      boost::thread_group threads;
+
+      /* this thread is one of the threads
+       */
+      for(unsigned int i = 1; i < number_threads; ++i)
+        {
+          threads.create_thread(tessellator);
+        }
+      tessellator();
+      threads.join_all();
+    }
+  else
+    {
+      tessellator();
+    }
+
+  unsigned int total_needed(0);
+  for(unsigned int o = 0, endo = contours.size(); o < endo; ++o)
     {
-      std::list<std::vector<fastuidraw::TessellatedPath::point> > temp;
-      std::vector<fastuidraw::TessellatedPath::point> work_room(m_params.m_max_segments + 1);
-      std::list<std::vector<fastuidraw::TessellatedPath::point> >::const_iterator iter, end_iter;
+      const ContourTessellation &C(contours[o]);
 
-      for(unsigned int loc = 0, o = 0, endo = input.number_contours(); o < endo; ++o)
+      m_edge_ranges[o].resize(C.m_edge_ranges.size());
+      for(unsigned int e = 0, ende = C.m_edge_ranges.size(); e < ende; ++e)
+        {
+          m_edge_ranges[o][e] = fastuidraw::range_type<unsigned int>(total_needed + C.m_edge_ranges[e].m_begin,
+                                                                     total_needed + C.m_edge_ranges[e].m_end);
+        }
+      total_needed += C.m_points.size();
+      m_contour_ends[o] = total_needed;
+
+      m_max_segments = fastuidraw::t_max(m_max_segments, C.m_max_segments);
+      m_effective_curve_distance_threshhold = fastuidraw::t_max(m_effective_curve_distance_threshhold,
+                                                                C.m_effective_curve_distance_threshhold);
+      m_effective_curvature_threshhold = fastuidraw::t_max(m_effective_curvature_threshhold,
+                                                           C.m_effective_curvature_threshhold);
+
+      /* the box starts at the first point of the first contour,
+         or at the origin if the first contour has no points.
+       */
+      if(o == 0 && !C.m_points.empty())
+        {
+          m_box_min = C.m_box_min;
+          m_box_max = C.m_box_max;
+        }
+      else if(!C.m_points.empty())
         {
-          fastuidraw::reference_counted_ptr<const fastuidraw::PathContour> contour(input.contour(o));
-          float contour_length(0.0f), open_contour_length(0.0f), closed_contour_length(0.0f);
-          std::list<std::vector<fastuidraw::TessellatedPath::point> >::iterator start_contour;
+          m_box_min.x() = std::min(m_box_min.x(), C.m_box_min.x());
+          m_box_min.y() = std::min(m_box_min.y(), C.m_box_min.y());
+          m_box_max.x() = std::max(m_box_max.x(), C.m_box_max.x());
+          m_box_max.y() = std::max(m_box_max.y(), C.m_box_max.y());
+        }
+    }
 
-          m_edge_ranges[o].resize(contour->number_points());
-          for(unsigned int e = 0, ende = contour->number_points(); e < ende; ++e)
+  m_number_points = total_needed;
+  if(!m_params.m_compact_point_data)
+    {
+      m_point_data.resize(total_needed);
+      for(unsigned int o = 0, endo = contours.size(); o < endo; ++o)
+        {
+          const ContourTessellation &C(contours[o]);
+          if(!C.m_points.empty())
             {
-              unsigned int needed;
-              float thresh_dist(0.0f), thresh_curvature(0.0f);
-
-              temp.push_back(std::vector<fastuidraw::TessellatedPath::point>());
-              needed = contour->interpolator(e)->produce_tessellation(m_params,
-                                                                      fastuidraw::make_c_array(work_room),
-                                                                      &thresh_dist,
-                                                                      &thresh_curvature);
-              m_edge_ranges[o][e] = fastuidraw::range_type<unsigned int>(loc, loc + needed);
-              loc += needed;
-
-              assert(needed > 0u);
-              m_max_segments = fastuidraw::t_max(m_max_segments, needed - 1);
-              m_effective_curve_distance_threshhold = fastuidraw::t_max(m_effective_curve_distance_threshhold, thresh_dist);
-              m_effective_curvature_threshhold = fastuidraw::t_max(m_effective_curvature_threshhold, thresh_curvature);
-
-              for(unsigned int n = 0; n < needed; ++n)
-                {
-                  const fastuidraw::vec2 &pt(work_room[n].m_p);
-
-                  work_room[n].m_distance_from_contour_start = contour_length + work_room[n].m_distance_from_edge_start;
-
-                  if(o == 0 and e == 0 and n == 0)
-                    {
-                      m_box_min = pt;
-                      m_box_max = pt;
-                    }
-                  else
-                    {
-                      m_box_min.x() = std::min(m_box_min.x(), pt.x());
-                      m_box_min.y() = std::min(m_box_min.y(), pt.y());
-                      m_box_max.x() = std::max(m_box_max.x(), pt.x());
-                      m_box_max.y() = std::max(m_box_max.y(), pt.y());
-                    }
-                }
-              std::list<std::vector<fastuidraw::TessellatedPath::point> >::iterator t;
-              t = temp.insert(temp.end(),
-                              std::vector<fastuidraw::TessellatedPath::point>(work_room.begin(), work_room.begin() + needed));
-              if(e == 0)
-                {
-                  start_contour = t;
-                }
-
-              contour_length = temp.back().back().m_distance_from_contour_start;
-
-              if(e + 2 == ende)
-                {
-                  open_contour_length = contour_length;
-                }
-              else if(e + 1 == ende)
-                {
-                  closed_contour_length = contour_length;
-                }
-
-              for(unsigned int n = 0; n < needed; ++n)
-                {
-                  (*t)[n].m_edge_length = (*t)[needed - 1].m_distance_from_edge_start;
-                }
+              std::copy(C.m_points.begin(), C.m_points.end(),
+                        m_point_data.begin() + m_edge_ranges[o].front().m_begin);
             }
+        }
+      return;
+    }
+
+  m_compact_p.resize(total_needed);
+  m_compact_p_t.resize(2 * total_needed);
+  m_compact_distance_from_edge_start.resize(total_needed);
+  m_edge_start_distances.resize(contours.size());
+  m_contour_lengths.resize(contours.size());
+  for(unsigned int o = 0, endo = contours.size(); o < endo; ++o)
+    {
+      const ContourTessellation &C(contours[o]);
+
+      m_edge_start_distances[o] = C.m_edge_start_distances;
+      m_contour_lengths[o] = fastuidraw::vec2(C.m_open_contour_length, C.m_closed_contour_length);
+      if(C.m_points.empty())
+        {
+          continue;
+        }
 
-          for(std::list<std::vector<fastuidraw::TessellatedPath::point> >::iterator
-                t = start_contour, endt = temp.end(); t != endt; ++t)
+      for(unsigned int i = 0, dst = m_edge_ranges[o].front().m_begin, endi = C.m_points.size(); i < endi; ++i, ++dst)
+        {
+          fastuidraw::vec2 p_t(C.m_points[i].m_p_t);
+          float m;
+
+          /* scale a derivative too large for a 16-bit float
+             so that it keeps its direction
+           */
+          m = fastuidraw::t_max(fastuidraw::t_abs(p_t.x()), fastuidraw::t_abs(p_t.y()));
+          if(m > 65504.0f)
             {
-              for(unsigned int e = 0, ende = t->size(); e < ende; ++e)
-                {
-                  (*t)[e].m_open_contour_length = open_contour_length;
-                  (*t)[e].m_closed_contour_length = closed_contour_length;
-                }
+              p_t *= 65504.0f / m;
             }
+
+          m_compact_p[dst] = C.m_points[i].m_p;
+          m_compact_p_t[2 * dst] = fastuidraw::pack_fp16(p_t.x());
+          m_compact_p_t[2 * dst + 1] = fastuidraw::pack_fp16(p_t.y());
+          m_compact_distance_from_edge_start[dst] = C.m_points[i].m_distance_from_edge_start;
         }
+    }
+}
+
+fastuidraw::TessellatedPath::point
+TessellatedPathPrivate::
+compact_point(unsigned int o, unsigned int e, unsigned int i) const
+{
+  fastuidraw::TessellatedPath::point pt;
+  const fastuidraw::range_type<unsigned int> &R(m_edge_ranges[o][e]);
+
+  pt.m_p = m_compact_p[i];
+  pt.m_p_t = fastuidraw::vec2(fastuidraw::unpack_fp16(m_compact_p_t[2 * i]),
+                              fastuidraw::unpack_fp16(m_compact_p_t[2 * i + 1]));
+  pt.m_distance_from_edge_start = m_compact_distance_from_edge_start[i];
+  pt.m_distance_from_contour_start = m_edge_start_distances[o][e] + pt.m_distance_from_edge_start;
+  pt.m_edge_length = m_compact_distance_from_edge_start[R.m_end - 1];
+  pt.m_open_contour_length = m_contour_lengths[o].x();
+  pt.m_closed_contour_length = m_contour_lengths[o].y();
+  return pt;
+}
 
-      unsigned int total_needed;
+void
+TessellatedPathPrivate::
+locate_point(unsigned int i, unsigned int *o, unsigned int *e) const
+{
+  std::vector<unsigned int>::const_iterator co;
+  std::vector<fastuidraw::range_type<unsigned int> >::const_iterator ce;
+
+  assert(i < m_number_points);
+  co = std::upper_bound(m_contour_ends.begin(), m_contour_ends.end(), i);
+  assert(co != m_contour_ends.end());
+  *o = co - m_contour_ends.begin();
+
+  const std::vector<fastuidraw::range_type<unsigned int> > &edges(m_edge_ranges[*o]);
+  ce = std::upper_bound(edges.begin(), edges.end(), i, point_before_range_end);
+  assert(ce != edges.end());
+  *e = ce - edges.begin();
+}
 
-      total_needed = m_edge_ranges.back().back().m_end;
-      m_point_data.reserve(total_needed);
-      for(iter = temp.begin(), end_iter = temp.end(); iter != end_iter; ++iter)
+void
+TessellatedPathPrivate::
+expand_compact_points(fastuidraw::range_type<unsigned int> R,
+                      fastuidraw::c_array<fastuidraw::TessellatedPath::point> dst) const
+{
+  unsigned int o, e;
+
+  assert(dst.size() == R.m_end - R.m_begin);
+  if(R.m_begin == R.m_end)
+    {
+      return;
+    }
+
+  locate_point(R.m_begin, &o, &e);
+  for(unsigned int i = R.m_begin; i < R.m_end; ++i)
+    {
+      while(i >= m_edge_ranges[o][e].m_end)
         {
-          std::copy(iter->begin(), iter->end(),
-                    std::back_insert_iterator<std::vector<fastuidraw::TessellatedPath::point> >(m_point_data));
+          /* next edge, skipping contours without edges
+           */
+          ++e;
+          while(e == m_edge_ranges[o].size())
+            {
+              ++o;
+              e = 0;
+            }
         }
-      assert(total_needed == m_point_data.size());
+      dst[i - R.m_begin] = compact_point(o, e, i);
     }
-  else
+}
+
+fastuidraw::const_c_array<fastuidraw::TessellatedPath::point>
+TessellatedPathPrivate::
+point_range(fastuidraw::range_type<unsigned int> R,
+            fastuidraw::c_array<fastuidraw::TessellatedPath::point> work_room) const
+{
+  if(m_point_data_ready.load(boost::memory_order_acquire))
     {
-      m_box_min = m_box_max = fastuidraw::vec2(0.0f, 0.0f);
+      return make_c_array(m_point_data).sub_array(R);
     }
+
+  assert(work_room.size() >= R.m_end - R.m_begin);
+  work_room = work_room.sub_array(0, R.m_end - R.m_begin);
+  expand_compact_points(R, work_room);
+  return work_room;
 }
 
 //////////////////////////////////////
@@ -174,7 +492,7 @@ TessellatedPath(const Path &input,
             << effective_curve_distance_threshhold()
             << ", curvature = "
             << effective_curvature_threshhold()
-            << ", num_points = " << point_data().size() << ")\n";
+            << ", num_points = " << number_points() << ")\n";
 }
 
 fastuidraw::TessellatedPath::
@@ -192,9 +510,14 @@ stroked(void) const
 {
   TessellatedPathPrivate *d;
   d = reinterpret_cast<TessellatedPathPrivate*>(m_d);
-  if(!d->m_stroked)
+  if(!d->m_stroked_ready.load(boost::memory_order_acquire))
     {
-      d->m_stroked = FASTUIDRAWnew StrokedPath(*this);
+      boost::lock_guard<boost::mutex> lock(d->m_mutex);
+      if(!d->m_stroked)
+        {
+          d->m_stroked = FASTUIDRAWnew StrokedPath(*this);
+          d->m_stroked_ready.store(true, boost::memory_order_release);
+        }
     }
   return d->m_stroked;
 }
@@ -205,9 +528,14 @@ filled(void) const
 {
   TessellatedPathPrivate *d;
   d = reinterpret_cast<TessellatedPathPrivate*>(m_d);
-  if(!d->m_filled)
+  if(!d->m_filled_ready.load(boost::memory_order_acquire))
     {
-      d->m_filled = FASTUIDRAWnew FilledPath(*this);
+      boost::lock_guard<boost::mutex> lock(d->m_mutex);
+      if(!d->m_filled)
+        {
+          d->m_filled = FASTUIDRAWnew FilledPath(*this);
+          d->m_filled_ready.store(true, boost::memory_order_release);
+        }
     }
   return d->m_filled;
 }
@@ -256,9 +584,102 @@ point_data(void) const
   TessellatedPathPrivate *d;
   d = reinterpret_cast<TessellatedPathPrivate*>(m_d);
 
+  if(!d->m_point_data_ready.load(boost::memory_order_acquire))
+    {
+      boost::lock_guard<boost::mutex> lock(d->m_mutex);
+      if(d->m_point_data.empty() && d->m_number_points > 0)
+        {
+          d->m_point_data.resize(d->m_number_points);
+          d->expand_compact_points(range_type<unsigned int>(0, d->m_number_points),
+                                   make_c_array(d->m_point_data));
+        }
+      d->m_point_data_ready.store(true, boost::memory_order_release);
+    }
   return make_c_array(d->m_point_data);
 }
 
+void
+fastuidraw::TessellatedPath::
+extract_point_data(c_array<point> dst) const
+{
+  TessellatedPathPrivate *d;
+  d = reinterpret_cast<TessellatedPathPrivate*>(m_d);
+
+  assert(dst.size() == d->m_number_points);
+  extract_point_data(range_type<unsigned int>(0, d->m_number_points), dst);
+}
+
+void
+fastuidraw::TessellatedPath::
+extract_point_data(range_type<unsigned int> R, c_array<point> dst) const
+{
+  TessellatedPathPrivate *d;
+  d = reinterpret_cast<TessellatedPathPrivate*>(m_d);
+
+  assert(R.m_begin <= R.m_end && R.m_end <= d->m_number_points);
+  assert(dst.size() == R.m_end - R.m_begin);
+  if(d->m_params.m_compact_point_data)
+    {
+      d->expand_compact_points(R, dst);
+    }
+  else
+    {
+      std::copy(d->m_point_data.begin() + R.m_begin,
+                d->m_point_data.begin() + R.m_end,
+                dst.begin());
+    }
+}
+
+fastuidraw::TessellatedPath::point
+fastuidraw::TessellatedPath::
+point_value(unsigned int i) const
+{
+  TessellatedPathPrivate *d;
+  d = reinterpret_cast<TessellatedPathPrivate*>(m_d);
+
+  assert(i < d->m_number_points);
+  if(!d->m_params.m_compact_point_data)
+    {
+      return d->m_point_data[i];
+    }
+
+  unsigned int o, e;
+  d->locate_point(i, &o, &e);
+  return d->compact_point(o, e, i);
+}
+
+unsigned int
+fastuidraw::TessellatedPath::
+number_points(void) const
+{
+  TessellatedPathPrivate *d;
+  d = reinterpret_cast<TessellatedPathPrivate*>(m_d);
+
+  return d->m_number_points;
+}
+
+unsigned int
+fastuidraw::TessellatedPath::
+point_data_bytes(void) const
+{
+  TessellatedPathPrivate *d;
+  d = reinterpret_cast<TessellatedPathPrivate*>(m_d);
+
+  if(!d->m_params.m_compact_point_data)
+    {
+      return d->m_number_points * sizeof(point);
+    }
+
+  unsigned int return_value;
+  return_value = d->m_number_points * (sizeof(vec2) + 2 * sizeof(uint16_t) + sizeof(float))
+    + d->m_contour_lengths.size() * sizeof(vec2);
+  for(unsigned int o = 0, endo = d->m_edge_start_distances.size(); o < endo; ++o)
+    {
+      return_value += d->m_edge_start_distances[o].size() * sizeof(float);
+    }
+  return return_value;
+}
+
 unsigned int
 fastuidraw::TessellatedPath::
 number_contours(void) const
@@ -301,21 +722,35 @@ unclosed_contour_range(unsigned int contour) const
 fastuidraw::const_c_array<fastuidraw::TessellatedPath::point>
 fastuidraw::TessellatedPath::
 contour_point_data(unsigned int contour) const
+{
+  return point_data().sub_array(contour_range(contour));
+}
+
+fastuidraw::const_c_array<fastuidraw::TessellatedPath::point>
+fastuidraw::TessellatedPath::
+unclosed_contour_point_data(unsigned int contour) const
+{
+  return point_data().sub_array(unclosed_contour_range(contour));
+}
+
+fastuidraw::const_c_array<fastuidraw::TessellatedPath::point>
+fastuidraw::TessellatedPath::
+contour_point_data(unsigned int contour, c_array<point> work_room) const
 {
   TessellatedPathPrivate *d;
   d = reinterpret_cast<TessellatedPathPrivate*>(m_d);
 
-  return make_c_array(d->m_point_data).sub_array(contour_range(contour));
+  return d->point_range(contour_range(contour), work_room);
 }
 
 fastuidraw::const_c_array<fastuidraw::TessellatedPath::point>
 fastuidraw::TessellatedPath::
-unclosed_contour_point_data(unsigned int contour) const
+unclosed_contour_point_data(unsigned int contour, c_array<point> work_room) const
 {
   TessellatedPathPrivate *d;
   d = reinterpret_cast<TessellatedPathPrivate*>(m_d);
 
-  return make_c_array(d->m_point_data).sub_array(unclosed_contour_range(contour));
+  return d->point_range(unclosed_contour_range(contour), work_room);
 }
 
 unsigned int
@@ -341,11 +776,18 @@ edge_range(unsigned int contour, unsigned int edge) const
 fastuidraw::const_c_array<fastuidraw::TessellatedPath::point>
 fastuidraw::TessellatedPath::
 edge_point_data(unsigned int contour, unsigned int edge) const
+{
+  return point_data().sub_array(edge_range(contour, edge));
+}
+
+fastuidraw::const_c_array<fastuidraw::TessellatedPath::point>
+fastuidraw::TessellatedPath::
+edge_point_data(unsigned int contour, unsigned int edge, c_array<point> work_room) const
 {
   TessellatedPathPrivate *d;
   d = reinterpret_cast<TessellatedPathPrivate*>(m_d);
 
-  return make_c_array(d->m_point_data).sub_array(edge_range(contour, edge));
+  return d->point_range(edge_range(contour, edge), work_room);
 }
 
 fastuidraw::vec2